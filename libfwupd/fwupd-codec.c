@@ -7,6 +7,7 @@
 #include "config.h"
 
 #include "fwupd-codec.h"
+#include "fwupd-enums-private.h"
 #include "fwupd-error.h"
 
 /**
@@ -317,6 +318,73 @@ fwupd_codec_from_variant(FwupdCodec *self, GVariant *value, GError **error)
 	return FALSE;
 }
 
+/* the single object created by fwupd_codec_array_pack(), or NULL if not packed */
+static GVariant *
+fwupd_codec_array_lookup_packed(GVariant *value, guint32 *byte_order)
+{
+	g_autoptr(GVariant) dict = NULL;
+	g_autoptr(GVariant) blob = NULL;
+
+	if (g_variant_n_children(value) != 1)
+		return NULL;
+	dict = g_variant_get_child_value(value, 0);
+	blob = g_variant_lookup_value(dict, FWUPD_RESULT_KEY_PACKED, G_VARIANT_TYPE_BYTESTRING);
+	if (blob == NULL)
+		return NULL;
+	if (!g_variant_lookup(dict, FWUPD_RESULT_KEY_PACKED_BYTE_ORDER, "u", byte_order))
+		*byte_order = G_BYTE_ORDER;
+	return g_steal_pointer(&blob);
+}
+
+/* replaces @value with the array it contains if it was packed */
+static void
+fwupd_codec_array_unpack(GVariant **value)
+{
+	guint32 byte_order = G_BYTE_ORDER;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GVariant) blob = NULL;
+	GVariant *unpacked;
+
+	blob = fwupd_codec_array_lookup_packed(*value, &byte_order);
+	if (blob == NULL)
+		return;
+
+	/* not trusted, so GVariant checks each child as it is accessed */
+	bytes = g_variant_get_data_as_bytes(blob);
+	unpacked = g_variant_ref_sink(
+	    g_variant_new_from_bytes(G_VARIANT_TYPE("aa{sv}"), bytes, FALSE));
+	if (byte_order != G_BYTE_ORDER) {
+		GVariant *tmp = g_variant_byteswap(unpacked);
+		g_variant_unref(unpacked);
+		unpacked = tmp;
+	}
+	g_variant_unref(*value);
+	*value = unpacked;
+}
+
+/* sending one blob avoids GDBus marshalling every dictionary entry of every object */
+static GVariant *
+fwupd_codec_array_pack(GVariant *value)
+{
+	GVariantBuilder builder;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GVariant) value_sunk = g_variant_ref_sink(value);
+
+	bytes = g_variant_get_data_as_bytes(value_sunk);
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("aa{sv}"));
+	g_variant_builder_open(&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add(&builder,
+			      "{sv}",
+			      FWUPD_RESULT_KEY_PACKED,
+			      g_variant_new_from_bytes(G_VARIANT_TYPE_BYTESTRING, bytes, TRUE));
+	g_variant_builder_add(&builder,
+			      "{sv}",
+			      FWUPD_RESULT_KEY_PACKED_BYTE_ORDER,
+			      g_variant_new_uint32(G_BYTE_ORDER));
+	g_variant_builder_close(&builder);
+	return g_variant_new("(aa{sv})", &builder);
+}
+
 /**
  * fwupd_codec_array_from_variant:
  * @value: a JSON node
@@ -325,6 +393,8 @@ fwupd_codec_from_variant(FwupdCodec *self, GVariant *value, GError **error)
  *
  * Converts an array of objects, each deserialized from a #GVariant value.
  *
+ * Arrays created using %FWUPD_CODEC_FLAG_PACKED are unpacked automatically.
+ *
  * Returns: (element-type GObject) (transfer container): %TRUE on success
  *
  * Since: 2.0.0
@@ -341,6 +411,7 @@ fwupd_codec_array_from_variant(GVariant *value, GType gtype, GError **error)
 
 	array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	untuple = g_variant_get_child_value(value, 0);
+	fwupd_codec_array_unpack(&untuple);
 	sz = g_variant_n_children(untuple);
 	for (guint i = 0; i < sz; i++) {
 		g_autoptr(GObject) gobj = g_object_new(gtype, NULL);
@@ -391,6 +462,9 @@ fwupd_codec_array_to_json(GPtrArray *array,
  *
  * Converts an array of objects into a #GVariant value.
  *
+ * If @flags includes %FWUPD_CODEC_FLAG_PACKED then the array is serialized into a single object,
+ * which should only be sent to clients that set %FWUPD_FEATURE_FLAG_PACKED_PAYLOADS.
+ *
  * Returns: (transfer full): a #GVariant
  *
  * Since: 2.0.0
@@ -407,6 +481,8 @@ fwupd_codec_array_to_variant(GPtrArray *array, FwupdCodecFlags flags)
 		FwupdCodec *codec = FWUPD_CODEC(g_ptr_array_index(array, i));
 		g_variant_builder_add_value(&builder, fwupd_codec_to_variant(codec, flags));
 	}
+	if (flags & FWUPD_CODEC_FLAG_PACKED)
+		return fwupd_codec_array_pack(g_variant_builder_end(&builder));
 	return g_variant_new("(aa{sv})", &builder);
 }
 
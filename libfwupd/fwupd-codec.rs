@@ -11,4 +11,7 @@ enum FwupdCodecFlags {
     // Compress values to the smallest possible size.
     // Since: 2.0.8
     Compressed = 1 << 1,
+    // Pack arrays into a single serialized blob, which is much cheaper to send over D-Bus.
+    // Since: 2.1.1
+    Packed = 1 << 2,
 }
@@ -678,5 +678,21 @@ G_BEGIN_DECLS
  * The D-Bus type signature string is 's' i.e. a string.
  **/
 #define FWUPD_RESULT_KEY_DEVICE_NAME "DeviceName"
+/**
+ * FWUPD_RESULT_KEY_PACKED:
+ *
+ * Result key to represent an array of objects serialized as a single `aa{sv}` blob.
+ *
+ * The D-Bus type signature string is 'ay' i.e. a byte array.
+ **/
+#define FWUPD_RESULT_KEY_PACKED "Packed"
+/**
+ * FWUPD_RESULT_KEY_PACKED_BYTE_ORDER:
+ *
+ * Result key to represent the byte order of the packed blob, e.g. `G_LITTLE_ENDIAN`.
+ *
+ * The D-Bus type signature string is 'u' i.e. a unsigned 32 bit integer.
+ **/
+#define FWUPD_RESULT_KEY_PACKED_BYTE_ORDER "PackedByteOrder"
 
 G_END_DECLS
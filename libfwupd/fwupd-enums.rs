@@ -77,6 +77,9 @@ enum FwupdFeatureFlags {
     // Can handle showing non-generic request message text.
     // Since: 1.9.8
     RequestsNonGeneric = 1 << 9,
+    // Can decode arrays of objects packed into a single serialized blob.
+    // Since: 2.1.1
+    PackedPayloads = 1 << 10,
     // Unknown flag.
     Unknown = u64::MAX,
 }
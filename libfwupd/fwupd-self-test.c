@@ -109,7 +109,7 @@ fwupd_enums_func(void)
 		g_assert_cmpstr(tmp, !=, NULL);
 		g_assert_cmpint(fwupd_plugin_flag_from_string(tmp), ==, i);
 	}
-	for (guint64 i = 1; i <= FWUPD_FEATURE_FLAG_REQUESTS_NON_GENERIC; i *= 2) {
+	for (guint64 i = 1; i <= FWUPD_FEATURE_FLAG_PACKED_PAYLOADS; i *= 2) {
 		const gchar *tmp = fwupd_feature_flag_to_string(i);
 		g_assert_cmpstr(tmp, !=, NULL);
 		g_assert_cmpint(fwupd_feature_flag_from_string(tmp), ==, i);
@@ -842,6 +842,96 @@ fwupd_request_func(void)
 			"950da62d4c753a26e64f7f7d687104ce38e32ca5");
 }
 
+/* roundtrip through the D-Bus wire format, like a method return would */
+static GPtrArray *
+fwupd_codec_packed_roundtrip(GPtrArray *devices, FwupdCodecFlags flags, GTimer *timer)
+{
+	gdouble elapsed_to;
+	gsize bufsz = 0;
+	g_autofree guchar *buf = NULL;
+	g_autoptr(GDBusMessage) msg1 = g_dbus_message_new();
+	g_autoptr(GDBusMessage) msg2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices_new = NULL;
+
+	g_timer_reset(timer);
+	g_dbus_message_set_body(msg1, fwupd_codec_array_to_variant(devices, flags));
+	buf = g_dbus_message_to_blob(msg1, &bufsz, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(buf);
+	elapsed_to = g_timer_elapsed(timer, NULL);
+
+	g_timer_reset(timer);
+	msg2 = g_dbus_message_new_from_blob(buf, bufsz, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(msg2);
+	devices_new = fwupd_codec_array_from_variant(g_dbus_message_get_body(msg2),
+						     FWUPD_TYPE_DEVICE,
+						     &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices_new);
+	g_debug("%s: serialize=%.1fms deserialize=%.1fms size=%" G_GSIZE_FORMAT "kB",
+		flags & FWUPD_CODEC_FLAG_PACKED ? "packed" : "dict",
+		elapsed_to * 1000.f,
+		g_timer_elapsed(timer, NULL) * 1000.f,
+		bufsz / 1024);
+	return g_steal_pointer(&devices_new);
+}
+
+static void
+fwupd_codec_packed_func(void)
+{
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func(g_object_unref);
+	g_autoptr(GPtrArray) devices_dict = NULL;
+	g_autoptr(GPtrArray) devices_packed = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* about the size of a large dock with a lot of attached devices */
+	for (guint i = 0; i < 500; i++) {
+		g_autofree gchar *id = g_strdup_printf("%040x", i);
+		g_autofree gchar *name = g_strdup_printf("Device %u", i);
+		g_autoptr(FwupdDevice) device = fwupd_device_new();
+		g_autoptr(FwupdRelease) release = fwupd_release_new();
+
+		fwupd_device_set_id(device, id);
+		fwupd_device_set_name(device, name);
+		fwupd_device_set_vendor(device, "Acme Corp");
+		fwupd_device_add_vendor_id(device, "USB:0x1234");
+		fwupd_device_add_guid(device, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+		fwupd_device_add_guid(device, "00000000-0000-0000-0000-000000000000");
+		fwupd_device_add_instance_id(device, "USB\\VID_1234&PID_5678");
+		fwupd_device_add_protocol(device, "com.acme");
+		fwupd_device_add_icon(device, "input-gaming");
+		fwupd_device_add_flag(device, FWUPD_DEVICE_FLAG_UPDATABLE);
+		fwupd_device_add_flag(device, FWUPD_DEVICE_FLAG_INTERNAL);
+		fwupd_device_set_version(device, "1.2.3");
+		fwupd_device_set_version_raw(device, 0x10203);
+		fwupd_device_set_version_format(device, FWUPD_VERSION_FORMAT_TRIPLET);
+		fwupd_device_set_created(device, 1700000000);
+		fwupd_device_set_plugin(device, "acme");
+		fwupd_release_set_version(release, "1.2.4");
+		fwupd_release_set_summary(release, "A firmware update");
+		fwupd_device_add_release(device, release);
+		g_ptr_array_add(devices, g_steal_pointer(&device));
+	}
+
+	/* both need to give the same result */
+	devices_dict = fwupd_codec_packed_roundtrip(devices, FWUPD_CODEC_FLAG_TRUSTED, timer);
+	devices_packed = fwupd_codec_packed_roundtrip(devices,
+						      FWUPD_CODEC_FLAG_TRUSTED |
+							  FWUPD_CODEC_FLAG_PACKED,
+						      timer);
+	g_assert_cmpint(devices_dict->len, ==, devices->len);
+	g_assert_cmpint(devices_packed->len, ==, devices->len);
+	for (guint i = 0; i < devices->len; i++) {
+		g_autofree gchar *str1 =
+		    fwupd_codec_to_string(FWUPD_CODEC(g_ptr_array_index(devices_dict, i)));
+		g_autofree gchar *str2 =
+		    fwupd_codec_to_string(FWUPD_CODEC(g_ptr_array_index(devices_packed, i)));
+		g_assert_cmpstr(str1, ==, str2);
+	}
+}
+
 static void
 fwupd_device_filter_func(void)
 {
@@ -1864,6 +1954,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/request", fwupd_request_func);
 	g_test_add_func("/fwupd/device", fwupd_device_func);
 	g_test_add_func("/fwupd/device{filter}", fwupd_device_filter_func);
+	g_test_add_func("/fwupd/codec{packed}", fwupd_codec_packed_func);
 	g_test_add_func("/fwupd/security-attr", fwupd_security_attr_func);
 	g_test_add_func("/fwupd/bios-attrs", fwupd_bios_settings_func);
 	g_test_add_func("/fwupd/client_api", fwupd_client_api);
@@ -23,22 +23,81 @@
 /**
  * FuArchive:
  *
- * An in-memory archive decompressor
+ * An archive decompressor.
+ *
+ * Loading an archive only reads the headers, and each entry is decompressed when it is looked up.
+ * The reader is kept open between lookups, so looking up entries in archive order only
+ * decompresses the archive once.
  */
 
+typedef struct {
+	gchar *fn;
+	GBytes *blob;  /* nullable, only set when added using fu_archive_add_entry() */
+	gint64 size;   /* uncompressed */
+	gint64 offset; /* of the header */
+	guint idx;     /* of the header */
+} FuArchiveEntry;
+
+typedef struct {
+	GInputStream *stream;
+	goffset offset; /* the caller may also use the stream between lookups */
+	guint8 buf[0x8000];
+} FuArchiveStreamHelper;
+
 struct _FuArchive {
 	GObject parent_instance;
-	GHashTable *entries; /* str:GBytes */
+	GBytes *data;		       /* nullable */
+	GInputStream *stream;	       /* nullable */
+	GPtrArray *entries;	       /* element-type FuArchiveEntry, in archive order */
+	GHashTable *entry_map;	       /* str:FuArchiveEntry */
+	FuArchiveEntry *entry_last;    /* nullable, last entry that was decompressed */
+	GBytes *blob_last;	       /* nullable, contents of @entry_last */
+	FuArchiveStreamHelper *helper; /* nullable */
+#ifdef HAVE_LIBARCHIVE
+	struct archive *arch; /* nullable, kept open for the next lookup */
+	guint arch_idx;	      /* of the next header */
+#endif
 };
 
 G_DEFINE_TYPE(FuArchive, fu_archive, G_TYPE_OBJECT)
 
+static void
+fu_archive_entry_free(FuArchiveEntry *entry)
+{
+	g_free(entry->fn);
+	if (entry->blob != NULL)
+		g_bytes_unref(entry->blob);
+	g_free(entry);
+}
+
+static void
+fu_archive_reader_close(FuArchive *self)
+{
+#ifdef HAVE_LIBARCHIVE
+	if (self->arch != NULL) {
+		archive_read_close(self->arch);
+		archive_read_free(self->arch);
+		self->arch = NULL;
+	}
+	self->arch_idx = 0;
+#endif
+}
+
 static void
 fu_archive_finalize(GObject *obj)
 {
 	FuArchive *self = FU_ARCHIVE(obj);
 
-	g_hash_table_unref(self->entries);
+	fu_archive_reader_close(self);
+	g_free(self->helper);
+	if (self->blob_last != NULL)
+		g_bytes_unref(self->blob_last);
+	if (self->data != NULL)
+		g_bytes_unref(self->data);
+	if (self->stream != NULL)
+		g_object_unref(self->stream);
+	g_hash_table_unref(self->entry_map);
+	g_ptr_array_unref(self->entries);
 	G_OBJECT_CLASS(fu_archive_parent_class)->finalize(obj);
 }
 
@@ -52,8 +111,25 @@ fu_archive_class_init(FuArchiveClass *klass)
 static void
 fu_archive_init(FuArchive *self)
 {
-	self->entries =
-	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
+	self->entries = g_ptr_array_new_with_free_func((GDestroyNotify)fu_archive_entry_free);
+	self->entry_map = g_hash_table_new(g_str_hash, g_str_equal);
+}
+
+/* replaces any existing entry with the same name */
+static void
+fu_archive_add_entry_internal(FuArchive *self, FuArchiveEntry *entry)
+{
+	FuArchiveEntry *entry_old = g_hash_table_lookup(self->entry_map, entry->fn);
+	if (entry_old != NULL) {
+		if (self->entry_last == entry_old) {
+			self->entry_last = NULL;
+			g_clear_pointer(&self->blob_last, g_bytes_unref);
+		}
+		g_hash_table_remove(self->entry_map, entry_old->fn);
+		g_ptr_array_remove(self->entries, entry_old);
+	}
+	g_hash_table_insert(self->entry_map, entry->fn, entry);
+	g_ptr_array_add(self->entries, entry);
 }
 
 /**
@@ -69,74 +145,18 @@ fu_archive_init(FuArchive *self)
 void
 fu_archive_add_entry(FuArchive *self, const gchar *fn, GBytes *blob)
 {
+	FuArchiveEntry *entry;
+
 	g_return_if_fail(FU_IS_ARCHIVE(self));
 	g_return_if_fail(fn != NULL);
 	g_return_if_fail(blob != NULL);
-	g_hash_table_insert(self->entries, g_strdup(fn), g_bytes_ref(blob));
-}
-
-/**
- * fu_archive_lookup_by_fn:
- * @self: a #FuArchive
- * @fn: a filename
- * @error: (nullable): optional return location for an error
- *
- * Finds the blob referenced by filename
- *
- * Returns: (transfer full): a #GBytes, or %NULL if the filename was not found
- *
- * Since: 1.2.2
- **/
-GBytes *
-fu_archive_lookup_by_fn(FuArchive *self, const gchar *fn, GError **error)
-{
-	GBytes *bytes;
-
-	g_return_val_if_fail(FU_IS_ARCHIVE(self), NULL);
-	g_return_val_if_fail(fn != NULL, NULL);
-	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
-
-	bytes = g_hash_table_lookup(self->entries, fn);
-	if (bytes == NULL) {
-		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no blob for %s", fn);
-		return NULL;
-	}
-	return g_bytes_ref(bytes);
-}
-
-/**
- * fu_archive_iterate:
- * @self: a #FuArchive
- * @callback: (scope call) (closure user_data): a #FuArchiveIterateFunc.
- * @user_data: user data
- * @error: (nullable): optional return location for an error
- *
- * Iterates over the archive contents, calling the given function for each
- * of the files found. If any @callback returns %FALSE scanning is aborted.
- *
- * Returns: True if no @callback returned FALSE
- *
- * Since: 1.3.4
- */
-gboolean
-fu_archive_iterate(FuArchive *self,
-		   FuArchiveIterateFunc callback,
-		   gpointer user_data,
-		   GError **error)
-{
-	GHashTableIter iter;
-	gpointer key, value;
 
-	g_return_val_if_fail(FU_IS_ARCHIVE(self), FALSE);
-	g_return_val_if_fail(callback != NULL, FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
-	g_hash_table_iter_init(&iter, self->entries);
-	while (g_hash_table_iter_next(&iter, &key, &value)) {
-		if (!callback(self, (const gchar *)key, (GBytes *)value, user_data, error))
-			return FALSE;
-	}
-	return TRUE;
+	entry = g_new0(FuArchiveEntry, 1);
+	entry->fn = g_strdup(fn);
+	entry->blob = g_bytes_ref(blob);
+	entry->size = g_bytes_get_size(blob);
+	entry->idx = G_MAXUINT;
+	fu_archive_add_entry_internal(self, entry);
 }
 
 #ifdef HAVE_LIBARCHIVE
@@ -239,9 +259,108 @@ fu_archive_set_compression(_archive_write_ctx *arch, FuArchiveCompression compre
 #endif
 }
 
+/* the reader may be kept open, so do not assume the stream is where we left it */
+static gboolean
+fu_archive_stream_helper_restore(FuArchiveStreamHelper *helper, GError **error)
+{
+	if (g_seekable_tell(G_SEEKABLE(helper->stream)) == helper->offset)
+		return TRUE;
+	return g_seekable_seek(G_SEEKABLE(helper->stream), helper->offset, G_SEEK_SET, NULL, error);
+}
+
+static gint64
+fu_archive_skip_cb(struct archive *arch, void *client_data, off_t request)
+{
+	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
+	gssize cnt;
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_archive_stream_helper_restore(helper, &error_local)) {
+		archive_set_error(arch,
+				  ARCHIVE_FAILED,
+				  "failed to seek stream: %s",
+				  error_local->message);
+		return -1;
+	}
+	cnt = g_input_stream_skip(helper->stream, request, NULL, &error_local);
+	if (cnt < 0) {
+		archive_set_error(arch,
+				  ARCHIVE_FAILED,
+				  "failed to read from stream: %s",
+				  error_local->message);
+		return -1;
+	}
+	helper->offset += cnt;
+	return cnt;
+}
+
+static gssize
+fu_archive_read_cb(struct archive *arch, void *client_data, const void **buffer)
+{
+	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
+	gssize cnt;
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_archive_stream_helper_restore(helper, &error_local)) {
+		archive_set_error(arch,
+				  ARCHIVE_FAILED,
+				  "failed to seek stream: %s",
+				  error_local->message);
+		return -1;
+	}
+	cnt = g_input_stream_read(helper->stream,
+				  helper->buf,
+				  sizeof(helper->buf),
+				  NULL,
+				  &error_local);
+	if (cnt < 0) {
+		archive_set_error(arch,
+				  ARCHIVE_FAILED,
+				  "failed to read from stream: %s",
+				  error_local->message);
+		return -1;
+	}
+	if (cnt > 0)
+		*buffer = helper->buf;
+	helper->offset += cnt;
+	return cnt;
+}
+
+static GSeekType
+fu_archive_whence_to_seek_type(gint whence)
+{
+	if (whence == SEEK_SET)
+		return G_SEEK_SET;
+	if (whence == SEEK_END)
+		return G_SEEK_END;
+	return G_SEEK_CUR;
+}
+
+static gint64
+fu_archive_seek_cb(struct archive *arch, void *client_data, gint64 offset, gint whence)
+{
+	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
+	g_autoptr(GError) error_local = NULL;
+	if (!fu_archive_stream_helper_restore(helper, &error_local) ||
+	    !g_seekable_seek(G_SEEKABLE(helper->stream),
+			     offset,
+			     fu_archive_whence_to_seek_type(whence),
+			     NULL,
+			     &error_local)) {
+		archive_set_error(arch,
+				  ARCHIVE_FAILED,
+				  "failed to read from stream: %s",
+				  error_local->message);
+		return -1;
+	}
+	helper->offset = g_seekable_tell(G_SEEKABLE(helper->stream));
+	return helper->offset;
+}
+/* the data or the stream is read from the start each time */
 static _archive_read_ctx *
-fu_archive_read_new(GError **error)
+fu_archive_read_open(FuArchive *self, FuArchiveStreamHelper *helper, GError **error)
 {
+	int r;
 	g_autoptr(_archive_read_ctx) arch = NULL;
 
 	arch = archive_read_new();
@@ -254,39 +373,80 @@ fu_archive_read_new(GError **error)
 	}
 	archive_read_support_format_all(arch);
 	archive_read_support_filter_all(arch);
+	if (self->data != NULL) {
+		r = archive_read_open_memory(arch,
+					     (void *)g_bytes_get_data(self->data, NULL),
+					     (size_t)g_bytes_get_size(self->data));
+	} else {
+		helper->stream = self->stream;
+		helper->offset = 0x0;
+		if (!g_seekable_seek(G_SEEKABLE(self->stream), 0x0, G_SEEK_SET, NULL, error))
+			return NULL;
+		archive_read_set_seek_callback(arch, fu_archive_seek_cb);
+		archive_read_set_read_callback(arch, fu_archive_read_cb);
+		archive_read_set_skip_callback(arch, fu_archive_skip_cb);
+		archive_read_set_callback_data(arch, helper);
+		r = archive_read_open1(arch);
+	}
+	if (r != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot open: %s",
+			    archive_error_string(arch));
+		return NULL;
+	}
 	return g_steal_pointer(&arch);
 }
 
 static gboolean
-fu_archive_read(FuArchive *self, _archive_read_ctx *arch, FuArchiveFlags flags, GError **error)
+fu_archive_read_next_header(_archive_read_ctx *arch,
+			    struct archive_entry **entry,
+			    gboolean *eof,
+			    GError **error)
 {
-	int r;
-	while (TRUE) {
+	int r = archive_read_next_header(arch, entry);
+	if (r == ARCHIVE_EOF) {
+		*eof = TRUE;
+		return TRUE;
+	}
+	if (r != ARCHIVE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot read header: %s",
+			    archive_error_string(arch));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* only reads the headers, skipping over the data */
+static gboolean
+fu_archive_read_index(FuArchive *self, FuArchiveFlags flags, GError **error)
+{
+	FuArchiveStreamHelper helper = {0};
+	g_autoptr(_archive_read_ctx) arch = NULL;
+
+	arch = fu_archive_read_open(self, &helper, error);
+	if (arch == NULL)
+		return FALSE;
+	for (guint idx = 0;; idx++) {
 		const gchar *fn;
-		gint64 bufsz;
-		gssize rc;
-		struct archive_entry *entry;
-		g_autofree gchar *fn_key = NULL;
-		g_autofree guint8 *buf = NULL;
-		g_autoptr(GBytes) bytes = NULL;
+		gboolean eof = FALSE;
+		struct archive_entry *entry_ar = NULL;
+		FuArchiveEntry *entry;
 
-		r = archive_read_next_header(arch, &entry);
-		if (r == ARCHIVE_EOF)
-			break;
-		if (r != ARCHIVE_OK) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "cannot read header: %s",
-				    archive_error_string(arch));
+		if (!fu_archive_read_next_header(arch, &entry_ar, &eof, error))
 			return FALSE;
-		}
+		if (eof)
+			break;
 
-		/* only extract if valid */
-		fn = archive_entry_pathname(entry);
+		/* only index if valid */
+		fn = archive_entry_pathname(entry_ar);
 		if (fn == NULL)
 			continue;
-		if (!archive_entry_size_is_set(entry)) {
+		if (!archive_entry_size_is_set(entry_ar)) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_INVALID_DATA,
@@ -294,47 +454,287 @@ fu_archive_read(FuArchive *self, _archive_read_ctx *arch, FuArchiveFlags flags,
 				    fn);
 			return FALSE;
 		}
-		bufsz = archive_entry_size(entry);
-		if (bufsz > 1024 * 1024 * 1024) {
+		if (archive_entry_size(entry_ar) > 1024 * 1024 * 1024) {
 			g_set_error_literal(error,
 					    FWUPD_ERROR,
 					    FWUPD_ERROR_NOT_SUPPORTED,
 					    "cannot read huge files");
 			return FALSE;
 		}
-		buf = g_malloc(bufsz);
-		rc = archive_read_data(arch, buf, (gsize)bufsz);
-		if (rc < 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_READ,
-				    "cannot read data: %s",
-				    archive_error_string(arch));
-			return FALSE;
+		entry = g_new0(FuArchiveEntry, 1);
+		if (flags & FU_ARCHIVE_FLAG_IGNORE_PATH) {
+			entry->fn = g_path_get_basename(fn);
+		} else {
+			entry->fn = g_strdup(fn);
 		}
-		if (rc != bufsz) {
+		entry->size = archive_entry_size(entry_ar);
+		entry->offset = archive_read_header_position(arch);
+		entry->idx = idx;
+		g_debug("adding %s [%" G_GINT64_FORMAT "]", entry->fn, entry->size);
+		fu_archive_add_entry_internal(self, entry);
+		if (archive_read_data_skip(arch) != ARCHIVE_OK) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_READ,
-				    "read %" G_GSSIZE_FORMAT " of %" G_GINT64_FORMAT,
-				    rc,
-				    bufsz);
+				    "cannot skip data: %s",
+				    archive_error_string(arch));
 			return FALSE;
 		}
-		if (flags & FU_ARCHIVE_FLAG_IGNORE_PATH) {
-			fn_key = g_path_get_basename(fn);
-		} else {
-			fn_key = g_strdup(fn);
-		}
-		g_debug("adding %s [%" G_GINT64_FORMAT "]", fn_key, bufsz);
-		bytes = g_bytes_new_take(g_steal_pointer(&buf), bufsz);
-		fu_archive_add_entry(self, fn_key, bytes);
 	}
 
 	/* success */
 	return TRUE;
 }
+
+/* moves forward to the header of @entry, where @idx is the index of the next header */
+static gboolean
+fu_archive_read_seek_entry(_archive_read_ctx *arch,
+			   guint *idx,
+			   FuArchiveEntry *entry,
+			   GError **error)
+{
+	while (*idx <= entry->idx) {
+		gboolean eof = FALSE;
+		struct archive_entry *entry_ar = NULL;
+
+		if (!fu_archive_read_next_header(arch, &entry_ar, &eof, error))
+			return FALSE;
+		if (eof)
+			break;
+		if ((*idx)++ < entry->idx)
+			continue;
+		if (archive_read_header_position(arch) != entry->offset ||
+		    archive_entry_size(entry_ar) != entry->size)
+			break;
+		return TRUE;
+	}
+	g_set_error(error,
+		    FWUPD_ERROR,
+		    FWUPD_ERROR_INVALID_DATA,
+		    "archive changed, %s no longer found",
+		    entry->fn);
+	return FALSE;
+}
+
+static GBytes *
+fu_archive_read_data(_archive_read_ctx *arch, FuArchiveEntry *entry, GError **error)
+{
+	gssize rc;
+	g_autofree guint8 *buf = g_malloc(entry->size);
+
+	rc = archive_read_data(arch, buf, (gsize)entry->size);
+	if (rc < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_READ,
+			    "cannot read data: %s",
+			    archive_error_string(arch));
+		return NULL;
+	}
+	if (rc != entry->size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_READ,
+			    "read %" G_GSSIZE_FORMAT " of %" G_GINT64_FORMAT,
+			    rc,
+			    entry->size);
+		return NULL;
+	}
+	return g_bytes_new_take(g_steal_pointer(&buf), entry->size);
+}
+#endif
+
+static GBytes *
+fu_archive_entry_get_bytes(FuArchive *self, FuArchiveEntry *entry, GError **error)
+{
+#ifdef HAVE_LIBARCHIVE
+	g_autoptr(GBytes) blob = NULL;
+#endif
+
+	if (entry->blob != NULL)
+		return g_bytes_ref(entry->blob);
+	if (entry == self->entry_last)
+		return g_bytes_ref(self->blob_last);
+#ifdef HAVE_LIBARCHIVE
+	/* entries before the current position can only be reached by starting again */
+	if (self->arch != NULL && entry->idx < self->arch_idx)
+		fu_archive_reader_close(self);
+	if (self->arch == NULL) {
+		if (self->helper == NULL)
+			self->helper = g_new0(FuArchiveStreamHelper, 1);
+		self->arch = fu_archive_read_open(self, self->helper, error);
+		if (self->arch == NULL)
+			return NULL;
+	}
+	if (!fu_archive_read_seek_entry(self->arch, &self->arch_idx, entry, error)) {
+		fu_archive_reader_close(self);
+		return NULL;
+	}
+	blob = fu_archive_read_data(self->arch, entry, error);
+	if (blob == NULL) {
+		fu_archive_reader_close(self);
+		return NULL;
+	}
+
+	/* the same entry is often looked up again straight away */
+	if (self->blob_last != NULL)
+		g_bytes_unref(self->blob_last);
+	self->entry_last = entry;
+	self->blob_last = g_bytes_ref(blob);
+	return g_steal_pointer(&blob);
+#else
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "missing libarchive support");
+	return NULL;
+#endif
+}
+
+/**
+ * fu_archive_lookup_by_fn:
+ * @self: a #FuArchive
+ * @fn: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the blob referenced by filename, decompressing it if required.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL if the filename was not found
+ *
+ * Since: 1.2.2
+ **/
+GBytes *
+fu_archive_lookup_by_fn(FuArchive *self, const gchar *fn, GError **error)
+{
+	FuArchiveEntry *entry;
+
+	g_return_val_if_fail(FU_IS_ARCHIVE(self), NULL);
+	g_return_val_if_fail(fn != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	entry = g_hash_table_lookup(self->entry_map, fn);
+	if (entry == NULL) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no blob for %s", fn);
+		return NULL;
+	}
+	return fu_archive_entry_get_bytes(self, entry, error);
+}
+
+/**
+ * fu_archive_lookup_stream_by_fn:
+ * @self: a #FuArchive
+ * @fn: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the stream referenced by filename, decompressing it if required.
+ *
+ * Returns: (transfer full): a #GInputStream, or %NULL if the filename was not found
+ *
+ * Since: 2.1.1
+ **/
+GInputStream *
+fu_archive_lookup_stream_by_fn(FuArchive *self, const gchar *fn, GError **error)
+{
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_ARCHIVE(self), NULL);
+	g_return_val_if_fail(fn != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	blob = fu_archive_lookup_by_fn(self, fn, error);
+	if (blob == NULL)
+		return NULL;
+	return g_memory_input_stream_new_from_bytes(blob);
+}
+
+/**
+ * fu_archive_get_size_by_fn:
+ * @self: a #FuArchive
+ * @fn: a filename
+ *
+ * Gets the uncompressed size of an entry without decompressing it.
+ *
+ * Returns: size in bytes, or -1 if the filename was not found
+ *
+ * Since: 2.1.1
+ **/
+gint64
+fu_archive_get_size_by_fn(FuArchive *self, const gchar *fn)
+{
+	FuArchiveEntry *entry;
+
+	g_return_val_if_fail(FU_IS_ARCHIVE(self), -1);
+	g_return_val_if_fail(fn != NULL, -1);
+
+	entry = g_hash_table_lookup(self->entry_map, fn);
+	if (entry == NULL)
+		return -1;
+	return entry->size;
+}
+
+/**
+ * fu_archive_iterate:
+ * @self: a #FuArchive
+ * @callback: (scope call) (closure user_data): a #FuArchiveIterateFunc.
+ * @user_data: user data
+ * @error: (nullable): optional return location for an error
+ *
+ * Iterates over the archive contents, calling the given function for each
+ * of the files found. If any @callback returns %FALSE scanning is aborted.
+ *
+ * The entries are decompressed in a single pass, and only one is held in memory at a time.
+ *
+ * Returns: True if no @callback returned FALSE
+ *
+ * Since: 1.3.4
+ */
+gboolean
+fu_archive_iterate(FuArchive *self,
+		   FuArchiveIterateFunc callback,
+		   gpointer user_data,
+		   GError **error)
+{
+#ifdef HAVE_LIBARCHIVE
+	FuArchiveStreamHelper helper = {0};
+	guint idx = 0;
+	g_autoptr(_archive_read_ctx) arch = NULL;
+#endif
+
+	g_return_val_if_fail(FU_IS_ARCHIVE(self), FALSE);
+	g_return_val_if_fail(callback != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* the stream position is shared with the lookup reader */
+	fu_archive_reader_close(self);
+
+	/* the entries are in archive order, then the ones added manually */
+	for (guint i = 0; i < self->entries->len; i++) {
+		FuArchiveEntry *entry = g_ptr_array_index(self->entries, i);
+		g_autoptr(GBytes) blob = NULL;
+
+		if (entry->blob != NULL) {
+			blob = g_bytes_ref(entry->blob);
+		} else {
+#ifdef HAVE_LIBARCHIVE
+			if (arch == NULL) {
+				arch = fu_archive_read_open(self, &helper, error);
+				if (arch == NULL)
+					return FALSE;
+			}
+			if (!fu_archive_read_seek_entry(arch, &idx, entry, error))
+				return FALSE;
+			blob = fu_archive_read_data(arch, entry, error);
+#else
+			blob = fu_archive_entry_get_bytes(self, entry, error);
 #endif
+			if (blob == NULL)
+				return FALSE;
+		}
+		if (!callback(self, entry->fn, blob, user_data, error))
+			return FALSE;
+	}
+	return TRUE;
+}
 
 /**
  * fu_archive_new:
@@ -342,7 +742,8 @@ fu_archive_read(FuArchive *self, _archive_read_ctx *arch, FuArchiveFlags flags,
  * @flags: archive flags, e.g. %FU_ARCHIVE_FLAG_NONE
  * @error: (nullable): optional return location for an error
  *
- * Parses @data as an archive and decompresses all files to memory blobs.
+ * Parses @data as an archive, reading only the headers. The files are decompressed when they are
+ * looked up, and @data is referenced for the lifetime of the archive.
  *
  * If @data is unspecified then a new empty archive is created.
  *
@@ -359,24 +760,8 @@ fu_archive_new(GBytes *data, FuArchiveFlags flags, GError **error)
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	if (data != NULL) {
-		int r;
-		g_autoptr(_archive_read_ctx) arch = NULL;
-
-		arch = fu_archive_read_new(error);
-		if (arch == NULL)
-			return NULL;
-		r = archive_read_open_memory(arch,
-					     (void *)g_bytes_get_data(data, NULL),
-					     (size_t)g_bytes_get_size(data));
-		if (r != 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "cannot open: %s",
-				    archive_error_string(arch));
-			return NULL;
-		}
-		if (!fu_archive_read(self, arch, flags, error))
+		self->data = g_bytes_ref(data);
+		if (!fu_archive_read_index(self, flags, error))
 			return NULL;
 	}
 	return g_steal_pointer(&self);
@@ -389,91 +774,14 @@ fu_archive_new(GBytes *data, FuArchiveFlags flags, GError **error)
 #endif
 }
 
-#ifdef HAVE_LIBARCHIVE
-typedef struct {
-	GInputStream *stream;
-	guint8 buf[0x8000];
-} FuArchiveStreamHelper;
-
-static gint64
-fu_archive_skip_cb(struct archive *arch, void *client_data, off_t request)
-{
-	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
-	gssize cnt;
-	g_autoptr(GError) error_local = NULL;
-
-	cnt = g_input_stream_skip(helper->stream, request, NULL, &error_local);
-	if (cnt < 0) {
-		archive_set_error(arch,
-				  ARCHIVE_FAILED,
-				  "failed to read from stream: %s",
-				  error_local->message);
-		return -1;
-	}
-	return cnt;
-}
-
-static gssize
-fu_archive_read_cb(struct archive *arch, void *client_data, const void **buffer)
-{
-	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
-	gssize cnt;
-	g_autoptr(GError) error_local = NULL;
-
-	cnt = g_input_stream_read(helper->stream,
-				  helper->buf,
-				  sizeof(helper->buf),
-				  NULL,
-				  &error_local);
-	if (cnt < 0) {
-		archive_set_error(arch,
-				  ARCHIVE_FAILED,
-				  "failed to read from stream: %s",
-				  error_local->message);
-		return -1;
-	}
-	if (cnt > 0)
-		*buffer = helper->buf;
-	return cnt;
-}
-
-static GSeekType
-fu_archive_whence_to_seek_type(gint whence)
-{
-	if (whence == SEEK_SET)
-		return G_SEEK_SET;
-	if (whence == SEEK_END)
-		return G_SEEK_END;
-	return G_SEEK_CUR;
-}
-
-static gint64
-fu_archive_seek_cb(struct archive *arch, void *client_data, gint64 offset, gint whence)
-{
-	FuArchiveStreamHelper *helper = (FuArchiveStreamHelper *)client_data;
-	g_autoptr(GError) error_local = NULL;
-	if (!g_seekable_seek(G_SEEKABLE(helper->stream),
-			     offset,
-			     fu_archive_whence_to_seek_type(whence),
-			     NULL,
-			     &error_local)) {
-		archive_set_error(arch,
-				  ARCHIVE_FAILED,
-				  "failed to read from stream: %s",
-				  error_local->message);
-		return -1;
-	}
-	return g_seekable_tell(G_SEEKABLE(helper->stream));
-}
-#endif
-
 /**
  * fu_archive_new_stream:
  * @stream: a #GInputStream
  * @flags: archive flags, e.g. %FU_ARCHIVE_FLAG_NONE
  * @error: (nullable): optional return location for an error
  *
- * Parses @stream as an archive and decompresses all files to memory blobs.
+ * Parses @stream as an archive, reading only the headers. The files are decompressed when they are
+ * looked up, and so @stream is referenced for the lifetime of the archive and must not be modified.
  *
  * Returns: a #FuArchive, or %NULL if the archive was invalid in any way.
  *
@@ -484,33 +792,12 @@ fu_archive_new_stream(GInputStream *stream, FuArchiveFlags flags, GError **error
 {
 #ifdef HAVE_LIBARCHIVE
 	g_autoptr(FuArchive) self = g_object_new(FU_TYPE_ARCHIVE, NULL);
-	g_autoptr(_archive_read_ctx) arch = NULL;
-	FuArchiveStreamHelper helper = {.stream = stream};
-	int r;
 
-	g_return_val_if_fail(G_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	if (!g_seekable_seek(G_SEEKABLE(stream), 0x0, G_SEEK_SET, NULL, error))
-		return NULL;
-
-	arch = fu_archive_read_new(error);
-	if (arch == NULL)
-		return NULL;
-	archive_read_set_seek_callback(arch, fu_archive_seek_cb);
-	archive_read_set_read_callback(arch, fu_archive_read_cb);
-	archive_read_set_skip_callback(arch, fu_archive_skip_cb);
-	archive_read_set_callback_data(arch, &helper);
-	r = archive_read_open1(arch);
-	if (r != 0) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "cannot open: %s",
-			    archive_error_string(arch));
-		return NULL;
-	}
-	if (!fu_archive_read(self, arch, flags, error))
+	self->stream = g_object_ref(stream);
+	if (!fu_archive_read_index(self, flags, error))
 		return NULL;
 	return g_steal_pointer(&self);
 #else
@@ -555,7 +842,6 @@ fu_archive_write(FuArchive *self,
 	int r;
 	g_autoptr(_archive_write_ctx) arch = NULL;
 	g_autoptr(GByteArray) blob = g_byte_array_new();
-	g_autoptr(GList) keys = NULL;
 
 	g_return_val_if_fail(FU_IS_ARCHIVE(self), NULL);
 	g_return_val_if_fail(format != FU_ARCHIVE_FORMAT_UNKNOWN, NULL);
@@ -599,15 +885,17 @@ fu_archive_write(FuArchive *self,
 		return NULL;
 	}
 
-	keys = g_hash_table_get_keys(self->entries);
-	for (GList *l = keys; l != NULL; l = l->next) {
-		const gchar *fn = l->data;
-		GBytes *bytes = g_hash_table_lookup(self->entries, fn);
+	for (guint i = 0; i < self->entries->len; i++) {
+		FuArchiveEntry *entry_fu = g_ptr_array_index(self->entries, i);
 		gssize rc;
 		g_autoptr(_archive_entry_ctx) entry = NULL;
+		g_autoptr(GBytes) bytes = NULL;
 
+		bytes = fu_archive_entry_get_bytes(self, entry_fu, error);
+		if (bytes == NULL)
+			return NULL;
 		entry = archive_entry_new();
-		archive_entry_set_pathname(entry, fn);
+		archive_entry_set_pathname(entry, entry_fu->fn);
 		archive_entry_set_filetype(entry, AE_IFREG);
 		archive_entry_set_perm(entry, 0644);
 		archive_entry_set_size(entry, g_bytes_get_size(bytes));
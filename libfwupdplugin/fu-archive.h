@@ -57,6 +57,12 @@ fu_archive_add_entry(FuArchive *self, const gchar *fn, GBytes *blob) G_GNUC_NON_
 GBytes *
 fu_archive_lookup_by_fn(FuArchive *self, const gchar *fn, GError **error) G_GNUC_WARN_UNUSED_RESULT
     G_GNUC_NON_NULL(1, 2);
+GInputStream *
+fu_archive_lookup_stream_by_fn(FuArchive *self,
+			       const gchar *fn,
+			       GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gint64
+fu_archive_get_size_by_fn(FuArchive *self, const gchar *fn) G_GNUC_NON_NULL(1, 2);
 GByteArray *
 fu_archive_write(FuArchive *self,
 		 FuArchiveFormat format,
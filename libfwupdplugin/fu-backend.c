@@ -10,6 +10,7 @@
 
 #include "fu-device-locker.h"
 #include "fu-device-private.h"
+#include "fu-trace.h"
 
 /**
  * FuBackend:
@@ -567,13 +568,19 @@ gboolean
 fu_backend_coldplug(FuBackend *self, FuProgress *progress, GError **error)
 {
 	FuBackendClass *klass = FU_BACKEND_GET_CLASS(self);
+	gboolean ret;
+	gint64 trace_begin;
+
 	g_return_val_if_fail(FU_IS_BACKEND(self), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 	if (!fu_backend_setup(self, FU_BACKEND_SETUP_FLAG_NONE, progress, error))
 		return FALSE;
 	if (klass->coldplug == NULL)
 		return TRUE;
-	return klass->coldplug(self, progress, error);
+	trace_begin = fu_trace_begin();
+	ret = klass->coldplug(self, progress, error);
+	fu_trace_end("backend", trace_begin, "coldplug(%s)", fu_backend_get_name(self));
+	return ret;
 }
 
 /**
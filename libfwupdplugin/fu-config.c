@@ -707,6 +707,29 @@ fu_config_get_value_u64(FuConfig *self, const gchar *section, const gchar *key)
 	return value;
 }
 
+/**
+ * fu_config_build_checksum:
+ * @self: a #FuConfig
+ *
+ * Builds a checksum of all the loaded config values, which changes when any of the config files
+ * are modified or a value is set.
+ *
+ * Returns: (transfer full): a SHA1 hash
+ *
+ * Since: 2.1.1
+ **/
+gchar *
+fu_config_build_checksum(FuConfig *self)
+{
+	FuConfigPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *data = NULL;
+	gsize datasz = 0;
+
+	g_return_val_if_fail(FU_IS_CONFIG(self), NULL);
+	data = g_key_file_to_data(priv->keyfile, &datasz, NULL);
+	return g_compute_checksum_for_data(G_CHECKSUM_SHA1, (const guchar *)data, datasz);
+}
+
 /**
  * fu_config_set_basename:
  * @self: a #FuConfig
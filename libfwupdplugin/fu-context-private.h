@@ -31,6 +31,8 @@ fu_context_load_hwinfo(FuContext *self,
 		       GError **error) G_GNUC_NON_NULL(1);
 gboolean
 fu_context_load_quirks(FuContext *self, FuQuirksLoadFlags flags, GError **error) G_GNUC_NON_NULL(1);
+const gchar *
+fu_context_get_quirks_guid(FuContext *self) G_GNUC_NON_NULL(1);
 GHashTable *
 fu_context_get_runtime_versions(FuContext *self) G_GNUC_NON_NULL(1);
 GHashTable *
@@ -1386,6 +1386,24 @@ fu_context_load_quirks(FuContext *self, FuQuirksLoadFlags flags, GError **error)
 	return TRUE;
 }
 
+/**
+ * fu_context_get_quirks_guid:
+ * @self: a #FuContext
+ *
+ * Gets the GUID of the loaded quirks, which changes when any quirk file is modified.
+ *
+ * Returns: a GUID, or %NULL if the quirks have not been loaded
+ *
+ * Since: 2.1.1
+ **/
+const gchar *
+fu_context_get_quirks_guid(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
+	return fu_quirks_get_guid(priv->quirks);
+}
+
 /**
  * fu_context_get_power_state:
  * @self: a #FuContext
@@ -12,6 +12,7 @@
 
 #include "fu-device-locker.h"
 #include "fu-device.h"
+#include "fu-trace.h"
 
 /**
  * FuDeviceLocker:
@@ -26,12 +27,23 @@ struct _FuDeviceLocker {
 	GObject parent_instance;
 	FuDevice *device;
 	gboolean device_open;
+	gint64 trace_begin;
 	FuDeviceLockerFunc open_func;
 	FuDeviceLockerFunc close_func;
 };
 
 G_DEFINE_TYPE(FuDeviceLocker, fu_device_locker, G_TYPE_OBJECT)
 
+static void
+fu_device_locker_trace_end(FuDeviceLocker *self)
+{
+	const gchar *name = fu_device_get_name(self->device);
+	fu_trace_end("locker",
+		     self->trace_begin,
+		     "%s",
+		     name != NULL ? name : G_OBJECT_TYPE_NAME(self->device));
+}
+
 static void
 fu_device_locker_finalize(GObject *obj)
 {
@@ -42,6 +54,7 @@ fu_device_locker_finalize(GObject *obj)
 		g_autoptr(GError) error = NULL;
 		if (!self->close_func(self->device, &error))
 			g_warning("failed to close device: %s", error->message);
+		fu_device_locker_trace_end(self);
 	}
 	if (self->device != NULL)
 		g_object_unref(self->device);
@@ -91,6 +104,7 @@ fu_device_locker_close(FuDeviceLocker *self, GError **error)
 		return FALSE;
 	}
 	self->device_open = FALSE;
+	fu_device_locker_trace_end(self);
 	return TRUE;
 }
 
@@ -162,6 +176,7 @@ fu_device_locker_new_full(FuDevice *device,
 	self->device = g_object_ref(device);
 	self->open_func = open_func;
 	self->close_func = close_func;
+	self->trace_begin = fu_trace_begin();
 
 	/* open device */
 	if (!self->open_func(device, error)) {
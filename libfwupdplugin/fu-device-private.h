@@ -43,6 +43,8 @@ void
 fu_device_set_update_request_id(FuDevice *self, const gchar *update_request_id) G_GNUC_NON_NULL(1);
 void
 fu_device_set_fwupd_version(FuDevice *self, const gchar *fwupd_version) G_GNUC_NON_NULL(1, 2);
+FuVersionKey *
+fu_device_get_version_key(FuDevice *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_device_ensure_id(FuDevice *self, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 void
@@ -26,6 +26,7 @@
 #include "fu-quirks.h"
 #include "fu-security-attr.h"
 #include "fu-string.h"
+#include "fu-trace.h"
 #include "fu-version-common.h"
 
 #define FU_DEVICE_RETRY_OPEN_COUNT 5
@@ -96,12 +97,14 @@ typedef struct {
 	GPtrArray *instance_ids;     /* (nullable) (element-type FuDeviceInstanceIdItem) */
 	GPtrArray *retry_recs;	     /* (nullable) (element-type FuDeviceRetryRecovery) */
 	guint retry_delay;
+	guint64 sleep_duration; /* ms */
 	GArray *private_flags_registered; /* (nullable) (element-type GQuark) */
 	GArray *private_flags;		  /* (nullable) (element-type GQuark) */
 	gchar *custom_flags;
 	gulong notify_flags_proxy_id;
 	GHashTable *instance_hash; /* (nullable) */
 	FuProgress *progress;	   /* provided for FuDevice notify callbacks */
+	FuVersionKey *version_key; /* (nullable) */
 } FuDevicePrivate;
 
 typedef struct {
@@ -791,6 +794,30 @@ fu_device_retry(FuDevice *self,
 	return fu_device_retry_full(self, func, count, priv->retry_delay, user_data, error);
 }
 
+/* nocheck:name */
+static gboolean
+fu_device_is_emulated_or_proxy(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	if (fu_device_has_flag(self, FWUPD_DEVICE_FLAG_EMULATED))
+		return TRUE;
+	if (priv->proxy != NULL && fu_device_has_flag(priv->proxy, FWUPD_DEVICE_FLAG_EMULATED))
+		return TRUE;
+	return FALSE;
+}
+
+static void
+fu_device_sleep_done(FuDevice *self, gint64 begin)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	guint delay_ms = (g_get_monotonic_time() - begin) / 1000;
+	priv->sleep_duration += delay_ms;
+	fu_trace_end("sleep",
+		     fu_trace_get_enabled() ? begin : 0,
+		     "%s",
+		     priv->name != NULL ? priv->name : fu_device_get_id(self));
+}
+
 /**
  * fu_device_sleep:
  * @self: a #FuDevice
@@ -807,17 +834,18 @@ fu_device_retry(FuDevice *self,
 void
 fu_device_sleep(FuDevice *self, guint delay_ms)
 {
-	FuDevicePrivate *priv = GET_PRIVATE(self);
+	gint64 begin;
 
 	g_return_if_fail(FU_IS_DEVICE(self));
 	g_return_if_fail(delay_ms < 100000);
 
-	if (fu_device_has_flag(self, FWUPD_DEVICE_FLAG_EMULATED))
+	if (fu_device_is_emulated_or_proxy(self))
 		return;
-	if (priv->proxy != NULL && fu_device_has_flag(priv->proxy, FWUPD_DEVICE_FLAG_EMULATED))
+	if (delay_ms == 0)
 		return;
-	if (delay_ms > 0)
-		g_usleep(delay_ms * 1000);
+	begin = g_get_monotonic_time();
+	g_usleep(delay_ms * 1000);
+	fu_device_sleep_done(self, begin);
 }
 
 /**
@@ -834,18 +862,171 @@ fu_device_sleep(FuDevice *self, guint delay_ms)
 void
 fu_device_sleep_full(FuDevice *self, guint delay_ms, FuProgress *progress)
 {
-	FuDevicePrivate *priv = GET_PRIVATE(self);
+	gint64 begin;
 
 	g_return_if_fail(FU_IS_DEVICE(self));
 	g_return_if_fail(delay_ms < 1000000);
 	g_return_if_fail(FU_IS_PROGRESS(progress));
 
-	if (fu_device_has_flag(self, FWUPD_DEVICE_FLAG_EMULATED))
+	if (fu_device_is_emulated_or_proxy(self))
 		return;
-	if (priv->proxy != NULL && fu_device_has_flag(priv->proxy, FWUPD_DEVICE_FLAG_EMULATED))
+	if (delay_ms == 0)
 		return;
-	if (delay_ms > 0)
-		fu_progress_sleep(progress, delay_ms);
+	begin = g_get_monotonic_time();
+	fu_progress_sleep(progress, delay_ms);
+	fu_device_sleep_done(self, begin);
+}
+
+/* returns early if @fd becomes readable */
+static void
+fu_device_sleep_fd(FuDevice *self, gint fd, guint delay_ms)
+{
+	GPollFD fds = {
+	    .fd = fd,
+	    .events = G_IO_IN | G_IO_ERR,
+	};
+	gint64 begin;
+
+	if (fd < 0) {
+		fu_device_sleep(self, delay_ms);
+		return;
+	}
+	if (fu_device_is_emulated_or_proxy(self))
+		return;
+	begin = g_get_monotonic_time();
+	if (g_poll(&fds, 1, (gint)delay_ms) < 0)
+		g_debug("failed to poll %i, ignoring", fd);
+	fu_device_sleep_done(self, begin);
+}
+
+/**
+ * fu_device_get_sleep_duration:
+ * @self: a #FuDevice
+ *
+ * Gets the total time spent sleeping in fu_device_sleep() and related functions, which is useful
+ * to find devices that are being updated slower than required.
+ *
+ * Returns: time in ms
+ *
+ * Since: 2.1.1
+ **/
+guint64
+fu_device_get_sleep_duration(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), G_MAXUINT64);
+	return priv->sleep_duration;
+}
+
+/**
+ * fu_device_poll_until_ready_full:
+ * @self: a #FuDevice
+ * @func: (scope call) (closure user_data): a function to query the device status
+ * @fd: a file descriptor that becomes readable when the status may have changed, or -1
+ * @delay_min: the first delay between each query in ms
+ * @delay_max: the maximum delay between each query in ms
+ * @timeout: the maximum total time to wait in ms
+ * @user_data: (nullable): a helper to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Calls @func until the device reports that it is ready, e.g. after an erase or a write. The
+ * delay between each query starts at @delay_min and then doubles up to @delay_max, so that fast
+ * devices do not have to wait for as long as the slowest device ever seen.
+ *
+ * If @fd is set then the delay also ends early when there is data to read, for instance a status
+ * report on a hidraw or serial device.
+ *
+ * If the device is emulated then no delays are performed, and the timeout is only checked
+ * against the total scheduled delay.
+ *
+ * Returns: %TRUE if the device is ready, or %FALSE with %FWUPD_ERROR_TIMED_OUT
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_device_poll_until_ready_full(FuDevice *self,
+				FuDeviceReadyFunc func,
+				gint fd,
+				guint delay_min,
+				guint delay_max,
+				guint timeout,
+				gpointer user_data,
+				GError **error)
+{
+	gboolean emulated;
+	gint64 begin = g_get_monotonic_time();
+	guint delay = MAX(delay_min, 1);
+	guint64 scheduled = 0;
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(delay_min <= delay_max, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	emulated = fu_device_is_emulated_or_proxy(self);
+	for (guint i = 1;; i++) {
+		gboolean ready = FALSE;
+		guint64 elapsed;
+
+		if (!func(self, &ready, user_data, error))
+			return FALSE;
+		if (ready) {
+			g_debug("ready after %u queries", i);
+			return TRUE;
+		}
+
+		/* use the wall clock when not emulated, as @func might be slow too */
+		elapsed = emulated ? scheduled : (guint64)(g_get_monotonic_time() - begin) / 1000;
+		if (elapsed >= timeout) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_TIMED_OUT,
+				    "device was not ready after %ums",
+				    timeout);
+			return FALSE;
+		}
+		delay = MIN(delay, timeout - elapsed);
+		fu_device_sleep_fd(self, fd, delay);
+		scheduled += delay;
+		delay = MIN(delay * 2, delay_max);
+	}
+}
+
+/**
+ * fu_device_poll_until_ready:
+ * @self: a #FuDevice
+ * @func: (scope call) (closure user_data): a function to query the device status
+ * @delay_min: the first delay between each query in ms
+ * @delay_max: the maximum delay between each query in ms
+ * @timeout: the maximum total time to wait in ms
+ * @user_data: (nullable): a helper to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Calls @func until the device reports that it is ready, using an exponential backoff.
+ *
+ * See fu_device_poll_until_ready_full() for more details.
+ *
+ * Returns: %TRUE if the device is ready, or %FALSE with %FWUPD_ERROR_TIMED_OUT
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_device_poll_until_ready(FuDevice *self,
+			   FuDeviceReadyFunc func,
+			   guint delay_min,
+			   guint delay_max,
+			   guint timeout,
+			   gpointer user_data,
+			   GError **error)
+{
+	return fu_device_poll_until_ready_full(self,
+					       func,
+					       -1,
+					       delay_min,
+					       delay_max,
+					       timeout,
+					       user_data,
+					       error);
 }
 
 /**
@@ -3484,6 +3665,35 @@ fu_device_set_id(FuDevice *self, const gchar *id)
 	}
 }
 
+/**
+ * fu_device_get_version_key:
+ * @self: a #FuDevice
+ *
+ * Gets the device version in a form that can be compared without allocating, which is only
+ * parsed again when the version or version format changes.
+ *
+ * Returns: (transfer none): a version key
+ *
+ * Since: 2.1.1
+ **/
+FuVersionKey *
+fu_device_get_version_key(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
+
+	if (priv->version_key == NULL ||
+	    fu_version_key_get_format(priv->version_key) != fu_device_get_version_format(self) ||
+	    g_strcmp0(fu_version_key_get_version(priv->version_key),
+		      fu_device_get_version(self)) != 0) {
+		g_clear_pointer(&priv->version_key, fu_version_key_free);
+		priv->version_key = fu_version_key_new(fu_device_get_version(self),
+						       fu_device_get_version_format(self));
+	}
+	return priv->version_key;
+}
+
 /**
  * fu_device_set_version_format:
  * @self: a #FuDevice
@@ -5335,6 +5545,7 @@ fu_device_to_string_impl(FuDevice *self, guint idt, GString *str)
 	fwupd_codec_string_append(str, idt, "ProxyGuid", priv->proxy_guid);
 	fwupd_codec_string_append_int(str, idt, "RemoveDelay", priv->remove_delay);
 	fwupd_codec_string_append_int(str, idt, "AcquiesceDelay", priv->acquiesce_delay);
+	fwupd_codec_string_append_int(str, idt, "SleepDuration", priv->sleep_duration);
 	fwupd_codec_string_append(str, idt, "CustomFlags", priv->custom_flags);
 	if (priv->specialized_gtype != G_TYPE_INVALID)
 		fwupd_codec_string_append(str, idt, "GType", g_type_name(priv->specialized_gtype));
@@ -8582,6 +8793,8 @@ fu_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->instance_ids);
 	if (priv->parent_guids != NULL)
 		g_ptr_array_unref(priv->parent_guids);
+	if (priv->version_key != NULL)
+		fu_version_key_free(priv->version_key);
 	g_array_unref(priv->private_flags);
 	g_array_unref(priv->private_flags_registered);
 	g_ptr_array_unref(priv->possible_plugins);
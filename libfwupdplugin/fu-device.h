@@ -306,6 +306,22 @@ typedef gboolean (*FuDeviceRetryFunc)(FuDevice *self,
 				      gpointer user_data,
 				      GError **error) G_GNUC_WARN_UNUSED_RESULT;
 
+/**
+ * FuDeviceReadyFunc:
+ * @self: a #FuDevice
+ * @ready: (out): set to %TRUE when the device is ready
+ * @user_data: (closure): user data
+ * @error: (nullable): optional return location for an error
+ *
+ * The device readiness callback, used with fu_device_poll_until_ready().
+ *
+ * Returns: %TRUE if the status was queried, or %FALSE for a fatal error
+ */
+typedef gboolean (*FuDeviceReadyFunc)(FuDevice *self,
+				      gboolean *ready,
+				      gpointer user_data,
+				      GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
 FuDevice *
 fu_device_new(FuContext *ctx);
 
@@ -1417,6 +1433,25 @@ void
 fu_device_sleep(FuDevice *self, guint delay_ms) G_GNUC_NON_NULL(1);
 void
 fu_device_sleep_full(FuDevice *self, guint delay_ms, FuProgress *progress) G_GNUC_NON_NULL(1);
+guint64
+fu_device_get_sleep_duration(FuDevice *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_device_poll_until_ready(FuDevice *self,
+			   FuDeviceReadyFunc func,
+			   guint delay_min,
+			   guint delay_max,
+			   guint timeout,
+			   gpointer user_data,
+			   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_device_poll_until_ready_full(FuDevice *self,
+				FuDeviceReadyFunc func,
+				gint fd,
+				guint delay_min,
+				guint delay_max,
+				guint timeout,
+				gpointer user_data,
+				GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_device_bind_driver(FuDevice *self, const gchar *subsystem, const gchar *driver, GError **error)
     G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
@@ -7,9 +7,11 @@
 #include "config.h"
 
 #include "fu-byte-array.h"
+#include "fu-common.h"
+#include "fu-efi-struct.h"
 #include "fu-efi-file.h"
 #include "fu-efi-filesystem.h"
-#include "fu-input-stream.h"
+#include "fu-input-stream-private.h"
 #include "fu-partial-input-stream.h"
 
 /**
@@ -25,6 +27,204 @@ G_DEFINE_TYPE(FuEfiFilesystem, fu_efi_filesystem, FU_TYPE_FIRMWARE)
 #define FU_EFI_FILESYSTEM_FILES_MAX 10000
 #define FU_EFI_FILESYSTEM_SIZE_MAX  0x10000000 /* 256 MB */
 
+static gboolean
+fu_efi_filesystem_is_freespace(GInputStream *stream,
+			       gsize offset,
+			       gboolean *is_freespace,
+			       GError **error)
+{
+	for (guint i = 0; i < 0x18; i++) {
+		guint8 tmp = 0;
+		if (!fu_input_stream_read_u8(stream, offset + i, &tmp, error))
+			return FALSE;
+		if (tmp != 0xff) {
+			*is_freespace = FALSE;
+			return TRUE;
+		}
+	}
+	*is_freespace = TRUE;
+	return TRUE;
+}
+
+static FuFirmware *
+fu_efi_filesystem_parse_file(GInputStream *stream,
+			     gsize offset,
+			     gsize streamsz,
+			     FuFirmwareParseFlags flags,
+			     GError **error)
+{
+	g_autoptr(FuFirmware) img = fu_efi_file_new();
+	g_autoptr(GInputStream) stream_tmp = NULL;
+
+	stream_tmp = fu_partial_input_stream_new(stream, offset, streamsz - offset, error);
+	if (stream_tmp == NULL) {
+		g_prefix_error_literal(error, "failed to cut EFI file: ");
+		return NULL;
+	}
+	if (!fu_firmware_parse_stream(img,
+				      stream_tmp,
+				      0x0,
+				      flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				      error)) {
+		g_prefix_error(error, "failed to parse EFI file at 0x%x: ", (guint)offset);
+		return NULL;
+	}
+	return g_steal_pointer(&img);
+}
+
+/* only the header is read, and anything unexpected is left for the sequential parser to report */
+static gboolean
+fu_efi_filesystem_scan_file(GInputStream *stream, gsize offset, gsize streamsz, gsize *size)
+{
+	gsize size_tmp;
+	g_autoptr(FuStructEfiFile) st = NULL;
+
+	st = fu_struct_efi_file_parse_stream(stream, offset, NULL);
+	if (st == NULL)
+		return FALSE;
+	if (fu_struct_efi_file_get_attrs(st) & FU_EFI_FILE_ATTRIB_LARGE_FILE) {
+		g_autoptr(FuStructEfiFile2) st2 = NULL;
+		st2 = fu_struct_efi_file2_parse_stream(stream, offset, NULL);
+		if (st2 == NULL)
+			return FALSE;
+		size_tmp = fu_struct_efi_file2_get_extended_size(st2);
+		if (size_tmp < st2->buf->len)
+			return FALSE;
+	} else {
+		size_tmp = fu_struct_efi_file_get_size(st);
+		if (size_tmp < st->buf->len)
+			return FALSE;
+	}
+	size_tmp = fu_common_align_up(size_tmp, FU_FIRMWARE_ALIGNMENT_8);
+	if (size_tmp > streamsz - offset)
+		return FALSE;
+	*size = size_tmp;
+	return TRUE;
+}
+
+typedef struct {
+	GInputStream *stream; /* private to the worker as the seek position is shared */
+	gsize offset;
+	gsize size;
+	gsize streamsz;
+	FuFirmwareParseFlags flags;
+	FuFirmware *img;
+	GError *error;
+} FuEfiFilesystemJob;
+
+static void
+fu_efi_filesystem_job_free(FuEfiFilesystemJob *job)
+{
+	if (job->stream != NULL)
+		g_object_unref(job->stream);
+	if (job->img != NULL)
+		g_object_unref(job->img);
+	if (job->error != NULL)
+		g_error_free(job->error);
+	g_free(job);
+}
+
+static void
+fu_efi_filesystem_job_cb(gpointer data, gpointer user_data)
+{
+	FuEfiFilesystemJob *job = (FuEfiFilesystemJob *)data;
+	job->img = fu_efi_filesystem_parse_file(job->stream,
+						job->offset,
+						job->streamsz,
+						job->flags,
+						&job->error);
+}
+
+/*
+ * Finds the file boundaries from the headers, and then parses (and so decompresses) the files on
+ * a worker pool. The images are added in order so that the result is the same as the sequential
+ * parse, and @offset is set to where the sequential parse should continue from.
+ */
+static gboolean
+fu_efi_filesystem_parse_threaded(FuFirmware *firmware,
+				 GInputStream *stream,
+				 gsize streamsz,
+				 FuFirmwareParseFlags flags,
+				 gsize *offset,
+				 GError **error)
+{
+	gsize offset_tmp = *offset;
+	guint images_max = fu_firmware_get_images_max(firmware);
+	guint threads_max;
+	GThreadPool *pool;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) jobs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_efi_filesystem_job_free);
+
+	/* sanity check */
+	if (streamsz > FU_EFI_FILESYSTEM_SIZE_MAX)
+		return TRUE;
+
+	/* find each file */
+	while (offset_tmp < streamsz && (images_max == 0 || jobs->len < images_max)) {
+		FuEfiFilesystemJob *job;
+		gboolean is_freespace = TRUE;
+		gsize size = 0;
+
+		if (!fu_efi_filesystem_is_freespace(stream, offset_tmp, &is_freespace, NULL))
+			break;
+		if (is_freespace)
+			break;
+		if (!fu_efi_filesystem_scan_file(stream, offset_tmp, streamsz, &size))
+			break;
+		job = g_new0(FuEfiFilesystemJob, 1);
+		job->offset = offset_tmp;
+		job->size = size;
+		job->streamsz = streamsz;
+		job->flags = flags & ~FU_FIRMWARE_PARSE_FLAG_THREADED;
+		g_ptr_array_add(jobs, job);
+		offset_tmp += size;
+	}
+	if (jobs->len < 2)
+		return TRUE;
+
+	/* each worker gets its own stream of the same immutable data, copied if not in memory */
+	blob = fu_input_stream_get_memory_bytes(stream);
+	if (blob == NULL) {
+		blob = fu_input_stream_read_bytes(stream, 0x0, streamsz, NULL, error);
+		if (blob == NULL)
+			return FALSE;
+	}
+	threads_max = MIN(g_get_num_processors(), jobs->len);
+	pool = g_thread_pool_new(fu_efi_filesystem_job_cb, NULL, threads_max, FALSE, error);
+	if (pool == NULL)
+		return FALSE;
+	for (guint i = 0; i < jobs->len; i++) {
+		FuEfiFilesystemJob *job = g_ptr_array_index(jobs, i);
+		job->stream = g_memory_input_stream_new_from_bytes(blob);
+		if (!g_thread_pool_push(pool, job, error)) {
+			g_thread_pool_free(pool, TRUE, TRUE);
+			return FALSE;
+		}
+	}
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	/* add in order, reporting the first failure just like the sequential parse */
+	for (guint i = 0; i < jobs->len; i++) {
+		FuEfiFilesystemJob *job = g_ptr_array_index(jobs, i);
+		if (job->error != NULL) {
+			g_propagate_error(error, g_steal_pointer(&job->error));
+			return FALSE;
+		}
+		fu_firmware_set_offset(firmware, job->offset);
+		if (!fu_firmware_add_image(firmware, job->img, error))
+			return FALSE;
+		*offset = job->offset + fu_firmware_get_size(job->img);
+
+		/* the header did not match what was parsed, so continue sequentially */
+		if (fu_firmware_get_size(job->img) != job->size)
+			break;
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_efi_filesystem_parse(FuFirmware *firmware,
 			GInputStream *stream,
@@ -35,40 +235,33 @@ fu_efi_filesystem_parse(FuFirmware *firmware,
 	gsize streamsz = 0;
 	if (!fu_input_stream_size(stream, &streamsz, error))
 		return FALSE;
+
+	/* decompress the files in parallel, if requested */
+	if (flags & FU_FIRMWARE_PARSE_FLAG_THREADED) {
+		if (!fu_efi_filesystem_parse_threaded(firmware,
+						      stream,
+						      streamsz,
+						      flags,
+						      &offset,
+						      error))
+			return FALSE;
+	}
 	while (offset < streamsz) {
-		g_autoptr(FuFirmware) img = fu_efi_file_new();
-		g_autoptr(GInputStream) stream_tmp = NULL;
 		gboolean is_freespace = TRUE;
+		g_autoptr(FuFirmware) img = NULL;
 
 		/* ignore free space */
-		for (guint i = 0; i < 0x18; i++) {
-			guint8 tmp = 0;
-			if (!fu_input_stream_read_u8(stream, offset + i, &tmp, error))
-				return FALSE;
-			if (tmp != 0xff) {
-				is_freespace = FALSE;
-				break;
-			}
-		}
+		if (!fu_efi_filesystem_is_freespace(stream, offset, &is_freespace, error))
+			return FALSE;
 		if (is_freespace) {
 			g_debug("ignoring free space @0x%x of 0x%x",
 				(guint)offset,
 				(guint)streamsz);
 			break;
 		}
-		stream_tmp = fu_partial_input_stream_new(stream, offset, streamsz - offset, error);
-		if (stream_tmp == NULL) {
-			g_prefix_error_literal(error, "failed to cut EFI file: ");
-			return FALSE;
-		}
-		if (!fu_firmware_parse_stream(img,
-					      stream_tmp,
-					      0x0,
-					      flags | FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
-					      error)) {
-			g_prefix_error(error, "failed to parse EFI file at 0x%x: ", (guint)offset);
+		img = fu_efi_filesystem_parse_file(stream, offset, streamsz, flags, error);
+		if (img == NULL)
 			return FALSE;
-		}
 		fu_firmware_set_offset(firmware, offset);
 		if (!fu_firmware_add_image(firmware, img, error))
 			return FALSE;
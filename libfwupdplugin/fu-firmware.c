@@ -13,7 +13,7 @@
 #include "fu-chunk-private.h"
 #include "fu-common.h"
 #include "fu-firmware.h"
-#include "fu-input-stream.h"
+#include "fu-input-stream-private.h"
 #include "fu-mem.h"
 #include "fu-partial-input-stream.h"
 #include "fu-string.h"
@@ -991,31 +991,54 @@ fu_firmware_validate_for_offset(FuFirmware *self,
 		return klass->validate(self, stream, offset, error);
 	}
 
-	/* try all the magic values, if provided */
+	/* try all the magic values at the same time, if provided */
 	if (priv->magic != NULL) {
+		gsize offset_search = offset;
+		gsize offset_best = 0;
+		guint idx_best = G_MAXUINT;
+		g_autoptr(GPtrArray) needles = g_ptr_array_new();
+
 		for (guint i = 0; i < priv->magic->len; i++) {
 			FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, i);
+			g_ptr_array_add(needles, patch->blob);
+		}
+
+		/* the magic registered first wins, even if another is found earlier */
+		while (idx_best != 0) {
+			FuFirmwarePatch *patch;
+			guint idx = 0;
 			gsize offset_tmp = 0;
-			g_debug("searching for 0x%x bytes of magic",
-				(guint)g_bytes_get_size(patch->blob));
-			if (fu_input_stream_find(stream,
-						 g_bytes_get_data(patch->blob, NULL),
-						 g_bytes_get_size(patch->blob),
-						 offset,
-						 &offset_tmp,
-						 NULL)) {
-				offset_tmp -= patch->offset;
-				g_debug("found magic @0x%x", (guint)offset_tmp);
-				if (offset_found != NULL)
-					*offset_found = offset_tmp;
-				return klass->validate(self, stream, *offset_found, error);
-			}
+
+			if (!fu_input_stream_find_any(stream,
+						      needles,
+						      offset_search,
+						      &offset_tmp,
+						      &idx,
+						      NULL))
+				break;
+			offset_search = offset_tmp + 1;
+
+			/* the magic is not at the start of the image, and there is no room */
+			patch = g_ptr_array_index(priv->magic, idx);
+			if (offset_tmp < offset + patch->offset)
+				continue;
+			offset_best = offset_tmp - patch->offset;
+			idx_best = idx;
+
+			/* only a magic registered before this one can still win */
+			g_ptr_array_set_size(needles, idx);
 		}
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_FILE,
-				    "failed to find magic bytes");
-		return FALSE;
+		if (idx_best == G_MAXUINT) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "failed to find magic bytes");
+			return FALSE;
+		}
+		g_debug("found magic %u @0x%x", idx_best, (guint)offset_best);
+		if (offset_found != NULL)
+			*offset_found = offset_best;
+		return klass->validate(self, stream, offset_best, error);
 	}
 
 	/* limit the size of firmware we search as brute force is expensive */
@@ -1034,6 +1057,56 @@ fu_firmware_validate_for_offset(FuFirmware *self,
 	return klass->validate(self, stream, offset, error);
 }
 
+/**
+ * fu_firmware_detect:
+ * @self: a #FuFirmware
+ * @stream: a seekable #GInputStream
+ * @offset: start offset
+ * @flags: #FuFirmwareParseFlags, e.g. %FU_FIRMWARE_PARSE_FLAG_NO_SEARCH
+ * @kind: (nullable) (out): how the stream was matched, e.g. %FU_FIRMWARE_DETECT_KIND_MAGIC
+ * @error: (nullable): optional return location for an error
+ *
+ * Checks if the stream could be parsed as this firmware type using only the registered magic
+ * values and the subclassed header validation, without doing a full parse.
+ *
+ * If the firmware type has neither then %TRUE is returned with @kind set to
+ * %FU_FIRMWARE_DETECT_KIND_UNKNOWN, as only fu_firmware_parse_stream() can tell.
+ *
+ * Returns: %TRUE if the stream may be this firmware type
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_firmware_detect(FuFirmware *self,
+		   GInputStream *stream,
+		   gsize offset,
+		   FuFirmwareParseFlags flags,
+		   FuFirmwareDetectKind *kind,
+		   GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	gsize offset_found = offset;
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing cheap to check */
+	if (klass->validate == NULL) {
+		if (kind != NULL)
+			*kind = FU_FIRMWARE_DETECT_KIND_UNKNOWN;
+		return TRUE;
+	}
+	if (!fu_firmware_validate_for_offset(self, stream, offset, &offset_found, flags, error))
+		return FALSE;
+	if (kind != NULL) {
+		*kind = priv->magic != NULL ? FU_FIRMWARE_DETECT_KIND_MAGIC
+					    : FU_FIRMWARE_DETECT_KIND_VALIDATE;
+	}
+	return TRUE;
+}
+
 /**
  * fu_firmware_parse_stream:
  * @self: a #FuFirmware
@@ -1216,7 +1289,7 @@ fu_firmware_parse_bytes(FuFirmware *self,
 	g_return_val_if_fail(fw != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	stream = g_memory_input_stream_new_from_bytes(fw);
+	stream = fu_input_stream_from_bytes(fw);
 	return fu_firmware_parse_stream(self, stream, offset, flags, error);
 }
 
@@ -2701,6 +2774,7 @@ fu_firmware_new_from_gtypes(GInputStream *stream,
 	va_list args;
 	g_autoptr(GArray) gtypes = g_array_new(FALSE, FALSE, sizeof(GType));
 	g_autoptr(GError) error_all = NULL;
+	g_autoptr(GInputStream) seekable_stream = NULL;
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
@@ -2724,12 +2798,28 @@ fu_firmware_new_from_gtypes(GInputStream *stream,
 		return NULL;
 	}
 
-	/* try each GType in turn */
+	/* only copy the stream once, rather than for each GType */
+	if (!G_IS_SEEKABLE(stream) || !g_seekable_can_seek(G_SEEKABLE(stream))) {
+		g_autoptr(GBytes) blob = NULL;
+		blob = fu_input_stream_read_bytes(stream, offset, G_MAXUINT32, NULL, error);
+		if (blob == NULL)
+			return NULL;
+		seekable_stream = g_memory_input_stream_new_from_bytes(blob);
+	} else {
+		seekable_stream = g_object_ref(stream);
+	}
+
+	/* try each GType in turn -- the magic search and header validation in
+	 * fu_firmware_parse_stream() already reject a mismatch before anything is parsed */
 	for (guint i = 0; i < gtypes->len; i++) {
 		GType gtype = g_array_index(gtypes, GType, i);
 		g_autoptr(FuFirmware) firmware = g_object_new(gtype, NULL);
 		g_autoptr(GError) error_local = NULL;
-		if (!fu_firmware_parse_stream(firmware, stream, offset, flags, &error_local)) {
+		if (!fu_firmware_parse_stream(firmware,
+					      seekable_stream,
+					      offset,
+					      flags,
+					      &error_local)) {
 			g_debug("@0x%x %s", (guint)offset, error_local->message);
 			if (error_all == NULL) {
 				g_propagate_error(&error_all, g_steal_pointer(&error_local));
@@ -220,6 +220,13 @@ fu_firmware_check_compatible(FuFirmware *self,
 			     FuFirmware *other,
 			     FuFirmwareParseFlags flags,
 			     GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_firmware_detect(FuFirmware *self,
+		   GInputStream *stream,
+		   gsize offset,
+		   FuFirmwareParseFlags flags,
+		   FuFirmwareDetectKind *kind,
+		   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 
 gboolean
 fu_firmware_add_image(FuFirmware *self, FuFirmware *img, GError **error) G_GNUC_NON_NULL(1, 2);
@@ -17,6 +17,7 @@ enum FuFirmwareParseFlags {
     CacheBlob = 1 << 11,
     OnlyTrustPqSignatures = 1 << 12,
     OnlyPartitionLayout = 1 << 13,
+    Threaded = 1 << 14, // parse independent images on a worker pool
 }
 
 #[derive(ToString)]
@@ -35,6 +36,13 @@ enum FuFirmwareFlags {
     AllowLinear = 1 << 10, // parse as an array of firmwares
 }
 
+#[derive(ToString)]
+enum FuFirmwareDetectKind {
+    Unknown, // no cheap header check, so needs a full parse
+    Validate, // the subclass validated the header
+    Magic, // a registered magic value was found
+}
+
 enum FuFirmwareAlignment {
     1,
     2,
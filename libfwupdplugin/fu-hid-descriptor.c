@@ -13,6 +13,7 @@
 #include "fu-hid-report-item.h"
 #include "fu-hid-struct.h"
 #include "fu-input-stream.h"
+#include "fu-mem.h"
 
 /**
  * FuHidDescriptor:
@@ -21,50 +22,246 @@
  *
  * Each report is a image of this firmware object and each report has children of #FuHidReportItem.
  *
+ * When parsed, the descriptor is stored as a flat table of items which is shared with any other
+ * descriptor with the same contents, and the report images are only created when exporting or
+ * writing the firmware. Use fu_hid_descriptor_find_report() rather than fu_firmware_get_images().
+ *
  * Documented: https://www.usb.org/sites/default/files/hid1_11.pdf
  *
  * See also: [class@FuFirmware]
  */
 
-G_DEFINE_TYPE(FuHidDescriptor, fu_hid_descriptor, FU_TYPE_FIRMWARE)
+/* one short item, where @offset is into the descriptor blob */
+typedef struct {
+	guint32 offset;
+	guint32 value;
+	guint16 size;
+	guint8 tag;
+} FuHidDescriptorItem;
+
+/* a slice of the items array */
+typedef struct {
+	guint items_idx;
+	guint items_len;
+} FuHidDescriptorReport;
+
+/* the parsed descriptor, which is immutable and shared between identical descriptors */
+typedef struct {
+	gatomicrefcount refcount;
+	GBytes *blob;
+	GArray *items;			/* (element-type FuHidDescriptorItem) */
+	GArray *reports;		/* (element-type FuHidDescriptorReport) */
+	GHashTable *report_id_idx;	/* report-id : (element-type guint) report idx */
+	GHashTable *usage_idx;		/* usage-page<<16|usage : (element-type guint) report idx */
+} FuHidDescriptorTable;
+
+typedef struct {
+	FuHidDescriptorTable *table;
+	gboolean images_valid;
+} FuHidDescriptorPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE(FuHidDescriptor, fu_hid_descriptor, FU_TYPE_FIRMWARE)
+#define GET_PRIVATE(o) (fu_hid_descriptor_get_instance_private(o))
 
 #define FU_HID_DESCRIPTOR_TABLE_LOCAL_SIZE_MAX	 1024
 #define FU_HID_DESCRIPTOR_TABLE_LOCAL_DUPES_MAX	 16
 #define FU_HID_DESCRIPTOR_TABLE_GLOBAL_SIZE_MAX	 1024
 #define FU_HID_DESCRIPTOR_TABLE_GLOBAL_DUPES_MAX 64
+#define FU_HID_DESCRIPTOR_TAG_MAX		 64 /* 6 bits */
+#define FU_HID_DESCRIPTOR_CACHE_SIZE_MAX	 32
+
+/* identical keyboards and mice all have the same descriptor */
+static GMutex fu_hid_descriptor_cache_mutex;
+static GHashTable *fu_hid_descriptor_cache = NULL; /* blob : FuHidDescriptorTable */
+
+static FuHidDescriptorTable *
+fu_hid_descriptor_table_ref(FuHidDescriptorTable *table)
+{
+	g_atomic_ref_count_inc(&table->refcount);
+	return table;
+}
+
+static void
+fu_hid_descriptor_table_unref(FuHidDescriptorTable *table)
+{
+	if (!g_atomic_ref_count_dec(&table->refcount))
+		return;
+	g_bytes_unref(table->blob);
+	g_array_unref(table->items);
+	g_array_unref(table->reports);
+	g_hash_table_unref(table->report_id_idx);
+	g_hash_table_unref(table->usage_idx);
+	g_free(table);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuHidDescriptorTable, fu_hid_descriptor_table_unref)
+
+static FuHidDescriptorTable *
+fu_hid_descriptor_table_new(GBytes *blob)
+{
+	FuHidDescriptorTable *table = g_new0(FuHidDescriptorTable, 1);
+	g_atomic_ref_count_init(&table->refcount);
+	table->blob = g_bytes_ref(blob);
+	table->items = g_array_new(FALSE, FALSE, sizeof(FuHidDescriptorItem));
+	table->reports = g_array_new(FALSE, FALSE, sizeof(FuHidDescriptorReport));
+	table->report_id_idx = g_hash_table_new_full(g_direct_hash,
+						     g_direct_equal,
+						     NULL,
+						     (GDestroyNotify)g_array_unref);
+	table->usage_idx = g_hash_table_new_full(g_direct_hash,
+						 g_direct_equal,
+						 NULL,
+						 (GDestroyNotify)g_array_unref);
+	return table;
+}
+
+static void
+fu_hid_descriptor_table_index_add(GHashTable *index, guint32 key, guint report_idx)
+{
+	GArray *report_idxs = g_hash_table_lookup(index, GUINT_TO_POINTER(key));
+	if (report_idxs == NULL) {
+		report_idxs = g_array_new(FALSE, FALSE, sizeof(guint));
+		g_hash_table_insert(index, GUINT_TO_POINTER(key), report_idxs);
+	}
+	g_array_append_val(report_idxs, report_idx);
+}
+
+static FuHidDescriptorItem *
+fu_hid_descriptor_table_report_get_item(FuHidDescriptorTable *table,
+					FuHidDescriptorReport *report,
+					guint8 tag)
+{
+	for (guint i = 0; i < report->items_len; i++) {
+		FuHidDescriptorItem *item =
+		    &g_array_index(table->items, FuHidDescriptorItem, report->items_idx + i);
+		if (item->tag == tag)
+			return item;
+	}
+	return NULL;
+}
 
 static guint
-fu_hid_descriptor_count_table_dupes(GPtrArray *table, FuHidReportItem *item)
+fu_hid_descriptor_count_table_dupes(GArray *table, FuHidDescriptorItem *item)
 {
 	guint cnt = 0;
 	for (guint i = 0; i < table->len; i++) {
-		FuHidReportItem *item_tmp = g_ptr_array_index(table, i);
-		if (fu_hid_report_item_get_kind(item) == fu_hid_report_item_get_kind(item_tmp) &&
-		    fu_hid_report_item_get_value(item) == fu_hid_report_item_get_value(item_tmp) &&
-		    fu_firmware_get_idx(FU_FIRMWARE(item)) ==
-			fu_firmware_get_idx(FU_FIRMWARE(item_tmp)))
+		FuHidDescriptorItem *item_tmp = &g_array_index(table, FuHidDescriptorItem, i);
+		if (item->value == item_tmp->value && item->tag == item_tmp->tag)
 			cnt++;
 	}
 	return cnt;
 }
 
 static gboolean
-fu_hid_descriptor_parse(FuFirmware *firmware,
-			GInputStream *stream,
-			FuFirmwareParseFlags flags,
-			GError **error)
+fu_hid_descriptor_parse_item(const guint8 *buf,
+			     gsize bufsz,
+			     gsize offset,
+			     FuHidDescriptorItem *item,
+			     GError **error)
+{
+	const guint8 size_lookup[] = {0, 1, 2, 4};
+	guint8 data_size = size_lookup[buf[offset] & 0b11];
+
+	item->offset = offset;
+	item->tag = (buf[offset] & 0b11111100) >> 2;
+	item->value = 0;
+	if (item->tag == FU_HID_ITEM_TAG_LONG && data_size == 2) {
+		if (!fu_memread_uint8_safe(buf, bufsz, offset + 1, &data_size, error))
+			return FALSE;
+	} else if (data_size == 1) {
+		guint8 value = 0;
+		if (!fu_memread_uint8_safe(buf, bufsz, offset + 1, &value, error))
+			return FALSE;
+		item->value = value;
+	} else if (data_size == 2) {
+		guint16 value = 0;
+		if (!fu_memread_uint16_safe(buf, bufsz, offset + 1, &value, G_LITTLE_ENDIAN, error))
+			return FALSE;
+		item->value = value;
+	} else if (data_size == 4) {
+		if (!fu_memread_uint32_safe(buf,
+					    bufsz,
+					    offset + 1,
+					    &item->value,
+					    G_LITTLE_ENDIAN,
+					    error))
+			return FALSE;
+	}
+
+	/* success */
+	item->size = 1 + data_size;
+	return TRUE;
+}
+
+/* each tag is only included once, in the order it was last seen */
+static void
+fu_hid_descriptor_table_append_last(GArray *items, GArray *table)
 {
+	gint last[FU_HID_DESCRIPTOR_TAG_MAX];
+
+	for (guint i = 0; i < FU_HID_DESCRIPTOR_TAG_MAX; i++)
+		last[i] = -1;
+	for (guint i = 0; i < table->len; i++) {
+		FuHidDescriptorItem *item = &g_array_index(table, FuHidDescriptorItem, i);
+		last[item->tag] = i;
+	}
+	for (guint i = 0; i < table->len; i++) {
+		FuHidDescriptorItem *item = &g_array_index(table, FuHidDescriptorItem, i);
+		if (last[item->tag] == (gint)i)
+			g_array_append_val(items, *item);
+	}
+}
+
+static void
+fu_hid_descriptor_table_add_report(FuHidDescriptorTable *table,
+				   GArray *table_state,
+				   GArray *table_local)
+{
+	FuHidDescriptorReport report = {.items_idx = table->items->len};
+	FuHidDescriptorItem *item_id;
+	FuHidDescriptorItem *item_page;
+	FuHidDescriptorItem *item_usage;
+
+	/* the items are stored contiguously so there is no per-report allocation */
+	fu_hid_descriptor_table_append_last(table->items, table_state);
+	fu_hid_descriptor_table_append_last(table->items, table_local);
+	report.items_len = table->items->len - report.items_idx;
+	g_array_append_val(table->reports, report);
+
+	/* index for fu_hid_descriptor_find_report() */
+	item_id = fu_hid_descriptor_table_report_get_item(table,
+							  &report,
+							  FU_HID_ITEM_TAG_REPORT_ID);
+	if (item_id != NULL) {
+		fu_hid_descriptor_table_index_add(table->report_id_idx,
+						  item_id->value,
+						  table->reports->len - 1);
+	}
+	item_page = fu_hid_descriptor_table_report_get_item(table,
+							    &report,
+							    FU_HID_ITEM_TAG_USAGE_PAGE);
+	item_usage = fu_hid_descriptor_table_report_get_item(table, &report, FU_HID_ITEM_TAG_USAGE);
+	if (item_page != NULL && item_usage != NULL) {
+		fu_hid_descriptor_table_index_add(table->usage_idx,
+						  (item_page->value << 16) |
+						      (item_usage->value & 0xFFFF),
+						  table->reports->len - 1);
+	}
+}
+
+static FuHidDescriptorTable *
+fu_hid_descriptor_table_parse(GBytes *blob, GError **error)
+{
+	gsize bufsz = 0;
 	gsize offset = 0;
-	gsize streamsz = 0;
-	g_autoptr(GPtrArray) table_state =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(GPtrArray) table_local =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	if (!fu_input_stream_size(stream, &streamsz, error))
-		return FALSE;
-	while (offset < streamsz) {
-		g_autofree gchar *itemstr = NULL;
-		g_autoptr(FuHidReportItem) item = fu_hid_report_item_new();
+	const guint8 *buf = g_bytes_get_data(blob, &bufsz);
+	g_autoptr(FuHidDescriptorTable) table = fu_hid_descriptor_table_new(blob);
+	g_autoptr(GArray) table_state = g_array_new(FALSE, FALSE, sizeof(FuHidDescriptorItem));
+	g_autoptr(GArray) table_local = g_array_new(FALSE, FALSE, sizeof(FuHidDescriptorItem));
+
+	while (offset < bufsz) {
+		FuHidDescriptorItem item = {0};
+		FuHidItemKind kind;
 
 		/* sanity check */
 		if (table_state->len > FU_HID_DESCRIPTOR_TABLE_GLOBAL_SIZE_MAX) {
@@ -73,7 +270,7 @@ fu_hid_descriptor_parse(FuFirmware *firmware,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "HID table state too large, limit is %u",
 				    (guint)FU_HID_DESCRIPTOR_TABLE_GLOBAL_SIZE_MAX);
-			return FALSE;
+			return NULL;
 		}
 		if (table_local->len > FU_HID_DESCRIPTOR_TABLE_LOCAL_SIZE_MAX) {
 			g_set_error(error,
@@ -81,20 +278,20 @@ fu_hid_descriptor_parse(FuFirmware *firmware,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "HID table state too large, limit is %u",
 				    (guint)FU_HID_DESCRIPTOR_TABLE_LOCAL_SIZE_MAX);
-			return FALSE;
+			return NULL;
 		}
 
-		if (!fu_firmware_parse_stream(FU_FIRMWARE(item), stream, offset, flags, error))
-			return FALSE;
-		offset += fu_firmware_get_size(FU_FIRMWARE(item));
-
-		/* only for debugging */
-		itemstr = fu_firmware_to_string(FU_FIRMWARE(item));
-		g_debug("add to table-state: %s", itemstr);
+		if (!fu_hid_descriptor_parse_item(buf, bufsz, offset, &item, error))
+			return NULL;
+		offset += item.size;
+		kind = item.tag & 0b11;
+		g_debug("add to table-state: %s=0x%x",
+			fu_hid_item_tag_to_string(item.tag),
+			(guint)item.value);
 
 		/* if there is a sane number of duplicate tokens then add to table */
-		if (fu_hid_report_item_get_kind(item) == FU_HID_ITEM_KIND_GLOBAL) {
-			if (fu_hid_descriptor_count_table_dupes(table_state, item) >
+		if (kind == FU_HID_ITEM_KIND_GLOBAL) {
+			if (fu_hid_descriptor_count_table_dupes(table_state, &item) >
 			    FU_HID_DESCRIPTOR_TABLE_GLOBAL_DUPES_MAX) {
 				g_set_error(
 				    error,
@@ -102,13 +299,12 @@ fu_hid_descriptor_parse(FuFirmware *firmware,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "table invalid @0x%x, too many duplicate global %s tokens",
 				    (guint)offset,
-				    fu_firmware_get_id(FU_FIRMWARE(item)));
-				return FALSE;
+				    fu_hid_item_tag_to_string(item.tag));
+				return NULL;
 			}
-			g_ptr_array_add(table_state, g_object_ref(item));
-		} else if (fu_hid_report_item_get_kind(item) == FU_HID_ITEM_KIND_LOCAL ||
-			   fu_hid_report_item_get_kind(item) == FU_HID_ITEM_KIND_MAIN) {
-			if (fu_hid_descriptor_count_table_dupes(table_local, item) >
+			g_array_append_val(table_state, item);
+		} else if (kind == FU_HID_ITEM_KIND_LOCAL || kind == FU_HID_ITEM_KIND_MAIN) {
+			if (fu_hid_descriptor_count_table_dupes(table_local, &item) >
 			    FU_HID_DESCRIPTOR_TABLE_LOCAL_DUPES_MAX) {
 				g_set_error(
 				    error,
@@ -116,45 +312,153 @@ fu_hid_descriptor_parse(FuFirmware *firmware,
 				    FWUPD_ERROR_INVALID_DATA,
 				    "table invalid @0x%x, too many duplicate %s %s:0x%x tokens",
 				    (guint)offset,
-				    fu_hid_item_kind_to_string(fu_hid_report_item_get_kind(item)),
-				    fu_firmware_get_id(FU_FIRMWARE(item)),
-				    fu_hid_report_item_get_value(item));
-				return FALSE;
+				    fu_hid_item_kind_to_string(kind),
+				    fu_hid_item_tag_to_string(item.tag),
+				    item.value);
+				return NULL;
 			}
-			g_ptr_array_add(table_local, g_object_ref(item));
+			g_array_append_val(table_local, item);
 		}
 
-		/* add report */
-		if (fu_hid_report_item_get_kind(item) == FU_HID_ITEM_KIND_MAIN) {
-			g_autoptr(FuHidReport) report = fu_hid_report_new();
-
-			/* copy the table state to the new report */
-			for (guint i = 0; i < table_state->len; i++) {
-				FuHidReportItem *item_tmp = g_ptr_array_index(table_state, i);
-				if (!fu_firmware_add_image(FU_FIRMWARE(report),
-							   FU_FIRMWARE(item_tmp),
-							   error))
-					return FALSE;
-			}
-			for (guint i = 0; i < table_local->len; i++) {
-				FuHidReportItem *item_tmp = g_ptr_array_index(table_local, i);
-				if (!fu_firmware_add_image(FU_FIRMWARE(report),
-							   FU_FIRMWARE(item_tmp),
-							   error))
-					return FALSE;
-			}
-			if (!fu_firmware_add_image(firmware, FU_FIRMWARE(report), error))
-				return FALSE;
-
-			/* remove all the local items */
-			g_ptr_array_set_size(table_local, 0);
+		/* add report, and remove all the local items */
+		if (kind == FU_HID_ITEM_KIND_MAIN) {
+			fu_hid_descriptor_table_add_report(table, table_state, table_local);
+			g_array_set_size(table_local, 0);
 		}
 	}
 
 	/* success */
+	return g_steal_pointer(&table);
+}
+
+static FuHidDescriptorTable *
+fu_hid_descriptor_table_lookup(GBytes *blob, GError **error)
+{
+	FuHidDescriptorTable *table;
+	g_autoptr(FuHidDescriptorTable) table_new = NULL;
+
+	/* already parsed */
+	g_mutex_lock(&fu_hid_descriptor_cache_mutex);
+	table = fu_hid_descriptor_cache != NULL
+		    ? g_hash_table_lookup(fu_hid_descriptor_cache, blob)
+		    : NULL;
+	if (table != NULL)
+		fu_hid_descriptor_table_ref(table);
+	g_mutex_unlock(&fu_hid_descriptor_cache_mutex);
+	if (table != NULL)
+		return table;
+
+	/* parse without the lock held, and add to the cache */
+	table_new = fu_hid_descriptor_table_parse(blob, error);
+	if (table_new == NULL)
+		return NULL;
+	g_mutex_lock(&fu_hid_descriptor_cache_mutex);
+	if (fu_hid_descriptor_cache == NULL) {
+		fu_hid_descriptor_cache =
+		    g_hash_table_new_full(g_bytes_hash,
+					  g_bytes_equal,
+					  (GDestroyNotify)g_bytes_unref,
+					  (GDestroyNotify)fu_hid_descriptor_table_unref);
+	}
+	if (g_hash_table_size(fu_hid_descriptor_cache) >= FU_HID_DESCRIPTOR_CACHE_SIZE_MAX)
+		g_hash_table_remove_all(fu_hid_descriptor_cache);
+	g_hash_table_insert(fu_hid_descriptor_cache,
+			    g_bytes_ref(blob),
+			    fu_hid_descriptor_table_ref(table_new));
+	g_mutex_unlock(&fu_hid_descriptor_cache_mutex);
+	return g_steal_pointer(&table_new);
+}
+
+static gboolean
+fu_hid_descriptor_parse(FuFirmware *firmware,
+			GInputStream *stream,
+			FuFirmwareParseFlags flags,
+			GError **error)
+{
+	FuHidDescriptor *self = FU_HID_DESCRIPTOR(firmware);
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(FuHidDescriptorTable) table = NULL;
+
+	blob = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, error);
+	if (blob == NULL)
+		return FALSE;
+	table = fu_hid_descriptor_table_lookup(blob, error);
+	if (table == NULL)
+		return FALSE;
+	if (table->reports->len > fu_firmware_get_images_max(firmware)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "too many images, limit is %u",
+			    fu_firmware_get_images_max(firmware));
+		return FALSE;
+	}
+
+	/* the FuHidReport images are only created when required */
+	if (priv->table != NULL)
+		fu_hid_descriptor_table_unref(priv->table);
+	priv->table = g_steal_pointer(&table);
+	priv->images_valid = FALSE;
 	return TRUE;
 }
 
+static FuHidReport *
+fu_hid_descriptor_build_report(FuHidDescriptor *self, guint report_idx, GError **error)
+{
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
+	FuHidDescriptorReport *report_flat =
+	    &g_array_index(priv->table->reports, FuHidDescriptorReport, report_idx);
+	g_autoptr(FuHidReport) report = fu_hid_report_new();
+	g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(priv->table->blob);
+
+	for (guint i = 0; i < report_flat->items_len; i++) {
+		FuHidDescriptorItem *item_flat = &g_array_index(priv->table->items,
+								FuHidDescriptorItem,
+								report_flat->items_idx + i);
+		g_autoptr(FuHidReportItem) item = fu_hid_report_item_new();
+		if (!fu_firmware_parse_stream(FU_FIRMWARE(item),
+					      stream,
+					      item_flat->offset,
+					      FU_FIRMWARE_PARSE_FLAG_NONE,
+					      error))
+			return NULL;
+		if (!fu_firmware_add_image(FU_FIRMWARE(report), FU_FIRMWARE(item), error))
+			return NULL;
+	}
+	return g_steal_pointer(&report);
+}
+
+static gboolean
+fu_hid_descriptor_ensure_images(FuHidDescriptor *self, GError **error)
+{
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
+
+	/* built from XML, or already done */
+	if (priv->table == NULL || priv->images_valid)
+		return TRUE;
+	for (guint i = 0; i < priv->table->reports->len; i++) {
+		g_autoptr(FuHidReport) report = fu_hid_descriptor_build_report(self, i, error);
+		if (report == NULL)
+			return FALSE;
+		if (!fu_firmware_add_image(FU_FIRMWARE(self), FU_FIRMWARE(report), error))
+			return FALSE;
+	}
+	priv->images_valid = TRUE;
+	return TRUE;
+}
+
+static void
+fu_hid_descriptor_export(FuFirmware *firmware, FuFirmwareExportFlags flags, XbBuilderNode *bn)
+{
+	FuHidDescriptor *self = FU_HID_DESCRIPTOR(firmware);
+	g_autoptr(GError) error_local = NULL;
+
+	/* the children are exported after this vfunc */
+	if (!fu_hid_descriptor_ensure_images(self, &error_local))
+		g_warning("failed to build HID reports: %s", error_local->message);
+}
+
 static gboolean
 fu_hid_descriptor_write_report_item(FuFirmware *report_item,
 				    GByteArray *buf,
@@ -207,9 +511,14 @@ fu_hid_descriptor_write_report(FuFirmware *report,
 static GByteArray *
 fu_hid_descriptor_write(FuFirmware *firmware, GError **error)
 {
+	FuHidDescriptor *self = FU_HID_DESCRIPTOR(firmware);
 	g_autoptr(GByteArray) buf = g_byte_array_new();
 	g_autoptr(GHashTable) globals = g_hash_table_new(g_direct_hash, g_direct_equal);
-	g_autoptr(GPtrArray) reports = fu_firmware_get_images(firmware);
+	g_autoptr(GPtrArray) reports = NULL;
+
+	if (!fu_hid_descriptor_ensure_images(self, error))
+		return NULL;
+	reports = fu_firmware_get_images(firmware);
 
 	/* for each report */
 	for (guint i = 0; i < reports->len; i++) {
@@ -225,8 +534,100 @@ fu_hid_descriptor_write(FuFirmware *firmware, GError **error)
 typedef struct {
 	const gchar *id;
 	guint32 value;
+	guint8 tag;
 } FuHidDescriptorCondition;
 
+static gboolean
+fu_hid_descriptor_find_condition_value(GArray *conditions, guint8 tag, guint32 *value)
+{
+	for (guint i = 0; i < conditions->len; i++) {
+		FuHidDescriptorCondition *cond =
+		    &g_array_index(conditions, FuHidDescriptorCondition, i);
+		if (cond->tag == tag) {
+			*value = cond->value;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* use the indexes to only check the reports that could possibly match */
+static GArray *
+fu_hid_descriptor_find_candidates(FuHidDescriptorTable *table, GArray *conditions)
+{
+	guint32 report_id = 0;
+	guint32 usage_page = 0;
+	guint32 usage = 0;
+
+	if (fu_hid_descriptor_find_condition_value(conditions,
+						   FU_HID_ITEM_TAG_REPORT_ID,
+						   &report_id)) {
+		GArray *report_idxs =
+		    g_hash_table_lookup(table->report_id_idx, GUINT_TO_POINTER(report_id));
+		return report_idxs != NULL ? g_array_ref(report_idxs)
+					   : g_array_new(FALSE, FALSE, sizeof(guint));
+	}
+	if (fu_hid_descriptor_find_condition_value(conditions,
+						   FU_HID_ITEM_TAG_USAGE_PAGE,
+						   &usage_page) &&
+	    fu_hid_descriptor_find_condition_value(conditions, FU_HID_ITEM_TAG_USAGE, &usage)) {
+		GArray *report_idxs =
+		    g_hash_table_lookup(table->usage_idx,
+					GUINT_TO_POINTER((usage_page << 16) | (usage & 0xFFFF)));
+		return report_idxs != NULL ? g_array_ref(report_idxs)
+					   : g_array_new(FALSE, FALSE, sizeof(guint));
+	}
+	return NULL;
+}
+
+static gboolean
+fu_hid_descriptor_table_report_matches(FuHidDescriptorTable *table,
+				       guint report_idx,
+				       GArray *conditions)
+{
+	FuHidDescriptorReport *report =
+	    &g_array_index(table->reports, FuHidDescriptorReport, report_idx);
+	for (guint i = 0; i < conditions->len; i++) {
+		FuHidDescriptorCondition *cond =
+		    &g_array_index(conditions, FuHidDescriptorCondition, i);
+		FuHidDescriptorItem *item;
+
+		/* not a tag we know about */
+		if (g_strcmp0(fu_hid_item_tag_to_string(cond->tag), cond->id) != 0)
+			return FALSE;
+		item = fu_hid_descriptor_table_report_get_item(table, report, cond->tag);
+		if (item == NULL || item->value != cond->value)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static FuHidReport *
+fu_hid_descriptor_find_report_flat(FuHidDescriptor *self, GArray *conditions, GError **error)
+{
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GArray) report_idxs = NULL;
+
+	report_idxs = fu_hid_descriptor_find_candidates(priv->table, conditions);
+	if (report_idxs == NULL) {
+		report_idxs = g_array_new(FALSE, FALSE, sizeof(guint));
+		for (guint i = 0; i < priv->table->reports->len; i++)
+			g_array_append_val(report_idxs, i);
+	}
+	for (guint i = 0; i < report_idxs->len; i++) {
+		guint report_idx = g_array_index(report_idxs, guint, i);
+		if (!fu_hid_descriptor_table_report_matches(priv->table, report_idx, conditions))
+			continue;
+		if (priv->images_valid) {
+			g_autoptr(GPtrArray) reports = fu_firmware_get_images(FU_FIRMWARE(self));
+			return g_object_ref(g_ptr_array_index(reports, report_idx));
+		}
+		return fu_hid_descriptor_build_report(self, report_idx, error);
+	}
+	g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no report found");
+	return NULL;
+}
+
 /**
  * fu_hid_descriptor_find_report:
  * @self: a #FuHidDescriptor
@@ -242,9 +643,10 @@ typedef struct {
 FuHidReport *
 fu_hid_descriptor_find_report(FuHidDescriptor *self, GError **error, ...)
 {
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
 	va_list args;
-	g_autoptr(GPtrArray) conditions = g_ptr_array_new_with_free_func(g_free);
-	g_autoptr(GPtrArray) reports = fu_firmware_get_images(FU_FIRMWARE(self));
+	g_autoptr(GArray) conditions = g_array_new(FALSE, FALSE, sizeof(FuHidDescriptorCondition));
+	g_autoptr(GPtrArray) reports = NULL;
 
 	g_return_val_if_fail(FU_IS_HID_DESCRIPTOR(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
@@ -252,21 +654,28 @@ fu_hid_descriptor_find_report(FuHidDescriptor *self, GError **error, ...)
 	/* parse varargs */
 	va_start(args, error);
 	for (guint i = 0; i < 1000; i++) {
-		g_autofree FuHidDescriptorCondition *cond = g_new0(FuHidDescriptorCondition, 1);
-		cond->id = va_arg(args, const gchar *);
-		if (cond->id == NULL)
+		FuHidDescriptorCondition cond = {0};
+		cond.id = va_arg(args, const gchar *);
+		if (cond.id == NULL)
 			break;
-		cond->value = va_arg(args, guint32);
-		g_ptr_array_add(conditions, g_steal_pointer(&cond));
+		cond.value = va_arg(args, guint32);
+		cond.tag = fu_hid_item_tag_from_string(cond.id);
+		g_array_append_val(conditions, cond);
 	}
 	va_end(args);
 
+	/* parsed from a blob */
+	if (priv->table != NULL)
+		return fu_hid_descriptor_find_report_flat(self, conditions, error);
+
 	/* return the first report that matches *all* conditions */
+	reports = fu_firmware_get_images(FU_FIRMWARE(self));
 	for (guint i = 0; i < reports->len; i++) {
 		FuHidReport *report = g_ptr_array_index(reports, i);
 		gboolean matched = TRUE;
 		for (guint j = 0; j < conditions->len; j++) {
-			FuHidDescriptorCondition *cond = g_ptr_array_index(conditions, j);
+			FuHidDescriptorCondition *cond =
+			    &g_array_index(conditions, FuHidDescriptorCondition, j);
 			g_autoptr(FuFirmware) item =
 			    fu_firmware_get_image_by_id(FU_FIRMWARE(report), cond->id, NULL);
 			if (item == NULL) {
@@ -298,11 +707,24 @@ fu_hid_descriptor_init(FuHidDescriptor *self)
 	fu_firmware_add_image_gtype(FU_FIRMWARE(self), FU_TYPE_HID_REPORT);
 }
 
+static void
+fu_hid_descriptor_finalize(GObject *object)
+{
+	FuHidDescriptor *self = FU_HID_DESCRIPTOR(object);
+	FuHidDescriptorPrivate *priv = GET_PRIVATE(self);
+	if (priv->table != NULL)
+		fu_hid_descriptor_table_unref(priv->table);
+	G_OBJECT_CLASS(fu_hid_descriptor_parent_class)->finalize(object);
+}
+
 static void
 fu_hid_descriptor_class_init(FuHidDescriptorClass *klass)
 {
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
 	FuFirmwareClass *firmware_class = FU_FIRMWARE_CLASS(klass);
+	object_class->finalize = fu_hid_descriptor_finalize;
 	firmware_class->parse = fu_hid_descriptor_parse;
+	firmware_class->export = fu_hid_descriptor_export;
 	firmware_class->write = fu_hid_descriptor_write;
 }
 
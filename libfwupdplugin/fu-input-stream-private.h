@@ -0,0 +1,14 @@
+/*
+ * Copyright 2023 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-input-stream.h"
+
+GInputStream *
+fu_input_stream_from_bytes(GBytes *blob) G_GNUC_NON_NULL(1);
+GBytes *
+fu_input_stream_get_memory_bytes(GInputStream *stream) G_GNUC_NON_NULL(1);
@@ -10,8 +10,9 @@
 
 #include "fu-chunk-array.h"
 #include "fu-crc-private.h"
-#include "fu-input-stream.h"
+#include "fu-input-stream-private.h"
 #include "fu-mem-private.h"
+#include "fu-partial-input-stream-private.h"
 #include "fu-sum.h"
 
 /**
@@ -366,6 +367,65 @@ fu_input_stream_read_bytes(GInputStream *stream,
 	return g_byte_array_free_to_bytes(g_steal_pointer(&buf)); /* nocheck:blocked */
 }
 
+/**
+ * fu_input_stream_from_bytes:
+ * @blob: a #GBytes
+ *
+ * Creates a memory input stream that keeps a reference to @blob, so that
+ * fu_input_stream_get_memory_bytes() can return the data without copying it.
+ *
+ * Returns: (transfer full): a #GInputStream
+ *
+ * Since: 2.1.1
+ **/
+GInputStream *
+fu_input_stream_from_bytes(GBytes *blob)
+{
+	GInputStream *stream;
+	g_return_val_if_fail(blob != NULL, NULL);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	g_object_set_data_full(G_OBJECT(stream),
+			       "fwupd::bytes",
+			       g_bytes_ref(blob),
+			       (GDestroyNotify)g_bytes_unref);
+	return stream;
+}
+
+/**
+ * fu_input_stream_get_memory_bytes:
+ * @stream: a #GInputStream
+ *
+ * Gets the data of a stream created with fu_input_stream_from_bytes(), or of a
+ * #FuPartialInputStream slice of one, without copying it.
+ *
+ * Returns: (transfer full) (nullable): a #GBytes, or %NULL if not backed by memory
+ *
+ * Since: 2.1.1
+ **/
+GBytes *
+fu_input_stream_get_memory_bytes(GInputStream *stream)
+{
+	GBytes *blob;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+
+	if (FU_IS_PARTIAL_INPUT_STREAM(stream)) {
+		FuPartialInputStream *partial_stream = FU_PARTIAL_INPUT_STREAM(stream);
+		g_autoptr(GBytes) blob_base = NULL;
+		blob_base = fu_input_stream_get_memory_bytes(
+		    fu_partial_input_stream_get_base_stream(partial_stream));
+		if (blob_base == NULL)
+			return NULL;
+		return g_bytes_new_from_bytes(blob_base,
+					      fu_partial_input_stream_get_offset(partial_stream),
+					      fu_partial_input_stream_get_size(partial_stream));
+	}
+	blob = g_object_get_data(G_OBJECT(stream), "fwupd::bytes");
+	if (blob == NULL)
+		return NULL;
+	return g_bytes_ref(blob);
+}
+
 /**
  * fu_input_stream_read_string:
  * @stream: a #GInputStream
@@ -474,6 +534,41 @@ fu_input_stream_compute_checksum(GInputStream *stream, GChecksumType checksum_ty
 	return g_strdup(g_checksum_get_string(csum));
 }
 
+static gboolean
+fu_input_stream_compute_checksums_cb(const guint8 *buf,
+				     gsize bufsz,
+				     gpointer user_data,
+				     GError **error)
+{
+	GPtrArray *csums = (GPtrArray *)user_data;
+	for (guint i = 0; i < csums->len; i++) {
+		GChecksum *csum = g_ptr_array_index(csums, i);
+		g_checksum_update(csum, buf, bufsz);
+	}
+	return TRUE;
+}
+
+/**
+ * fu_input_stream_compute_checksums:
+ * @stream: a #GInputStream
+ * @csums: (element-type GChecksum): checksums
+ * @error: (nullable): optional return location for an error
+ *
+ * Updates each checksum with the entire stream, reading the stream just once.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_input_stream_compute_checksums(GInputStream *stream, GPtrArray *csums, GError **error)
+{
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(csums != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	return fu_input_stream_chunkify(stream, fu_input_stream_compute_checksums_cb, csums, error);
+}
+
 static gboolean
 fu_input_stream_compute_sum8_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
 {
@@ -781,3 +876,196 @@ fu_input_stream_find(GInputStream *stream,
 		    (guint)bufsz);
 	return FALSE;
 }
+
+#define FU_INPUT_STREAM_FIND_STATE_INVALID G_MAXUINT32
+
+/* one node of the Aho-Corasick automaton, with the goto function fully expanded */
+typedef struct {
+	guint32 next[256];
+	guint32 fail;
+	guint match; /* index into the longest needle ending here plus one, or zero if none */
+} FuInputStreamFindState;
+
+static guint32
+fu_input_stream_find_state_new(GArray *states)
+{
+	FuInputStreamFindState state = {.fail = 0, .match = 0};
+	for (guint i = 0; i < G_N_ELEMENTS(state.next); i++)
+		state.next[i] = FU_INPUT_STREAM_FIND_STATE_INVALID;
+	g_array_append_val(states, state);
+	return states->len - 1;
+}
+
+static GArray *
+fu_input_stream_find_states_new(GPtrArray *needles)
+{
+	GArray *states = g_array_new(FALSE, FALSE, sizeof(FuInputStreamFindState));
+	g_autoptr(GQueue) queue = g_queue_new();
+
+	/* build the trie, where the first needle wins if two are identical */
+	fu_input_stream_find_state_new(states);
+	for (guint i = 0; i < needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(needles, i);
+		gsize bufsz = 0;
+		const guint8 *buf = g_bytes_get_data(needle, &bufsz);
+		guint32 cur = 0;
+		FuInputStreamFindState *state;
+
+		for (gsize j = 0; j < bufsz; j++) {
+			guint32 idx;
+			state = &g_array_index(states, FuInputStreamFindState, cur);
+			idx = state->next[buf[j]];
+			if (idx == FU_INPUT_STREAM_FIND_STATE_INVALID) {
+				/* this may reallocate the array */
+				idx = fu_input_stream_find_state_new(states);
+				state = &g_array_index(states, FuInputStreamFindState, cur);
+				state->next[buf[j]] = idx;
+			}
+			cur = idx;
+		}
+		state = &g_array_index(states, FuInputStreamFindState, cur);
+		if (state->match == 0)
+			state->match = i + 1;
+	}
+
+	/* add the failure links breadth-first, so every state has a transition for every byte */
+	for (guint b = 0; b < 256; b++) {
+		FuInputStreamFindState *root = &g_array_index(states, FuInputStreamFindState, 0);
+		if (root->next[b] == FU_INPUT_STREAM_FIND_STATE_INVALID) {
+			root->next[b] = 0;
+			continue;
+		}
+		g_queue_push_tail(queue, GUINT_TO_POINTER(root->next[b]));
+	}
+	while (!g_queue_is_empty(queue)) {
+		guint32 cur = GPOINTER_TO_UINT(g_queue_pop_head(queue));
+		FuInputStreamFindState *state = &g_array_index(states, FuInputStreamFindState, cur);
+		FuInputStreamFindState *state_fail =
+		    &g_array_index(states, FuInputStreamFindState, state->fail);
+		for (guint b = 0; b < 256; b++) {
+			FuInputStreamFindState *child;
+			FuInputStreamFindState *child_fail;
+			guint32 idx = state->next[b];
+			if (idx == FU_INPUT_STREAM_FIND_STATE_INVALID) {
+				state->next[b] = state_fail->next[b];
+				continue;
+			}
+			child = &g_array_index(states, FuInputStreamFindState, idx);
+			child->fail = state_fail->next[b];
+
+			/* a shorter needle may end here, but it starts later than this one */
+			child_fail = &g_array_index(states, FuInputStreamFindState, child->fail);
+			if (child->match == 0)
+				child->match = child_fail->match;
+			g_queue_push_tail(queue, GUINT_TO_POINTER(idx));
+		}
+	}
+	return states;
+}
+
+/**
+ * fu_input_stream_find_any:
+ * @stream: a #GInputStream
+ * @needles: (element-type GBytes): buffers to look for
+ * @offset: starting offset, typically 0x0
+ * @offset_found: (nullable) (out): found offset
+ * @idx_found: (nullable) (out): index into @needles of the buffer that was found
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the first of any of the memory buffers within an input stream, reading the stream only
+ * once and without loading the entire stream into a buffer.
+ *
+ * If more than one buffer starts at the same offset then the one with the lowest index is
+ * returned.
+ *
+ * Returns: %TRUE if any of @needles was found
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_input_stream_find_any(GInputStream *stream,
+			 GPtrArray *needles,
+			 gsize offset,
+			 gsize *offset_found,
+			 guint *idx_found,
+			 GError **error)
+{
+	const gsize blocksz = 0x10000;
+	gsize offset_cur = offset;
+	gsize needlesz_max = 0;
+	gsize offset_best = G_MAXSIZE;
+	guint idx_best = G_MAXUINT;
+	guint32 cur = 0;
+	g_autoptr(GArray) states = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(needles != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	for (guint i = 0; i < needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(needles, i);
+		g_return_val_if_fail(g_bytes_get_size(needle) != 0, FALSE);
+		needlesz_max = MAX(needlesz_max, g_bytes_get_size(needle));
+	}
+
+	states = fu_input_stream_find_states_new(needles);
+	while (needles->len > 0) {
+		g_autoptr(GByteArray) buf_tmp = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* read more data, the automaton keeps the partial match across blocks */
+		buf_tmp = fu_input_stream_read_byte_array(stream,
+							  offset_cur,
+							  blocksz,
+							  NULL,
+							  &error_local);
+		if (buf_tmp == NULL) {
+			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
+				break;
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return FALSE;
+		}
+		for (guint i = 0; i < buf_tmp->len; i++) {
+			FuInputStreamFindState *state =
+			    &g_array_index(states, FuInputStreamFindState, cur);
+			gsize offset_end = offset_cur + i + 1;
+
+			/* a longer needle cannot start at or before the best match any more */
+			if (idx_best != G_MAXUINT && offset_end > offset_best + needlesz_max)
+				break;
+			cur = state->next[buf_tmp->data[i]];
+			state = &g_array_index(states, FuInputStreamFindState, cur);
+			if (state->match != 0) {
+				guint idx = state->match - 1;
+				GBytes *needle = g_ptr_array_index(needles, idx);
+				gsize offset_start = offset_end - g_bytes_get_size(needle);
+				if (offset_start < offset_best ||
+				    (offset_start == offset_best && idx < idx_best)) {
+					offset_best = offset_start;
+					idx_best = idx;
+				}
+			}
+		}
+		if (idx_best != G_MAXUINT &&
+		    offset_cur + buf_tmp->len >= offset_best + needlesz_max)
+			break;
+		if (buf_tmp->len == 0)
+			break;
+
+		/* move the offset */
+		offset_cur += buf_tmp->len;
+	}
+	if (idx_best != G_MAXUINT) {
+		if (offset_found != NULL)
+			*offset_found = offset_best;
+		if (idx_found != NULL)
+			*idx_found = idx_best;
+		return TRUE;
+	}
+	g_set_error(error,
+		    FWUPD_ERROR,
+		    FWUPD_ERROR_NOT_FOUND,
+		    "failed to find any of %u buffers",
+		    needles->len);
+	return FALSE;
+}
@@ -101,9 +101,19 @@ fu_input_stream_compute_checksum(GInputStream *stream,
 				 GChecksumType checksum_type,
 				 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 gboolean
+fu_input_stream_compute_checksums(GInputStream *stream, GPtrArray *csums, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gboolean
 fu_input_stream_find(GInputStream *stream,
 		     const guint8 *buf,
 		     gsize bufsz,
 		     gsize offset,
 		     gsize *offset_found,
 		     GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_input_stream_find_any(GInputStream *stream,
+			 GPtrArray *needles,
+			 gsize offset,
+			 gsize *offset_found,
+			 guint *idx_found,
+			 GError **error) G_GNUC_NON_NULL(1, 2);
@@ -12,3 +12,5 @@ gsize
 fu_partial_input_stream_get_offset(FuPartialInputStream *self) G_GNUC_NON_NULL(1);
 gsize
 fu_partial_input_stream_get_size(FuPartialInputStream *self) G_GNUC_NON_NULL(1);
+GInputStream *
+fu_partial_input_stream_get_base_stream(FuPartialInputStream *self) G_GNUC_NON_NULL(1);
@@ -237,6 +237,23 @@ fu_partial_input_stream_get_size(FuPartialInputStream *self)
 	return self->size;
 }
 
+/**
+ * fu_partial_input_stream_get_base_stream:
+ * @self: a #FuPartialInputStream
+ *
+ * Gets the stream that this is a slice of.
+ *
+ * Returns: (transfer none): a #GInputStream
+ *
+ * Since: 2.1.1
+ **/
+GInputStream *
+fu_partial_input_stream_get_base_stream(FuPartialInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_PARTIAL_INPUT_STREAM(self), NULL);
+	return self->base_stream;
+}
+
 static gssize
 fu_partial_input_stream_read(GInputStream *stream,
 			     void *buffer,
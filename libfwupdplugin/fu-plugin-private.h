@@ -28,6 +28,17 @@ void
 fu_plugin_set_priority(FuPlugin *self, guint priority) G_GNUC_NON_NULL(1);
 GArray *
 fu_plugin_get_device_gtypes(FuPlugin *self) G_GNUC_NON_NULL(1);
+const gchar *
+fu_plugin_get_activation_reason(FuPlugin *self) G_GNUC_NON_NULL(1);
+void
+fu_plugin_set_activation_reason(FuPlugin *self, const gchar *activation_reason)
+    G_GNUC_NON_NULL(1);
+gboolean
+fu_plugin_get_deferred(FuPlugin *self) G_GNUC_NON_NULL(1);
+void
+fu_plugin_set_deferred(FuPlugin *self, gboolean deferred) G_GNUC_NON_NULL(1);
+gboolean
+fu_plugin_can_defer_startup(FuPlugin *self) G_GNUC_NON_NULL(1);
 gchar *
 fu_plugin_to_string(FuPlugin *self) G_GNUC_NON_NULL(1);
 void
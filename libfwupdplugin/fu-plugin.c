@@ -24,6 +24,7 @@
 #include "fu-plugin-private.h"
 #include "fu-security-attr.h"
 #include "fu-string.h"
+#include "fu-trace.h"
 
 /**
  * FuPlugin:
@@ -51,6 +52,8 @@ typedef struct {
 	GHashTable *cache;	     /* (nullable): platform_id:GObject */
 	GHashTable *report_metadata; /* (nullable): key:value */
 	GFileMonitor *config_monitor;
+	gchar *activation_reason; /* (nullable) */
+	gboolean deferred;
 	FuPluginData *data;
 	FuPluginVfuncs vfuncs;
 } FuPluginPrivate;
@@ -63,6 +66,7 @@ enum {
 	SIGNAL_DEVICE_REGISTER,
 	SIGNAL_RULES_CHANGED,
 	SIGNAL_CHECK_SUPPORTED,
+	SIGNAL_SECURITY_CHANGED,
 	SIGNAL_LAST
 };
 
@@ -156,6 +160,14 @@ fu_plugin_get_vfuncs(FuPlugin *self)
 	return FU_PLUGIN_GET_CLASS(self);
 }
 
+/* disabled, or waiting for the engine to run ->startup() */
+static gboolean
+fu_plugin_is_inactive(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	return priv->deferred || fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED);
+}
+
 /**
  * fu_plugin_cache_lookup:
  * @self: a #FuPlugin
@@ -390,6 +402,8 @@ fu_plugin_add_string(FuPlugin *self, guint idt, GString *str)
 					  "DeviceGTypeDefault",
 					  g_type_name(priv->device_gtype_default));
 	}
+	fwupd_codec_string_append(str, idt + 1, "ActivationReason", priv->activation_reason);
+	fwupd_codec_string_append_bool(str, idt + 1, "Deferred", priv->deferred);
 
 	/* optional */
 	if (vfuncs->to_string != NULL)
@@ -844,6 +858,8 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 gboolean
 fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 	g_autoptr(GError) error_local = NULL;
 
@@ -856,13 +872,16 @@ fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 	fu_plugin_runner_init(self);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
 	if (vfuncs->startup != NULL) {
 		g_debug("startup(%s)", fu_plugin_get_name(self));
-		if (!vfuncs->startup(self, progress, &error_local)) {
+		trace_begin = fu_trace_begin();
+		ret = vfuncs->startup(self, progress, &error_local);
+		fu_trace_end("plugin", trace_begin, "startup(%s)", fu_plugin_get_name(self));
+		if (!ret) {
 			if (error_local == NULL) {
 				g_critical("unset plugin error in startup(%s)",
 					   fu_plugin_get_name(self));
@@ -898,6 +917,8 @@ fu_plugin_runner_startup(FuPlugin *self, FuProgress *progress, GError **error)
 gboolean
 fu_plugin_runner_ready(FuPlugin *self, FuProgress *progress, GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 	g_autoptr(GError) error_local = NULL;
 
@@ -905,7 +926,7 @@ fu_plugin_runner_ready(FuPlugin *self, FuProgress *progress, GError **error)
 
 	/* progress */
 	fu_progress_set_name(progress, fu_plugin_get_name(self));
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 	fu_plugin_add_flag(self, FWUPD_PLUGIN_FLAG_READY);
 	if (vfuncs->ready == NULL)
@@ -913,7 +934,10 @@ fu_plugin_runner_ready(FuPlugin *self, FuProgress *progress, GError **error)
 
 	/* optional */
 	g_debug("ready(%s)", fu_plugin_get_name(self));
-	if (!vfuncs->ready(self, progress, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = vfuncs->ready(self, progress, &error_local);
+	fu_trace_end("plugin", trace_begin, "ready(%s)", fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in ready(%s)", fu_plugin_get_name(self));
 			g_set_error_literal(&error_local,
@@ -954,7 +978,7 @@ fu_plugin_runner_init(FuPlugin *self)
 		return;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return;
 
 	/* optional */
@@ -972,17 +996,22 @@ fu_plugin_runner_device_generic(FuPlugin *self,
 				FuPluginDeviceFunc device_func,
 				GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
 	if (device_func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!device_func(self, device, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = device_func(self, device, &error_local);
+	fu_trace_end("plugin", trace_begin, "%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1011,17 +1040,22 @@ fu_plugin_runner_device_generic_progress(FuPlugin *self,
 					 FuPluginDeviceProgressFunc device_func,
 					 GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
 	if (device_func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!device_func(self, device, progress, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = device_func(self, device, progress, &error_local);
+	fu_trace_end("plugin", trace_begin, "%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1051,17 +1085,22 @@ fu_plugin_runner_flagged_device_generic(FuPlugin *self,
 					FuPluginFlaggedDeviceFunc func,
 					GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
 	if (func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!func(self, device, progress, flags, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = func(self, device, progress, flags, &error_local);
+	fu_trace_end("plugin", trace_begin, "%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1089,17 +1128,22 @@ fu_plugin_runner_device_array_generic(FuPlugin *self,
 				      FuPluginDeviceArrayFunc func,
 				      GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	g_autoptr(GError) error_local = NULL;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
 	if (func == NULL)
 		return TRUE;
 	g_debug("%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
-	if (!func(self, devices, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = func(self, devices, &error_local);
+	fu_trace_end("plugin", trace_begin, "%s(%s)", symbol_name + 10, fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in for %s(%s)",
 				   fu_plugin_get_name(self),
@@ -1135,6 +1179,8 @@ fu_plugin_runner_device_array_generic(FuPlugin *self,
 gboolean
 fu_plugin_runner_coldplug(FuPlugin *self, FuProgress *progress, GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	FuPluginPrivate *priv = GET_PRIVATE(self);
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 	g_autoptr(GError) error_local = NULL;
@@ -1146,7 +1192,7 @@ fu_plugin_runner_coldplug(FuPlugin *self, FuProgress *progress, GError **error)
 		fu_progress_set_name(progress, fu_plugin_get_name(self));
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* no HwId */
@@ -1157,7 +1203,10 @@ fu_plugin_runner_coldplug(FuPlugin *self, FuProgress *progress, GError **error)
 	if (vfuncs->coldplug == NULL)
 		return TRUE;
 	g_debug("coldplug(%s)", fu_plugin_get_name(self));
-	if (!vfuncs->coldplug(self, progress, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = vfuncs->coldplug(self, progress, &error_local);
+	fu_trace_end("plugin", trace_begin, "coldplug(%s)", fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in coldplug(%s)", fu_plugin_get_name(self));
 			g_set_error_literal(&error_local,
@@ -1363,7 +1412,7 @@ fu_plugin_runner_reload(FuPlugin *self, FuDevice *device, GError **error)
 	g_autoptr(FuDeviceLocker) locker = NULL;
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* no object loaded */
@@ -1391,7 +1440,7 @@ fu_plugin_runner_reboot_cleanup(FuPlugin *self, FuDevice *device, GError **error
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 
 	/* optional */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 	if (vfuncs->reboot_cleanup == NULL)
 		return TRUE;
@@ -1788,6 +1837,8 @@ fu_plugin_runner_backend_device_added(FuPlugin *self,
 				      FuProgress *progress,
 				      GError **error)
 {
+	gboolean ret;
+	gint64 trace_begin;
 	FuPluginPrivate *priv = GET_PRIVATE(self);
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 	g_autoptr(GError) error_local = NULL;
@@ -1798,7 +1849,7 @@ fu_plugin_runner_backend_device_added(FuPlugin *self,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -1814,7 +1865,10 @@ fu_plugin_runner_backend_device_added(FuPlugin *self,
 		return FALSE;
 	}
 	g_debug("backend_device_added(%s)", fu_plugin_get_name(self));
-	if (!vfuncs->backend_device_added(self, device, progress, &error_local)) {
+	trace_begin = fu_trace_begin();
+	ret = vfuncs->backend_device_added(self, device, progress, &error_local);
+	fu_trace_end("plugin", trace_begin, "backend_device_added(%s)", fu_plugin_get_name(self));
+	if (!ret) {
 		if (error_local == NULL) {
 			g_critical("unset plugin error in backend_device_added(%s)",
 				   fu_plugin_get_name(self));
@@ -1856,7 +1910,7 @@ fu_plugin_runner_backend_device_changed(FuPlugin *self, FuDevice *device, GError
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -1897,7 +1951,7 @@ fu_plugin_runner_device_added(FuPlugin *self, FuDevice *device)
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return;
 
 	/* optional */
@@ -1945,7 +1999,7 @@ fu_plugin_runner_device_register(FuPlugin *self, FuDevice *device)
 	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return;
 
 	/* optional */
@@ -1977,7 +2031,7 @@ fu_plugin_runner_device_created(FuPlugin *self, FuDevice *device, GError **error
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -2018,7 +2072,7 @@ fu_plugin_runner_verify(FuPlugin *self,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -2223,7 +2277,7 @@ fu_plugin_runner_write_firmware(FuPlugin *self,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED)) {
+	if (fu_plugin_is_inactive(self)) {
 		g_debug("plugin not enabled, skipping");
 		return TRUE;
 	}
@@ -2299,7 +2353,7 @@ fu_plugin_runner_composite_peek_firmware(FuPlugin *self,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED)) {
+	if (fu_plugin_is_inactive(self)) {
 		g_debug("plugin not enabled, skipping");
 		return TRUE;
 	}
@@ -2349,7 +2403,7 @@ fu_plugin_runner_clear_results(FuPlugin *self, FuDevice *device, GError **error)
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -2398,7 +2452,7 @@ fu_plugin_runner_get_results(FuPlugin *self, FuDevice *device, GError **error)
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* not enabled */
-	if (fu_plugin_has_flag(self, FWUPD_PLUGIN_FLAG_DISABLED))
+	if (fu_plugin_is_inactive(self))
 		return TRUE;
 
 	/* optional */
@@ -2586,6 +2640,102 @@ fu_plugin_set_priority(FuPlugin *self, guint priority)
 	priv->priority = priority;
 }
 
+/**
+ * fu_plugin_get_activation_reason:
+ * @self: a #FuPlugin
+ *
+ * Gets why a plugin with %FWUPD_PLUGIN_FLAG_LAZY_STARTUP was started.
+ *
+ * Returns: a string, or %NULL if the plugin has not been activated
+ *
+ * Since: 2.1.1
+ **/
+const gchar *
+fu_plugin_get_activation_reason(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), NULL);
+	return priv->activation_reason;
+}
+
+/**
+ * fu_plugin_set_activation_reason:
+ * @self: a #FuPlugin
+ * @activation_reason: (nullable): a string, e.g. `HwId 6de5d951-d755-576b-bd09-c5cf66b27234`
+ *
+ * Sets why a plugin with %FWUPD_PLUGIN_FLAG_LAZY_STARTUP was started.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_plugin_set_activation_reason(FuPlugin *self, const gchar *activation_reason)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_PLUGIN(self));
+	if (g_strcmp0(priv->activation_reason, activation_reason) == 0)
+		return;
+	g_free(priv->activation_reason);
+	priv->activation_reason = g_strdup(activation_reason);
+}
+
+/**
+ * fu_plugin_get_deferred:
+ * @self: a #FuPlugin
+ *
+ * Gets if the engine has postponed ->startup() until a matching device appears. All runners other
+ * than ->startup() are skipped until then, without the plugin being marked as disabled.
+ *
+ * Returns: %TRUE if the startup was deferred
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_plugin_get_deferred(FuPlugin *self)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), FALSE);
+	return priv->deferred;
+}
+
+/**
+ * fu_plugin_set_deferred:
+ * @self: a #FuPlugin
+ * @deferred: boolean
+ *
+ * Sets if the engine has postponed ->startup() until a matching device appears.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_plugin_set_deferred(FuPlugin *self, gboolean deferred)
+{
+	FuPluginPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_PLUGIN(self));
+	priv->deferred = deferred;
+}
+
+/**
+ * fu_plugin_can_defer_startup:
+ * @self: a #FuPlugin
+ *
+ * Gets if ->startup() can be postponed, i.e. the plugin does not implement any vfunc that has to
+ * run before a matching device has been found, for example ->device_registered() or
+ * ->modify_config().
+ *
+ * Returns: %TRUE if the startup can be deferred
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_plugin_can_defer_startup(FuPlugin *self)
+{
+	FuPluginVfuncs *vfuncs = fu_plugin_get_vfuncs(self);
+	g_return_val_if_fail(FU_IS_PLUGIN(self), FALSE);
+	return vfuncs->device_registered == NULL && vfuncs->modify_config == NULL &&
+	       vfuncs->composite_prepare == NULL && vfuncs->composite_cleanup == NULL &&
+	       vfuncs->add_security_attrs == NULL;
+}
+
 /**
  * fu_plugin_add_rule:
  * @self: a #FuPlugin
@@ -2611,6 +2761,23 @@ fu_plugin_add_rule(FuPlugin *self, FuPluginRule rule, const gchar *name)
 	g_signal_emit(self, signals[SIGNAL_RULES_CHANGED], 0);
 }
 
+/**
+ * fu_plugin_security_changed:
+ * @self: a #FuPlugin
+ *
+ * Informs the daemon that the HSI attributes added by this plugin may have changed.
+ *
+ * Unlike fu_context_security_changed() only the attributes from this plugin are recalculated.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_plugin_security_changed(FuPlugin *self)
+{
+	g_return_if_fail(FU_IS_PLUGIN(self));
+	g_signal_emit(self, signals[SIGNAL_SECURITY_CHANGED], 0);
+}
+
 /**
  * fu_plugin_get_rules:
  * @self: a #FuPlugin
@@ -3086,6 +3253,25 @@ fu_plugin_class_init(FuPluginClass *klass)
 						     G_TYPE_NONE,
 						     0);
 
+	/**
+	 * FuPlugin::security-changed:
+	 * @self: the #FuPlugin instance that emitted the signal
+	 *
+	 * The ::security-changed signal is emitted when the HSI attributes added by the plugin
+	 * may have changed.
+	 *
+	 * Since: 2.1.1
+	 **/
+	signals[SIGNAL_SECURITY_CHANGED] = g_signal_new("security-changed",
+							G_TYPE_FROM_CLASS(object_class),
+							G_SIGNAL_RUN_LAST,
+							0,
+							NULL,
+							NULL,
+							g_cclosure_marshal_VOID__VOID,
+							G_TYPE_NONE,
+							0);
+
 	/**
 	 * FuPlugin:context:
 	 *
@@ -3139,6 +3325,7 @@ fu_plugin_finalize(GObject *object)
 		g_array_unref(priv->device_gtypes);
 	if (priv->config_monitor != NULL)
 		g_object_unref(priv->config_monitor);
+	g_free(priv->activation_reason);
 	g_free(priv->data);
 
 	G_OBJECT_CLASS(fu_plugin_parent_class)->finalize(object);
@@ -528,6 +528,8 @@ fu_plugin_get_devices(FuPlugin *self) G_GNUC_NON_NULL(1);
 void
 fu_plugin_add_rule(FuPlugin *self, FuPluginRule rule, const gchar *name) G_GNUC_NON_NULL(1, 3);
 void
+fu_plugin_security_changed(FuPlugin *self) G_GNUC_NON_NULL(1);
+void
 fu_plugin_add_report_metadata(FuPlugin *self, const gchar *key, const gchar *value)
     G_GNUC_NON_NULL(1, 2, 3);
 void
@@ -12,6 +12,7 @@
 
 #include "fu-progress-private.h"
 #include "fu-string.h"
+#include "fu-trace.h"
 
 /**
  * FuProgress:
@@ -72,6 +73,7 @@ struct _FuProgress {
 	guint step_weighting;
 	GTimer *timer;
 	GTimer *timer_child;
+	gint64 trace_begin; /* of the current child */
 	guint step_now;
 	guint step_done;
 	guint step_scaling;
@@ -506,6 +508,7 @@ fu_progress_set_steps(FuProgress *self, guint step_max)
 
 	/* reset child timer */
 	g_timer_start(self->timer_child);
+	self->trace_begin = fu_trace_begin();
 }
 
 /**
@@ -705,6 +708,7 @@ fu_progress_add_step(FuProgress *self, FwupdStatus status, guint value, const gc
 
 	/* reset child timer */
 	g_timer_start(self->timer_child);
+	self->trace_begin = fu_trace_begin();
 }
 
 /**
@@ -877,6 +881,14 @@ fu_progress_step_done(FuProgress *self)
 			fu_progress_set_duration(child, g_timer_elapsed(self->timer_child, NULL));
 		g_timer_start(self->timer_child);
 	}
+	if (child != NULL) {
+		fu_trace_end("progress",
+			     self->trace_begin,
+			     "%s:%s",
+			     self->id,
+			     fu_progress_get_name_fallback(child));
+	}
+	self->trace_begin = fu_trace_begin();
 
 	/* is already at 100%? */
 	if (self->step_now >= self->children->len) {
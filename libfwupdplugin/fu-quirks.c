@@ -1043,6 +1043,26 @@ fu_quirks_add_possible_key(FuQuirks *self, const gchar *possible_key)
 	g_hash_table_add(self->possible_keys, g_strdup(possible_key));
 }
 
+/**
+ * fu_quirks_get_guid:
+ * @self: a #FuQuirks
+ *
+ * Gets the GUID of the compiled quirk silo, which changes when any of the quirk files are added,
+ * removed or modified.
+ *
+ * Returns: a GUID, or %NULL if the quirks have not been loaded
+ *
+ * Since: 2.1.1
+ **/
+const gchar *
+fu_quirks_get_guid(FuQuirks *self)
+{
+	g_return_val_if_fail(FU_IS_QUIRKS(self), NULL);
+	if (self->silo == NULL)
+		return NULL;
+	return xb_silo_get_guid(self->silo);
+}
+
 static void
 fu_quirks_housekeeping_cb(FuContext *ctx, FuQuirks *self)
 {
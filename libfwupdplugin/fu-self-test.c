@@ -24,9 +24,11 @@
 #include "fu-device-private.h"
 #include "fu-device-progress.h"
 #include "fu-dummy-efivars.h"
+#include "fu-efi-common.h"
 #include "fu-efi-lz77-decompressor.h"
 #include "fu-efi-x509-signature-private.h"
 #include "fu-efivars-private.h"
+#include "fu-input-stream-private.h"
 #include "fu-kernel-search-path-private.h"
 #include "fu-lzma-common.h"
 #include "fu-plugin-private.h"
@@ -325,6 +327,144 @@ fu_archive_cab_func(void)
 	g_assert_null(data_tmp3);
 }
 
+static gboolean
+fu_archive_lazy_iterate_cb(FuArchive *self,
+			   const gchar *filename,
+			   GBytes *bytes,
+			   gpointer user_data,
+			   GError **error)
+{
+	GString *str = (GString *)user_data;
+	g_string_append_printf(str, "%s:%u,", filename, (guint)g_bytes_get_size(bytes));
+	return TRUE;
+}
+
+/* in kB, or 0 if unknown */
+static guint64
+fu_self_test_get_peak_rss(void)
+{
+	g_autofree gchar *buf = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	if (!g_file_get_contents("/proc/self/status", &buf, NULL, NULL))
+		return 0;
+	lines = g_strsplit(buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		if (g_str_has_prefix(lines[i], "VmHWM:"))
+			return g_ascii_strtoull(lines[i] + strlen("VmHWM:"), NULL, 10);
+	}
+	return 0;
+}
+
+static void
+fu_archive_lazy_func(void)
+{
+	const gsize entry_sz = 0x100000;
+	const guint entry_cnt = 16;
+	gboolean ret;
+	gdouble elapsed_first;
+	gdouble elapsed_index;
+	guint64 peak_rss;
+	guint8 buf_tmp[0x10] = {0};
+	g_autoptr(FuArchive) archive1 = fu_archive_new(NULL, FU_ARCHIVE_FLAG_NONE, NULL);
+	g_autoptr(FuArchive) archive2 = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_again = NULL;
+	g_autoptr(GBytes) blob_earlier = NULL;
+	g_autoptr(GBytes) blob_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GInputStream) stream_tmp = NULL;
+	g_autoptr(GString) str = g_string_new(NULL);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+#ifndef HAVE_LIBARCHIVE
+	g_test_skip("no libarchive support");
+	return;
+#endif
+
+	/* create a large-ish compressed archive */
+	for (guint i = 0; i < entry_cnt; i++) {
+		g_autofree gchar *fn = g_strdup_printf("dir/file%02u.bin", i);
+		g_autofree guint8 *data = g_malloc(entry_sz);
+		g_autoptr(GBytes) blob_entry = NULL;
+		for (gsize j = 0; j < entry_sz; j++)
+			data[j] = (guint8)(i + j / 0x1000);
+		blob_entry = g_bytes_new_take(g_steal_pointer(&data), entry_sz);
+		fu_archive_add_entry(archive1, fn, blob_entry);
+	}
+	buf = fu_archive_write(archive1,
+			       FU_ARCHIVE_FORMAT_PAX,
+			       FU_ARCHIVE_COMPRESSION_GZIP,
+			       &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(buf);
+	blob = g_bytes_new(buf->data, buf->len);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+
+	/* only the headers are read */
+	peak_rss = fu_self_test_get_peak_rss();
+	g_timer_reset(timer);
+	archive2 = fu_archive_new_stream(stream, FU_ARCHIVE_FLAG_IGNORE_PATH, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(archive2);
+	elapsed_index = g_timer_elapsed(timer, NULL);
+	g_assert_cmpint(fu_archive_get_size_by_fn(archive2, "file07.bin"), ==, entry_sz);
+	g_assert_cmpint(fu_archive_get_size_by_fn(archive2, "dir/file07.bin"), ==, -1);
+
+	/* decompress just one entry */
+	g_timer_reset(timer);
+	blob_tmp = fu_archive_lookup_by_fn(archive2, "file07.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_tmp);
+	elapsed_first = g_timer_elapsed(timer, NULL);
+	g_assert_cmpint(g_bytes_get_size(blob_tmp), ==, entry_sz);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(blob_tmp, NULL))[0x2000], ==, 7 + 2);
+	g_debug("index=%.2fms first=%.2fms peak-rss-increase=%" G_GUINT64_FORMAT "kB",
+		elapsed_index * 1000.f,
+		elapsed_first * 1000.f,
+		fu_self_test_get_peak_rss() - peak_rss);
+
+	/* not decompressed again */
+	blob_again = fu_archive_lookup_by_fn(archive2, "file07.bin", &error);
+	g_assert_no_error(error);
+	g_assert_true(blob_again == blob_tmp);
+
+	/* the caller uses the stream between lookups */
+	ret = g_seekable_seek(G_SEEKABLE(stream), 0x0, G_SEEK_SET, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(g_input_stream_read(stream, buf_tmp, sizeof(buf_tmp), NULL, &error),
+			==,
+			sizeof(buf_tmp));
+	g_assert_no_error(error);
+
+	/* as a stream, moving forward from the last entry */
+	stream_tmp = fu_archive_lookup_stream_by_fn(archive2, "file15.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_tmp);
+	g_assert_true(G_IS_SEEKABLE(stream_tmp));
+	g_assert_cmpint(g_input_stream_read(stream_tmp, buf_tmp, sizeof(buf_tmp), NULL, &error),
+			==,
+			sizeof(buf_tmp));
+	g_assert_no_error(error);
+	g_assert_cmpint(buf_tmp[0], ==, 15);
+
+	/* going backwards starts again from the beginning */
+	blob_earlier = fu_archive_lookup_by_fn(archive2, "file03.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_earlier);
+	g_assert_cmpint(((const guint8 *)g_bytes_get_data(blob_earlier, NULL))[0x2000], ==, 3 + 2);
+
+	/* in archive order, one at a time */
+	ret = fu_archive_iterate(archive2, fu_archive_lazy_iterate_cb, str, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(g_str_has_prefix(str->str, "file00.bin:1048576,file01.bin:1048576,"));
+	g_assert_true(g_str_has_suffix(str->str, "file15.bin:1048576,"));
+}
+
 static void
 fu_volume_gpt_type_func(void)
 {
@@ -3531,6 +3671,56 @@ fu_common_version_func(void)
 	}
 }
 
+static gchar *
+fu_version_key_random_string(GRand *rand)
+{
+	const gchar chars[] = "0123456789.~-abx ";
+	GString *str;
+
+	/* sometimes use NULL */
+	if (g_rand_int_range(rand, 0, 50) == 0)
+		return NULL;
+	str = g_string_new(NULL);
+	if (g_rand_int_range(rand, 0, 5) == 0)
+		g_string_append(str, "0x");
+	for (gint i = g_rand_int_range(rand, 0, 12); i > 0; i--)
+		g_string_append_c(str, chars[g_rand_int_range(rand, 0, (gint32)sizeof(chars) - 1)]);
+	return g_string_free(str, FALSE);
+}
+
+static void
+fu_version_key_func(void)
+{
+	FwupdVersionFormat fmts[] = {FWUPD_VERSION_FORMAT_UNKNOWN,
+				     FWUPD_VERSION_FORMAT_PLAIN,
+				     FWUPD_VERSION_FORMAT_NUMBER,
+				     FWUPD_VERSION_FORMAT_TRIPLET,
+				     FWUPD_VERSION_FORMAT_QUAD,
+				     FWUPD_VERSION_FORMAT_HEX};
+	g_autoptr(GRand) rand = g_rand_new_with_seed(0x4655);
+
+	/* must sort exactly the same as the string comparison */
+	for (guint i = 0; i < 100000; i++) {
+		gint32 idx = g_rand_int_range(rand, 0, (gint32)G_N_ELEMENTS(fmts));
+		FwupdVersionFormat fmt = fmts[idx];
+		g_autofree gchar *version_a = fu_version_key_random_string(rand);
+		g_autofree gchar *version_b = fu_version_key_random_string(rand);
+		g_autoptr(FuVersionKey) key_a = fu_version_key_new(version_a, fmt);
+		g_autoptr(FuVersionKey) key_b = fu_version_key_new(version_b, fmt);
+		gint rc_str = fu_version_compare(version_a, version_b, fmt);
+		gint rc_key = fu_version_key_compare(key_a, key_b);
+
+		if (rc_str != rc_key) {
+			g_test_message("'%s' vs '%s' [%s]",
+				       version_a,
+				       version_b,
+				       fwupd_version_format_to_string(fmt));
+		}
+		g_assert_cmpint(rc_str, ==, rc_key);
+		g_assert_cmpstr(fu_version_key_get_version(key_a), ==, version_a);
+	}
+}
+
 static void
 fu_common_vercmp_func(void)
 {
@@ -4181,6 +4371,65 @@ fu_firmware_new_from_gtypes_func(void)
 	g_assert_null(firmware3);
 }
 
+static void
+fu_firmware_detect_func(void)
+{
+	gboolean ret;
+	FuFirmwareDetectKind kind = FU_FIRMWARE_DETECT_KIND_UNKNOWN;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuFirmware) firmware = fu_dfu_firmware_new();
+	g_autoptr(FuFirmware) firmware_dfu = fu_dfu_firmware_new();
+	g_autoptr(FuFirmware) firmware_srec = fu_srec_firmware_new();
+	g_autoptr(FuFirmware) firmware_uswid = fu_uswid_firmware_new();
+	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "dfu.builder.xml", NULL);
+	ret = fu_firmware_build_from_filename(firmware, filename, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fw = fu_firmware_write(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(fw);
+	stream = g_memory_input_stream_new_from_bytes(fw);
+
+	/* header matches */
+	ret = fu_firmware_detect(firmware_dfu,
+				 stream,
+				 0x0,
+				 FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				 &kind,
+				 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(kind, ==, FU_FIRMWARE_DETECT_KIND_VALIDATE);
+
+	/* nothing to check without parsing */
+	ret = fu_firmware_detect(firmware_srec,
+				 stream,
+				 0x0,
+				 FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+				 &kind,
+				 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(kind, ==, FU_FIRMWARE_DETECT_KIND_UNKNOWN);
+
+	/* magic not found */
+	ret = fu_firmware_detect(firmware_uswid,
+				 stream,
+				 0x0,
+				 FU_FIRMWARE_PARSE_FLAG_NONE,
+				 &kind,
+				 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+
+	/* not parsed */
+	g_assert_false(fu_firmware_has_flag(firmware_dfu, FU_FIRMWARE_FLAG_DONE_PARSE));
+}
+
 static void
 fu_firmware_csv_func(void)
 {
@@ -4577,6 +4826,77 @@ fu_hid_descriptor_func(void)
 	g_assert_null(report3);
 }
 
+static void
+fu_hid_descriptor_parse_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *xml = NULL;
+	g_autoptr(FuFirmware) firmware1 = fu_hid_descriptor_new();
+	g_autoptr(FuFirmware) firmware2 = fu_hid_descriptor_new();
+	g_autoptr(FuFirmware) firmware3 = fu_hid_descriptor_new();
+	g_autoptr(FuFirmware) item_id = NULL;
+	g_autoptr(FuHidReport) report1 = NULL;
+	g_autoptr(FuHidReport) report2 = NULL;
+	g_autoptr(FuHidReport) report3 = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "hid-descriptor.builder.xml", NULL);
+	ret = fu_firmware_build_from_filename(firmware1, filename, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fu_firmware_write(firmware1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* the second parse uses the cached table */
+	ret = fu_firmware_parse_bytes(firmware2, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_parse_bytes(firmware3, blob, 0x0, FU_FIRMWARE_PARSE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* indexed by usage */
+	report1 = fu_hid_descriptor_find_report(FU_HID_DESCRIPTOR(firmware2),
+						&error,
+						"usage",
+						0xC8,
+						NULL);
+	g_assert_no_error(error);
+	g_assert_nonnull(report1);
+	item_id = fu_firmware_get_image_by_id(FU_FIRMWARE(report1), "report-id", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(item_id);
+	g_assert_cmpint(fu_hid_report_item_get_value(FU_HID_REPORT_ITEM(item_id)), ==, 0xF1);
+
+	/* indexed by report-id */
+	report2 = fu_hid_descriptor_find_report(FU_HID_DESCRIPTOR(firmware3),
+						&error,
+						"usage-page",
+						0xFF0B,
+						"report-id",
+						0xF1,
+						NULL);
+	g_assert_no_error(error);
+	g_assert_nonnull(report2);
+	report3 = fu_hid_descriptor_find_report(FU_HID_DESCRIPTOR(firmware3),
+						&error,
+						"usage-page",
+						0x1234,
+						"report-id",
+						0xF1,
+						NULL);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(report3);
+
+	/* the report images are created on demand */
+	xml = fu_firmware_export_to_xml(firmware2, FU_FIRMWARE_EXPORT_FLAG_NONE, NULL);
+	g_assert_nonnull(xml);
+	g_assert_nonnull(g_strstr_len(xml, -1, "FuHidReport"));
+}
+
 static void
 fu_firmware_func(void)
 {
@@ -5059,6 +5379,71 @@ fu_device_retry_hardware_func(void)
 	g_assert_cmpint(helper.cnt_failed, ==, 2);
 }
 
+static gboolean
+fu_device_poll_until_ready_cb(FuDevice *device, gboolean *ready, gpointer user_data, GError **error)
+{
+	guint *cnt = (guint *)user_data;
+	(*cnt)++;
+	*ready = *cnt >= 3;
+	return TRUE;
+}
+
+static gboolean
+fu_device_poll_until_never_cb(FuDevice *device, gboolean *ready, gpointer user_data, GError **error)
+{
+	guint *cnt = (guint *)user_data;
+	(*cnt)++;
+	return TRUE;
+}
+
+static void
+fu_device_poll_until_ready_func(void)
+{
+	gboolean ret;
+	guint cnt = 0;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(GError) error = NULL;
+
+	/* ready on the 3rd query, after sleeping for 1ms and then 2ms */
+	ret = fu_device_poll_until_ready(device,
+					 fu_device_poll_until_ready_cb,
+					 1,
+					 10,
+					 5000,
+					 &cnt,
+					 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(cnt, ==, 3);
+	g_assert_cmpint(fu_device_get_sleep_duration(device), >=, 3);
+
+	/* never ready */
+	ret = fu_device_poll_until_ready(device,
+					 fu_device_poll_until_never_cb,
+					 1,
+					 10,
+					 20,
+					 &cnt,
+					 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* emulated devices do not sleep, and only use the scheduled delays for the timeout */
+	cnt = 0;
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
+	ret = fu_device_poll_until_ready(device,
+					 fu_device_poll_until_never_cb,
+					 100,
+					 1000,
+					 60000,
+					 &cnt,
+					 &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_TIMED_OUT);
+	g_assert_false(ret);
+	g_assert_cmpint(cnt, ==, 64);
+}
+
 static void
 fu_bios_settings_load_func(void)
 {
@@ -6016,6 +6401,35 @@ fu_progress_finish_func(void)
 	fu_progress_step_done(progress);
 }
 
+static void
+fu_progress_trace_func(void)
+{
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	/* nothing recorded when disabled */
+	fu_trace_clear();
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 100, "disabled");
+	fu_progress_step_done(progress);
+	g_assert_cmpint(fu_trace_get_size(), ==, 0);
+
+	/* one event per step */
+	fu_trace_set_enabled(TRUE);
+	fu_progress_reset(progress);
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 100, "enabled");
+	fu_progress_step_done(progress);
+	fu_trace_set_enabled(FALSE);
+	g_assert_cmpint(fu_trace_get_size(), ==, 1);
+
+	/* exported as Chrome trace JSON */
+	str = fu_trace_to_string();
+	g_assert_nonnull(g_strstr_len(str, -1, "\"traceEvents\""));
+	g_assert_nonnull(g_strstr_len(str, -1, ":enabled\""));
+	g_assert_null(g_strstr_len(str, -1, ":disabled\""));
+	fu_trace_clear();
+	g_assert_cmpint(fu_trace_get_size(), ==, 0);
+}
+
 static void
 fu_progress_global_fraction_func(void)
 {
@@ -6137,6 +6551,38 @@ fu_partial_input_stream_simple_func(void)
 	g_assert_null(stream2);
 }
 
+static void
+fu_input_stream_memory_bytes_func(void)
+{
+	g_autoptr(GBytes) blob = g_bytes_new_static("12345678", 8);
+	g_autoptr(GBytes) blob_full = NULL;
+	g_autoptr(GBytes) blob_none = NULL;
+	g_autoptr(GBytes) blob_partial = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = fu_input_stream_from_bytes(blob);
+	g_autoptr(GInputStream) stream_plain = g_memory_input_stream_new_from_bytes(blob);
+	g_autoptr(GInputStream) stream_partial = NULL;
+
+	/* the same data, not a copy */
+	blob_full = fu_input_stream_get_memory_bytes(stream);
+	g_assert_nonnull(blob_full);
+	g_assert_true(g_bytes_get_data(blob_full, NULL) == g_bytes_get_data(blob, NULL));
+
+	/* slice of the same data */
+	stream_partial = fu_partial_input_stream_new(stream, 2, 4, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_partial);
+	blob_partial = fu_input_stream_get_memory_bytes(stream_partial);
+	g_assert_nonnull(blob_partial);
+	g_assert_cmpint(g_bytes_get_size(blob_partial), ==, 4);
+	g_assert_true(g_bytes_get_data(blob_partial, NULL) ==
+		      (const guint8 *)g_bytes_get_data(blob, NULL) + 2);
+
+	/* unknown */
+	blob_none = fu_input_stream_get_memory_bytes(stream_plain);
+	g_assert_null(blob_none);
+}
+
 static void
 fu_partial_input_stream_closed_base_func(void)
 {
@@ -6525,6 +6971,51 @@ fu_strsplit_stream_func(void)
 	g_assert_cmpint(cnt3, ==, 4);
 }
 
+static gboolean
+fu_strsplit_slices_cb(const gchar *token,
+		      gsize tokensz,
+		      guint token_idx,
+		      gpointer user_data,
+		      GError **error)
+{
+	GArray *sizes = (GArray *)user_data;
+	g_array_append_val(sizes, tokensz);
+	return TRUE;
+}
+
+static void
+fu_strsplit_slices_func(void)
+{
+	gboolean ret;
+	g_autoptr(GArray) sizes1 = g_array_new(FALSE, FALSE, sizeof(gsize));
+	g_autoptr(GArray) sizes2 = g_array_new(FALSE, FALSE, sizeof(gsize));
+	g_autoptr(GString) str = g_string_new(NULL);
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* in memory */
+	ret = fu_strsplit_slices("a123bb123", -1, "123", fu_strsplit_slices_cb, sizes1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(sizes1->len, ==, 3);
+	g_assert_cmpint(g_array_index(sizes1, gsize, 0), ==, 1);
+	g_assert_cmpint(g_array_index(sizes1, gsize, 1), ==, 2);
+	g_assert_cmpint(g_array_index(sizes1, gsize, 2), ==, 0);
+
+	/* delimiter straddles the chunk boundary */
+	for (guint i = 0; i < 0x8000 - 1; i++)
+		g_string_append_c(str, 'a');
+	g_string_append(str, "123bbb123c");
+	stream = G_INPUT_STREAM(g_memory_input_stream_new_from_data(str->str, str->len, NULL));
+	ret = fu_strsplit_stream_slices(stream, 0x0, "123", fu_strsplit_slices_cb, sizes2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(sizes2->len, ==, 3);
+	g_assert_cmpint(g_array_index(sizes2, gsize, 0), ==, 0x8000 - 1);
+	g_assert_cmpint(g_array_index(sizes2, gsize, 1), ==, 3);
+	g_assert_cmpint(g_array_index(sizes2, gsize, 2), ==, 1);
+}
+
 static void
 fu_input_stream_find_func(void)
 {
@@ -6569,6 +7060,130 @@ fu_input_stream_find_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_input_stream_find_any_func(void)
+{
+	const gchar *haystack = "I write free software. Firmware troublemaker, writing Firmware.";
+	const gchar *needles_str[] = {"Firmware", "ware", "soft", "XXX", NULL};
+	gboolean ret;
+	gsize offset = 0;
+	guint idx = 0;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) needles =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GPtrArray) needles2 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GPtrArray) needles3 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GPtrArray) needles4 =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+
+	for (guint i = 0; needles_str[i] != NULL; i++) {
+		GBytes *needle = g_bytes_new_static(needles_str[i], strlen(needles_str[i]));
+		g_ptr_array_add(needles, needle);
+	}
+	stream =
+	    g_memory_input_stream_new_from_data((const guint8 *)haystack, strlen(haystack), NULL);
+
+	/* "soft" is the first to start */
+	ret = fu_input_stream_find_any(stream, needles, 0x0, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 13);
+	g_assert_cmpint(idx, ==, 2);
+
+	/* "software" contains "ware" */
+	ret = fu_input_stream_find_any(stream, needles, 14, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 17);
+	g_assert_cmpint(idx, ==, 1);
+
+	/* both "Firmware" and "ware" end here, but "Firmware" starts first */
+	ret = fu_input_stream_find_any(stream, needles, 44, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 54);
+	g_assert_cmpint(idx, ==, 0);
+
+	/* "soft" ends first, but "free software" starts first */
+	g_ptr_array_add(needles3, g_bytes_new_static("soft", 4));
+	g_ptr_array_add(needles3, g_bytes_new_static("free software", 13));
+	ret = fu_input_stream_find_any(stream, needles3, 0x0, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 8);
+	g_assert_cmpint(idx, ==, 1);
+
+	/* both start at the same offset, so the first added wins even though it ends later */
+	g_ptr_array_add(needles4, g_bytes_new_static("Firmware trouble", 16));
+	g_ptr_array_add(needles4, g_bytes_new_static("Firmware", 8));
+	ret = fu_input_stream_find_any(stream, needles4, 14, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 23);
+	g_assert_cmpint(idx, ==, 0);
+
+	/* nothing */
+	g_ptr_array_add(needles2, g_bytes_new_static("XXX", 3));
+	ret = fu_input_stream_find_any(stream, needles2, 0x0, &offset, &idx, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false(ret);
+}
+
+static void
+fu_input_stream_find_any_performance_func(void)
+{
+	const gsize bufsz = 32 * 1024 * 1024;
+	const gchar *needles_str[] = {"__FMAP__", "$FLASH", "_FVH", "$USWID", "PFIT", NULL};
+	gboolean ret;
+	gsize offset = 0;
+	guint idx = 0;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) needles =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* a synthetic SPI image with the only match right at the end */
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7);
+	memcpy(buf + bufsz - 8, "PFIT", 4);
+	for (guint i = 0; needles_str[i] != NULL; i++) {
+		GBytes *needle = g_bytes_new_static(needles_str[i], strlen(needles_str[i]));
+		g_ptr_array_add(needles, needle);
+	}
+	stream = g_memory_input_stream_new_from_data(buf, bufsz, NULL);
+
+	/* one pass per needle */
+	for (guint i = 0; i < needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(needles, i);
+		g_autoptr(GError) error_local = NULL;
+		ret = fu_input_stream_find(stream,
+					   g_bytes_get_data(needle, NULL),
+					   g_bytes_get_size(needle),
+					   0x0,
+					   &offset,
+					   &error_local);
+		if (ret)
+			break;
+	}
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, bufsz - 8);
+	g_print("find=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* one pass for all needles */
+	g_timer_reset(timer);
+	ret = fu_input_stream_find_any(stream, needles, 0x0, &offset, &idx, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, bufsz - 8);
+	g_assert_cmpint(idx, ==, 4);
+	g_print("find-any=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f);
+}
+
 static void
 fu_input_stream_sum_overflow_func(void)
 {
@@ -6597,6 +7212,8 @@ fu_input_stream_chunkify_func(void)
 	g_autoptr(GBytes) blob = NULL;
 	g_autofree gchar *checksum = NULL;
 	g_autofree gchar *checksum2 = NULL;
+	g_autoptr(GPtrArray) csums =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_checksum_free);
 
 	for (guint i = 0; i < 0x80000; i++)
 		fu_byte_array_append_uint8(buf, i);
@@ -6614,6 +7231,16 @@ fu_input_stream_chunkify_func(void)
 	checksum2 = g_compute_checksum_for_bytes(G_CHECKSUM_SHA1, blob);
 	g_assert_cmpstr(checksum, ==, checksum2);
 
+	g_ptr_array_add(csums, g_checksum_new(G_CHECKSUM_SHA1));
+	g_ptr_array_add(csums, g_checksum_new(G_CHECKSUM_SHA256));
+	ret = fu_input_stream_compute_checksums(stream, csums, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(g_checksum_get_string(g_ptr_array_index(csums, 0)), ==, checksum2);
+	g_assert_cmpstr(g_checksum_get_string(g_ptr_array_index(csums, 1)),
+			==,
+			"33bc8aab40703678c3ebe94d2dd8f2afff285dd901f9234e841e4679f8204fd5");
+
 	ret = fu_input_stream_compute_crc16(stream, FU_CRC_KIND_B16_XMODEM, &crc16, &error);
 	g_assert_no_error(error);
 	g_assert_true(ret);
@@ -6919,6 +7546,107 @@ fu_cab_checksum_func(void)
 	}
 }
 
+static void
+fu_efi_filesystem_threaded_func(void)
+{
+	const gsize payloadsz = 1024 * 1024;
+	const guint files_cnt = 16;
+	gboolean ret;
+	gdouble elapsed_seq;
+	gdouble elapsed_thr;
+	g_autofree gchar *b64 = NULL;
+	g_autofree gchar *xml = NULL;
+	g_autofree gchar *xml_seq = NULL;
+	g_autofree gchar *xml_thr = NULL;
+	g_autoptr(FuFirmware) file = fu_efi_file_new();
+	g_autoptr(FuFirmware) filesystem_seq = fu_efi_filesystem_new();
+	g_autoptr(FuFirmware) filesystem_thr = fu_efi_filesystem_new();
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GByteArray) payload = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_file = NULL;
+	g_autoptr(GBytes) blob_lzma = NULL;
+	g_autoptr(GBytes) blob_payload = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) imgs = NULL;
+	g_autoptr(GRand) rand = g_rand_new_with_seed(0x1234);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* a RAW section of data that does not compress too well */
+	fu_byte_array_append_uint24(payload, 4 + payloadsz, G_LITTLE_ENDIAN);
+	fu_byte_array_append_uint8(payload, FU_EFI_SECTION_TYPE_RAW);
+	for (gsize i = 0; i < payloadsz; i++)
+		fu_byte_array_append_uint8(payload, g_rand_int_range(rand, 0, 16));
+	blob_payload = g_bytes_new(payload->data, payload->len);
+	blob_lzma = fu_lzma_compress_bytes(blob_payload, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_lzma);
+
+	/* a DXE driver with the LZMA compressed section */
+	b64 = g_base64_encode(g_bytes_get_data(blob_lzma, NULL), g_bytes_get_size(blob_lzma));
+	xml = g_strdup_printf("<firmware gtype=\"FuEfiFile\">\n"
+			      "  <id>ced4eac6-49f3-4c12-a597-fc8c33447691</id>\n"
+			      "  <type>0x07</type>\n"
+			      "  <firmware gtype=\"FuEfiSection\">\n"
+			      "    <type>0x02</type>\n"
+			      "    <id>%s</id>\n"
+			      "    <data>%s</data>\n"
+			      "  </firmware>\n"
+			      "</firmware>\n",
+			      FU_EFI_SECTION_GUID_LZMA_COMPRESS,
+			      b64);
+	ret = fu_firmware_build_from_xml(file, xml, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob_file = fu_firmware_write(file, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_file);
+
+	/* a multi-file filesystem */
+	for (guint i = 0; i < files_cnt; i++) {
+		fu_byte_array_append_bytes(buf, blob_file);
+		fu_byte_array_align_up(buf, FU_FIRMWARE_ALIGNMENT_8, 0xFF);
+	}
+	blob = g_bytes_new(buf->data, buf->len);
+
+	/* sequential */
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(filesystem_seq,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_NONE,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	elapsed_seq = g_timer_elapsed(timer, NULL);
+
+	/* threaded */
+	g_timer_reset(timer);
+	ret = fu_firmware_parse_bytes(filesystem_thr,
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_THREADED,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	elapsed_thr = g_timer_elapsed(timer, NULL);
+	g_print("sequential=%.0fms threaded=%.0fms speedup=%.1fx ",
+		elapsed_seq * 1000.f,
+		elapsed_thr * 1000.f,
+		elapsed_seq / elapsed_thr);
+
+	/* the same tree */
+	xml_seq = fu_firmware_export_to_xml(filesystem_seq, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_seq);
+	xml_thr = fu_firmware_export_to_xml(filesystem_thr, FU_FIRMWARE_EXPORT_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(xml_thr);
+	g_assert_cmpstr(xml_seq, ==, xml_thr);
+	imgs = fu_firmware_get_images(filesystem_thr);
+	g_assert_cmpint(imgs->len, ==, files_cnt);
+}
+
 static void
 fu_efi_lz77_decompressor_func(void)
 {
@@ -7390,10 +8118,20 @@ main(int argc, char **argv)
 
 	g_test_add_func("/fwupd/cab{checksum}", fu_cab_checksum_func);
 	g_test_add_func("/fwupd/efi-lz77{decompressor}", fu_efi_lz77_decompressor_func);
+	if (g_test_slow()) {
+		g_test_add_func("/fwupd/efi-filesystem{threaded}",
+				fu_efi_filesystem_threaded_func);
+	}
 	g_test_add_func("/fwupd/input-stream", fu_input_stream_func);
 	g_test_add_func("/fwupd/input-stream{sum-overflow}", fu_input_stream_sum_overflow_func);
 	g_test_add_func("/fwupd/input-stream{chunkify}", fu_input_stream_chunkify_func);
 	g_test_add_func("/fwupd/input-stream{find}", fu_input_stream_find_func);
+	g_test_add_func("/fwupd/input-stream{memory-bytes}", fu_input_stream_memory_bytes_func);
+	g_test_add_func("/fwupd/input-stream{find-any}", fu_input_stream_find_any_func);
+	if (g_test_slow()) {
+		g_test_add_func("/fwupd/input-stream{find-any-performance}",
+				fu_input_stream_find_any_performance_func);
+	}
 	g_test_add_func("/fwupd/partial-input-stream", fu_partial_input_stream_func);
 	g_test_add_func("/fwupd/partial-input-stream{closed-base}",
 			fu_partial_input_stream_closed_base_func);
@@ -7409,6 +8147,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/quirks{vendor-ids}", fu_quirks_vendor_ids_func);
 	g_test_add_func("/fwupd/string{password-mask}", fu_strpassmask_func);
 	g_test_add_func("/fwupd/string{strsplit-stream}", fu_strsplit_stream_func);
+	g_test_add_func("/fwupd/string{strsplit-slices}", fu_strsplit_slices_func);
 	g_test_add_func("/fwupd/lzma", fu_lzma_func);
 	g_test_add_func("/fwupd/common{strnsplit}", fu_strsplit_func);
 	g_test_add_func("/fwupd/common{olson-timezone-id}", fu_common_olson_timezone_id_func);
@@ -7422,6 +8161,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/progress{no-equal}", fu_progress_non_equal_steps_func);
 	g_test_add_func("/fwupd/progress{finish}", fu_progress_finish_func);
 	g_test_add_func("/fwupd/progress{global-fraction}", fu_progress_global_fraction_func);
+	g_test_add_func("/fwupd/progress{trace}", fu_progress_trace_func);
 	g_test_add_func("/fwupd/bios-attrs{load}", fu_bios_settings_load_func);
 	g_test_add_func("/fwupd/security-attrs{hsi}", fu_security_attrs_hsi_func);
 	g_test_add_func("/fwupd/security-attrs{compare}", fu_security_attrs_compare_func);
@@ -7460,6 +8200,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/common{strtoll}", fu_strtoll_func);
 	g_test_add_func("/fwupd/common{version}", fu_common_version_func);
 	g_test_add_func("/fwupd/common{version-semver}", fu_version_semver_func);
+	g_test_add_func("/fwupd/common{version-key}", fu_version_key_func);
 	g_test_add_func("/fwupd/common{vercmp}", fu_common_vercmp_func);
 	g_test_add_func("/fwupd/common{strstrip}", fu_strstrip_func);
 	g_test_add_func("/fwupd/common{endian}", fu_common_endian_func);
@@ -7498,6 +8239,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/kernel{config}", fu_kernel_config_func);
 	g_test_add_func("/fwupd/hid{descriptor}", fu_hid_descriptor_func);
 	g_test_add_func("/fwupd/hid{descriptor-container}", fu_hid_descriptor_container_func);
+	g_test_add_func("/fwupd/hid{descriptor-parse}", fu_hid_descriptor_parse_func);
 	g_test_add_func("/fwupd/firmware", fu_firmware_func);
 	g_test_add_func("/fwupd/firmware{common}", fu_firmware_common_func);
 	g_test_add_func("/fwupd/firmware{convert-version}", fu_firmware_convert_version_func);
@@ -7523,9 +8265,11 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/firmware{builder-round-trip}", fu_firmware_builder_round_trip_func);
 	g_test_add_func("/fwupd/firmware{fmap}", fu_firmware_fmap_func);
 	g_test_add_func("/fwupd/firmware{gtypes}", fu_firmware_new_from_gtypes_func);
+	g_test_add_func("/fwupd/firmware{detect}", fu_firmware_detect_func);
 	g_test_add_func("/fwupd/firmware{sorted}", fu_firmware_sorted_func);
 	g_test_add_func("/fwupd/archive{invalid}", fu_archive_invalid_func);
 	g_test_add_func("/fwupd/archive{cab}", fu_archive_cab_func);
+	g_test_add_func("/fwupd/archive{lazy}", fu_archive_lazy_func);
 	g_test_add_func("/fwupd/device", fu_device_func);
 	g_test_add_func("/fwupd/device{parent-name-prefix}", fu_device_parent_name_prefix_func);
 	g_test_add_func("/fwupd/device{id-for-display}", fu_device_id_display_func);
@@ -7562,6 +8306,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device{retry-success}", fu_device_retry_success_func);
 	g_test_add_func("/fwupd/device{retry-failed}", fu_device_retry_failed_func);
 	g_test_add_func("/fwupd/device{retry-hardware}", fu_device_retry_hardware_func);
+	g_test_add_func("/fwupd/device{poll-until-ready}", fu_device_poll_until_ready_func);
 	g_test_add_func("/fwupd/device{cfi-device}", fu_device_cfi_device_func);
 	g_test_add_func("/fwupd/device{progress}", fu_plugin_device_progress_func);
 	return g_test_run();
@@ -430,95 +430,167 @@ fu_strsplit_bytes(GBytes *blob, const gchar *delimiter, gint max_tokens)
 			   max_tokens);
 }
 
+/* returns the first @delimiter in @str, using memchr() to skip to candidates */
+static const gchar *
+fu_strsplit_find(const gchar *str, gsize strsz, const gchar *delimiter, gsize delimiter_sz)
+{
+	const gchar *end = str + strsz;
+	while ((gsize)(end - str) >= delimiter_sz) {
+		str = memchr(str, delimiter[0], (end - str) - delimiter_sz + 1);
+		if (str == NULL)
+			return NULL;
+		if (memcmp(str + 1, delimiter + 1, delimiter_sz - 1) == 0)
+			return str;
+		str++;
+	}
+	return NULL;
+}
+
 typedef struct {
-	FuStrsplitFunc callback;
+	FuStrsplitSliceFunc callback;
 	gpointer user_data;
 	guint token_idx;
 	const gchar *delimiter;
 	gsize delimiter_sz;
+	GByteArray *carry; /* the start of a token that continues in the next chunk */
 	gboolean detected_nul;
-	gboolean more_chunks;
 } FuStrsplitHelper;
 
 static gboolean
-fu_strsplit_buffer_drain(GByteArray *buf, FuStrsplitHelper *helper, GError **error)
+fu_strsplit_helper_emit(FuStrsplitHelper *helper, const gchar *token, gsize tokensz, GError **error)
 {
-	gsize buf_offset = 0;
-	while (buf_offset <= buf->len) {
-		gsize offset;
-		g_autoptr(GString) token = g_string_new(NULL);
-
-		/* find first match in buffer, starting at the buffer offset */
-		for (offset = buf_offset; offset < buf->len; offset++) {
-			if (buf->data[offset] == 0x0) {
-				helper->detected_nul = TRUE;
-				break;
-			}
-			if (strncmp((const gchar *)buf->data + offset,
-				    helper->delimiter,
-				    helper->delimiter_sz) == 0)
-				break;
-		}
+	/* sanity check is valid UTF-8 */
+	if (!g_utf8_validate_len(token, tokensz, NULL)) {
+		g_autofree gchar *str = fu_strsafe(token, tokensz);
+		g_debug("ignoring invalid UTF-8, got: %s", str);
+		return TRUE;
+	}
+	return helper->callback(token, tokensz, helper->token_idx++, helper->user_data, error);
+}
 
-		/* no token found, keep going */
-		if (helper->more_chunks && offset == buf->len)
-			break;
+/* a delimiter might start in the carry and end in the next chunk */
+static gsize
+fu_strsplit_helper_find_straddle(FuStrsplitHelper *helper, const gchar *buf, gsize bufsz)
+{
+	gsize carry_sz = helper->carry->len;
+	for (gsize i = helper->delimiter_sz - 1; i > 0; i--) {
+		gsize head = helper->delimiter_sz - i;
+		if (i > carry_sz || head > bufsz)
+			continue;
+		if (memcmp(helper->carry->data + carry_sz - i, helper->delimiter, i) == 0 &&
+		    memcmp(buf, helper->delimiter + i, head) == 0)
+			return i;
+	}
+	return 0;
+}
 
-		/* sanity check is valid UTF-8 */
-		g_string_append_len(token,
-				    (const gchar *)buf->data + buf_offset,
-				    offset - buf_offset);
-		if (!g_utf8_validate_len(token->str, token->len, NULL)) {
-			g_debug("ignoring invalid UTF-8, got: %s", token->str);
+static gboolean
+fu_strsplit_helper_drain(FuStrsplitHelper *helper,
+			 const gchar *buf,
+			 gsize bufsz,
+			 gboolean more_chunks,
+			 GError **error)
+{
+	const gchar *nul = memchr(buf, '\0', bufsz);
+	const gchar *end;
+
+	/* everything after a NUL is ignored */
+	if (nul != NULL) {
+		bufsz = nul - buf;
+		more_chunks = FALSE;
+		helper->detected_nul = TRUE;
+	}
+	end = buf + bufsz;
+
+	/* finish the token started in the previous chunk */
+	if (helper->carry->len > 0) {
+		const gchar *delim;
+		gsize straddle = fu_strsplit_helper_find_straddle(helper, buf, bufsz);
+		if (straddle > 0) {
+			if (!fu_strsplit_helper_emit(helper,
+						     (const gchar *)helper->carry->data,
+						     helper->carry->len - straddle,
+						     error))
+				return FALSE;
+			buf += helper->delimiter_sz - straddle;
 		} else {
-			if (!helper->callback(token, helper->token_idx++, helper->user_data, error))
+			delim =
+			    fu_strsplit_find(buf, bufsz, helper->delimiter, helper->delimiter_sz);
+			if (delim == NULL && more_chunks) {
+				g_byte_array_append(helper->carry, (const guint8 *)buf, bufsz);
+				return TRUE;
+			}
+			if (delim == NULL)
+				delim = end;
+			g_byte_array_append(helper->carry, (const guint8 *)buf, delim - buf);
+			if (!fu_strsplit_helper_emit(helper,
+						     (const gchar *)helper->carry->data,
+						     helper->carry->len,
+						     error))
 				return FALSE;
+			if (delim == end) {
+				g_byte_array_set_size(helper->carry, 0);
+				return TRUE;
+			}
+			buf = delim + helper->delimiter_sz;
 		}
-		if (helper->detected_nul) {
-			buf_offset = buf->len;
-			break;
+		g_byte_array_set_size(helper->carry, 0);
+	}
+
+	/* tokens are borrowed from the chunk where possible */
+	while (TRUE) {
+		const gchar *delim =
+		    fu_strsplit_find(buf, end - buf, helper->delimiter, helper->delimiter_sz);
+		if (delim == NULL) {
+			if (more_chunks) {
+				g_byte_array_append(helper->carry, (const guint8 *)buf, end - buf);
+				return TRUE;
+			}
+			return fu_strsplit_helper_emit(helper, buf, end - buf, error);
 		}
-		buf_offset = offset + helper->delimiter_sz;
+		if (!fu_strsplit_helper_emit(helper, buf, delim - buf, error))
+			return FALSE;
+		buf = delim + helper->delimiter_sz;
 	}
-	g_byte_array_remove_range(buf, 0, MIN(buf_offset, buf->len));
-	return TRUE;
 }
 
 /**
- * fu_strsplit_stream:
+ * fu_strsplit_stream_slices:
  * @stream: a #GInputStream to split
  * @offset: offset into @stream
  * @delimiter: a string which specifies the places at which to split the string
- * @callback: (scope call) (closure user_data): a #FuStrsplitFunc.
+ * @callback: (scope call) (closure user_data): a #FuStrsplitSliceFunc.
  * @user_data: user data
  * @error: (nullable): optional return location for an error
  *
- * Splits the string, calling the given function for each
- * of the tokens found. If any @callback returns %FALSE scanning is aborted.
+ * Splits the string, calling the given function for each of the tokens found. If any
+ * @callback returns %FALSE scanning is aborted.
  *
- * Use this function in preference to fu_strsplit() when the input file is untrusted,
- * and you don't want to allocate a GStrv with billions of one byte items.
+ * This is the same as fu_strsplit_stream(), but the tokens are not copied into a #GString.
+ * Instead @callback is given a token which is only valid for the duration of the callback and
+ * which is not NUL terminated. Tokens that are not valid UTF-8 are ignored.
  *
  * Returns: %TRUE if no @callback returned FALSE
  *
- * Since: 2.0.0
+ * Since: 2.1.1
  */
 gboolean
-fu_strsplit_stream(GInputStream *stream,
-		   gsize offset,
-		   const gchar *delimiter,
-		   FuStrsplitFunc callback,
-		   gpointer user_data,
-		   GError **error)
+fu_strsplit_stream_slices(GInputStream *stream,
+			  gsize offset,
+			  const gchar *delimiter,
+			  FuStrsplitSliceFunc callback,
+			  gpointer user_data,
+			  GError **error)
 {
 	g_autoptr(FuChunkArray) chunks = NULL;
-	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GByteArray) carry = g_byte_array_new();
 	g_autoptr(GInputStream) stream_partial = NULL;
 	FuStrsplitHelper helper = {
 	    .callback = callback,
 	    .user_data = user_data,
 	    .delimiter = delimiter,
 	    .token_idx = 0,
+	    .carry = carry,
 	};
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
@@ -547,9 +619,11 @@ fu_strsplit_stream(GInputStream *stream,
 		g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, i, error);
 		if (chk == NULL)
 			return FALSE;
-		g_byte_array_append(buf, fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk));
-		helper.more_chunks = i != fu_chunk_array_length(chunks) - 1;
-		if (!fu_strsplit_buffer_drain(buf, &helper, error))
+		if (!fu_strsplit_helper_drain(&helper,
+					      (const gchar *)fu_chunk_get_data(chk),
+					      fu_chunk_get_data_sz(chk),
+					      i != fu_chunk_array_length(chunks) - 1,
+					      error))
 			return FALSE;
 		if (helper.detected_nul)
 			break;
@@ -558,35 +632,34 @@ fu_strsplit_stream(GInputStream *stream,
 }
 
 /**
- * fu_strsplit_full:
+ * fu_strsplit_slices:
  * @str: a string to split
  * @sz: size of @str, or -1 for unknown
  * @delimiter: a string which specifies the places at which to split the string
- * @callback: (scope call) (closure user_data): a #FuStrsplitFunc.
+ * @callback: (scope call) (closure user_data): a #FuStrsplitSliceFunc.
  * @user_data: user data
  * @error: (nullable): optional return location for an error
  *
- * Splits the string, calling the given function for each
- * of the tokens found. If any @callback returns %FALSE scanning is aborted.
+ * Splits the string, calling the given function for each of the tokens found. If any
+ * @callback returns %FALSE scanning is aborted.
  *
- * Use this function in preference to fu_strsplit() when the input file is untrusted,
- * and you don't want to allocate a GStrv with billions of one byte items.
+ * This is the same as fu_strsplit_full(), but the tokens are not copied into a #GString.
+ * Instead @callback is given a pointer into @str which is not NUL terminated.
  *
  * Returns: %TRUE if no @callback returned FALSE
  *
- * Since: 1.8.2
+ * Since: 2.1.1
  */
 gboolean
-fu_strsplit_full(const gchar *str,
-		 gssize sz,
-		 const gchar *delimiter,
-		 FuStrsplitFunc callback,
-		 gpointer user_data,
-		 GError **error)
+fu_strsplit_slices(const gchar *str,
+		   gssize sz,
+		   const gchar *delimiter,
+		   FuStrsplitSliceFunc callback,
+		   gpointer user_data,
+		   GError **error)
 {
+	const gchar *end;
 	gsize delimiter_sz;
-	gsize offset_old = 0;
-	gsize str_sz;
 	guint token_idx = 0;
 
 	g_return_val_if_fail(str != NULL, FALSE);
@@ -595,32 +668,116 @@ fu_strsplit_full(const gchar *str,
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
 	/* make known */
-	str_sz = sz != -1 ? (gsize)sz : strlen(str);
+	end = str + (sz != -1 ? (gsize)sz : strlen(str));
 	delimiter_sz = strlen(delimiter);
 
-	/* cannot split */
-	if (delimiter_sz > str_sz) {
-		g_autoptr(GString) token = g_string_new(str);
-		return callback(token, token_idx, user_data, error);
-	}
-
 	/* start splittin' */
-	while (offset_old <= str_sz) {
-		gsize offset;
-		g_autoptr(GString) token = g_string_new(NULL);
-
-		for (offset = offset_old; offset < str_sz; offset++) {
-			if (strncmp(str + offset, delimiter, delimiter_sz) == 0)
-				break;
-		}
-		g_string_append_len(token, str + offset_old, offset - offset_old);
-		if (!callback(token, token_idx++, user_data, error))
+	while (TRUE) {
+		const gchar *delim = fu_strsplit_find(str, end - str, delimiter, delimiter_sz);
+		if (delim == NULL)
+			return callback(str, end - str, token_idx, user_data, error);
+		if (!callback(str, delim - str, token_idx++, user_data, error))
 			return FALSE;
-		offset_old = offset + delimiter_sz;
+		str = delim + delimiter_sz;
 	}
+}
 
-	/* success */
-	return TRUE;
+typedef struct {
+	FuStrsplitFunc callback;
+	gpointer user_data;
+	GString *token; /* reused for each token */
+} FuStrsplitCopyHelper;
+
+static gboolean
+fu_strsplit_copy_cb(const gchar *token,
+		    gsize tokensz,
+		    guint token_idx,
+		    gpointer user_data,
+		    GError **error)
+{
+	FuStrsplitCopyHelper *helper = (FuStrsplitCopyHelper *)user_data;
+	g_string_truncate(helper->token, 0);
+	g_string_append_len(helper->token, token, tokensz);
+	return helper->callback(helper->token, token_idx, helper->user_data, error);
+}
+
+/**
+ * fu_strsplit_stream:
+ * @stream: a #GInputStream to split
+ * @offset: offset into @stream
+ * @delimiter: a string which specifies the places at which to split the string
+ * @callback: (scope call) (closure user_data): a #FuStrsplitFunc.
+ * @user_data: user data
+ * @error: (nullable): optional return location for an error
+ *
+ * Splits the string, calling the given function for each
+ * of the tokens found. If any @callback returns %FALSE scanning is aborted.
+ *
+ * Use this function in preference to fu_strsplit() when the input file is untrusted,
+ * and you don't want to allocate a GStrv with billions of one byte items.
+ *
+ * Returns: %TRUE if no @callback returned FALSE
+ *
+ * Since: 2.0.0
+ */
+gboolean
+fu_strsplit_stream(GInputStream *stream,
+		   gsize offset,
+		   const gchar *delimiter,
+		   FuStrsplitFunc callback,
+		   gpointer user_data,
+		   GError **error)
+{
+	g_autoptr(GString) token = g_string_new(NULL);
+	FuStrsplitCopyHelper helper = {
+	    .callback = callback,
+	    .user_data = user_data,
+	    .token = token,
+	};
+	g_return_val_if_fail(callback != NULL, FALSE);
+	return fu_strsplit_stream_slices(stream,
+					 offset,
+					 delimiter,
+					 fu_strsplit_copy_cb,
+					 &helper,
+					 error);
+}
+
+/**
+ * fu_strsplit_full:
+ * @str: a string to split
+ * @sz: size of @str, or -1 for unknown
+ * @delimiter: a string which specifies the places at which to split the string
+ * @callback: (scope call) (closure user_data): a #FuStrsplitFunc.
+ * @user_data: user data
+ * @error: (nullable): optional return location for an error
+ *
+ * Splits the string, calling the given function for each
+ * of the tokens found. If any @callback returns %FALSE scanning is aborted.
+ *
+ * Use this function in preference to fu_strsplit() when the input file is untrusted,
+ * and you don't want to allocate a GStrv with billions of one byte items.
+ *
+ * Returns: %TRUE if no @callback returned FALSE
+ *
+ * Since: 1.8.2
+ */
+gboolean
+fu_strsplit_full(const gchar *str,
+		 gssize sz,
+		 const gchar *delimiter,
+		 FuStrsplitFunc callback,
+		 gpointer user_data,
+		 GError **error)
+{
+	g_autoptr(GString) token = g_string_new(NULL);
+	FuStrsplitCopyHelper helper = {
+	    .callback = callback,
+	    .user_data = user_data,
+	    .token = token,
+	};
+	g_return_val_if_fail(callback != NULL, FALSE);
+	return fu_strsplit_slices(str, sz, delimiter, fu_strsplit_copy_cb, &helper, error);
 }
 
 /**
@@ -81,6 +81,36 @@ fu_strsplit_stream(GInputStream *stream,
 		   gpointer user_data,
 		   GError **error) G_GNUC_NON_NULL(1, 3);
 
+/**
+ * FuStrsplitSliceFunc:
+ * @token: the start of the token, which is not NUL terminated
+ * @tokensz: the size of @token in bytes
+ * @token_idx: the token number
+ * @user_data: (closure): user data
+ * @error: a #GError or NULL
+ *
+ * The fu_strsplit_slices() iteration callback.
+ */
+typedef gboolean (*FuStrsplitSliceFunc)(const gchar *token,
+					gsize tokensz,
+					guint token_idx,
+					gpointer user_data,
+					GError **error);
+gboolean
+fu_strsplit_slices(const gchar *str,
+		   gssize sz,
+		   const gchar *delimiter,
+		   FuStrsplitSliceFunc callback,
+		   gpointer user_data,
+		   GError **error) G_GNUC_NON_NULL(1, 3);
+gboolean
+fu_strsplit_stream_slices(GInputStream *stream,
+			  gsize offset,
+			  const gchar *delimiter,
+			  FuStrsplitSliceFunc callback,
+			  gpointer user_data,
+			  GError **error) G_GNUC_NON_NULL(1, 3);
+
 /**
  * FuUtfConvertFlags:
  * @FU_UTF_CONVERT_FLAG_NONE:		No flags set
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuTrace"
+
+#include "config.h"
+
+#include <fwupd.h>
+#include <json-glib/json-glib.h>
+
+#include "fu-path.h"
+#include "fu-trace.h"
+
+/**
+ * FuTrace:
+ *
+ * A process-wide sink of timed events, exported in the Chrome trace event format so that it can
+ * be loaded into `chrome://tracing` or <https://ui.perfetto.dev/>.
+ *
+ * Tracing is disabled by default, and in that case fu_trace_begin() returns zero and
+ * fu_trace_end() does nothing.
+ */
+
+/* ~5MB of JSON, which is about a minute of a busy daemon */
+#define FU_TRACE_EVENTS_MAX 100000
+
+typedef struct {
+	const gchar *category; /* static */
+	gchar *name;
+	gint64 ts;
+	gint64 dur;
+	guint tid;
+} FuTraceEvent;
+
+static gint fu_trace_enabled = FALSE;
+static gint fu_trace_tid_last = 0;
+static guint fu_trace_dropped = 0;
+static GMutex fu_trace_mutex;
+static GArray *fu_trace_events = NULL; /* (element-type FuTraceEvent) */
+static GPrivate fu_trace_tid;
+
+static void
+fu_trace_event_clear(FuTraceEvent *event)
+{
+	g_free(event->name);
+}
+
+/* small sequential numbers are easier to read than pthread_t values */
+static guint
+fu_trace_get_tid(void)
+{
+	guint tid = GPOINTER_TO_UINT(g_private_get(&fu_trace_tid));
+	if (tid == 0) {
+		tid = (guint)g_atomic_int_add(&fu_trace_tid_last, 1) + 1;
+		g_private_set(&fu_trace_tid, GUINT_TO_POINTER(tid));
+	}
+	return tid;
+}
+
+/**
+ * fu_trace_get_enabled:
+ *
+ * Gets if tracing is enabled.
+ *
+ * Returns: %TRUE if events are being recorded
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_trace_get_enabled(void)
+{
+	return g_atomic_int_get(&fu_trace_enabled);
+}
+
+/**
+ * fu_trace_set_enabled:
+ * @enabled: boolean
+ *
+ * Enables or disables recording trace events. Existing events are not cleared.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_trace_set_enabled(gboolean enabled)
+{
+	g_atomic_int_set(&fu_trace_enabled, enabled);
+}
+
+/**
+ * fu_trace_clear:
+ *
+ * Removes all the recorded trace events.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_trace_clear(void)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&fu_trace_mutex);
+	if (fu_trace_events != NULL)
+		g_array_set_size(fu_trace_events, 0);
+	fu_trace_dropped = 0;
+}
+
+/**
+ * fu_trace_begin:
+ *
+ * Gets the start timestamp of a new trace event.
+ *
+ * Returns: a monotonic time in microseconds, or 0 if tracing is not enabled
+ *
+ * Since: 2.1.1
+ **/
+gint64
+fu_trace_begin(void)
+{
+	if (!fu_trace_get_enabled())
+		return 0;
+	return g_get_monotonic_time();
+}
+
+/**
+ * fu_trace_end:
+ * @category: a static string, e.g. `plugin`
+ * @begin: the value returned from fu_trace_begin()
+ * @fmt: the event name format string
+ * @...: the arguments for @fmt
+ *
+ * Records a complete trace event, using the calling thread and the current time.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_trace_end(const gchar *category, gint64 begin, const gchar *fmt, ...)
+{
+	FuTraceEvent event = {.category = category};
+	va_list args;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	/* not enabled when the event started */
+	if (begin == 0)
+		return;
+
+	event.tid = fu_trace_get_tid();
+	event.ts = begin;
+	event.dur = g_get_monotonic_time() - begin;
+	locker = g_mutex_locker_new(&fu_trace_mutex);
+	if (fu_trace_events == NULL) {
+		fu_trace_events = g_array_new(FALSE, FALSE, sizeof(FuTraceEvent));
+		g_array_set_clear_func(fu_trace_events, (GDestroyNotify)fu_trace_event_clear);
+	}
+	if (fu_trace_events->len >= FU_TRACE_EVENTS_MAX) {
+		fu_trace_dropped++;
+		return;
+	}
+	va_start(args, fmt);
+	event.name = g_strdup_vprintf(fmt, args);
+	va_end(args);
+	g_array_append_val(fu_trace_events, event);
+}
+
+/**
+ * fu_trace_get_size:
+ *
+ * Gets the number of recorded trace events.
+ *
+ * Returns: integer
+ *
+ * Since: 2.1.1
+ **/
+guint
+fu_trace_get_size(void)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&fu_trace_mutex);
+	return fu_trace_events != NULL ? fu_trace_events->len : 0;
+}
+
+/**
+ * fu_trace_to_string:
+ *
+ * Exports the recorded events as Chrome trace event JSON.
+ *
+ * Returns: (transfer full): a JSON string
+ *
+ * Since: 2.1.1
+ **/
+gchar *
+fu_trace_to_string(void)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&fu_trace_mutex);
+	g_autoptr(JsonBuilder) builder = json_builder_new();
+	g_autoptr(JsonGenerator) json_generator = json_generator_new();
+	g_autoptr(JsonNode) json_root = NULL;
+
+	json_builder_begin_object(builder);
+	json_builder_set_member_name(builder, "displayTimeUnit");
+	json_builder_add_string_value(builder, "ms");
+	json_builder_set_member_name(builder, "traceEvents");
+	json_builder_begin_array(builder);
+
+	/* so the viewer can show something better than a number */
+	json_builder_begin_object(builder);
+	json_builder_set_member_name(builder, "name");
+	json_builder_add_string_value(builder, "process_name");
+	json_builder_set_member_name(builder, "ph");
+	json_builder_add_string_value(builder, "M");
+	json_builder_set_member_name(builder, "pid");
+	json_builder_add_int_value(builder, 1);
+	json_builder_set_member_name(builder, "args");
+	json_builder_begin_object(builder);
+	json_builder_set_member_name(builder, "name");
+	json_builder_add_string_value(builder,
+				      g_get_prgname() != NULL ? g_get_prgname() : "fwupd");
+	json_builder_end_object(builder);
+	json_builder_end_object(builder);
+
+	for (guint i = 0; fu_trace_events != NULL && i < fu_trace_events->len; i++) {
+		FuTraceEvent *event = &g_array_index(fu_trace_events, FuTraceEvent, i);
+		json_builder_begin_object(builder);
+		json_builder_set_member_name(builder, "name");
+		json_builder_add_string_value(builder, event->name);
+		json_builder_set_member_name(builder, "cat");
+		json_builder_add_string_value(builder, event->category);
+		json_builder_set_member_name(builder, "ph");
+		json_builder_add_string_value(builder, "X");
+		json_builder_set_member_name(builder, "ts");
+		json_builder_add_int_value(builder, event->ts);
+		json_builder_set_member_name(builder, "dur");
+		json_builder_add_int_value(builder, event->dur);
+		json_builder_set_member_name(builder, "pid");
+		json_builder_add_int_value(builder, 1);
+		json_builder_set_member_name(builder, "tid");
+		json_builder_add_int_value(builder, event->tid);
+		json_builder_end_object(builder);
+	}
+	json_builder_end_array(builder);
+
+	/* the viewers ignore this, but it explains missing events */
+	json_builder_set_member_name(builder, "otherData");
+	json_builder_begin_object(builder);
+	json_builder_set_member_name(builder, "dropped");
+	json_builder_add_int_value(builder, fu_trace_dropped);
+	json_builder_end_object(builder);
+	json_builder_end_object(builder);
+
+	/* export as a string */
+	json_root = json_builder_get_root(builder);
+	json_generator_set_root(json_generator, json_root);
+	return json_generator_to_data(json_generator, NULL);
+}
+
+/**
+ * fu_trace_save:
+ * @filename: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Saves the recorded events as Chrome trace event JSON.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_trace_save(const gchar *filename, GError **error)
+{
+	g_autofree gchar *str = fu_trace_to_string();
+
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (!fu_path_mkdir_parent(filename, error))
+		return FALSE;
+	if (!g_file_set_contents(filename, str, -1, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
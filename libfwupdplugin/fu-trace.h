@@ -0,0 +1,28 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+gboolean
+fu_trace_get_enabled(void);
+void
+fu_trace_set_enabled(gboolean enabled);
+void
+fu_trace_clear(void);
+gint64
+fu_trace_begin(void);
+void
+fu_trace_end(const gchar *category, gint64 begin, const gchar *fmt, ...) G_GNUC_PRINTF(3, 4)
+    G_GNUC_NON_NULL(1, 3);
+guint
+fu_trace_get_size(void);
+gchar *
+fu_trace_to_string(void);
+gboolean
+fu_trace_save(const gchar *filename, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
@@ -1231,6 +1231,20 @@ fu_udev_device_ioctl(FuUdevDevice *self,
 					    "permission denied");
 			return FALSE;
 		}
+		if (errno == EINVAL) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_DATA,
+					    "invalid argument");
+			return FALSE;
+		}
+		if (errno == ENOMEM) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_BROKEN_SYSTEM,
+					    "out of memory");
+			return FALSE;
+		}
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INTERNAL,
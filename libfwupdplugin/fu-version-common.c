@@ -775,3 +775,204 @@ fu_version_compare(const gchar *version_a, const gchar *version_b, FwupdVersionF
 	}
 	return fu_version_compare_safe(version_a, version_b);
 }
+
+typedef struct {
+	gint64 value;
+	const gchar *suffix; /* never NULL, pointer into buf */
+} FuVersionKeySegment;
+
+struct FuVersionKey {
+	FwupdVersionFormat fmt;
+	gchar *version;	 /* (nullable): as supplied */
+	gchar *buf;	 /* (nullable): converted version, with each '.' replaced by NUL */
+	guint segments_len;
+	FuVersionKeySegment segments[];
+};
+
+/**
+ * fu_version_key_new:
+ * @version: (nullable): the semver release version, e.g. `1.2.3`
+ * @fmt: a version format, e.g. %FWUPD_VERSION_FORMAT_PLAIN
+ *
+ * Parses the version number into a form that can be compared many times using
+ * fu_version_key_compare() without splitting or allocating.
+ *
+ * The sort order is identical to fu_version_compare().
+ *
+ * Returns: (transfer full): a version key
+ *
+ * Since: 2.1.1
+ */
+FuVersionKey *
+fu_version_key_new(const gchar *version, FwupdVersionFormat fmt)
+{
+	FuVersionKey *self;
+	gsize version_sz = version != NULL ? strlen(version) + 1 : 0;
+	gsize buf_sz = 0;
+	guint segments_len = 0;
+	gchar *ptr;
+	g_autofree gchar *buf = NULL;
+
+	/* only HEX needs converting before it can be compared */
+	if (fmt == FWUPD_VERSION_FORMAT_HEX)
+		buf = fu_version_parse_from_format(version, fmt);
+	else if (fmt != FWUPD_VERSION_FORMAT_PLAIN)
+		buf = g_strdup(version);
+	if (buf != NULL) {
+		buf_sz = strlen(buf) + 1;
+		if (buf[0] != '\0') {
+			segments_len = 1;
+			for (gsize i = 0; buf[i] != '\0'; i++) {
+				if (buf[i] == '.')
+					segments_len++;
+			}
+		}
+	}
+
+	/* use one allocation for the header, segments and both strings */
+	self = g_malloc0(sizeof(FuVersionKey) + segments_len * sizeof(FuVersionKeySegment) +
+			 buf_sz + version_sz);
+	self->fmt = fmt;
+	self->segments_len = segments_len;
+	ptr = (gchar *)&self->segments[segments_len];
+	if (version != NULL) {
+		self->version = ptr;
+		memcpy(self->version, version, version_sz); /* nocheck:blocked */
+		ptr += version_sz;
+	}
+	if (buf != NULL) {
+		gchar *section;
+
+		self->buf = ptr;
+		memcpy(self->buf, buf, buf_sz); /* nocheck:blocked */
+		section = self->buf;
+		for (guint i = 0; i < segments_len; i++) {
+			gchar *endptr = NULL;
+			gchar *dot = strchr(section, '.');
+			if (dot != NULL)
+				*dot = '\0';
+			self->segments[i].value =
+			    g_ascii_strtoll(section, &endptr, 10); /* nocheck:blocked */
+			self->segments[i].suffix = endptr;
+			if (dot != NULL)
+				section = dot + 1;
+		}
+	}
+
+	/* success */
+	return self;
+}
+
+/**
+ * fu_version_key_free:
+ * @self: a version key
+ *
+ * Frees a version key.
+ *
+ * Since: 2.1.1
+ */
+void
+fu_version_key_free(FuVersionKey *self)
+{
+	g_free(self);
+}
+
+/**
+ * fu_version_key_get_version:
+ * @self: a version key
+ *
+ * Gets the version the key was created from.
+ *
+ * Returns: (nullable): the version, e.g. `1.2.3`
+ *
+ * Since: 2.1.1
+ */
+const gchar *
+fu_version_key_get_version(const FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	return self->version;
+}
+
+/**
+ * fu_version_key_get_format:
+ * @self: a version key
+ *
+ * Gets the version format the key was created with.
+ *
+ * Returns: a version format, e.g. %FWUPD_VERSION_FORMAT_PLAIN
+ *
+ * Since: 2.1.1
+ */
+FwupdVersionFormat
+fu_version_key_get_format(const FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, FWUPD_VERSION_FORMAT_UNKNOWN);
+	return self->fmt;
+}
+
+/**
+ * fu_version_key_compare:
+ * @key_a: a version key
+ * @key_b: a version key, created with the same format as @key_a
+ *
+ * Compares version keys for sorting, without allocating.
+ *
+ * Returns: -1 if a < b, +1 if a > b, 0 if they are equal, and %G_MAXINT on error
+ *
+ * Since: 2.1.1
+ */
+gint
+fu_version_key_compare(const FuVersionKey *key_a, const FuVersionKey *key_b)
+{
+	guint longest_split;
+
+	g_return_val_if_fail(key_a != NULL, G_MAXINT);
+	g_return_val_if_fail(key_b != NULL, G_MAXINT);
+	g_return_val_if_fail(key_a->fmt == key_b->fmt, G_MAXINT);
+
+	/* don't touch */
+	if (key_a->fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		return g_strcmp0(key_a->version, key_b->version);
+
+	/* sanity check */
+	if (key_a->buf == NULL || key_b->buf == NULL)
+		return G_MAXINT;
+
+	/* optimization */
+	if (g_strcmp0(key_a->version, key_b->version) == 0)
+		return 0;
+
+	/* same as fu_version_compare_safe(), but using the pre-parsed sections */
+	longest_split = MAX(key_a->segments_len, key_b->segments_len);
+	for (guint i = 0; i < longest_split; i++) {
+		const FuVersionKeySegment *seg_a;
+		const FuVersionKeySegment *seg_b;
+
+		/* we lost or gained a dot */
+		if (i >= key_a->segments_len)
+			return -1;
+		if (i >= key_b->segments_len)
+			return 1;
+
+		/* compare integers */
+		seg_a = &key_a->segments[i];
+		seg_b = &key_b->segments[i];
+		if (seg_a->value < seg_b->value)
+			return -1;
+		if (seg_a->value > seg_b->value)
+			return 1;
+
+		/* compare strings */
+		if (seg_a->suffix[0] != '\0' || seg_b->suffix[0] != '\0') {
+			gint rc = fu_version_compare_chunk(seg_a->suffix, seg_b->suffix);
+			if (rc < 0)
+				return -1;
+			if (rc > 0)
+				return 1;
+		}
+	}
+
+	/* we really shouldn't get here */
+	return 0;
+}
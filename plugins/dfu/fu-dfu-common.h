@@ -32,6 +32,7 @@
 #define FU_DFU_DEVICE_FLAG_GD32			  "gd32"
 #define FU_DFU_DEVICE_FLAG_ALLOW_ZERO_POLLTIMEOUT "allow-zero-polltimeout"
 #define FU_DFU_DEVICE_FLAG_INDEX_FORCE_DETACH	  "index-force-detach"
+#define FU_DFU_DEVICE_FLAG_SKIP_UNCHANGED	  "skip-unchanged"
 
 GBytes *
 fu_dfu_utils_bytes_join_array(GPtrArray *chunks);
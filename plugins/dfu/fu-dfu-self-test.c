@@ -12,6 +12,7 @@
 #include "fu-dfu-device.h"
 #include "fu-dfu-sector.h"
 #include "fu-dfu-target-private.h"
+#include "fu-dfu-target-stm.h"
 
 static gboolean
 fu_test_compare_lines(const gchar *txt1, const gchar *txt2, GError **error)
@@ -141,6 +142,44 @@ fu_dfu_target_dfuse_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_dfu_target_stm_shared_sectors_func(void)
+{
+	FuDfuSector *sector;
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuDfuDevice) device = g_object_new(FU_TYPE_DFU_DEVICE, "context", ctx, NULL);
+	g_autoptr(FuDfuTarget) target = fu_dfu_target_stm_new();
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) sectors_unchanged = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_autoptr(GPtrArray) sectors_array = g_ptr_array_new();
+
+	fu_device_set_proxy(FU_DEVICE(target), FU_DEVICE(device));
+	ret = fu_dfu_target_parse_sectors(target, "@Flash /0x08000000/4*001Kg", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* 0x600 byte chunks, so #0 spans sectors 0+1 and #1 spans sectors 1+2 */
+	blob = g_bytes_new_take(g_malloc0(0x1000), 0x1000);
+	chunks = fu_chunk_array_new_from_bytes(blob, 0x08000000, FU_CHUNK_PAGESZ_NONE, 0x600);
+	g_assert_cmpint(fu_chunk_array_length(chunks), ==, 3);
+
+	/* only sector 2 changed */
+	g_hash_table_add(sectors_unchanged, fu_dfu_target_get_sector_for_addr(target, 0x08000000));
+	g_hash_table_add(sectors_unchanged, fu_dfu_target_get_sector_for_addr(target, 0x08000400));
+	g_ptr_array_add(sectors_array, fu_dfu_target_get_sector_for_addr(target, 0x08000800));
+	g_hash_table_add(sectors_unchanged, fu_dfu_target_get_sector_for_addr(target, 0x08000c00));
+
+	/* sector 1 is written by chunk #1, which then makes chunk #0 write sector 0 */
+	fu_dfu_target_stm_erase_shared_sectors(target, chunks, sectors_array, sectors_unchanged);
+	g_assert_cmpint(sectors_array->len, ==, 3);
+	g_assert_cmpint(g_hash_table_size(sectors_unchanged), ==, 1);
+	sector = fu_dfu_target_get_sector_for_addr(target, 0x08000c00);
+	g_assert_true(g_hash_table_contains(sectors_unchanged, sector));
+}
+
 int
 main(int argc, char **argv)
 {
@@ -159,5 +198,6 @@ main(int argc, char **argv)
 
 	/* tests go here */
 	g_test_add_func("/dfu/target{DfuSe}", fu_dfu_target_dfuse_func);
+	g_test_add_func("/dfu/target-stm{shared-sectors}", fu_dfu_target_stm_shared_sectors_func);
 	return g_test_run();
 }
@@ -180,8 +180,8 @@ fu_dfu_target_stm_upload_element(FuDfuTarget *target,
 		if (chunk_size < fu_dfu_device_get_transfer_size(proxy))
 			break;
 
-		/* more data than we needed */
-		if (maximum_size > 0 && total_size > maximum_size)
+		/* all the data we needed */
+		if (maximum_size > 0 && total_size >= maximum_size)
 			break;
 	}
 	fu_progress_step_done(progress);
@@ -314,6 +314,152 @@ fu_dfu_target_stm_download_element1(FuDfuTarget *target,
 	return TRUE;
 }
 
+/* read back each sector, and remove the ones that already have the right contents */
+static gboolean
+fu_dfu_target_stm_download_element_verify(FuDfuTarget *target,
+					  GBytes *bytes,
+					  guint32 address,
+					  GPtrArray *sectors_array,
+					  GHashTable *sectors_unchanged,
+					  FuProgress *progress,
+					  GError **error)
+{
+	g_autoptr(GPtrArray) sectors_tmp = g_ptr_array_copy(sectors_array, NULL, NULL);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, sectors_tmp->len);
+
+	g_ptr_array_set_size(sectors_array, 0);
+	for (guint i = 0; i < sectors_tmp->len; i++) {
+		FuDfuSector *sector = g_ptr_array_index(sectors_tmp, i);
+		guint32 sector_addr = fu_dfu_sector_get_address(sector);
+		guint32 sector_end = sector_addr + fu_dfu_sector_get_size(sector);
+		guint32 image_end = address + g_bytes_get_size(bytes);
+		guint32 offset = MAX(sector_addr, address);
+		gsize size = MIN(sector_end, image_end) - offset;
+		g_autoptr(FuChunk) chk = NULL;
+		g_autoptr(GBytes) blob_dev = NULL;
+		g_autoptr(GBytes) blob_img = NULL;
+
+		/* not possible to compare, so just erase */
+		if (!fu_dfu_sector_has_cap(sector, FU_DFU_SECTOR_CAP_READABLE)) {
+			g_ptr_array_add(sectors_array, sector);
+			fu_progress_step_done(progress);
+			continue;
+		}
+
+		/* only the part of the sector covered by the image has to match */
+		blob_img = fu_bytes_new_offset(bytes, offset - address, size, error);
+		if (blob_img == NULL)
+			return FALSE;
+		chk = fu_dfu_target_stm_upload_element(target,
+						       offset,
+						       size,
+						       size,
+						       fu_progress_get_child(progress),
+						       error);
+		if (chk == NULL) {
+			g_prefix_error(error, "failed to read sector 0x%04x: ", sector_addr);
+			return FALSE;
+		}
+		blob_dev = fu_chunk_get_bytes(chk);
+		if (g_bytes_compare(blob_dev, blob_img) == 0) {
+			g_debug("sector 0x%04x-%04x is unchanged", sector_addr, sector_end);
+			g_hash_table_add(sectors_unchanged, sector);
+		} else {
+			g_ptr_array_add(sectors_array, sector);
+		}
+		fu_progress_step_done(progress);
+	}
+
+	/* success */
+	g_debug("skipping %u of %u sectors",
+		sectors_tmp->len - sectors_array->len,
+		sectors_tmp->len);
+	return TRUE;
+}
+
+/* the chunk can be skipped only if every sector it touches is already correct */
+static gboolean
+fu_dfu_target_stm_chunk_is_unchanged(FuDfuTarget *target,
+				     FuChunk *chk,
+				     GHashTable *sectors_unchanged)
+{
+	guint32 offset = fu_chunk_get_address(chk);
+	guint32 offset_end = offset + fu_chunk_get_data_sz(chk);
+
+	if (g_hash_table_size(sectors_unchanged) == 0)
+		return FALSE;
+	while (offset < offset_end) {
+		FuDfuSector *sector = fu_dfu_target_get_sector_for_addr(target, offset);
+		if (sector == NULL || fu_dfu_sector_get_size(sector) == 0 ||
+		    !g_hash_table_contains(sectors_unchanged, sector))
+			return FALSE;
+		offset = fu_dfu_sector_get_address(sector) + fu_dfu_sector_get_size(sector);
+	}
+	return TRUE;
+}
+
+/* returns TRUE if any sector touched by the chunk was moved back to the erase list */
+static gboolean
+fu_dfu_target_stm_erase_chunk_sectors(FuDfuTarget *target,
+				      FuChunk *chk,
+				      GPtrArray *sectors_array,
+				      GHashTable *sectors_unchanged)
+{
+	gboolean changed = FALSE;
+	guint32 offset = fu_chunk_get_address(chk);
+	guint32 offset_end = offset + fu_chunk_get_data_sz(chk);
+
+	while (offset < offset_end) {
+		FuDfuSector *sector = fu_dfu_target_get_sector_for_addr(target, offset);
+		if (sector == NULL || fu_dfu_sector_get_size(sector) == 0)
+			break;
+		if (g_hash_table_remove(sectors_unchanged, sector)) {
+			g_debug("sector 0x%04x shares a chunk with a changed sector",
+				fu_dfu_sector_get_address(sector));
+			g_ptr_array_add(sectors_array, sector);
+			changed = TRUE;
+		}
+		offset = fu_dfu_sector_get_address(sector) + fu_dfu_sector_get_size(sector);
+	}
+	return changed;
+}
+
+/* chunks are the transfer size and not sector aligned, so any unchanged sector sharing a chunk
+ * with a changed sector gets written too -- and so has to be erased first */
+void
+fu_dfu_target_stm_erase_shared_sectors(FuDfuTarget *target,
+				       FuChunkArray *chunks,
+				       GPtrArray *sectors_array,
+				       GHashTable *sectors_unchanged)
+{
+	gboolean changed = TRUE;
+
+	g_return_if_fail(FU_IS_DFU_TARGET(target));
+	g_return_if_fail(chunks != NULL);
+	g_return_if_fail(sectors_array != NULL);
+	g_return_if_fail(sectors_unchanged != NULL);
+
+	/* erasing a sector can make another chunk changed, so repeat until stable */
+	while (changed) {
+		changed = FALSE;
+		for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+			g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, i, NULL);
+			if (chk == NULL)
+				continue;
+			if (fu_dfu_target_stm_chunk_is_unchanged(target, chk, sectors_unchanged))
+				continue;
+			if (fu_dfu_target_stm_erase_chunk_sectors(target,
+								  chk,
+								  sectors_array,
+								  sectors_unchanged))
+				changed = TRUE;
+		}
+	}
+}
+
 static gboolean
 fu_dfu_target_stm_download_element2(FuDfuTarget *target,
 				    GPtrArray *sectors_array,
@@ -342,11 +488,12 @@ fu_dfu_target_stm_download_element2(FuDfuTarget *target,
 static gboolean
 fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 				    FuChunkArray *chunks,
-				    GPtrArray *sectors_array,
+				    GHashTable *sectors_unchanged,
 				    FuProgress *progress,
 				    GError **error)
 {
 	guint zone_last = G_MAXUINT;
+	guint idx_addr = 0;
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
@@ -362,6 +509,15 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 		if (chk_tmp == NULL)
 			return FALSE;
 
+		/* already correct, but the address pointer has to be set again after the gap */
+		if (fu_dfu_target_stm_chunk_is_unchanged(target, chk_tmp, sectors_unchanged)) {
+			g_debug("skipping unchanged chunk at 0x%04x",
+				(guint)fu_chunk_get_address(chk_tmp));
+			zone_last = G_MAXUINT;
+			fu_progress_step_done(progress);
+			continue;
+		}
+
 		/* for DfuSe devices we need to set the address manually */
 		sector = fu_dfu_target_get_sector_for_addr(target, fu_chunk_get_address(chk_tmp));
 		if (sector == NULL) {
@@ -383,6 +539,7 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 							   error))
 				return FALSE;
 			zone_last = fu_dfu_sector_get_zone(sector);
+			idx_addr = i;
 		}
 
 		/* we have to write one final zero-sized chunk for EOF */
@@ -391,10 +548,11 @@ fu_dfu_target_stm_download_element3(FuDfuTarget *target,
 			(guint)fu_chunk_get_address(chk_tmp),
 			g_bytes_get_size(bytes_tmp));
 
-		/* ST uses wBlockNum=0 for DfuSe commands and wBlockNum=1 is reserved */
+		/* ST uses wBlockNum=0 for DfuSe commands and wBlockNum=1 is reserved, and the
+		 * block number is an offset from the address pointer */
 		fu_byte_array_append_bytes(buf, bytes_tmp);
 		if (!fu_dfu_target_download_chunk(target,
-						  (i + 2),
+						  (i - idx_addr) + 2,
 						  buf,
 						  0, /* timeout default */
 						  fu_progress_get_child(progress),
@@ -423,20 +581,32 @@ fu_dfu_target_stm_download_element(FuDfuTarget *target,
 				   GError **error)
 {
 	FuDfuDevice *proxy;
+	gboolean skip_unchanged = FALSE;
 	g_autoptr(GBytes) bytes = NULL;
 	g_autoptr(FuChunkArray) chunks = NULL;
 	g_autoptr(GPtrArray) sectors_array = g_ptr_array_new();
+	g_autoptr(GHashTable) sectors_unchanged = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	/* reading back is only useful if the device supports it */
+	proxy = FU_DFU_DEVICE(fu_device_get_proxy(FU_DEVICE(target), error));
+	if (proxy == NULL)
+		return FALSE;
+	if (fu_device_has_private_flag(FU_DEVICE(proxy), FU_DFU_DEVICE_FLAG_SKIP_UNCHANGED)) {
+		if (fu_device_has_private_flag(FU_DEVICE(proxy), FU_DFU_DEVICE_FLAG_CAN_UPLOAD))
+			skip_unchanged = TRUE;
+		else
+			g_debug("cannot skip unchanged sectors as upload is not supported");
+	}
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 1, NULL);
+	if (skip_unchanged)
+		fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_READ, 20, "verify");
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_ERASE, 49, NULL);
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 50, NULL);
 
 	/* 1st pass: work out which sectors need erasing */
-	proxy = FU_DFU_DEVICE(fu_device_get_proxy(FU_DEVICE(target), error));
-	if (proxy == NULL)
-		return FALSE;
 	bytes = fu_chunk_get_bytes(chk);
 	chunks = fu_chunk_array_new_from_bytes(bytes,
 					       fu_chunk_get_address(chk),
@@ -450,6 +620,23 @@ fu_dfu_target_stm_download_element(FuDfuTarget *target,
 		return FALSE;
 	fu_progress_step_done(progress);
 
+	/* optionally drop the sectors that already have the right contents */
+	if (skip_unchanged) {
+		if (!fu_dfu_target_stm_download_element_verify(target,
+							       bytes,
+							       (guint32)fu_chunk_get_address(chk),
+							       sectors_array,
+							       sectors_unchanged,
+							       fu_progress_get_child(progress),
+							       error))
+			return FALSE;
+		fu_dfu_target_stm_erase_shared_sectors(target,
+						       chunks,
+						       sectors_array,
+						       sectors_unchanged);
+		fu_progress_step_done(progress);
+	}
+
 	/* 2nd pass: actually erase sectors */
 	if (!fu_dfu_target_stm_download_element2(target,
 						 sectors_array,
@@ -461,7 +648,7 @@ fu_dfu_target_stm_download_element(FuDfuTarget *target,
 	/* 3rd pass: write data */
 	if (!fu_dfu_target_stm_download_element3(target,
 						 chunks,
-						 sectors_array,
+						 sectors_unchanged,
 						 fu_progress_get_child(progress),
 						 error))
 		return FALSE;
@@ -17,3 +17,8 @@ struct _FuDfuTargetStmClass {
 
 FuDfuTarget *
 fu_dfu_target_stm_new(void);
+void
+fu_dfu_target_stm_erase_shared_sectors(FuDfuTarget *target,
+				       FuChunkArray *chunks,
+				       GPtrArray *sectors_array,
+				       GHashTable *sectors_unchanged);
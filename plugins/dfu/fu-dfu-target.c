@@ -454,23 +454,17 @@ fu_dfu_target_manifest_wait(FuDfuTarget *self, GError **error)
 	return TRUE;
 }
 
-gboolean
-fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
+/* the proxy status must have been refreshed just before calling this */
+static gboolean
+fu_dfu_target_check_status_refreshed(FuDfuTarget *self, FuDfuDevice *proxy, GError **error)
 {
-	FuDfuDevice *proxy;
 	FuDfuStatus status;
 	g_autoptr(GTimer) timer = g_timer_new();
 
-	/* get the status */
-	proxy = FU_DFU_DEVICE(fu_device_get_proxy(FU_DEVICE(self), error));
-	if (proxy == NULL)
-		return FALSE;
-	if (!fu_dfu_device_refresh(proxy, 0, error))
-		return FALSE;
-
-	/* wait for dfuDNBUSY to not be set */
+	/* wait for dfuDNBUSY to not be set, using the bwPollTimeout from the last GetStatus */
 	while (fu_dfu_device_get_state(proxy) == FU_DFU_STATE_DFU_DNBUSY) {
-		g_debug("waiting for FU_DFU_STATE_DFU_DNBUSY to clear");
+		g_debug("waiting %ums for FU_DFU_STATE_DFU_DNBUSY to clear",
+			fu_dfu_device_get_download_timeout(proxy));
 		fu_device_sleep(FU_DEVICE(proxy), fu_dfu_device_get_download_timeout(proxy));
 		if (!fu_dfu_device_refresh(proxy, 0, error))
 			return FALSE;
@@ -516,6 +510,20 @@ fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
 	return FALSE;
 }
 
+gboolean
+fu_dfu_target_check_status(FuDfuTarget *self, GError **error)
+{
+	FuDfuDevice *proxy;
+
+	/* get the status */
+	proxy = FU_DFU_DEVICE(fu_device_get_proxy(FU_DEVICE(self), error));
+	if (proxy == NULL)
+		return FALSE;
+	if (!fu_dfu_device_refresh(proxy, 0, error))
+		return FALSE;
+	return fu_dfu_target_check_status_refreshed(self, proxy, error);
+}
+
 /**
  * fu_dfu_target_use_alt_setting:
  * @self: a #FuDfuTarget
@@ -678,6 +686,7 @@ fu_dfu_target_download_chunk(FuDfuTarget *self,
 			     GError **error)
 {
 	FuDfuDevice *proxy;
+	guint refresh_timeout_ms = 0;
 	g_autoptr(GError) error_local = NULL;
 	gsize actual_length;
 
@@ -713,23 +722,26 @@ fu_dfu_target_download_chunk(FuDfuTarget *self,
 		return FALSE;
 	}
 
-	/* for STM32 devices, the action only occurs when we do GetStatus --
-	 * and it can take a long time to complete! */
-	if (fu_dfu_device_get_version(proxy) == FU_DFU_FIRMARE_VERSION_DFUSE) {
-		if (!fu_dfu_device_refresh(proxy, 35000, error))
-			return FALSE;
-	}
-
-	/* wait for the device to write contents to the EEPROM */
-	if (buf->len == 0 && fu_dfu_device_get_download_timeout(proxy) > 0)
-		fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_BUSY);
-	if (fu_dfu_device_get_download_timeout(proxy) > 0) {
+	/* the bwPollTimeout is bogus, so always wait for the device to write to the EEPROM */
+	if (fu_device_has_private_flag(FU_DEVICE(proxy), FU_DFU_DEVICE_FLAG_IGNORE_POLLTIMEOUT) &&
+	    fu_dfu_device_get_download_timeout(proxy) > 0) {
+		if (buf->len == 0)
+			fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_BUSY);
 		g_debug("sleeping for %ums…", fu_dfu_device_get_download_timeout(proxy));
 		fu_device_sleep(FU_DEVICE(proxy), fu_dfu_device_get_download_timeout(proxy));
 	}
 
-	/* find out if the write was successful, waiting for BUSY to clear */
-	if (!fu_dfu_target_check_status(self, error)) {
+	/* for STM32 devices, the action only occurs when we do GetStatus --
+	 * and it can take a long time to complete! */
+	if (fu_dfu_device_get_version(proxy) == FU_DFU_FIRMARE_VERSION_DFUSE)
+		refresh_timeout_ms = 35000;
+	if (!fu_dfu_device_refresh(proxy, refresh_timeout_ms, error))
+		return FALSE;
+	if (buf->len == 0 && fu_dfu_device_get_state(proxy) == FU_DFU_STATE_DFU_DNBUSY)
+		fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_BUSY);
+
+	/* find out if the write was successful, only sleeping if the device asks us to */
+	if (!fu_dfu_target_check_status_refreshed(self, proxy, error)) {
 		g_prefix_error_literal(error, "cannot wait for busy: ");
 		return FALSE;
 	}
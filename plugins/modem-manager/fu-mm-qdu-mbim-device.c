@@ -207,7 +207,7 @@ fu_mm_qdu_mbim_device_write_firmware(FuDevice *device,
 	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
 	g_autoptr(XbSilo) silo = NULL;
 
-	/* decompress entire archive ahead of time */
+	/* only the headers are read here */
 	stream = fu_firmware_get_stream(firmware, error);
 	if (stream == NULL)
 		return FALSE;
@@ -44,6 +44,7 @@ fu_mtd_plugin_constructed(GObject *obj)
 	fu_context_add_quirk_key(ctx, "MtdFmapRegions");
 	fu_context_add_quirk_key(ctx, "MtdFmapOffset");
 	fu_plugin_add_device_udev_subsystem(plugin, "mtd");
+	fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP);
 	fu_plugin_set_device_gtype_default(plugin, FU_TYPE_MTD_DEVICE);
 	fu_plugin_add_device_gtype(plugin, FU_TYPE_MTD_IFD_DEVICE); /* coverage */
 }
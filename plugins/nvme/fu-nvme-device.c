@@ -16,6 +16,7 @@ struct _FuNvmeDevice {
 	FuPciDevice parent_instance;
 	guint pci_depth;
 	guint64 write_block_size;
+	guint64 transfer_size_max;
 	guint serial_suffix;
 };
 
@@ -35,12 +36,17 @@ G_DEFINE_TYPE(FuNvmeDevice, fu_nvme_device, FU_TYPE_PCI_DEVICE)
 
 #define FU_NVME_DEVICE_IOCTL_TIMEOUT 5000 /* ms */
 
+/* used when MDTS is unlimited, and small enough for the kernel to map in one request */
+#define FU_NVME_DEVICE_TRANSFER_SIZE_MAX 0x40000
+
 static void
 fu_nvme_device_to_string(FuDevice *device, guint idt, GString *str)
 {
 	FuNvmeDevice *self = FU_NVME_DEVICE(device);
 	fwupd_codec_string_append_int(str, idt, "PciDepth", self->pci_depth);
 	fwupd_codec_string_append_int(str, idt, "SerialSuffix", self->serial_suffix);
+	fwupd_codec_string_append_hex(str, idt, "WriteBlockSize", self->write_block_size);
+	fwupd_codec_string_append_hex(str, idt, "TransferSizeMax", self->transfer_size_max);
 }
 
 /* @addr_start and @addr_end are *inclusive* to match the NMVe specification */
@@ -323,6 +329,7 @@ fu_nvme_device_parse_cns(FuNvmeDevice *self, const guint8 *buf, gsize bufsz, GEr
 	guint8 frmw;
 	guint8 fawr;
 	guint8 fwug;
+	guint8 mdts;
 	guint8 nfws;
 	guint8 s1ro;
 	const fwupd_guid_t *gu;
@@ -364,6 +371,14 @@ fu_nvme_device_parse_cns(FuNvmeDevice *self, const guint8 *buf, gsize bufsz, GEr
 	if (fwug != 0x00 && fwug != 0xff)
 		self->write_block_size = ((guint64)fwug) * 0x1000;
 
+	/* maximum data transfer size in units of CAP.MPSMIN, which we cannot read without
+	 * mapping the BAR -- but the kernel refuses controllers where that is not 4KiB */
+	mdts = fu_struct_nvme_id_ctrl_get_mdts(st);
+	if (mdts != 0 && mdts < 16) {
+		self->transfer_size_max =
+		    MIN((guint64)0x1000 << mdts, FU_NVME_DEVICE_TRANSFER_SIZE_MAX);
+	}
+
 	/* firmware slot information */
 	frmw = fu_struct_nvme_id_ctrl_get_frmw(st);
 	fawr = (frmw & 0x10) >> 4;
@@ -486,6 +501,96 @@ fu_nvme_device_setup(FuDevice *device, GError **error)
 	return TRUE;
 }
 
+static guint64
+fu_nvme_device_get_block_size(FuNvmeDevice *self)
+{
+	return self->write_block_size > 0 ? self->write_block_size : 0x1000;
+}
+
+/* the largest multiple of the update granularity the controller accepts in one command */
+guint64
+fu_nvme_device_get_transfer_size(FuNvmeDevice *self)
+{
+	guint64 block_size;
+
+	g_return_val_if_fail(FU_IS_NVME_DEVICE(self), 0);
+
+	block_size = fu_nvme_device_get_block_size(self);
+
+	/* these devices won't accept blocks of different sizes */
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_NVME_DEVICE_FLAG_FORCE_ALIGN))
+		return block_size;
+
+	/* preserve compat with older emulation files */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) &&
+	    !fu_device_check_fwupd_version(FU_DEVICE(self), "2.1.1"))
+		return block_size;
+
+	if (self->transfer_size_max <= block_size)
+		return block_size;
+	return self->transfer_size_max - (self->transfer_size_max % block_size);
+}
+
+/* the kernel returns EINVAL or ENOMEM when it cannot map a transfer that large */
+static gboolean
+fu_nvme_device_is_transfer_too_large(const GError *error)
+{
+	return g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA) ||
+	       g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_BROKEN_SYSTEM);
+}
+
+gboolean
+fu_nvme_device_write_blocks(FuNvmeDevice *self, GBytes *fw, FuProgress *progress, GError **error)
+{
+	gsize bufsz = 0;
+	gsize offset = 0;
+	guint64 block_size;
+	guint64 transfer_size;
+	const guint8 *buf;
+
+	g_return_val_if_fail(FU_IS_NVME_DEVICE(self), FALSE);
+	g_return_val_if_fail(fw != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	block_size = fu_nvme_device_get_block_size(self);
+	transfer_size = fu_nvme_device_get_transfer_size(self);
+	buf = g_bytes_get_data(fw, &bufsz);
+	while (offset < bufsz) {
+		gsize chunksz = MIN(transfer_size, bufsz - offset);
+		g_autoptr(GError) error_local = NULL;
+
+		if (!fu_nvme_device_fw_download(self,
+						offset,
+						buf + offset,
+						chunksz,
+						&error_local)) {
+			if (transfer_size <= block_size ||
+			    !fu_nvme_device_is_transfer_too_large(error_local)) {
+				g_propagate_prefixed_error(error,
+							   g_steal_pointer(&error_local),
+							   "failed to write 0x%x bytes at 0x%x: ",
+							   (guint)chunksz,
+							   (guint)offset);
+				return FALSE;
+			}
+
+			/* the kernel rejected a large transfer, so try smaller ones and remember
+			 * that for next time */
+			transfer_size = MAX(transfer_size / 2 / block_size, 1) * block_size;
+			g_debug("retrying with a transfer size of 0x%x: %s",
+				(guint)transfer_size,
+				error_local->message);
+			self->transfer_size_max = transfer_size;
+			continue;
+		}
+		offset += chunksz;
+		fu_progress_set_percentage_full(progress, offset, bufsz);
+	}
+
+	/* success */
+	return TRUE;
+}
+
 static gboolean
 fu_nvme_device_write_firmware(FuDevice *device,
 			      FuFirmware *firmware,
@@ -496,8 +601,7 @@ fu_nvme_device_write_firmware(FuDevice *device,
 	FuNvmeDevice *self = FU_NVME_DEVICE(device);
 	g_autoptr(GBytes) fw2 = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	g_autoptr(FuChunkArray) chunks = NULL;
-	guint64 block_size = self->write_block_size > 0 ? self->write_block_size : 0x1000;
+	guint64 block_size = fu_nvme_device_get_block_size(self);
 	guint8 commit_action = FU_NVME_COMMIT_ACTION_CA1;
 
 	/* progress */
@@ -519,29 +623,8 @@ fu_nvme_device_write_firmware(FuDevice *device,
 	}
 
 	/* write each block */
-	chunks = fu_chunk_array_new_from_bytes(fw2,
-					       FU_CHUNK_ADDR_OFFSET_NONE,
-					       FU_CHUNK_PAGESZ_NONE,
-					       block_size);
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autoptr(FuChunk) chk = NULL;
-
-		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
-			return FALSE;
-		if (!fu_nvme_device_fw_download(self,
-						fu_chunk_get_address(chk),
-						fu_chunk_get_data(chk),
-						fu_chunk_get_data_sz(chk),
-						error)) {
-			g_prefix_error(error, "failed to write chunk %u: ", i);
-			return FALSE;
-		}
-		fu_progress_set_percentage_full(fu_progress_get_child(progress),
-						(gsize)i + 1,
-						(gsize)fu_chunk_array_length(chunks));
-	}
+	if (!fu_nvme_device_write_blocks(self, fw2, fu_progress_get_child(progress), error))
+		return FALSE;
 	fu_progress_step_done(progress);
 
 	/* wait */
@@ -607,6 +690,7 @@ fu_nvme_device_set_progress(FuDevice *device, FuProgress *progress)
 static void
 fu_nvme_device_init(FuNvmeDevice *self)
 {
+	self->transfer_size_max = FU_NVME_DEVICE_TRANSFER_SIZE_MAX;
 	fu_device_add_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_REQUIRE_AC);
 	fu_device_add_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_UPDATABLE);
 	fu_device_add_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_MD_SET_SIGNED);
@@ -15,3 +15,7 @@ FuNvmeDevice *
 fu_nvme_device_new_from_blob(FuContext *ctx, const guint8 *buf, gsize sz, GError **error);
 gboolean
 fu_nvme_device_set_serial(FuNvmeDevice *self, const gchar *serial, GError **error);
+guint64
+fu_nvme_device_get_transfer_size(FuNvmeDevice *self);
+gboolean
+fu_nvme_device_write_blocks(FuNvmeDevice *self, GBytes *fw, FuProgress *progress, GError **error);
@@ -82,6 +82,101 @@ fu_nvme_cns_func(void)
 			"e1409b09-50cf-5aef-8ad8-760b9022f88d");
 }
 
+static void
+fu_nvme_transfer_size_func(void)
+{
+	guint8 buf[0x1000] = {0x0};
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuNvmeDevice) dev1 = NULL;
+	g_autoptr(FuNvmeDevice) dev2 = NULL;
+	g_autoptr(FuNvmeDevice) dev3 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* MDTS of 128KiB rounded down to a FWUG of 12KiB */
+	buf[77] = 5;  /* mdts */
+	buf[319] = 3; /* fwug */
+	dev1 = fu_nvme_device_new_from_blob(ctx, buf, sizeof(buf), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(dev1);
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev1), ==, 0x1E000);
+
+	/* no limit, so use the default */
+	buf[77] = 0;
+	buf[319] = 0;
+	dev2 = fu_nvme_device_new_from_blob(ctx, buf, sizeof(buf), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(dev2);
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev2), ==, 0x40000);
+
+	/* MDTS smaller than FWUG */
+	buf[77] = 1;
+	buf[319] = 4;
+	dev3 = fu_nvme_device_new_from_blob(ctx, buf, sizeof(buf), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(dev3);
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev3), ==, 0x4000);
+}
+
+static void
+fu_nvme_add_download_event(FuNvmeDevice *self, gsize bufsz, guint32 addr, FwupdError error_code)
+{
+	g_autofree gchar *id = g_strdup_printf("NvmeIoctl:Opcode=0x11,Cdw10=0x%02x,Cdw11=0x%02x",
+					       (guint)(bufsz >> 2) - 1,
+					       addr >> 2);
+	g_autoptr(FuDeviceEvent) event = fu_device_event_new(id);
+
+	if (error_code != FWUPD_ERROR_LAST) {
+		g_autoptr(GError) error = g_error_new_literal(FWUPD_ERROR, error_code, "failed");
+		fu_device_event_set_error(event, error);
+	} else {
+		fu_device_event_set_data(event, "DataOut", NULL, 0);
+	}
+	fu_device_add_event(FU_DEVICE(self), event);
+}
+
+static FuNvmeDevice *
+fu_nvme_device_new_emulated(FuContext *ctx)
+{
+	g_autoptr(FuNvmeDevice) self = g_object_new(FU_TYPE_NVME_DEVICE, "context", ctx, NULL);
+	fu_device_add_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED);
+	fu_device_set_fwupd_version(FU_DEVICE(self), "2.1.1");
+	return g_steal_pointer(&self);
+}
+
+static void
+fu_nvme_write_blocks_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuDeviceEvent) event_end = fu_device_event_new("NvmeIoctl:End");
+	g_autoptr(FuNvmeDevice) dev1 = fu_nvme_device_new_emulated(ctx);
+	g_autoptr(FuNvmeDevice) dev2 = fu_nvme_device_new_emulated(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) fw = g_bytes_new_take(g_malloc0(0x40000), 0x40000);
+	g_autoptr(GError) error = NULL;
+
+	/* there are only events for the expected downloads, so any other call fails */
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev1), ==, 0x40000);
+	fu_nvme_add_download_event(dev1, 0x40000, 0x0, FWUPD_ERROR_INVALID_DATA);
+	fu_nvme_add_download_event(dev1, 0x20000, 0x0, FWUPD_ERROR_LAST);
+	fu_nvme_add_download_event(dev1, 0x20000, 0x20000, FWUPD_ERROR_LAST);
+	fu_device_add_event(FU_DEVICE(dev1), event_end);
+
+	/* the kernel rejected the transfer, so retry with half the size */
+	ret = fu_nvme_device_write_blocks(dev1, fw, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev1), ==, 0x20000);
+
+	/* any other failure is not retried */
+	fu_nvme_add_download_event(dev2, 0x40000, 0x0, FWUPD_ERROR_INTERNAL);
+	fu_device_add_event(FU_DEVICE(dev2), event_end);
+	ret = fu_nvme_device_write_blocks(dev2, fw, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL);
+	g_assert_false(ret);
+	g_assert_cmpint(fu_nvme_device_get_transfer_size(dev2), ==, 0x40000);
+}
+
 static void
 fu_nvme_cns_all_func(void)
 {
@@ -138,5 +233,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/serial-suffix", fu_nvme_serial_suffix_func);
 	g_test_add_func("/fwupd/cns", fu_nvme_cns_func);
 	g_test_add_func("/fwupd/cns{all}", fu_nvme_cns_all_func);
+	g_test_add_func("/fwupd/transfer-size", fu_nvme_transfer_size_func);
+	g_test_add_func("/fwupd/write-blocks", fu_nvme_write_blocks_func);
 	return g_test_run();
 }
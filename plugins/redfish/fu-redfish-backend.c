@@ -17,6 +17,9 @@
 #include "fu-redfish-smbios.h"
 #include "fu-redfish-smc-device.h"
 
+/* BMCs are typically slow, but do not have much spare memory or CPU either */
+#define FU_REDFISH_BACKEND_REQUESTS_ACTIVE_MAX 4
+
 struct _FuRedfishBackend {
 	FuBackend parent_instance;
 	gchar *hostname;
@@ -34,6 +37,7 @@ struct _FuRedfishBackend {
 	gboolean wildcard_targets;
 	gint64 max_image_size; /* bytes */
 	gchar *system_id;
+	const gchar *expand_query; /* nullable */
 	GType device_gtype;
 	GHashTable *request_cache; /* str:GByteArray */
 	CURLSH *curlsh;
@@ -153,31 +157,58 @@ fu_redfish_backend_coldplug_collection(FuRedfishBackend *self,
 				       FwupdJsonObject *json_obj,
 				       GError **error)
 {
+	guint json_arr_members_sz;
 	g_autoptr(FwupdJsonArray) json_arr_members = NULL;
+	g_autoptr(GPtrArray) json_objs =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_json_object_unref);
+	g_autoptr(GPtrArray) member_uris = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) requests =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GTimer) timer = g_timer_new();
 
 	json_arr_members = fwupd_json_object_get_array(json_obj, "Members", error);
 	if (json_arr_members == NULL)
 		return FALSE;
-	for (guint i = 0; i < fwupd_json_array_get_size(json_arr_members); i++) {
+	json_arr_members_sz = fwupd_json_array_get_size(json_arr_members);
+	for (guint i = 0; i < json_arr_members_sz; i++) {
 		const gchar *member_uri;
-		g_autoptr(FuRedfishRequest) request = fu_redfish_backend_request_new(self);
 		g_autoptr(FwupdJsonObject) json_obj_member = NULL;
-		g_autoptr(FwupdJsonObject) json_obj_tmp = NULL;
 
 		json_obj_member = fwupd_json_array_get_object(json_arr_members, i, error);
 		if (json_obj_member == NULL)
 			return FALSE;
+
+		/* already included using $expand */
+		if (fwupd_json_object_has_node(json_obj_member, "@odata.type")) {
+			g_ptr_array_add(json_objs, g_steal_pointer(&json_obj_member));
+			continue;
+		}
 		member_uri = fwupd_json_object_get_string(json_obj_member, "@odata.id", error);
 		if (member_uri == NULL)
 			return FALSE;
+		g_ptr_array_add(member_uris, g_strdup(member_uri));
+		g_ptr_array_add(requests, fu_redfish_backend_request_new(self));
+	}
 
-		/* create the device for the member */
-		if (!fu_redfish_request_perform(request,
-						member_uri,
-						FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON,
-						error))
-			return FALSE;
-		json_obj_tmp = fu_redfish_request_get_json_object(request);
+	/* get the remaining members concurrently */
+	if (!fu_redfish_request_perform_multi(requests,
+					      member_uris,
+					      FU_REDFISH_BACKEND_REQUESTS_ACTIVE_MAX,
+					      FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON,
+					      error))
+		return FALSE;
+	for (guint i = 0; i < requests->len; i++) {
+		FuRedfishRequest *request = g_ptr_array_index(requests, i);
+		g_ptr_array_add(json_objs, fu_redfish_request_get_json_object(request));
+	}
+	g_debug("got %u members (%u requested) in %.0fms",
+		json_objs->len,
+		requests->len,
+		g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* create the device for each member */
+	for (guint i = 0; i < json_objs->len; i++) {
+		FwupdJsonObject *json_obj_tmp = g_ptr_array_index(json_objs, i);
 		if (!fu_redfish_backend_coldplug_member(self, json_obj_tmp, error))
 			return FALSE;
 	}
@@ -196,6 +227,14 @@ fu_redfish_backend_coldplug_inventory(FuRedfishBackend *self,
 	collection_uri = fwupd_json_object_get_string(json_inventory, "@odata.id", error);
 	if (collection_uri == NULL)
 		return FALSE;
+
+	/* include all the members in the same response if supported */
+	if (self->expand_query != NULL) {
+		(void)curl_url_set(fu_redfish_request_get_uri(request),
+				   CURLUPART_QUERY,
+				   self->expand_query,
+				   0);
+	}
 	if (!fu_redfish_request_perform(request,
 					collection_uri,
 					FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON,
@@ -490,6 +529,42 @@ fu_redfish_backend_setup_dell(FuRedfishBackend *self, GError **error)
 	return fu_redfish_backend_setup_dell_member(self, member_uri, error);
 }
 
+static void
+fu_redfish_backend_ensure_expand_query(FuRedfishBackend *self, FwupdJsonObject *json_obj)
+{
+	gboolean expand_all = FALSE;
+	gboolean no_links = FALSE;
+	g_autoptr(FwupdJsonObject) json_expand = NULL;
+	g_autoptr(FwupdJsonObject) json_features = NULL;
+
+	json_features = fwupd_json_object_get_object(json_obj, "ProtocolFeaturesSupported", NULL);
+	if (json_features == NULL)
+		return;
+	json_expand = fwupd_json_object_get_object(json_features, "ExpandQuery", NULL);
+	if (json_expand == NULL)
+		return;
+	if (!fwupd_json_object_get_boolean_with_default(json_expand,
+							"NoLinks",
+							&no_links,
+							FALSE,
+							NULL))
+		return;
+	if (!fwupd_json_object_get_boolean_with_default(json_expand,
+							"ExpandAll",
+							&expand_all,
+							FALSE,
+							NULL))
+		return;
+
+	/* prefer not to also expand the Links section */
+	if (no_links) {
+		self->expand_query = "$expand=.";
+		return;
+	}
+	if (expand_all)
+		self->expand_query = "$expand=*";
+}
+
 static gboolean
 fu_redfish_backend_setup(FuBackend *backend,
 			 FuBackendSetupFlags flags,
@@ -541,6 +616,7 @@ fu_redfish_backend_setup(FuBackend *backend,
 		if (!fu_redfish_backend_setup_dell(self, error))
 			return FALSE;
 	}
+	fu_redfish_backend_ensure_expand_query(self, json_obj);
 	json_update_service = fwupd_json_object_get_object(json_obj, "UpdateService", error);
 	if (json_update_service == NULL)
 		return FALSE;
@@ -637,6 +713,7 @@ fu_redfish_backend_to_string(FuBackend *backend, guint idt, GString *str)
 	fwupd_codec_string_append_bool(str, idt, "WildcardTargets", self->wildcard_targets);
 	fwupd_codec_string_append_hex(str, idt, "MaxImageSize", self->max_image_size);
 	fwupd_codec_string_append(str, idt, "SystemId", self->system_id);
+	fwupd_codec_string_append(str, idt, "ExpandQuery", self->expand_query);
 	fwupd_codec_string_append(str, idt, "DeviceGType", g_type_name(self->device_gtype));
 }
 
@@ -618,11 +618,17 @@ fu_redfish_device_get_backend(FuRedfishDevice *self, GError **error)
 	return priv->backend;
 }
 
+#define FU_REDFISH_DEVICE_POLL_DELAY_MIN       500   /* ms */
+#define FU_REDFISH_DEVICE_POLL_DELAY_MAX       10000 /* ms */
+#define FU_REDFISH_DEVICE_POLL_RETRY_AFTER_MAX 60    /* s */
+
 typedef struct {
 	gchar *location;
 	gboolean completed;
 	GHashTable *messages_seen;
 	FuProgress *progress;
+	guint delay;	/* ms */
+	gint64 pc_last; /* or -1 for unknown */
 } FuRedfishDevicePollCtx;
 
 gboolean
@@ -754,6 +760,18 @@ fu_redfish_device_poll_task_once(FuRedfishDevice *self, FuRedfishDevicePollCtx *
 	if (pc >= 0 && pc <= 100)
 		fu_progress_set_percentage(ctx->progress, (guint)pc);
 
+	/* poll faster while the task is making progress, and back off when it is not */
+	if (fu_redfish_request_get_retry_after(request) > 0) {
+		ctx->delay = MIN(fu_redfish_request_get_retry_after(request),
+				 FU_REDFISH_DEVICE_POLL_RETRY_AFTER_MAX) *
+			     1000;
+	} else if (pc > ctx->pc_last) {
+		ctx->delay = MAX(ctx->delay / 2, FU_REDFISH_DEVICE_POLL_DELAY_MIN);
+	} else {
+		ctx->delay = MIN(ctx->delay * 2, FU_REDFISH_DEVICE_POLL_DELAY_MAX);
+	}
+	ctx->pc_last = pc;
+
 	/* print all messages we've not seen yet */
 	json_msgs = fwupd_json_object_get_array(json_obj, "Messages", NULL);
 	if (json_msgs != NULL) {
@@ -824,6 +842,8 @@ fu_redfish_device_poll_ctx_new(FuProgress *progress, const gchar *location)
 	ctx->messages_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	ctx->location = g_strdup(location);
 	ctx->progress = g_object_ref(progress);
+	ctx->delay = 1000;
+	ctx->pc_last = -1;
 	return ctx;
 }
 
@@ -853,7 +873,7 @@ fu_redfish_device_poll_task(FuRedfishDevice *self,
 
 	/* sleep and then reprobe hardware */
 	do {
-		fu_device_sleep(FU_DEVICE(self), 1000); /* ms */
+		fu_device_sleep(FU_DEVICE(self), ctx->delay);
 		if (!fu_redfish_device_poll_task_once(self, ctx, error))
 			return FALSE;
 		if (ctx->completed) {
@@ -86,16 +86,21 @@ fu_redfish_multipart_device_write_firmware(FuDevice *device,
 	FuRedfishBackend *backend;
 	CURL *curl;
 	curl_mimepart *part;
-	const gchar *location;
+	const gchar *location = NULL;
 	g_autoptr(FwupdJsonObject) json_obj = NULL;
 	g_autoptr(curl_mime) mime = NULL;
 	g_autoptr(FuRedfishRequest) request = NULL;
-	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(GString) params = NULL;
 
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 20, "upload");
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_BUSY, 80, "apply");
+
 	/* get default image */
-	fw = fu_firmware_get_bytes(firmware, error);
-	if (fw == NULL)
+	stream = fu_firmware_get_stream(firmware, error);
+	if (stream == NULL)
 		return FALSE;
 
 	/* create the multipart request */
@@ -117,8 +122,8 @@ fu_redfish_multipart_device_write_firmware(FuDevice *device,
 	curl_mime_name(part, "UpdateFile");
 	(void)curl_mime_type(part, "application/octet-stream");
 	(void)curl_mime_filename(part, fu_firmware_get_filename(firmware));
-
-	(void)curl_mime_data(part, g_bytes_get_data(fw, NULL), g_bytes_get_size(fw));
+	if (!fu_redfish_request_mime_data_stream(request, part, stream, error))
+		return FALSE;
 
 	(void)curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
 	(void)curl_easy_setopt(curl,
@@ -126,7 +131,7 @@ fu_redfish_multipart_device_write_firmware(FuDevice *device,
 			       fu_redfish_multipart_device_location_headers_callback);
 	(void)curl_easy_setopt(fu_redfish_request_get_curl(request), CURLOPT_HEADERDATA, &location);
 
-	fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_WRITE);
+	fu_redfish_request_set_upload_progress(request, fu_progress_get_child(progress));
 	if (!fu_redfish_request_perform(request,
 					fu_redfish_backend_get_push_uri_path(backend),
 					FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON,
@@ -164,7 +169,18 @@ fu_redfish_multipart_device_write_firmware(FuDevice *device,
 		if (location == NULL)
 			return FALSE;
 	}
-	return fu_redfish_device_poll_task(FU_REDFISH_DEVICE(self), location, progress, error);
+	fu_progress_step_done(progress);
+
+	/* wait for the BMC to apply the update */
+	if (!fu_redfish_device_poll_task(FU_REDFISH_DEVICE(self),
+					 location,
+					 fu_progress_get_child(progress),
+					 error))
+		return FALSE;
+	fu_progress_step_done(progress);
+
+	/* success */
+	return TRUE;
 }
 
 static void
@@ -13,7 +13,12 @@ struct _FuRedfishRequest {
 	CURL *curl;
 	CURLU *uri;
 	GByteArray *buf;
+	gchar *path; /* nullable */
 	glong status_code;
+	guint retry_after;	     /* s */
+	GInputStream *upload_stream; /* nullable */
+	GError *upload_error;	     /* nullable */
+	FuProgress *upload_progress; /* nullable */
 	FwupdJsonParser *json_parser;
 	FwupdJsonObject *json_obj;
 	GHashTable *cache; /* nullable */
@@ -24,6 +29,9 @@ G_DEFINE_TYPE(FuRedfishRequest, fu_redfish_request, G_TYPE_OBJECT)
 typedef gchar curlptr;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(curlptr, curl_free)
 
+typedef CURLM _curlm;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(_curlm, curl_multi_cleanup)
+
 FwupdJsonObject *
 fu_redfish_request_get_json_object(FuRedfishRequest *self)
 {
@@ -52,6 +60,14 @@ fu_redfish_request_get_status_code(FuRedfishRequest *self)
 	return self->status_code;
 }
 
+/* in seconds, or 0 if the server did not specify a Retry-After header */
+guint
+fu_redfish_request_get_retry_after(FuRedfishRequest *self)
+{
+	g_return_val_if_fail(FU_IS_REDFISH_REQUEST(self), 0);
+	return self->retry_after;
+}
+
 static gboolean
 fu_redfish_request_load_json(FuRedfishRequest *self, GByteArray *buf, GError **error)
 {
@@ -124,42 +140,61 @@ fu_redfish_request_load_json(FuRedfishRequest *self, GByteArray *buf, GError **e
 	return TRUE;
 }
 
-gboolean
-fu_redfish_request_perform(FuRedfishRequest *self,
-			   const gchar *path,
-			   FuRedfishRequestPerformFlags flags,
-			   GError **error)
+/* returns %TRUE if the request was satisfied from the cache */
+static gboolean
+fu_redfish_request_load_cache(FuRedfishRequest *self,
+			      const gchar *path,
+			      FuRedfishRequestPerformFlags flags,
+			      gboolean *ret,
+			      GError **error)
 {
-	CURLcode res;
-	g_autofree gchar *str = NULL;
-	g_autoptr(curlptr) uri_str = NULL;
-
-	g_return_val_if_fail(FU_IS_REDFISH_REQUEST(self), FALSE);
-	g_return_val_if_fail(path != NULL, FALSE);
-	g_return_val_if_fail(self->status_code == 0, FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	GByteArray *buf;
 
-	/* already in cache? */
-	if (flags & FU_REDFISH_REQUEST_PERFORM_FLAG_USE_CACHE && self->cache != NULL) {
-		GByteArray *buf = g_hash_table_lookup(self->cache, path);
-		if (buf != NULL) {
-			if (flags & FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON)
-				return fu_redfish_request_load_json(self, buf, error);
-			g_byte_array_unref(self->buf);
-			self->buf = g_byte_array_ref(buf);
-			return TRUE;
-		}
+	if ((flags & FU_REDFISH_REQUEST_PERFORM_FLAG_USE_CACHE) == 0 || self->cache == NULL)
+		return FALSE;
+	buf = g_hash_table_lookup(self->cache, path);
+	if (buf == NULL)
+		return FALSE;
+	if (flags & FU_REDFISH_REQUEST_PERFORM_FLAG_LOAD_JSON) {
+		*ret = fu_redfish_request_load_json(self, buf, error);
+		return TRUE;
 	}
+	g_byte_array_unref(self->buf);
+	self->buf = g_byte_array_ref(buf);
+	*ret = TRUE;
+	return TRUE;
+}
 
-	/* do request */
+static void
+fu_redfish_request_prepare(FuRedfishRequest *self, const gchar *path)
+{
+	g_free(self->path);
+	self->path = g_strdup(path);
 	(void)curl_url_set(self->uri, CURLUPART_PATH, path, 0);
+}
+
+static gboolean
+fu_redfish_request_finish(FuRedfishRequest *self,
+			  CURLcode res,
+			  FuRedfishRequestPerformFlags flags,
+			  GError **error)
+{
+	g_autofree gchar *str = NULL;
+	g_autoptr(curlptr) uri_str = NULL;
+
 	(void)curl_url_get(self->uri, CURLUPART_URL, &uri_str, 0);
-	res = curl_easy_perform(self->curl);
 	curl_easy_getinfo(self->curl, CURLINFO_RESPONSE_CODE, &self->status_code);
 	str = g_strndup((const gchar *)self->buf->data, self->buf->len);
 	g_debug("%s: %s [%li]", uri_str, str, self->status_code);
 
 	/* check result */
+	if (res != CURLE_OK && self->upload_error != NULL) {
+		g_propagate_prefixed_error(error,
+					   g_steal_pointer(&self->upload_error),
+					   "failed to upload to %s: ",
+					   uri_str);
+		return FALSE;
+	}
 	if (res != CURLE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -189,7 +224,138 @@ fu_redfish_request_perform(FuRedfishRequest *self,
 
 	/* save to cache */
 	if (self->cache != NULL)
-		g_hash_table_insert(self->cache, g_strdup(path), g_byte_array_ref(self->buf));
+		g_hash_table_insert(self->cache, g_strdup(self->path), g_byte_array_ref(self->buf));
+
+	/* success */
+	return TRUE;
+}
+
+gboolean
+fu_redfish_request_perform(FuRedfishRequest *self,
+			   const gchar *path,
+			   FuRedfishRequestPerformFlags flags,
+			   GError **error)
+{
+	gboolean ret = FALSE;
+
+	g_return_val_if_fail(FU_IS_REDFISH_REQUEST(self), FALSE);
+	g_return_val_if_fail(path != NULL, FALSE);
+	g_return_val_if_fail(self->status_code == 0, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* already in cache? */
+	if (fu_redfish_request_load_cache(self, path, flags, &ret, error))
+		return ret;
+
+	/* do request */
+	fu_redfish_request_prepare(self, path);
+	return fu_redfish_request_finish(self, curl_easy_perform(self->curl), flags, error);
+}
+
+static void
+fu_redfish_request_multi_remove_all(CURLM *multi, GPtrArray *requests)
+{
+	for (guint i = 0; i < requests->len; i++) {
+		FuRedfishRequest *self = g_ptr_array_index(requests, i);
+		(void)curl_multi_remove_handle(multi, self->curl);
+	}
+}
+
+/* each request can then be used exactly like after fu_redfish_request_perform() */
+gboolean
+fu_redfish_request_perform_multi(GPtrArray *requests,
+				 GPtrArray *paths,
+				 guint max_active,
+				 FuRedfishRequestPerformFlags flags,
+				 GError **error)
+{
+	guint active = 0;
+	guint idx = 0;
+	g_autoptr(_curlm) multi = NULL;
+
+	g_return_val_if_fail(requests != NULL, FALSE);
+	g_return_val_if_fail(paths != NULL, FALSE);
+	g_return_val_if_fail(requests->len == paths->len, FALSE);
+	g_return_val_if_fail(max_active > 0, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	multi = curl_multi_init();
+	if (multi == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "failed to create multi handle");
+		return FALSE;
+	}
+	(void)curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (glong)max_active);
+	(void)curl_multi_setopt(multi, CURLMOPT_PIPELINING, (glong)CURLPIPE_MULTIPLEX);
+	while (idx < requests->len || active > 0) {
+		CURLMcode mres;
+		CURLMsg *msg;
+		gint msgs_left = 0;
+		gint running = 0;
+
+		/* keep the pipeline full */
+		while (active < max_active && idx < requests->len) {
+			FuRedfishRequest *self = g_ptr_array_index(requests, idx);
+			const gchar *path = g_ptr_array_index(paths, idx);
+			gboolean ret = FALSE;
+
+			idx++;
+			if (fu_redfish_request_load_cache(self, path, flags, &ret, error)) {
+				if (!ret) {
+					fu_redfish_request_multi_remove_all(multi, requests);
+					return FALSE;
+				}
+				continue;
+			}
+			fu_redfish_request_prepare(self, path);
+			(void)curl_easy_setopt(self->curl, CURLOPT_PRIVATE, self);
+			mres = curl_multi_add_handle(multi, self->curl);
+			if (mres != CURLM_OK) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INTERNAL,
+					    "failed to add %s: %s",
+					    path,
+					    curl_multi_strerror(mres));
+				fu_redfish_request_multi_remove_all(multi, requests);
+				return FALSE;
+			}
+			active++;
+		}
+		if (active == 0)
+			break;
+
+		/* make progress on all the transfers */
+		mres = curl_multi_perform(multi, &running);
+		if (mres == CURLM_OK && running > 0)
+			mres = curl_multi_wait(multi, NULL, 0, 1000, NULL);
+		if (mres != CURLM_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "failed to perform requests: %s",
+				    curl_multi_strerror(mres));
+			fu_redfish_request_multi_remove_all(multi, requests);
+			return FALSE;
+		}
+
+		/* process any that completed */
+		while ((msg = curl_multi_info_read(multi, &msgs_left)) != NULL) {
+			FuRedfishRequest *self = NULL;
+
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+			(void)curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&self);
+			(void)curl_multi_remove_handle(multi, msg->easy_handle);
+			active--;
+			if (!fu_redfish_request_finish(self, msg->data.result, flags, error)) {
+				fu_redfish_request_multi_remove_all(multi, requests);
+				return FALSE;
+			}
+		}
+	}
 
 	/* success */
 	return TRUE;
@@ -202,6 +368,7 @@ static void
 fu_redfish_request_reset(FuRedfishRequest *self)
 {
 	self->status_code = 0;
+	self->retry_after = 0;
 	self->json_obj = NULL;
 	g_byte_array_set_size(self->buf, 0);
 }
@@ -267,6 +434,108 @@ fu_redfish_request_write_cb(char *ptr, size_t size, size_t nmemb, void *userdata
 	return realsize;
 }
 
+static size_t
+fu_redfish_request_header_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FuRedfishRequest *self = FU_REDFISH_REQUEST(userdata);
+	gsize bufsz = size * nmemb;
+
+	if (bufsz > 12 && g_ascii_strncasecmp(ptr, "Retry-After:", 12) == 0) {
+		guint64 tmp = 0;
+		g_autofree gchar *str = g_strndup(ptr + 12, bufsz - 12);
+
+		/* an HTTP-date is also allowed, but BMCs use delay-seconds */
+		if (fu_strtoull(g_strstrip(str), &tmp, 0, G_MAXUINT, FU_INTEGER_BASE_10, NULL))
+			self->retry_after = (guint)tmp;
+	}
+	return bufsz;
+}
+
+static size_t
+fu_redfish_request_upload_read_cb(char *buffer, size_t size, size_t nitems, void *arg)
+{
+	FuRedfishRequest *self = FU_REDFISH_REQUEST(arg);
+	gssize rc;
+	g_autoptr(GError) error_local = NULL;
+
+	rc = g_input_stream_read(self->upload_stream, buffer, size * nitems, NULL, &error_local);
+	if (rc < 0) {
+		if (self->upload_error == NULL)
+			self->upload_error = g_steal_pointer(&error_local);
+		return CURL_READFUNC_ABORT;
+	}
+	return (size_t)rc;
+}
+
+static int
+fu_redfish_request_upload_seek_cb(void *arg, curl_off_t offset, int origin)
+{
+	FuRedfishRequest *self = FU_REDFISH_REQUEST(arg);
+	GSeekType seek_type = G_SEEK_SET;
+
+	if (origin == SEEK_CUR)
+		seek_type = G_SEEK_CUR;
+	else if (origin == SEEK_END)
+		seek_type = G_SEEK_END;
+	if (!g_seekable_seek(G_SEEKABLE(self->upload_stream), offset, seek_type, NULL, NULL))
+		return CURL_SEEKFUNC_FAIL;
+	return CURL_SEEKFUNC_OK;
+}
+
+/* the stream is read as the part is uploaded, rather than being copied into memory */
+gboolean
+fu_redfish_request_mime_data_stream(FuRedfishRequest *self,
+				    curl_mimepart *part,
+				    GInputStream *stream,
+				    GError **error)
+{
+	gsize streamsz = 0;
+
+	g_return_val_if_fail(FU_IS_REDFISH_REQUEST(self), FALSE);
+	g_return_val_if_fail(part != NULL, FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return FALSE;
+	if (!g_seekable_seek(G_SEEKABLE(stream), 0x0, G_SEEK_SET, NULL, error))
+		return FALSE;
+	g_set_object(&self->upload_stream, stream);
+	(void)curl_mime_data_cb(part,
+				(curl_off_t)streamsz,
+				fu_redfish_request_upload_read_cb,
+				fu_redfish_request_upload_seek_cb,
+				NULL,
+				self);
+	return TRUE;
+}
+
+static int
+fu_redfish_request_xferinfo_cb(void *clientp,
+			       curl_off_t dltotal,
+			       curl_off_t dlnow,
+			       curl_off_t ultotal,
+			       curl_off_t ulnow)
+{
+	FuRedfishRequest *self = FU_REDFISH_REQUEST(clientp);
+	if (ultotal > 0 && ulnow <= ultotal)
+		fu_progress_set_percentage_full(self->upload_progress, ulnow, ultotal);
+	return 0;
+}
+
+void
+fu_redfish_request_set_upload_progress(FuRedfishRequest *self, FuProgress *progress)
+{
+	g_return_if_fail(FU_IS_REDFISH_REQUEST(self));
+	g_return_if_fail(FU_IS_PROGRESS(progress));
+	g_set_object(&self->upload_progress, progress);
+	(void)curl_easy_setopt(self->curl,
+			       CURLOPT_XFERINFOFUNCTION,
+			       fu_redfish_request_xferinfo_cb);
+	(void)curl_easy_setopt(self->curl, CURLOPT_XFERINFODATA, self);
+	(void)curl_easy_setopt(self->curl, CURLOPT_NOPROGRESS, 0L);
+}
+
 void
 fu_redfish_request_set_cache(FuRedfishRequest *self, GHashTable *cache)
 {
@@ -293,6 +562,8 @@ fu_redfish_request_init(FuRedfishRequest *self)
 	self->json_parser = fwupd_json_parser_new();
 	(void)curl_easy_setopt(self->curl, CURLOPT_WRITEFUNCTION, fu_redfish_request_write_cb);
 	(void)curl_easy_setopt(self->curl, CURLOPT_WRITEDATA, self->buf);
+	(void)curl_easy_setopt(self->curl, CURLOPT_HEADERFUNCTION, fu_redfish_request_header_cb);
+	(void)curl_easy_setopt(self->curl, CURLOPT_HEADERDATA, self);
 }
 
 static void
@@ -303,6 +574,13 @@ fu_redfish_request_finalize(GObject *object)
 		g_hash_table_unref(self->cache);
 	g_object_unref(self->json_parser);
 	g_byte_array_unref(self->buf);
+	g_free(self->path);
+	if (self->upload_stream != NULL)
+		g_object_unref(self->upload_stream);
+	if (self->upload_error != NULL)
+		g_error_free(self->upload_error);
+	if (self->upload_progress != NULL)
+		g_object_unref(self->upload_progress);
 	curl_easy_cleanup(self->curl);
 	curl_url_cleanup(self->uri);
 	G_OBJECT_CLASS(fu_redfish_request_parent_class)->finalize(object);
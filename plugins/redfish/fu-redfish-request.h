@@ -21,6 +21,12 @@ fu_redfish_request_perform(FuRedfishRequest *self,
 			   FuRedfishRequestPerformFlags flags,
 			   GError **error);
 gboolean
+fu_redfish_request_perform_multi(GPtrArray *requests,
+				 GPtrArray *paths,
+				 guint max_active,
+				 FuRedfishRequestPerformFlags flags,
+				 GError **error);
+gboolean
 fu_redfish_request_perform_full(FuRedfishRequest *self,
 				const gchar *path,
 				const gchar *request,
@@ -37,5 +43,14 @@ CURLU *
 fu_redfish_request_get_uri(FuRedfishRequest *self);
 glong
 fu_redfish_request_get_status_code(FuRedfishRequest *self);
+guint
+fu_redfish_request_get_retry_after(FuRedfishRequest *self);
+gboolean
+fu_redfish_request_mime_data_stream(FuRedfishRequest *self,
+				    curl_mimepart *part,
+				    GInputStream *stream,
+				    GError **error);
+void
+fu_redfish_request_set_upload_progress(FuRedfishRequest *self, FuProgress *progress);
 void
 fu_redfish_request_set_cache(FuRedfishRequest *self, GHashTable *cache);
@@ -136,8 +136,8 @@ fu_redfish_smc_device_write_firmware(FuDevice *device,
 	const gchar *location = NULL;
 	g_autoptr(curl_mime) mime = NULL;
 	g_autoptr(FuRedfishRequest) request = NULL;
-	g_autoptr(GBytes) fw = NULL;
 	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(GString) params = NULL;
 
 	/* progress */
@@ -146,8 +146,8 @@ fu_redfish_smc_device_write_firmware(FuDevice *device,
 	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_RESTART, 50, "apply");
 
 	/* get default image */
-	fw = fu_firmware_get_bytes(firmware, error);
-	if (fw == NULL)
+	stream = fu_firmware_get_stream(firmware, error);
+	if (stream == NULL)
 		return FALSE;
 
 	/* create the multipart for uploading the image request */
@@ -169,7 +169,8 @@ fu_redfish_smc_device_write_firmware(FuDevice *device,
 	curl_mime_name(part, "UpdateFile");
 	(void)curl_mime_type(part, "application/octet-stream");
 	(void)curl_mime_filename(part, "firmware.bin");
-	(void)curl_mime_data(part, g_bytes_get_data(fw, NULL), g_bytes_get_size(fw));
+	if (!fu_redfish_request_mime_data_stream(request, part, stream, error))
+		return FALSE;
 
 	(void)curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
 
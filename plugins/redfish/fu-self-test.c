@@ -25,6 +25,7 @@ typedef struct {
 	FuPlugin *unlicensed_plugin;
 	FuPlugin *hpe_plugin;
 	FuPlugin *dell_plugin;
+	FuPlugin *expand_plugin;
 } FuTest;
 
 static void
@@ -126,6 +127,7 @@ fu_test_self_init(FuTest *self)
 	ret = fu_plugin_runner_startup(self->dell_plugin, progress, &error);
 	if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
 		g_test_skip("no redfish.py running");
+		g_clear_error(&error);
 	} else {
 		g_assert_no_error(error);
 		g_assert_true(ret);
@@ -141,6 +143,26 @@ fu_test_self_init(FuTest *self)
 		g_assert_no_error(error);
 		g_assert_true(ret);
 	}
+
+	/* BMC supporting $expand */
+	self->expand_plugin = fu_plugin_new_from_gtype(fu_redfish_plugin_get_type(), ctx);
+	ret = fu_plugin_runner_startup(self->expand_plugin, progress, &error);
+	if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
+		g_test_skip("no redfish.py running");
+		g_clear_error(&error);
+	} else {
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		fu_redfish_plugin_set_credentials(self->expand_plugin,
+						  "expand_username",
+						  "password2");
+		ret = fu_redfish_plugin_reload(self->expand_plugin, progress, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		ret = fu_plugin_runner_coldplug(self->expand_plugin, progress, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
 }
 
 static void
@@ -387,6 +409,28 @@ fu_test_redfish_devices_func(gconstpointer user_data)
 	g_assert_true(fu_device_has_vendor_id(dev, "REDFISH:CONTOSO"));
 }
 
+static void
+fu_test_redfish_expand_devices_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	GPtrArray *devices;
+
+	/* the members are included in the collection rather than requested one by one */
+	devices = fu_plugin_get_devices(self->expand_plugin);
+	g_assert_nonnull(devices);
+	if (devices->len == 0) {
+		g_test_skip("no redfish support");
+		return;
+	}
+	g_assert_cmpint(devices->len, ==, 2);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *dev = g_ptr_array_index(devices, i);
+		g_assert_true(FU_IS_REDFISH_DEVICE(dev));
+		g_assert_true(g_strcmp0(fu_device_get_name(dev), "BIOS Firmware") == 0 ||
+			      g_strcmp0(fu_device_get_name(dev), "BMC Firmware") == 0);
+	}
+}
+
 static void
 fu_test_redfish_unlicensed_devices_func(gconstpointer user_data)
 {
@@ -621,6 +665,8 @@ fu_test_self_free(FuTest *self)
 		g_object_unref(self->hpe_plugin);
 	if (self->dell_plugin != NULL)
 		g_object_unref(self->dell_plugin);
+	if (self->expand_plugin != NULL)
+		g_object_unref(self->expand_plugin);
 	g_free(self);
 }
 
@@ -668,6 +714,9 @@ main(int argc, char **argv)
 	g_test_add_data_func("/redfish/dell_plugin{devices}",
 			     self,
 			     fu_test_redfish_dell_devices_func);
+	g_test_add_data_func("/redfish/expand_plugin{devices}",
+			     self,
+			     fu_test_redfish_expand_devices_func);
 	g_test_add_data_func("/redfish/plugin{update}", self, fu_test_redfish_update_func);
 	return g_test_run();
 }
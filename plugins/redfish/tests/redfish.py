@@ -15,12 +15,14 @@ HARDCODED_SMC_USERNAME = "smc_username"
 HARDCODED_UNL_USERNAME = "unlicensed_username"
 HARDCODED_HPE_USERNAME = "hpe_username"
 HARDCODED_DELL_USERNAME = "dell_username"
+HARDCODED_EXPAND_USERNAME = "expand_username"
 HARDCODED_USERNAMES = {
     "username2",
     HARDCODED_SMC_USERNAME,
     HARDCODED_UNL_USERNAME,
     HARDCODED_HPE_USERNAME,
     HARDCODED_DELL_USERNAME,
+    HARDCODED_EXPAND_USERNAME,
 }
 HARDCODED_PASSWORD = "password2"
 
@@ -65,6 +67,15 @@ def index():
 
     if request.authorization["username"] == HARDCODED_HPE_USERNAME:
         res["Vendor"] = "HPE"
+    elif request.authorization["username"] == HARDCODED_EXPAND_USERNAME:
+        res["ProtocolFeaturesSupported"] = {
+            "ExpandQuery": {
+                "ExpandAll": True,
+                "Levels": True,
+                "MaxLevels": 1,
+                "NoLinks": True,
+            }
+        }
 
     if request.authorization["username"] == HARDCODED_DELL_USERNAME:
         res["Vendor"] = "Dell"
@@ -163,11 +174,12 @@ def firmware_inventory():
         ],
         "Members@odata.count": 2,
     }
+    if request.args.get("$expand") in [".", "*"]:
+        res["Members"] = [_firmware_inventory_bmc(), _firmware_inventory_bios()]
     return Response(json.dumps(res), status=200, mimetype="application/json")
 
 
-@app.route("/redfish/v1/UpdateService/FirmwareInventory/BMC")
-def firmware_inventory_bmc():
+def _firmware_inventory_bmc():
     res = {
         "@odata.id": "/redfish/v1/UpdateService/FirmwareInventory/BMC",
         "@odata.type": "#SoftwareInventory.v1_2_3.SoftwareInventory",
@@ -201,6 +213,12 @@ def firmware_inventory_bmc():
 
     if request.authorization["username"] == HARDCODED_DELL_USERNAME:
         res["Oem"] = {"Dell": {"DellSoftwareInventory": {"Status": "Installed"}}}
+    return res
+
+
+@app.route("/redfish/v1/UpdateService/FirmwareInventory/BMC")
+def firmware_inventory_bmc():
+    res = _firmware_inventory_bmc()
     return Response(json.dumps(res), status=200, mimetype="application/json")
 
 
@@ -251,8 +269,7 @@ def firmware_systems_slot7():
     return Response(json.dumps(res), status=200, mimetype="application/json")
 
 
-@app.route("/redfish/v1/UpdateService/FirmwareInventory/BIOS")
-def firmware_inventory_bios():
+def _firmware_inventory_bios():
     res = {
         "@odata.id": "/redfish/v1/UpdateService/FirmwareInventory/BIOS",
         "@odata.type": "#SoftwareInventory.v1_2_3.SoftwareInventory",
@@ -273,6 +290,12 @@ def firmware_inventory_bios():
         res["Manufacturer"] = "SMCI"
     else:
         res["Manufacturer"] = "Contoso"
+    return res
+
+
+@app.route("/redfish/v1/UpdateService/FirmwareInventory/BIOS")
+def firmware_inventory_bios():
+    res = _firmware_inventory_bios()
     return Response(json.dumps(res), status=200, mimetype="application/json")
 
 
@@ -323,8 +346,10 @@ def task_status_545():
         "Name": "Task 545",
         "PercentComplete": app._percentage545,
     }
+    headers = {}
     if app._percentage545 == 0:
         res["TaskState"] = "Running"
+        headers["Retry-After"] = "1"
     elif app._percentage545 in [25, 50, 75]:
         res["TaskState"] = "Running"
         res["TaskStatus"] = "OK"
@@ -362,7 +387,12 @@ def task_status_545():
             }
         ]
     app._percentage545 += 25
-    return Response(response=json.dumps(res), status=200, mimetype="application/json")
+    return Response(
+        response=json.dumps(res),
+        status=200,
+        mimetype="application/json",
+        headers=headers,
+    )
 
 
 @app.route("/redfish/v1/TaskService/Tasks/546")
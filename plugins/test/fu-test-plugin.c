@@ -105,6 +105,35 @@ static void
 fu_test_plugin_device_registered(FuPlugin *plugin, FuDevice *device)
 {
 	fu_device_set_metadata(device, "BestDevice", "/dev/urandom");
+
+	/* used for the HSI attribute, even though the device is from another plugin */
+	if (fu_device_get_metadata(device, "TestHsi") != NULL)
+		fu_plugin_cache_add(plugin, "hsi", device);
+}
+
+static gboolean
+fu_test_plugin_backend_device_removed(FuPlugin *plugin, FuDevice *device, GError **error)
+{
+	if (fu_plugin_cache_lookup(plugin, "hsi") == device)
+		fu_plugin_cache_remove(plugin, "hsi");
+	return TRUE;
+}
+
+static void
+fu_test_plugin_add_security_attrs(FuPlugin *plugin, FuSecurityAttrs *attrs)
+{
+	FuDevice *device = fu_plugin_cache_lookup(plugin, "hsi");
+	g_autoptr(FwupdSecurityAttr) attr = NULL;
+
+	if (device == NULL)
+		return;
+	attr = fu_plugin_security_attr_new(plugin, "org.fwupd.hsi.Test");
+	fwupd_security_attr_set_result_success(attr, FWUPD_SECURITY_ATTR_RESULT_LOCKED);
+	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_LOCKED))
+		fwupd_security_attr_add_flag(attr, FWUPD_SECURITY_ATTR_FLAG_SUCCESS);
+	else
+		fwupd_security_attr_set_result(attr, FWUPD_SECURITY_ATTR_RESULT_NOT_LOCKED);
+	fu_security_attrs_append(attrs, attr);
 }
 
 static gboolean
@@ -430,5 +459,7 @@ fu_test_plugin_class_init(FuTestPluginClass *klass)
 	plugin_class->attach = fu_test_plugin_attach;
 	plugin_class->coldplug = fu_test_plugin_coldplug;
 	plugin_class->device_registered = fu_test_plugin_device_registered;
+	plugin_class->backend_device_removed = fu_test_plugin_backend_device_removed;
+	plugin_class->add_security_attrs = fu_test_plugin_add_security_attrs;
 	plugin_class->modify_config = fu_test_plugin_modify_config;
 }
@@ -11,6 +11,7 @@
 #include "fu-security-attrs-private.h"
 #include "fu-tpm-eventlog-common.h"
 #include "fu-tpm-eventlog-parser.h"
+#include "fu-tpm-eventlog-replay.h"
 #include "fu-tpm-plugin.h"
 #include "fu-tpm-v1-device.h"
 #include "fu-tpm-v2-device.h"
@@ -206,6 +207,56 @@ fu_tpm_eventlog_parse_v2_func(void)
 			"6d9fed68092cfb91c9552bcb7879e75e1df36efd407af67690dc3389a5722fab");
 }
 
+static void
+fu_tpm_eventlog_replay_func(void)
+{
+	const guint8 buf1[TPM2_SHA1_DIGEST_SIZE] = {[0 ... TPM2_SHA1_DIGEST_SIZE - 1] = 0x01};
+	const guint8 buf2[TPM2_SHA1_DIGEST_SIZE] = {[0 ... TPM2_SHA1_DIGEST_SIZE - 1] = 0x02};
+	FuTpmEventlogItem item1 = {.pcr = 7, .kind = FU_TPM_EVENTLOG_ITEM_KIND_EV_SEPARATOR};
+	FuTpmEventlogItem item2 = {.pcr = 7, .kind = FU_TPM_EVENTLOG_ITEM_KIND_EV_SEPARATOR};
+	g_autoptr(FuTpmEventlogReplay) replay = fu_tpm_eventlog_replay_new();
+	g_autoptr(GBytes) blob1 = g_bytes_new_static(buf1, sizeof(buf1));
+	g_autoptr(GBytes) blob2 = g_bytes_new_static(buf2, sizeof(buf2));
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) pcr0s = NULL;
+	g_autoptr(GPtrArray) pcr7s = NULL;
+	g_autoptr(GPtrArray) pcr7s_new = NULL;
+
+	/* nothing added yet */
+	pcr7s = fu_tpm_eventlog_replay_get_checksums(replay, 7, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(pcr7s);
+	g_clear_error(&error);
+
+	/* extend */
+	item1.checksum_sha1 = blob1;
+	fu_tpm_eventlog_replay_add_item(replay, &item1);
+	pcr7s = fu_tpm_eventlog_replay_get_checksums(replay, 7, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(pcr7s);
+	g_assert_cmpint(pcr7s->len, ==, 1);
+	g_assert_cmpstr(g_ptr_array_index(pcr7s, 0),
+			==,
+			"c3ad7f64b8d976aaf2b3a9c98f7ee5631cde7125");
+
+	/* the log grew */
+	item2.checksum_sha1 = blob2;
+	fu_tpm_eventlog_replay_add_item(replay, &item2);
+	g_assert_cmpint(fu_tpm_eventlog_replay_get_size(replay), ==, 2);
+	pcr7s_new = fu_tpm_eventlog_replay_get_checksums(replay, 7, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(pcr7s_new);
+	g_assert_cmpint(pcr7s_new->len, ==, 1);
+	g_assert_cmpstr(g_ptr_array_index(pcr7s_new, 0),
+			==,
+			"0e88991a168f26482d5b6e381824271fdb496df9");
+
+	/* other PCRs are untouched */
+	pcr0s = fu_tpm_eventlog_replay_get_checksums(replay, 0, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(pcr0s);
+}
+
 static void
 fu_tpm_empty_pcr_func(void)
 {
@@ -286,5 +337,6 @@ main(int argc, char **argv)
 	g_test_add_func("/tpm/empty-pcr", fu_tpm_empty_pcr_func);
 	g_test_add_func("/tpm/eventlog-parse{v1}", fu_tpm_eventlog_parse_v1_func);
 	g_test_add_func("/tpm/eventlog-parse{v2}", fu_tpm_eventlog_parse_v2_func);
+	g_test_add_func("/tpm/eventlog-replay", fu_tpm_eventlog_replay_func);
 	return g_test_run();
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-tpm-eventlog-replay.h"
+
+/*
+ * Replays the event log into every PCR bank at the same time, so that the log only has to be
+ * walked once however many PCRs are wanted. Events can be added as the log grows and the
+ * reconstructed values are always up to date.
+ */
+
+typedef enum {
+	FU_TPM_EVENTLOG_REPLAY_BANK_SHA1,
+	FU_TPM_EVENTLOG_REPLAY_BANK_SHA256,
+	FU_TPM_EVENTLOG_REPLAY_BANK_SHA384,
+	FU_TPM_EVENTLOG_REPLAY_BANK_LAST
+} FuTpmEventlogReplayBank;
+
+typedef struct {
+	guint8 digest[TPM2_SHA384_DIGEST_SIZE];
+	guint cnt;
+} FuTpmEventlogReplayPcr;
+
+struct _FuTpmEventlogReplay {
+	GObject parent_instance;
+	GChecksum *csums[FU_TPM_EVENTLOG_REPLAY_BANK_LAST]; /* reset for each extend */
+	FuTpmEventlogReplayPcr pcrs[FU_TPM_EVENTLOG_REPLAY_PCR_MAX]
+				   [FU_TPM_EVENTLOG_REPLAY_BANK_LAST];
+	guint items_cnt;
+};
+
+G_DEFINE_TYPE(FuTpmEventlogReplay, fu_tpm_eventlog_replay, G_TYPE_OBJECT)
+
+static const gsize fu_tpm_eventlog_replay_bank_sizes[] = {
+    TPM2_SHA1_DIGEST_SIZE,
+    TPM2_SHA256_DIGEST_SIZE,
+    TPM2_SHA384_DIGEST_SIZE,
+};
+
+static GBytes *
+fu_tpm_eventlog_replay_item_get_checksum(FuTpmEventlogItem *item, FuTpmEventlogReplayBank bank)
+{
+	if (bank == FU_TPM_EVENTLOG_REPLAY_BANK_SHA1)
+		return item->checksum_sha1;
+	if (bank == FU_TPM_EVENTLOG_REPLAY_BANK_SHA256)
+		return item->checksum_sha256;
+	if (bank == FU_TPM_EVENTLOG_REPLAY_BANK_SHA384)
+		return item->checksum_sha384;
+	return NULL;
+}
+
+/* if TXT is enabled then the first event for PCR0 should be a StartupLocality */
+static gboolean
+fu_tpm_eventlog_replay_add_startup_locality(FuTpmEventlogReplay *self, FuTpmEventlogItem *item)
+{
+	guint8 locality;
+	g_autoptr(FuStructTpmEfiStartupLocalityEvent) st_loc = NULL;
+
+	if (item->kind != FU_TPM_EVENTLOG_ITEM_KIND_EV_NO_ACTION || item->pcr != 0 ||
+	    item->blob == NULL || self->items_cnt != 0)
+		return FALSE;
+	st_loc = fu_struct_tpm_efi_startup_locality_event_parse_bytes(item->blob, 0x0, NULL);
+	if (st_loc == NULL)
+		return FALSE;
+	locality = fu_struct_tpm_efi_startup_locality_event_get_locality(st_loc);
+	for (guint i = 0; i < FU_TPM_EVENTLOG_REPLAY_BANK_LAST; i++) {
+		FuTpmEventlogReplayPcr *pcr = &self->pcrs[0][i];
+		pcr->digest[fu_tpm_eventlog_replay_bank_sizes[i] - 1] = locality;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_tpm_eventlog_replay_add_item:
+ * @self: a #FuTpmEventlogReplay
+ * @item: a #FuTpmEventlogItem
+ *
+ * Extends the PCR of the event with each of the measurement checksums it has.
+ *
+ * Events have to be added in the same order as in the event log.
+ **/
+void
+fu_tpm_eventlog_replay_add_item(FuTpmEventlogReplay *self, FuTpmEventlogItem *item)
+{
+	g_return_if_fail(FU_IS_TPM_EVENTLOG_REPLAY(self));
+	g_return_if_fail(item != NULL);
+
+	if (item->pcr >= FU_TPM_EVENTLOG_REPLAY_PCR_MAX) {
+		g_debug("ignoring event for invalid PCR %u", item->pcr);
+		self->items_cnt++;
+		return;
+	}
+	if (fu_tpm_eventlog_replay_add_startup_locality(self, item)) {
+		self->items_cnt++;
+		return;
+	}
+
+	/* take existing PCR hash, append new measurement to that,
+	 * hash that with the same algorithm */
+	for (guint i = 0; i < FU_TPM_EVENTLOG_REPLAY_BANK_LAST; i++) {
+		FuTpmEventlogReplayPcr *pcr = &self->pcrs[item->pcr][i];
+		GBytes *checksum = fu_tpm_eventlog_replay_item_get_checksum(item, i);
+		gsize digestsz = fu_tpm_eventlog_replay_bank_sizes[i];
+
+		if (checksum == NULL)
+			continue;
+		g_checksum_reset(self->csums[i]);
+		g_checksum_update(self->csums[i], (const guchar *)pcr->digest, digestsz);
+		g_checksum_update(self->csums[i],
+				  (const guchar *)g_bytes_get_data(checksum, NULL),
+				  g_bytes_get_size(checksum));
+		g_checksum_get_digest(self->csums[i], pcr->digest, &digestsz);
+		pcr->cnt++;
+	}
+	self->items_cnt++;
+}
+
+/**
+ * fu_tpm_eventlog_replay_add_items:
+ * @self: a #FuTpmEventlogReplay
+ * @items: (element-type FuTpmEventlogItem): events
+ *
+ * Extends the PCRs with all the events in a single pass.
+ **/
+void
+fu_tpm_eventlog_replay_add_items(FuTpmEventlogReplay *self, GPtrArray *items)
+{
+	g_return_if_fail(FU_IS_TPM_EVENTLOG_REPLAY(self));
+	g_return_if_fail(items != NULL);
+
+	for (guint i = 0; i < items->len; i++) {
+		FuTpmEventlogItem *item = g_ptr_array_index(items, i);
+		fu_tpm_eventlog_replay_add_item(self, item);
+	}
+}
+
+/**
+ * fu_tpm_eventlog_replay_get_size:
+ * @self: a #FuTpmEventlogReplay
+ *
+ * Gets the number of events that have been added.
+ *
+ * Returns: integer
+ **/
+guint
+fu_tpm_eventlog_replay_get_size(FuTpmEventlogReplay *self)
+{
+	g_return_val_if_fail(FU_IS_TPM_EVENTLOG_REPLAY(self), 0);
+	return self->items_cnt;
+}
+
+/**
+ * fu_tpm_eventlog_replay_get_checksums:
+ * @self: a #FuTpmEventlogReplay
+ * @pcr: PCR index
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the reconstructed PCR values for each bank that was measured into, in the order
+ * SHA1, SHA256 and then SHA384.
+ *
+ * Returns: (transfer container) (element-type utf8): checksums, or %NULL on error
+ **/
+GPtrArray *
+fu_tpm_eventlog_replay_get_checksums(FuTpmEventlogReplay *self, guint8 pcr, GError **error)
+{
+	g_autoptr(GPtrArray) csums = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_val_if_fail(FU_IS_TPM_EVENTLOG_REPLAY(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* sanity check */
+	if (self->items_cnt == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "no event log data");
+		return NULL;
+	}
+	if (pcr >= FU_TPM_EVENTLOG_REPLAY_PCR_MAX) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "invalid PCR specified: %u",
+			    pcr);
+		return NULL;
+	}
+	for (guint i = 0; i < FU_TPM_EVENTLOG_REPLAY_BANK_LAST; i++) {
+		FuTpmEventlogReplayPcr *pcr_bank = &self->pcrs[pcr][i];
+		g_autoptr(GBytes) blob = NULL;
+		if (pcr_bank->cnt == 0)
+			continue;
+		blob = g_bytes_new_static(pcr_bank->digest, fu_tpm_eventlog_replay_bank_sizes[i]);
+		g_ptr_array_add(csums, fu_bytes_to_string(blob));
+	}
+	if (csums->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "no SHA1, SHA256, or SHA384 data");
+		return NULL;
+	}
+	return g_steal_pointer(&csums);
+}
+
+static void
+fu_tpm_eventlog_replay_init(FuTpmEventlogReplay *self)
+{
+	self->csums[FU_TPM_EVENTLOG_REPLAY_BANK_SHA1] = g_checksum_new(G_CHECKSUM_SHA1);
+	self->csums[FU_TPM_EVENTLOG_REPLAY_BANK_SHA256] = g_checksum_new(G_CHECKSUM_SHA256);
+	self->csums[FU_TPM_EVENTLOG_REPLAY_BANK_SHA384] = g_checksum_new(G_CHECKSUM_SHA384);
+}
+
+static void
+fu_tpm_eventlog_replay_finalize(GObject *obj)
+{
+	FuTpmEventlogReplay *self = FU_TPM_EVENTLOG_REPLAY(obj);
+	for (guint i = 0; i < FU_TPM_EVENTLOG_REPLAY_BANK_LAST; i++)
+		g_checksum_free(self->csums[i]);
+	G_OBJECT_CLASS(fu_tpm_eventlog_replay_parent_class)->finalize(obj);
+}
+
+static void
+fu_tpm_eventlog_replay_class_init(FuTpmEventlogReplayClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_tpm_eventlog_replay_finalize;
+}
+
+/**
+ * fu_tpm_eventlog_replay_new:
+ *
+ * Creates a new replay of the TPM event log, with all PCRs starting as zero.
+ *
+ * Returns: (transfer full): a #FuTpmEventlogReplay
+ **/
+FuTpmEventlogReplay *
+fu_tpm_eventlog_replay_new(void)
+{
+	return g_object_new(FU_TYPE_TPM_EVENTLOG_REPLAY, NULL);
+}
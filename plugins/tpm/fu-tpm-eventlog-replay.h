@@ -0,0 +1,33 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-tpm-eventlog-common.h"
+
+/* the PC client platform profile only defines PCRs 0 to 23 */
+#define FU_TPM_EVENTLOG_REPLAY_PCR_MAX 24
+
+#define FU_TYPE_TPM_EVENTLOG_REPLAY (fu_tpm_eventlog_replay_get_type())
+G_DECLARE_FINAL_TYPE(FuTpmEventlogReplay,
+		     fu_tpm_eventlog_replay,
+		     FU,
+		     TPM_EVENTLOG_REPLAY,
+		     GObject)
+
+FuTpmEventlogReplay *
+fu_tpm_eventlog_replay_new(void);
+void
+fu_tpm_eventlog_replay_add_item(FuTpmEventlogReplay *self, FuTpmEventlogItem *item)
+    G_GNUC_NON_NULL(1, 2);
+void
+fu_tpm_eventlog_replay_add_items(FuTpmEventlogReplay *self, GPtrArray *items)
+    G_GNUC_NON_NULL(1, 2);
+guint
+fu_tpm_eventlog_replay_get_size(FuTpmEventlogReplay *self) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_tpm_eventlog_replay_get_checksums(FuTpmEventlogReplay *self, guint8 pcr, GError **error)
+    G_GNUC_NON_NULL(1);
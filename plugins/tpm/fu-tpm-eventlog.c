@@ -15,6 +15,7 @@
 #include <unistd.h>
 
 #include "fu-tpm-eventlog-parser.h"
+#include "fu-tpm-eventlog-replay.h"
 
 typedef struct {
 	gint pcr;
@@ -55,6 +56,7 @@ fu_tpm_eventlog_process(FuUtil *self, const gchar *fn, GError **error)
 	gsize bufsz = 0;
 	g_autofree guint8 *buf = NULL;
 	g_autoptr(GPtrArray) items = NULL;
+	g_autoptr(FuTpmEventlogReplay) replay = fu_tpm_eventlog_replay_new();
 	g_autoptr(GString) str = g_string_new(NULL);
 	gint max_pcr = 0;
 
@@ -64,6 +66,9 @@ fu_tpm_eventlog_process(FuUtil *self, const gchar *fn, GError **error)
 	items = fu_tpm_eventlog_parser_new(buf, bufsz, FU_TPM_EVENTLOG_PARSER_FLAG_ALL_PCRS, error);
 	if (items == NULL)
 		return FALSE;
+
+	/* replay all the PCRs at once, in the order they were measured */
+	fu_tpm_eventlog_replay_add_items(replay, items);
 	g_ptr_array_sort(items, fu_tpm_eventlog_sort_cb);
 
 	for (guint i = 0; i < items->len; i++) {
@@ -91,7 +96,7 @@ fu_tpm_eventlog_process(FuUtil *self, const gchar *fn, GError **error)
 	}
 	fwupd_codec_string_append(str, 0, "Reconstructed PCRs", "");
 	for (guint8 i = 0; i <= max_pcr; i++) {
-		g_autoptr(GPtrArray) pcrs = fu_tpm_eventlog_calc_checksums(items, i, NULL);
+		g_autoptr(GPtrArray) pcrs = fu_tpm_eventlog_replay_get_checksums(replay, i, NULL);
 		if (pcrs == NULL)
 			continue;
 		for (guint j = 0; j < pcrs->len; j++) {
@@ -7,6 +7,7 @@
 #include "config.h"
 
 #include "fu-tpm-eventlog-parser.h"
+#include "fu-tpm-eventlog-replay.h"
 #include "fu-tpm-plugin.h"
 #include "fu-tpm-v1-device.h"
 #include "fu-tpm-v2-device.h"
@@ -16,6 +17,7 @@ struct _FuTpmPlugin {
 	FuTpmDevice *tpm_device;
 	FuDevice *bios_device;
 	GPtrArray *ev_items; /* of FuTpmEventlogItem */
+	FuTpmEventlogReplay *ev_replay;
 };
 
 G_DEFINE_TYPE(FuTpmPlugin, fu_tpm_plugin, FU_TYPE_PLUGIN)
@@ -153,13 +155,13 @@ fu_tpm_plugin_add_security_attr_eventlog(FuPlugin *plugin, FuSecurityAttrs *attr
 	fu_security_attrs_append(attrs, attr);
 
 	/* check reconstructed to PCR0 */
-	if (self->ev_items == NULL) {
+	if (self->ev_replay == NULL) {
 		fwupd_security_attr_set_result(attr, FWUPD_SECURITY_ATTR_RESULT_NOT_FOUND);
 		return;
 	}
 
 	/* calculate from the eventlog */
-	pcr0s_calc = fu_tpm_eventlog_calc_checksums(self->ev_items, 0, &error);
+	pcr0s_calc = fu_tpm_eventlog_replay_get_checksums(self->ev_replay, 0, &error);
 	if (pcr0s_calc == NULL) {
 		g_warning("failed to get eventlog reconstruction: %s", error->message);
 		fwupd_security_attr_set_result(attr, FWUPD_SECURITY_ATTR_RESULT_NOT_VALID);
@@ -278,7 +280,7 @@ fu_tpm_plugin_eventlog_report_metadata(FuPlugin *plugin)
 			g_string_append_printf(str, " [%s]", blobstr);
 		g_string_append(str, "\n");
 	}
-	pcrs = fu_tpm_eventlog_calc_checksums(self->ev_items, 0, NULL);
+	pcrs = fu_tpm_eventlog_replay_get_checksums(self->ev_replay, 0, NULL);
 	if (pcrs != NULL) {
 		for (guint j = 0; j < pcrs->len; j++) {
 			const gchar *csum = g_ptr_array_index(pcrs, j);
@@ -325,6 +327,10 @@ fu_tpm_plugin_coldplug_eventlog(FuPlugin *plugin, GError **error)
 	if (self->ev_items == NULL)
 		return FALSE;
 
+	/* replayed once, and shared by the report metadata and the HSI attribute */
+	self->ev_replay = fu_tpm_eventlog_replay_new();
+	fu_tpm_eventlog_replay_add_items(self->ev_replay, self->ev_items);
+
 	/* add optional report metadata */
 	str = fu_tpm_plugin_eventlog_report_metadata(plugin);
 	fu_plugin_add_report_metadata(plugin, "TpmEventLog", str);
@@ -399,6 +405,8 @@ fu_tpm_plugin_finalize(GObject *obj)
 		g_object_unref(self->bios_device);
 	if (self->ev_items != NULL)
 		g_ptr_array_unref(self->ev_items);
+	if (self->ev_replay != NULL)
+		g_object_unref(self->ev_replay);
 	G_OBJECT_CLASS(fu_tpm_plugin_parent_class)->finalize(obj);
 }
 
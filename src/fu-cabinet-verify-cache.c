@@ -0,0 +1,431 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuCabinet"
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fu-cabinet-verify-cache.h"
+
+/*
+ * Verifying the signature of a payload means hashing it and then checking the PKCS#7 or GPG
+ * signature, and the same archive is parsed for the details, for the install and again after a
+ * reboot. The cache remembers the payloads that were verified, so that the signature check can
+ * be skipped the next time the same payload is seen.
+ *
+ * Each entry is the HMAC of the payload SHA256, the verify flags and a fingerprint of all the
+ * trust roots, using a random key that is only readable by root. Entries cannot be forged without
+ * the key, and adding or removing a trusted certificate invalidates every entry. Negative results
+ * are never cached.
+ */
+
+#define FU_CABINET_VERIFY_CACHE_KEY_SIZE     32
+#define FU_CABINET_VERIFY_CACHE_ENTRIES_MAX 10000
+
+struct _FuCabinetVerifyCache {
+	GObject parent_instance;
+	GChecksum *trust_root; /* SHA256 */
+	GHashTable *entries;   /* (element-type utf8 utf8) */
+	GBytes *key;
+	gchar *filename;
+};
+
+G_DEFINE_TYPE(FuCabinetVerifyCache, fu_cabinet_verify_cache, G_TYPE_OBJECT)
+
+static gint
+fu_cabinet_verify_cache_sort_cb(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(const gchar **)a, *(const gchar **)b);
+}
+
+/**
+ * fu_cabinet_verify_cache_add_trust_root:
+ * @self: a #FuCabinetVerifyCache
+ * @path: a directory of public keys or certificates
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds the contents of a directory to the trust root fingerprint. This should be the same
+ * directories passed to jcat_context_add_public_keys().
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_cabinet_verify_cache_add_trust_root(FuCabinetVerifyCache *self,
+				       const gchar *path,
+				       GError **error)
+{
+	const gchar *fn;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) filenames = g_ptr_array_new_with_free_func(g_free);
+
+	g_return_val_if_fail(FU_IS_CABINET_VERIFY_CACHE(self), FALSE);
+	g_return_val_if_fail(path != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* the directory name is included even if it does not exist */
+	g_checksum_update(self->trust_root, (const guchar *)path, strlen(path) + 1);
+	if (!g_file_test(path, G_FILE_TEST_IS_DIR))
+		return TRUE;
+	dir = g_dir_open(path, 0, error);
+	if (dir == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	while ((fn = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(filenames, g_strdup(fn));
+	g_ptr_array_sort(filenames, fu_cabinet_verify_cache_sort_cb);
+	for (guint i = 0; i < filenames->len; i++) {
+		const gchar *basename = g_ptr_array_index(filenames, i);
+		gsize bufsz = 0;
+		g_autofree gchar *buf = NULL;
+		g_autofree gchar *filename = g_build_filename(path, basename, NULL);
+
+		if (!g_file_test(filename, G_FILE_TEST_IS_REGULAR))
+			continue;
+		if (!g_file_get_contents(filename, &buf, &bufsz, error)) {
+			fwupd_error_convert(error);
+			return FALSE;
+		}
+		g_checksum_update(self->trust_root,
+				  (const guchar *)basename,
+				  strlen(basename) + 1);
+		g_checksum_update(self->trust_root, (const guchar *)buf, bufsz);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static GBytes *
+fu_cabinet_verify_cache_key_new(GError **error)
+{
+	gsize bufsz = 0;
+	g_autofree guint8 *buf = g_malloc0(FU_CABINET_VERIFY_CACHE_KEY_SIZE);
+	g_autoptr(GFile) file = g_file_new_for_path("/dev/urandom");
+	g_autoptr(GFileInputStream) stream = NULL;
+
+	stream = g_file_read(file, NULL, error);
+	if (stream == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	if (!g_input_stream_read_all(G_INPUT_STREAM(stream),
+				     buf,
+				     FU_CABINET_VERIFY_CACHE_KEY_SIZE,
+				     &bufsz,
+				     NULL,
+				     error)) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	if (bufsz != FU_CABINET_VERIFY_CACHE_KEY_SIZE) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_READ,
+				    "not enough random data for key");
+		return NULL;
+	}
+	return g_bytes_new_take(g_steal_pointer(&buf), FU_CABINET_VERIFY_CACHE_KEY_SIZE);
+}
+
+static gboolean
+fu_cabinet_verify_cache_ensure_key(FuCabinetVerifyCache *self, GError **error)
+{
+	g_autofree gchar *fn_key = NULL;
+	g_autoptr(GBytes) key = NULL;
+
+	if (self->key != NULL)
+		return TRUE;
+
+	/* not persistent */
+	if (self->filename == NULL) {
+		self->key = fu_cabinet_verify_cache_key_new(error);
+		return self->key != NULL;
+	}
+
+	/* reuse the existing key, or create a new one that only root can read */
+	fn_key = g_strdup_printf("%s.key", self->filename);
+	if (g_file_test(fn_key, G_FILE_TEST_EXISTS)) {
+		key = fu_bytes_get_contents(fn_key, error);
+		if (key == NULL)
+			return FALSE;
+		if (g_bytes_get_size(key) == FU_CABINET_VERIFY_CACHE_KEY_SIZE) {
+			self->key = g_steal_pointer(&key);
+			return TRUE;
+		}
+		g_warning("ignoring invalid key %s", fn_key);
+		g_clear_pointer(&key, g_bytes_unref);
+	}
+	key = fu_cabinet_verify_cache_key_new(error);
+	if (key == NULL)
+		return FALSE;
+	if (!fu_path_mkdir_parent(fn_key, error))
+		return FALSE;
+	if (!g_file_set_contents_full(fn_key,
+				      g_bytes_get_data(key, NULL),
+				      g_bytes_get_size(key),
+				      G_FILE_SET_CONTENTS_CONSISTENT,
+				      0600,
+				      error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+
+	/* success */
+	self->key = g_steal_pointer(&key);
+	return TRUE;
+}
+
+/**
+ * fu_cabinet_verify_cache_load:
+ * @self: a #FuCabinetVerifyCache
+ * @filename: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Loads the verified entries, and saves new entries to the same file. The key is stored in
+ * a file of the same name with the `.key` suffix.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_cabinet_verify_cache_load(FuCabinetVerifyCache *self, const gchar *filename, GError **error)
+{
+	g_autofree gchar *buf = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	g_return_val_if_fail(FU_IS_CABINET_VERIFY_CACHE(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	g_free(self->filename);
+	self->filename = g_strdup(filename);
+	g_clear_pointer(&self->key, g_bytes_unref);
+	g_hash_table_remove_all(self->entries);
+	if (!fu_cabinet_verify_cache_ensure_key(self, error))
+		return FALSE;
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+	if (!g_file_get_contents(filename, &buf, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+
+	/* anything that does not look like an entry is ignored */
+	lines = g_strsplit(buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		if (strlen(lines[i]) != 64 || !g_str_is_ascii(lines[i]))
+			continue;
+		if (g_hash_table_size(self->entries) >= FU_CABINET_VERIFY_CACHE_ENTRIES_MAX)
+			break;
+		g_hash_table_add(self->entries, g_strdup(lines[i]));
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_cabinet_verify_cache_save(FuCabinetVerifyCache *self, GError **error)
+{
+	GHashTableIter iter;
+	gpointer key = NULL;
+	g_autoptr(GString) str = g_string_new(NULL);
+
+	if (self->filename == NULL)
+		return TRUE;
+	g_hash_table_iter_init(&iter, self->entries);
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+		g_string_append_printf(str, "%s\n", (const gchar *)key);
+	if (!fu_path_mkdir_parent(self->filename, error))
+		return FALSE;
+	if (!g_file_set_contents_full(self->filename,
+				      str->str,
+				      str->len,
+				      G_FILE_SET_CONTENTS_CONSISTENT,
+				      0600,
+				      error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_cabinet_verify_cache_append(FuCabinetVerifyCache *self, const gchar *entry, GError **error)
+{
+	g_autofree gchar *line = g_strdup_printf("%s\n", entry);
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileOutputStream) stream = NULL;
+
+	if (self->filename == NULL)
+		return TRUE;
+	if (!fu_path_mkdir_parent(self->filename, error))
+		return FALSE;
+
+	/* a torn line is ignored when loading, so there is no need to rewrite the whole file */
+	file = g_file_new_for_path(self->filename);
+	stream = g_file_append_to(file, G_FILE_CREATE_PRIVATE, NULL, error);
+	if (stream == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	if (!g_output_stream_write_all(G_OUTPUT_STREAM(stream),
+				       line,
+				       strlen(line),
+				       NULL,
+				       NULL,
+				       error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	if (!g_output_stream_close(G_OUTPUT_STREAM(stream), NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gchar *
+fu_cabinet_verify_cache_build_entry(FuCabinetVerifyCache *self,
+				    const gchar *checksum,
+				    JcatVerifyFlags flags)
+{
+	g_autofree gchar *trust_root = NULL;
+	g_autofree gchar *flags_str = g_strdup_printf("%u", (guint)flags);
+	g_autoptr(GChecksum) csum = g_checksum_copy(self->trust_root);
+	g_autoptr(GHmac) hmac = NULL;
+
+	trust_root = g_strdup(g_checksum_get_string(csum));
+	hmac = g_hmac_new(G_CHECKSUM_SHA256,
+			  g_bytes_get_data(self->key, NULL),
+			  g_bytes_get_size(self->key));
+	g_hmac_update(hmac, (const guchar *)trust_root, strlen(trust_root) + 1);
+	g_hmac_update(hmac, (const guchar *)flags_str, strlen(flags_str) + 1);
+	g_hmac_update(hmac, (const guchar *)checksum, strlen(checksum) + 1);
+	return g_strdup(g_hmac_get_string(hmac));
+}
+
+/**
+ * fu_cabinet_verify_cache_lookup:
+ * @self: a #FuCabinetVerifyCache
+ * @checksum: the SHA256 checksum of the payload
+ * @flags: the #JcatVerifyFlags used to verify the payload
+ *
+ * Finds out if the payload has been verified before with the same trust roots.
+ *
+ * Returns: %TRUE if the payload was verified
+ **/
+gboolean
+fu_cabinet_verify_cache_lookup(FuCabinetVerifyCache *self,
+			       const gchar *checksum,
+			       JcatVerifyFlags flags)
+{
+	g_autofree gchar *entry = NULL;
+
+	g_return_val_if_fail(FU_IS_CABINET_VERIFY_CACHE(self), FALSE);
+	g_return_val_if_fail(checksum != NULL, FALSE);
+
+	if (self->key == NULL || g_hash_table_size(self->entries) == 0)
+		return FALSE;
+	entry = fu_cabinet_verify_cache_build_entry(self, checksum, flags);
+	return g_hash_table_contains(self->entries, entry);
+}
+
+/**
+ * fu_cabinet_verify_cache_add:
+ * @self: a #FuCabinetVerifyCache
+ * @checksum: the SHA256 checksum of the payload
+ * @flags: the #JcatVerifyFlags used to verify the payload
+ * @error: (nullable): optional return location for an error
+ *
+ * Records that the payload has been verified, appending to the cache if it was loaded from a file.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_cabinet_verify_cache_add(FuCabinetVerifyCache *self,
+			    const gchar *checksum,
+			    JcatVerifyFlags flags,
+			    GError **error)
+{
+	gboolean cleared = FALSE;
+	g_autofree gchar *entry = NULL;
+
+	g_return_val_if_fail(FU_IS_CABINET_VERIFY_CACHE(self), FALSE);
+	g_return_val_if_fail(checksum != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (!fu_cabinet_verify_cache_ensure_key(self, error))
+		return FALSE;
+	if (g_hash_table_size(self->entries) >= FU_CABINET_VERIFY_CACHE_ENTRIES_MAX) {
+		g_debug("verify cache full, clearing");
+		g_hash_table_remove_all(self->entries);
+		cleared = TRUE;
+	}
+	entry = fu_cabinet_verify_cache_build_entry(self, checksum, flags);
+	if (!g_hash_table_add(self->entries, g_strdup(entry)))
+		return TRUE;
+
+	/* only rewrite the file when the old entries have to be dropped */
+	if (cleared)
+		return fu_cabinet_verify_cache_save(self, error);
+	return fu_cabinet_verify_cache_append(self, entry, error);
+}
+
+/**
+ * fu_cabinet_verify_cache_get_size:
+ * @self: a #FuCabinetVerifyCache
+ *
+ * Gets the number of verified payloads.
+ *
+ * Returns: integer
+ **/
+guint
+fu_cabinet_verify_cache_get_size(FuCabinetVerifyCache *self)
+{
+	g_return_val_if_fail(FU_IS_CABINET_VERIFY_CACHE(self), 0);
+	return g_hash_table_size(self->entries);
+}
+
+static void
+fu_cabinet_verify_cache_init(FuCabinetVerifyCache *self)
+{
+	self->trust_root = g_checksum_new(G_CHECKSUM_SHA256);
+	self->entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void
+fu_cabinet_verify_cache_finalize(GObject *obj)
+{
+	FuCabinetVerifyCache *self = FU_CABINET_VERIFY_CACHE(obj);
+	g_checksum_free(self->trust_root);
+	g_hash_table_unref(self->entries);
+	if (self->key != NULL)
+		g_bytes_unref(self->key);
+	g_free(self->filename);
+	G_OBJECT_CLASS(fu_cabinet_verify_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_cabinet_verify_cache_class_init(FuCabinetVerifyCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_cabinet_verify_cache_finalize;
+}
+
+/**
+ * fu_cabinet_verify_cache_new:
+ *
+ * Creates a new cache of verified payloads. Until fu_cabinet_verify_cache_load() is called the
+ * cache is only kept in memory.
+ *
+ * Returns: (transfer full): a #FuCabinetVerifyCache
+ **/
+FuCabinetVerifyCache *
+fu_cabinet_verify_cache_new(void)
+{
+	return g_object_new(FU_TYPE_CABINET_VERIFY_CACHE, NULL);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+#include <jcat.h>
+
+#define FU_TYPE_CABINET_VERIFY_CACHE (fu_cabinet_verify_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuCabinetVerifyCache,
+		     fu_cabinet_verify_cache,
+		     FU,
+		     CABINET_VERIFY_CACHE,
+		     GObject)
+
+FuCabinetVerifyCache *
+fu_cabinet_verify_cache_new(void);
+gboolean
+fu_cabinet_verify_cache_add_trust_root(FuCabinetVerifyCache *self,
+				       const gchar *path,
+				       GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_cabinet_verify_cache_load(FuCabinetVerifyCache *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_cabinet_verify_cache_lookup(FuCabinetVerifyCache *self,
+			       const gchar *checksum,
+			       JcatVerifyFlags flags) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_cabinet_verify_cache_add(FuCabinetVerifyCache *self,
+			    const gchar *checksum,
+			    JcatVerifyFlags flags,
+			    GError **error) G_GNUC_NON_NULL(1, 2);
+guint
+fu_cabinet_verify_cache_get_size(FuCabinetVerifyCache *self) G_GNUC_NON_NULL(1);
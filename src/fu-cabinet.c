@@ -28,6 +28,7 @@ struct _FuCabinet {
 	XbSilo *silo;
 	JcatContext *jcat_context;
 	JcatFile *jcat_file;
+	FuCabinetVerifyCache *verify_cache;
 };
 
 G_DEFINE_TYPE(FuCabinet, fu_cabinet, FU_TYPE_CAB_FIRMWARE)
@@ -50,6 +51,23 @@ fu_cabinet_set_jcat_context(FuCabinet *self, JcatContext *jcat_context)
 	g_set_object(&self->jcat_context, jcat_context);
 }
 
+/**
+ * fu_cabinet_set_verify_cache: (skip):
+ * @self: a #FuCabinet
+ * @verify_cache: (nullable): a #FuCabinetVerifyCache
+ *
+ * Sets the cache of payloads that have already been verified, which allows the signature
+ * checks to be skipped when the same payload is parsed again.
+ *
+ * Since: 2.1.1
+ **/
+void
+fu_cabinet_set_verify_cache(FuCabinet *self, FuCabinetVerifyCache *verify_cache)
+{
+	g_return_if_fail(FU_IS_CABINET(self));
+	g_set_object(&self->verify_cache, verify_cache);
+}
+
 /**
  * fu_cabinet_get_silo: (skip):
  * @self: a #FuCabinet
@@ -99,6 +117,18 @@ fu_cabinet_add_file(FuCabinet *self, const gchar *basename, GBytes *data, GError
 	return fu_firmware_add_image(FU_FIRMWARE(self), FU_FIRMWARE(img), error);
 }
 
+#define FU_CABINET_CHECKSUM_KIND_LAST (G_CHECKSUM_SHA384 + 1)
+
+static GChecksum *
+fu_cabinet_checksum_ensure(GPtrArray *csums, GChecksum **csum_by_kind, GChecksumType kind)
+{
+	if (csum_by_kind[kind] == NULL) {
+		csum_by_kind[kind] = g_checksum_new(kind);
+		g_ptr_array_add(csums, csum_by_kind[kind]);
+	}
+	return csum_by_kind[kind];
+}
+
 /* sets the firmware and signature blobs on XbNode */
 static gboolean
 fu_cabinet_parse_release(FuCabinet *self,
@@ -106,10 +136,16 @@ fu_cabinet_parse_release(FuCabinet *self,
 			 FuFirmwareParseFlags flags,
 			 GError **error)
 {
+	const gchar *checksum_sha256 = NULL;
 	const gchar *csum_filename = NULL;
+	gboolean verified = FALSE;
 	gsize streamsz = 0;
+	GChecksum *csum_by_kind[FU_CABINET_CHECKSUM_KIND_LAST] = {NULL};
 	g_autofree gchar *basename = NULL;
 	g_autoptr(FuFirmware) img_blob = NULL;
+	g_autoptr(FuFirmware) img_sig = NULL;
+	g_autoptr(GPtrArray) csums =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_checksum_free);
 	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(GError) error_local2 = NULL;
 	g_autoptr(XbNode) artifact = NULL;
@@ -204,14 +240,35 @@ fu_cabinet_parse_release(FuCabinet *self,
 		xb_node_set_data(release, "fwupd::ReleaseSize", blob_sz);
 	}
 
+	/* the signature is either in the jcat file, or a legacy GPG detached signature */
+	item = jcat_file_get_item_by_id(self->jcat_file, basename, NULL);
+	if (item == NULL) {
+		g_autofree gchar *basename_sig = g_strdup_printf("%s.asc", basename);
+		img_sig = fu_firmware_get_image_by_id(FU_FIRMWARE(self), basename_sig, NULL);
+	}
+
+	/* hash the payload just once for everything that needs a checksum */
+	if (csum_tmp != NULL && xb_node_get_text(csum_tmp) != NULL) {
+		fu_cabinet_checksum_ensure(csums,
+					   csum_by_kind,
+					   fwupd_checksum_guess_kind(xb_node_get_text(csum_tmp)));
+	}
+	if (item != NULL && jcat_item_has_target(item)) {
+		fu_cabinet_checksum_ensure(csums, csum_by_kind, G_CHECKSUM_SHA256);
+		fu_cabinet_checksum_ensure(csums, csum_by_kind, G_CHECKSUM_SHA512);
+	}
+	if (self->verify_cache != NULL && (item != NULL || img_sig != NULL))
+		fu_cabinet_checksum_ensure(csums, csum_by_kind, G_CHECKSUM_SHA256);
+	if (csums->len > 0 && !fu_input_stream_compute_checksums(stream, csums, error))
+		return FALSE;
+	if (csum_by_kind[G_CHECKSUM_SHA256] != NULL)
+		checksum_sha256 = g_checksum_get_string(csum_by_kind[G_CHECKSUM_SHA256]);
+
 	/* set if unspecified, but error out if specified and incorrect */
 	if (csum_tmp != NULL && xb_node_get_text(csum_tmp) != NULL) {
 		const gchar *checksum_old = xb_node_get_text(csum_tmp);
 		GChecksumType checksum_type = fwupd_checksum_guess_kind(checksum_old);
-		g_autofree gchar *checksum = NULL;
-		checksum = fu_input_stream_compute_checksum(stream, checksum_type, error);
-		if (checksum == NULL)
-			return FALSE;
+		const gchar *checksum = g_checksum_get_string(csum_by_kind[checksum_type]);
 		if (g_strcmp0(checksum, checksum_old) != 0) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -223,31 +280,27 @@ fu_cabinet_parse_release(FuCabinet *self,
 		}
 	}
 
-	/* the jcat file signed the *checksum of the payload*, not the payload itself */
-	item = jcat_file_get_item_by_id(self->jcat_file, basename, NULL);
-	if (item != NULL && jcat_item_has_target(item)) {
-		g_autofree gchar *checksum_sha256 = NULL;
-		g_autofree gchar *checksum_sha512 = NULL;
+	/* verified before using the same trust roots */
+	if (self->verify_cache != NULL && checksum_sha256 != NULL &&
+	    (item != NULL || img_sig != NULL) &&
+	    fu_cabinet_verify_cache_lookup(self->verify_cache, checksum_sha256, jcat_flags)) {
+		g_info("verified payload %s from cache", basename);
+		release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
+	} else if (item != NULL && jcat_item_has_target(item)) {
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) results = NULL;
 		g_autoptr(JcatBlob) blob_target_sha256 = NULL;
 		g_autoptr(JcatBlob) blob_target_sha512 = NULL;
 		g_autoptr(JcatItem) item_target = jcat_item_new(basename);
 
-		/* add SHA-256 */
-		checksum_sha256 =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-		if (checksum_sha256 == NULL)
-			return FALSE;
+		/* the jcat file signed the *checksum of the payload*, not the payload itself */
 		blob_target_sha256 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA256, checksum_sha256);
 		jcat_item_add_blob(item_target, blob_target_sha256);
 
 		/* add SHA-512 */
-		checksum_sha512 =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA512, error);
-		if (checksum_sha512 == NULL)
-			return FALSE;
-		blob_target_sha512 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA512, checksum_sha512);
+		blob_target_sha512 =
+		    jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA512,
+				       g_checksum_get_string(csum_by_kind[G_CHECKSUM_SHA512]));
 		jcat_item_add_blob(item_target, blob_target_sha512);
 
 		results =
@@ -264,6 +317,7 @@ fu_cabinet_parse_release(FuCabinet *self,
 		} else {
 			g_info("verified indirect payload %s: %u", basename, results->len);
 			release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
+			verified = TRUE;
 		}
 	} else if (item != NULL) {
 		g_autoptr(GBytes) blob = NULL;
@@ -285,48 +339,50 @@ fu_cabinet_parse_release(FuCabinet *self,
 		} else {
 			g_info("verified payload %s: %u", basename, results->len);
 			release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
+			verified = TRUE;
 		}
-
-	} else {
-		g_autofree gchar *basename_sig = NULL;
-		g_autoptr(FuFirmware) img_sig = NULL;
+	} else if (img_sig != NULL) {
+		g_autoptr(JcatResult) jcat_result = NULL;
+		g_autoptr(JcatBlob) jcat_blob = NULL;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GBytes) data_sig = NULL;
+		g_autoptr(GError) error_local = NULL;
 
 		/* legacy GPG detached signature */
-		basename_sig = g_strdup_printf("%s.asc", basename);
-		img_sig = fu_firmware_get_image_by_id(FU_FIRMWARE(FU_CAB_FIRMWARE(self)),
-						      basename_sig,
-						      NULL);
-		if (img_sig != NULL) {
-			g_autoptr(JcatResult) jcat_result = NULL;
-			g_autoptr(JcatBlob) jcat_blob = NULL;
-			g_autoptr(GBytes) blob = NULL;
-			g_autoptr(GBytes) data_sig = NULL;
-			g_autoptr(GError) error_local = NULL;
-
-			blob = fu_firmware_get_bytes(img_blob, error);
-			if (blob == NULL)
-				return FALSE;
-			data_sig = fu_firmware_get_bytes(img_sig, error);
-			if (data_sig == NULL)
-				return FALSE;
-			jcat_blob = jcat_blob_new(JCAT_BLOB_KIND_GPG, data_sig);
-			jcat_result = jcat_context_verify_blob(
-			    self->jcat_context,
-			    blob,
-			    jcat_blob,
-			    jcat_flags | JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-			    &error_local);
-			if (jcat_result == NULL) {
-				g_info("failed to verify payload %s using detached: %s",
-				       basename,
-				       error_local->message);
-			} else {
-				g_info("verified payload %s using detached", basename);
-				release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
-			}
+		blob = fu_firmware_get_bytes(img_blob, error);
+		if (blob == NULL)
+			return FALSE;
+		data_sig = fu_firmware_get_bytes(img_sig, error);
+		if (data_sig == NULL)
+			return FALSE;
+		jcat_blob = jcat_blob_new(JCAT_BLOB_KIND_GPG, data_sig);
+		jcat_result = jcat_context_verify_blob(self->jcat_context,
+						       blob,
+						       jcat_blob,
+						       jcat_flags |
+							   JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+						       &error_local);
+		if (jcat_result == NULL) {
+			g_info("failed to verify payload %s using detached: %s",
+			       basename,
+			       error_local->message);
+		} else {
+			g_info("verified payload %s using detached", basename);
+			release_flags |= FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD;
+			verified = TRUE;
 		}
 	}
 
+	/* remember for next time, but only successes */
+	if (verified && self->verify_cache != NULL && checksum_sha256 != NULL) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_cabinet_verify_cache_add(self->verify_cache,
+						 checksum_sha256,
+						 jcat_flags,
+						 &error_local))
+			g_warning("failed to save verify cache: %s", error_local->message);
+	}
+
 	/* this means we can get the data from fu_keyring_get_release_flags */
 	release_flags_blob = g_bytes_new(&release_flags, sizeof(release_flags));
 	xb_node_set_data(release, "fwupd::ReleaseFlags", release_flags_blob);
@@ -1097,6 +1153,8 @@ fu_cabinet_finalize(GObject *obj)
 	g_free(self->container_checksum_alt);
 	g_object_unref(self->jcat_context);
 	g_object_unref(self->jcat_file);
+	if (self->verify_cache != NULL)
+		g_object_unref(self->verify_cache);
 	G_OBJECT_CLASS(fu_cabinet_parent_class)->finalize(obj);
 }
 
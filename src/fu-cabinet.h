@@ -10,6 +10,7 @@
 #include <xmlb.h>
 
 #include "fu-cab-firmware.h"
+#include "fu-cabinet-verify-cache.h"
 
 #define FU_TYPE_CABINET (fu_cabinet_get_type())
 
@@ -31,6 +32,9 @@ FuCabinet *
 fu_cabinet_new(void);
 void
 fu_cabinet_set_jcat_context(FuCabinet *self, JcatContext *jcat_context) G_GNUC_NON_NULL(1);
+void
+fu_cabinet_set_verify_cache(FuCabinet *self, FuCabinetVerifyCache *verify_cache)
+    G_GNUC_NON_NULL(1);
 gboolean
 fu_cabinet_sign(FuCabinet *self,
 		GBytes *cert,
@@ -214,6 +214,8 @@ fu_dbus_daemon_create_request(FuDbusDaemon *self, const gchar *sender, GError **
 		if (locale != NULL)
 			fu_engine_request_set_locale(request, locale);
 		fu_engine_request_set_feature_flags(request, fu_client_get_feature_flags(client));
+		if (fu_client_get_feature_flags(client) & FWUPD_FEATURE_FLAG_PACKED_PAYLOADS)
+			converter_flags |= FWUPD_CODEC_FLAG_PACKED;
 	}
 
 	/* are we root and therefore trusted? */
@@ -244,6 +246,14 @@ fu_dbus_daemon_create_request(FuDbusDaemon *self, const gchar *sender, GError **
 	return g_object_ref(request);
 }
 
+/* releases and remotes never include trusted values */
+static GVariant *
+fu_dbus_daemon_array_to_variant(FuEngineRequest *request, GPtrArray *array)
+{
+	FwupdCodecFlags flags = fu_engine_request_get_converter_flags(request);
+	return fwupd_codec_array_to_variant(array, flags & FWUPD_CODEC_FLAG_PACKED);
+}
+
 static GVariant *
 fu_dbus_daemon_device_array_to_variant(FuDbusDaemon *self,
 				       FuEngineRequest *request,
@@ -1251,9 +1261,8 @@ fu_dbus_daemon_method_get_releases(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
+	g_dbus_method_invocation_return_value(invocation,
+					      fu_dbus_daemon_array_to_variant(request, releases));
 }
 
 static void
@@ -1325,6 +1334,25 @@ fu_dbus_daemon_method_get_report_metadata(FuDbusDaemon *self,
 	g_dbus_method_invocation_return_value(invocation, g_variant_new_tuple(&val, 1));
 }
 
+static void
+fu_dbus_daemon_method_get_trace(FuDbusDaemon *self,
+				GVariant *parameters,
+				FuEngineRequest *request,
+				GDBusMethodInvocation *invocation)
+{
+	g_autofree gchar *str = NULL;
+
+	if (!fu_trace_get_enabled()) {
+		g_dbus_method_invocation_return_error_literal(invocation,
+							      FWUPD_ERROR,
+							      FWUPD_ERROR_NOT_SUPPORTED,
+							      "tracing not enabled, use --trace");
+		return;
+	}
+	str = fu_trace_to_string();
+	g_dbus_method_invocation_return_value(invocation, g_variant_new("(s)", str));
+}
+
 static void
 fu_dbus_daemon_method_set_approved_firmware(FuDbusDaemon *self,
 					    GVariant *parameters,
@@ -1494,9 +1522,8 @@ fu_dbus_daemon_method_get_downgrades(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
+	g_dbus_method_invocation_return_value(invocation,
+					      fu_dbus_daemon_array_to_variant(request, releases));
 }
 
 static void
@@ -1516,9 +1543,8 @@ fu_dbus_daemon_method_get_upgrades(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
+	g_dbus_method_invocation_return_value(invocation,
+					      fu_dbus_daemon_array_to_variant(request, releases));
 }
 
 static void
@@ -1536,9 +1562,8 @@ fu_dbus_daemon_method_get_remotes(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(remotes, FWUPD_CODEC_FLAG_NONE));
+	g_dbus_method_invocation_return_value(invocation,
+					      fu_dbus_daemon_array_to_variant(request, remotes));
 }
 
 static void
@@ -1646,9 +1671,8 @@ fu_dbus_daemon_method_search(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
+	g_dbus_method_invocation_return_value(invocation,
+					      fu_dbus_daemon_array_to_variant(request, releases));
 }
 
 static void
@@ -2514,6 +2538,21 @@ typedef void (*FuDbusDaemonMethodFunc)(FuDbusDaemon *self,
 				       FuEngineRequest *request,
 				       GDBusMethodInvocation *invocation);
 
+typedef struct {
+	gchar *method_name;
+	gint64 trace_begin;
+} FuDbusDaemonTraceHelper;
+
+/* the invocation is only finalized when the method returns, which may be async */
+static void
+fu_dbus_daemon_method_trace_weak_notify_cb(gpointer user_data, GObject *where_the_object_was)
+{
+	FuDbusDaemonTraceHelper *helper = (FuDbusDaemonTraceHelper *)user_data;
+	fu_trace_end("dbus", helper->trace_begin, "%s", helper->method_name);
+	g_free(helper->method_name);
+	g_free(helper);
+}
+
 static void
 fu_dbus_daemon_method_call(GDBusConnection *connection,
 			   const gchar *sender,
@@ -2539,6 +2578,7 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 	    {"GetApprovedFirmware", fu_dbus_daemon_method_get_approved_firmware},
 	    {"GetBlockedFirmware", fu_dbus_daemon_method_get_blocked_firmware},
 	    {"GetReportMetadata", fu_dbus_daemon_method_get_report_metadata},
+	    {"GetTrace", fu_dbus_daemon_method_get_trace},
 	    {"SetApprovedFirmware", fu_dbus_daemon_method_set_approved_firmware},
 	    {"SetBlockedFirmware", fu_dbus_daemon_method_set_blocked_firmware},
 	    {"Quit", fu_dbus_daemon_method_quit},
@@ -2586,6 +2626,16 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 	/* activity */
 	fu_engine_idle_reset(engine);
 
+	/* record how long the method took to return */
+	if (fu_trace_get_enabled()) {
+		FuDbusDaemonTraceHelper *helper = g_new0(FuDbusDaemonTraceHelper, 1);
+		helper->method_name = g_strdup(method_name);
+		helper->trace_begin = fu_trace_begin();
+		g_object_weak_ref(G_OBJECT(invocation),
+				  fu_dbus_daemon_method_trace_weak_notify_cb,
+				  helper);
+	}
+
 	/* be helpful */
 	parameters_str = g_variant_print_string(parameters, NULL, TRUE);
 	g_debug("called %s%s", method_name, parameters_str->str);
@@ -23,6 +23,9 @@
  * has been changed. If the #FuDevice has changed during a device replug then
  * the ::changed signal will be emitted instead of ::added and then ::removed.
  *
+ * Readers never take the devices lock: every change to the list publishes a new immutable
+ * snapshot of the items, and lookups only need to take a reference to the current one.
+ *
  * See also: [class@FuDevice]
  */
 
@@ -31,8 +34,10 @@ fu_device_list_finalize(GObject *obj);
 
 struct _FuDeviceList {
 	GObject parent_instance;
-	GPtrArray *devices; /* of FuDeviceItem */
-	GRWLock devices_mutex;
+	GPtrArray *devices; /* of FuDeviceItem, only used by writers */
+	GMutex devices_mutex;
+	GPtrArray *snapshot; /* of FuDeviceListEntry, immutable once published */
+	GMutex snapshot_mutex;
 };
 
 enum { SIGNAL_ADDED, SIGNAL_REMOVED, SIGNAL_CHANGED, SIGNAL_LAST };
@@ -51,8 +56,17 @@ typedef struct {
 	FuDevice *device_old;
 	FuDeviceList *self; /* no ref */
 	guint remove_id;
+	gatomicrefcount refcount;
 } FuDeviceItem;
 
+/* a copy of the item at the time the snapshot was taken, so that readers see a consistent
+ * view even if the item is replaced or removed while they are using it */
+typedef struct {
+	FuDeviceItem *item;   /* ref */
+	FuDevice *device;     /* ref */
+	FuDevice *device_old; /* nullable, ref */
+} FuDeviceListEntry;
+
 static void
 fu_device_list_codec_iface_init(FwupdCodecInterface *iface);
 
@@ -86,38 +100,140 @@ fu_device_list_emit_device_changed(FuDeviceList *self, FuDevice *device)
 	g_signal_emit(self, signals[SIGNAL_CHANGED], 0, device);
 }
 
+static FuDeviceItem *
+fu_device_list_item_ref(FuDeviceItem *item)
+{
+	g_atomic_ref_count_inc(&item->refcount);
+	return item;
+}
+
 static void
-fu_device_list_add_string(FwupdCodec *codec, guint idt, GString *str)
+fu_device_list_item_unref(FuDeviceItem *item)
 {
-	FuDeviceList *self = FU_DEVICE_LIST(codec);
+	if (!g_atomic_ref_count_dec(&item->refcount))
+		return;
+	if (item->device_old != NULL)
+		g_object_unref(item->device_old);
+	if (item->device != NULL)
+		g_object_unref(item->device);
+	g_free(item);
+}
+
+/* the item may still be referenced by a snapshot, but it must never fire once removed */
+static void
+fu_device_list_item_release(FuDeviceItem *item)
+{
+	if (item->remove_id != 0) {
+		g_source_remove(item->remove_id);
+		item->remove_id = 0;
+	}
+	fu_device_list_item_unref(item);
+}
+
+static void
+fu_device_list_entry_free(FuDeviceListEntry *entry)
+{
+	fu_device_list_item_unref(entry->item);
+	g_object_unref(entry->device);
+	if (entry->device_old != NULL)
+		g_object_unref(entry->device_old);
+	g_free(entry);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuDeviceListEntry, fu_device_list_entry_free)
 
-	g_rw_lock_reader_lock(&self->devices_mutex);
+/* the copy keeps the item and devices alive after the snapshot has been dropped */
+static FuDeviceListEntry *
+fu_device_list_entry_dup(FuDeviceListEntry *entry)
+{
+	FuDeviceListEntry *entry_new = g_new0(FuDeviceListEntry, 1);
+	entry_new->item = fu_device_list_item_ref(entry->item);
+	entry_new->device = g_object_ref(entry->device);
+	if (entry->device_old != NULL)
+		entry_new->device_old = g_object_ref(entry->device_old);
+	return entry_new;
+}
+
+/* caller must hold devices_mutex */
+static void
+fu_device_list_snapshot_publish(FuDeviceList *self)
+{
+	GPtrArray *snapshot;
+	g_autoptr(GPtrArray) snapshot_old = NULL;
+
+	snapshot = g_ptr_array_new_full(self->devices->len,
+					(GDestroyNotify)fu_device_list_entry_free);
 	for (guint i = 0; i < self->devices->len; i++) {
 		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
+		FuDeviceListEntry *entry = g_new0(FuDeviceListEntry, 1);
+		entry->item = fu_device_list_item_ref(item);
+		entry->device = g_object_ref(item->device);
+		if (item->device_old != NULL)
+			entry->device_old = g_object_ref(item->device_old);
+		g_ptr_array_add(snapshot, entry);
+	}
+
+	/* swap, and drop the old snapshot when the last reader has finished with it */
+	g_mutex_lock(&self->snapshot_mutex);
+	snapshot_old = self->snapshot;
+	self->snapshot = snapshot;
+	g_mutex_unlock(&self->snapshot_mutex);
+}
+
+static void
+fu_device_list_snapshot_invalidate(FuDeviceList *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->devices_mutex);
+	fu_device_list_snapshot_publish(self);
+}
+
+/* the returned array must not be modified */
+static GPtrArray *
+fu_device_list_snapshot_ref(FuDeviceList *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->snapshot_mutex);
+	return g_ptr_array_ref(self->snapshot);
+}
+
+static void
+fu_device_list_remove_item(FuDeviceList *self, FuDeviceItem *item)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->devices_mutex);
+	if (g_ptr_array_remove(self->devices, item))
+		fu_device_list_snapshot_publish(self);
+}
+
+static void
+fu_device_list_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuDeviceList *self = FU_DEVICE_LIST(codec);
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
 		gboolean wfr;
 
 		g_string_append_printf(str,
 				       "%u [%p] %s\n",
 				       i,
-				       item,
-				       item->remove_id != 0 ? "IN_TIMEOUT" : "");
-		wfr = fu_device_has_flag(item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+				       entry->item,
+				       entry->item->remove_id != 0 ? "IN_TIMEOUT" : "");
+		wfr = fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
 		g_string_append_printf(str,
 				       "new: %s [%p] %s\n",
-				       fu_device_get_id(item->device),
-				       item->device,
+				       fu_device_get_id(entry->device),
+				       entry->device,
 				       wfr ? "WAIT_FOR_REPLUG" : "");
-		if (item->device_old != NULL) {
-			wfr =
-			    fu_device_has_flag(item->device_old, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+		if (entry->device_old != NULL) {
+			wfr = fu_device_has_flag(entry->device_old,
+						 FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
 			g_string_append_printf(str,
 					       "old: %s [%p] %s\n",
-					       fu_device_get_id(item->device_old),
-					       item->device_old,
+					       fu_device_get_id(entry->device_old),
+					       entry->device_old,
 					       wfr ? "WAIT_FOR_REPLUG" : "");
 		}
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
 }
 
 /* we cannot use fu_device_get_children() as this will not find "parent-only"
@@ -126,13 +242,12 @@ static GPtrArray *
 fu_device_list_get_children(FuDeviceList *self, FuDevice *device)
 {
 	GPtrArray *devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (device == fu_device_get_parent_internal(item->device))
-			g_ptr_array_add(devices, g_object_ref(item->device));
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (device == fu_device_get_parent_internal(entry->device))
+			g_ptr_array_add(devices, g_object_ref(entry->device));
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
 	return devices;
 }
 
@@ -195,21 +310,22 @@ GPtrArray *
 fu_device_list_get_all(FuDeviceList *self)
 {
 	GPtrArray *devices;
+	g_autoptr(GPtrArray) snapshot = NULL;
+
 	g_return_val_if_fail(FU_IS_DEVICE_LIST(self), NULL);
-	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		g_ptr_array_add(devices, g_object_ref(item->device));
+	snapshot = fu_device_list_snapshot_ref(self);
+	devices = g_ptr_array_new_full(snapshot->len, (GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		g_ptr_array_add(devices, g_object_ref(entry->device));
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == NULL)
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->device_old == NULL)
 			continue;
-		g_ptr_array_add(devices, g_object_ref(item->device_old));
+		g_ptr_array_add(devices, g_object_ref(entry->device_old));
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
 	return devices;
 }
 
@@ -229,84 +345,82 @@ GPtrArray *
 fu_device_list_get_active(FuDeviceList *self)
 {
 	GPtrArray *devices;
+	g_autoptr(GPtrArray) snapshot = NULL;
+
 	g_return_val_if_fail(FU_IS_DEVICE_LIST(self), NULL);
-	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (fu_device_has_private_flag_quark(item->device, quarks[QUARK_UNCONNECTED]))
+
+	snapshot = fu_device_list_snapshot_ref(self);
+	devices = g_ptr_array_new_full(snapshot->len, (GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (fu_device_has_private_flag_quark(entry->device, quarks[QUARK_UNCONNECTED]))
 			continue;
-		if (fu_device_has_inhibit(item->device, "hidden"))
+		if (fu_device_has_inhibit(entry->device, "hidden"))
 			continue;
-		g_ptr_array_add(devices, g_object_ref(item->device));
+		g_ptr_array_add(devices, g_object_ref(entry->device));
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
 	return devices;
 }
 
-static FuDeviceItem *
+static FuDeviceListEntry *
 fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device == device)
-			return item;
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->device == device)
+			return fu_device_list_entry_dup(entry);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == device)
-			return item;
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->device_old == device)
+			return fu_device_list_entry_dup(entry);
 	}
 	return NULL;
 }
 
-static FuDeviceItem *
+static FuDeviceListEntry *
 fu_device_list_find_by_guid(FuDeviceList *self, const gchar *guid)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (fu_device_has_guid(item->device, guid))
-			return item;
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (fu_device_has_guid(entry->device, guid))
+			return fu_device_list_entry_dup(entry);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == NULL)
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->device_old == NULL)
 			continue;
-		if (fu_device_has_guid(item->device_old, guid))
-			return item;
+		if (fu_device_has_guid(entry->device_old, guid))
+			return fu_device_list_entry_dup(entry);
 	}
 	return NULL;
 }
 
-static FuDeviceItem *
+static FuDeviceListEntry *
 fu_device_list_find_by_connection(FuDeviceList *self,
 				  const gchar *physical_id,
 				  const gchar *logical_id)
 {
-	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(GPtrArray) snapshot = NULL;
 	if (physical_id == NULL)
 		return NULL;
-	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
+	snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		FuDevice *device = entry->device;
+		if (g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
 		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
+			return fu_device_list_entry_dup(entry);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device_old;
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		FuDevice *device = entry->device_old;
 		if (device != NULL &&
 		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
 		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
+			return fu_device_list_entry_dup(entry);
 	}
 	return NULL;
 }
@@ -314,20 +428,20 @@ fu_device_list_find_by_connection(FuDeviceList *self,
 static gint
 fu_device_list_item_sort_by_priority_cb(gconstpointer a, gconstpointer b)
 {
-	const FuDeviceItem *item1 = *((FuDeviceItem **)a);
-	const FuDeviceItem *item2 = *((FuDeviceItem **)b);
-	if (fu_device_get_priority(item1->device) < fu_device_get_priority(item2->device))
+	const FuDeviceListEntry *entry1 = *((FuDeviceListEntry **)a);
+	const FuDeviceListEntry *entry2 = *((FuDeviceListEntry **)b);
+	if (fu_device_get_priority(entry1->device) < fu_device_get_priority(entry2->device))
 		return 1;
-	if (fu_device_get_priority(item1->device) > fu_device_get_priority(item2->device))
+	if (fu_device_get_priority(entry1->device) > fu_device_get_priority(entry2->device))
 		return -1;
 	return 0;
 }
 
 static GPtrArray *
-fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError **error)
+fu_device_list_filter_by_id(GPtrArray *snapshot, const gchar *device_id, GError **error)
 {
 	gsize device_id_len;
-	g_autoptr(GPtrArray) items = g_ptr_array_new();
+	g_autoptr(GPtrArray) entries = g_ptr_array_new();
 
 	g_return_val_if_fail(device_id != NULL, NULL);
 
@@ -341,45 +455,41 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 			    device_id);
 		return NULL;
 	}
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		const gchar *ids[] = {fu_device_get_id(item_tmp->device),
-				      fu_device_get_equivalent_id(item_tmp->device),
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		const gchar *ids[] = {fu_device_get_id(entry->device),
+				      fu_device_get_equivalent_id(entry->device),
 				      NULL};
 		for (guint j = 0; ids[j] != NULL; j++) {
 			if (strncmp(ids[j], device_id, device_id_len) == 0) {
-				g_ptr_array_add(items, item_tmp);
+				g_ptr_array_add(entries, entry);
 				break;
 			}
 		}
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
-	if (items->len > 0) {
-		g_ptr_array_sort(items, fu_device_list_item_sort_by_priority_cb);
-		return g_steal_pointer(&items);
+	if (entries->len > 0) {
+		g_ptr_array_sort(entries, fu_device_list_item_sort_by_priority_cb);
+		return g_steal_pointer(&entries);
 	}
 
 	/* only search old devices if we didn't find the active device */
-	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
 		const gchar *ids[3] = {NULL};
-		if (item_tmp->device_old == NULL)
+		if (entry->device_old == NULL)
 			continue;
-		ids[0] = fu_device_get_id(item_tmp->device_old);
-		ids[1] = fu_device_get_equivalent_id(item_tmp->device_old);
+		ids[0] = fu_device_get_id(entry->device_old);
+		ids[1] = fu_device_get_equivalent_id(entry->device_old);
 		for (guint j = 0; ids[j] != NULL; j++) {
 			if (strncmp(ids[j], device_id, device_id_len) == 0) {
-				g_ptr_array_add(items, item_tmp);
+				g_ptr_array_add(entries, entry);
 				break;
 			}
 		}
 	}
-	g_rw_lock_reader_unlock(&self->devices_mutex);
-	if (items->len > 0) {
-		g_ptr_array_sort(items, fu_device_list_item_sort_by_priority_cb);
-		return g_steal_pointer(&items);
+	if (entries->len > 0) {
+		g_ptr_array_sort(entries, fu_device_list_item_sort_by_priority_cb);
+		return g_steal_pointer(&entries);
 	}
 
 	/* failed */
@@ -391,22 +501,23 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 	return NULL;
 }
 
-static FuDeviceItem *
+static FuDeviceListEntry *
 fu_device_list_find_by_id(FuDeviceList *self, const gchar *device_id, GError **error)
 {
-	FuDeviceItem *item0;
-	g_autoptr(GPtrArray) items = NULL;
+	FuDeviceListEntry *entry0;
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	g_autoptr(GPtrArray) entries = NULL;
 
-	items = fu_device_list_filter_by_id(self, device_id, error);
-	if (items == NULL)
+	entries = fu_device_list_filter_by_id(snapshot, device_id, error);
+	if (entries == NULL)
 		return NULL;
 
 	/* check there are not more devices that have the same priority */
-	item0 = g_ptr_array_index(items, 0);
-	for (guint i = 1; i < items->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(items, i);
-		if (fu_device_get_priority(item_tmp->device) ==
-		    fu_device_get_priority(item0->device)) {
+	entry0 = g_ptr_array_index(entries, 0);
+	for (guint i = 1; i < entries->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(entries, i);
+		if (fu_device_get_priority(entry->device) ==
+		    fu_device_get_priority(entry0->device)) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
@@ -415,7 +526,7 @@ fu_device_list_find_by_id(FuDeviceList *self, const gchar *device_id, GError **e
 			return NULL;
 		}
 	}
-	return item0;
+	return fu_device_list_entry_dup(entry0);
 }
 
 /**
@@ -432,47 +543,46 @@ fu_device_list_find_by_id(FuDeviceList *self, const gchar *device_id, GError **e
 FuDevice *
 fu_device_list_get_old(FuDeviceList *self, FuDevice *device)
 {
-	FuDeviceItem *item = fu_device_list_find_by_device(self, device);
-	if (item == NULL)
+	g_autoptr(FuDeviceListEntry) entry = fu_device_list_find_by_device(self, device);
+	if (entry == NULL)
 		return NULL;
-	if (item->device_old == NULL)
+	if (entry->device_old == NULL)
 		return NULL;
-	return g_object_ref(item->device_old);
+	return g_object_ref(entry->device_old);
 }
 
-static FuDeviceItem *
+static FuDeviceListEntry *
 fu_device_list_get_by_guids_removed(FuDeviceList *self, GPtrArray *guids)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->remove_id == 0)
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->item->remove_id == 0)
 			continue;
 		for (guint j = 0; j < guids->len; j++) {
 			const gchar *guid = g_ptr_array_index(guids, j);
-			if (fu_device_has_guid(item->device, guid) ||
-			    fu_device_has_instance_id(item->device,
+			if (fu_device_has_guid(entry->device, guid) ||
+			    fu_device_has_instance_id(entry->device,
 						      guid,
 						      FU_DEVICE_INSTANCE_FLAG_COUNTERPART |
 							  FU_DEVICE_INSTANCE_FLAG_VISIBLE))
-				return item;
+				return fu_device_list_entry_dup(entry);
 		}
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
-		if (item->device_old == NULL)
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (entry->device_old == NULL)
 			continue;
-		if (item->remove_id == 0)
+		if (entry->item->remove_id == 0)
 			continue;
 		for (guint j = 0; j < guids->len; j++) {
 			const gchar *guid = g_ptr_array_index(guids, j);
-			if (fu_device_has_guid(item->device_old, guid) ||
-			    fu_device_has_instance_id(item->device_old,
+			if (fu_device_has_guid(entry->device_old, guid) ||
+			    fu_device_has_instance_id(entry->device_old,
 						      guid,
 						      FU_DEVICE_INSTANCE_FLAG_COUNTERPART |
 							  FU_DEVICE_INSTANCE_FLAG_VISIBLE))
-				return item;
+				return fu_device_list_entry_dup(entry);
 		}
 	}
 	return NULL;
@@ -493,25 +603,22 @@ fu_device_list_device_delayed_remove_cb(gpointer user_data)
 		GPtrArray *children = fu_device_get_children(item->device);
 		for (guint j = 0; j < children->len; j++) {
 			FuDevice *child = g_ptr_array_index(children, j);
-			FuDeviceItem *child_item;
-			child_item = fu_device_list_find_by_id(self, fu_device_get_id(child), NULL);
-			if (child_item == NULL) {
+			g_autoptr(FuDeviceListEntry) child_entry = NULL;
+			child_entry =
+			    fu_device_list_find_by_id(self, fu_device_get_id(child), NULL);
+			if (child_entry == NULL) {
 				g_info("device %s not found", fu_device_get_id(child));
 				continue;
 			}
 			fu_device_list_emit_device_removed(self, child);
-			g_rw_lock_writer_lock(&self->devices_mutex);
-			g_ptr_array_remove(self->devices, child_item);
-			g_rw_lock_writer_unlock(&self->devices_mutex);
+			fu_device_list_remove_item(self, child_entry->item);
 		}
 	}
 
 	/* just remove now */
 	g_info("doing delayed removal");
 	fu_device_list_emit_device_removed(self, item->device);
-	g_rw_lock_writer_lock(&self->devices_mutex);
-	g_ptr_array_remove(self->devices, item);
-	g_rw_lock_writer_unlock(&self->devices_mutex);
+	fu_device_list_remove_item(self, item);
 	return G_SOURCE_REMOVE;
 }
 
@@ -561,16 +668,18 @@ void
 fu_device_list_remove(FuDeviceList *self, FuDevice *device)
 {
 	FuDeviceItem *item;
+	g_autoptr(FuDeviceListEntry) entry = NULL;
 
 	g_return_if_fail(FU_IS_DEVICE_LIST(self));
 	g_return_if_fail(FU_IS_DEVICE(device));
 
 	/* check the device already exists */
-	item = fu_device_list_find_by_id(self, fu_device_get_id(device), NULL);
-	if (item == NULL) {
+	entry = fu_device_list_find_by_id(self, fu_device_get_id(device), NULL);
+	if (entry == NULL) {
 		g_info("device %s not found", fu_device_get_id(device));
 		return;
 	}
+	item = entry->item;
 
 	/* we can't do anything with an unconnected device */
 	fu_device_add_private_flag(item->device, FU_DEVICE_PRIVATE_FLAG_UNCONNECTED);
@@ -593,24 +702,21 @@ fu_device_list_remove(FuDeviceList *self, FuDevice *device)
 		GPtrArray *children = fu_device_get_children(device);
 		for (guint j = 0; j < children->len; j++) {
 			FuDevice *child = g_ptr_array_index(children, j);
-			FuDeviceItem *child_item;
-			child_item = fu_device_list_find_by_id(self, fu_device_get_id(child), NULL);
-			if (child_item == NULL) {
+			g_autoptr(FuDeviceListEntry) child_entry = NULL;
+			child_entry =
+			    fu_device_list_find_by_id(self, fu_device_get_id(child), NULL);
+			if (child_entry == NULL) {
 				g_info("device %s not found", fu_device_get_id(child));
 				continue;
 			}
 			fu_device_list_emit_device_removed(self, child);
-			g_rw_lock_writer_lock(&self->devices_mutex);
-			g_ptr_array_remove(self->devices, child_item);
-			g_rw_lock_writer_unlock(&self->devices_mutex);
+			fu_device_list_remove_item(self, child_entry->item);
 		}
 	}
 
 	/* remove right now */
 	fu_device_list_emit_device_removed(self, item->device);
-	g_rw_lock_writer_lock(&self->devices_mutex);
-	g_ptr_array_remove(self->devices, item);
-	g_rw_lock_writer_unlock(&self->devices_mutex);
+	fu_device_list_remove_item(self, item);
 }
 
 /**
@@ -624,11 +730,13 @@ fu_device_list_remove(FuDeviceList *self, FuDevice *device)
 void
 fu_device_list_remove_all(FuDeviceList *self)
 {
+	g_autoptr(GMutexLocker) locker = NULL;
+
 	g_return_if_fail(FU_IS_DEVICE_LIST(self));
 
-	g_rw_lock_writer_lock(&self->devices_mutex);
+	locker = g_mutex_locker_new(&self->devices_mutex);
 	g_ptr_array_set_size(self->devices, 0);
-	g_rw_lock_writer_unlock(&self->devices_mutex);
+	fu_device_list_snapshot_publish(self);
 }
 
 static void
@@ -657,20 +765,6 @@ fu_device_list_add_missing_guids(FuDevice *device_new, FuDevice *device_old)
 	}
 }
 
-static void
-fu_device_list_item_finalized_cb(gpointer data, GObject *where_the_object_was)
-{
-	FuDeviceItem *item = (FuDeviceItem *)data;
-	FuDeviceList *self = FU_DEVICE_LIST(item->self);
-
-	g_critical("FuDevice %p was finalized without being removed from "
-		   "FuDeviceList, removing item!",
-		   where_the_object_was);
-	g_rw_lock_writer_lock(&self->devices_mutex);
-	g_ptr_array_remove(self->devices, item);
-	g_rw_lock_writer_unlock(&self->devices_mutex);
-}
-
 static void
 fu_device_list_item_set_device_old(FuDeviceItem *item, FuDevice *device)
 {
@@ -679,19 +773,6 @@ fu_device_list_item_set_device_old(FuDeviceItem *item, FuDevice *device)
 	g_set_object(&item->device_old, device);
 }
 
-/* this should never be required, and yet here we are */
-static void
-fu_device_list_item_set_device(FuDeviceItem *item, FuDevice *device)
-{
-	if (item->device != NULL) {
-		g_object_weak_unref(G_OBJECT(item->device), fu_device_list_item_finalized_cb, item);
-	}
-	if (device != NULL) {
-		g_object_weak_ref(G_OBJECT(device), fu_device_list_item_finalized_cb, item);
-	}
-	g_set_object(&item->device, device);
-}
-
 static void
 fu_device_list_clear_wait_for_replug(FuDeviceList *self, FuDeviceItem *item)
 {
@@ -720,6 +801,9 @@ fu_device_list_clear_wait_for_replug(FuDeviceList *self, FuDeviceItem *item)
 	/* debug */
 	str = fwupd_codec_to_string(FWUPD_CODEC(self));
 	g_debug("%s", str);
+
+	/* anything in fu_device_list_wait_for() can now re-check */
+	g_main_context_wakeup(NULL);
 }
 
 /* nocheck:name */
@@ -809,7 +893,8 @@ fu_device_list_replace(FuDeviceList *self, FuDeviceItem *item, FuDevice *device)
 
 	/* assign the new device */
 	fu_device_list_item_set_device_old(item, item->device);
-	fu_device_list_item_set_device(item, device);
+	g_set_object(&item->device, device);
+	fu_device_list_snapshot_invalidate(self);
 	fu_device_list_emit_device_changed(self, device);
 
 	/* debug */
@@ -846,6 +931,9 @@ void
 fu_device_list_add(FuDeviceList *self, FuDevice *device)
 {
 	FuDeviceItem *item;
+	g_autoptr(FuDeviceListEntry) entry = NULL;
+	g_autoptr(FuDeviceListEntry) entry_connection = NULL;
+	g_autoptr(FuDeviceListEntry) entry_removed = NULL;
 
 	g_return_if_fail(FU_IS_DEVICE_LIST(self));
 	g_return_if_fail(FU_IS_DEVICE(device));
@@ -854,8 +942,9 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	fu_device_convert_instance_ids(device);
 
 	/* is the device waiting to be replugged? */
-	item = fu_device_list_find_by_id(self, fu_device_get_id(device), NULL);
-	if (item != NULL) {
+	entry = fu_device_list_find_by_id(self, fu_device_get_id(device), NULL);
+	if (entry != NULL) {
+		item = entry->item;
 		/* literally the same object */
 		if (device == item->device) {
 			g_info("found existing device %s", fu_device_get_id(device));
@@ -875,7 +964,8 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 					      FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR |
 						  FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR);
 			g_set_object(&item->device_old, item->device);
-			fu_device_list_item_set_device(item, device);
+			g_set_object(&item->device, device);
+			fu_device_list_snapshot_invalidate(self);
 			fu_device_list_clear_wait_for_replug(self, item);
 			fu_device_list_emit_device_changed(self, device);
 			return;
@@ -902,10 +992,11 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	}
 
 	/* verify a device with same connection does not already exist */
-	item = fu_device_list_find_by_connection(self,
-						 fu_device_get_physical_id(device),
-						 fu_device_get_logical_id(device));
-	if (item != NULL && item->remove_id != 0) {
+	entry_connection = fu_device_list_find_by_connection(self,
+							     fu_device_get_physical_id(device),
+							     fu_device_get_logical_id(device));
+	if (entry_connection != NULL && entry_connection->item->remove_id != 0) {
+		item = entry_connection->item;
 		g_info("found physical device %s recently removed, reusing "
 		       "item from plugin %s for plugin %s",
 		       fu_device_get_id(item->device),
@@ -917,12 +1008,13 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	}
 
 	/* verify a compatible device does not already exist */
-	item = fu_device_list_get_by_guids_removed(self, fu_device_get_guids(device));
-	if (item == NULL) {
+	entry_removed = fu_device_list_get_by_guids_removed(self, fu_device_get_guids(device));
+	if (entry_removed == NULL) {
 		g_autoptr(GPtrArray) guids = fu_device_get_counterpart_guids(device);
-		item = fu_device_list_get_by_guids_removed(self, guids);
+		entry_removed = fu_device_list_get_by_guids_removed(self, guids);
 	}
-	if (item != NULL) {
+	if (entry_removed != NULL) {
+		item = entry_removed->item;
 		if (fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_REPLUG_MATCH_GUID)) {
 			g_info("found compatible device %s recently removed, reusing "
 			       "item from plugin %s for plugin %s",
@@ -944,11 +1036,14 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	/* add helper */
 	item = g_new0(FuDeviceItem, 1);
 	item->self = self; /* no ref */
-	fu_device_list_item_set_device(item, device);
-	g_rw_lock_writer_lock(&self->devices_mutex);
+	g_atomic_ref_count_init(&item->refcount);
+	g_set_object(&item->device, device);
+	g_mutex_lock(&self->devices_mutex);
 	g_ptr_array_add(self->devices, item);
-	g_rw_lock_writer_unlock(&self->devices_mutex);
+	fu_device_list_snapshot_publish(self);
+	g_mutex_unlock(&self->devices_mutex);
 	fu_device_list_emit_device_added(self, device);
+	g_main_context_wakeup(NULL);
 }
 
 /**
@@ -966,13 +1061,13 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 FuDevice *
 fu_device_list_get_by_guid(FuDeviceList *self, const gchar *guid, GError **error)
 {
-	FuDeviceItem *item;
+	g_autoptr(FuDeviceListEntry) entry = NULL;
 	g_return_val_if_fail(FU_IS_DEVICE_LIST(self), NULL);
 	g_return_val_if_fail(guid != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
-	item = fu_device_list_find_by_guid(self, guid);
-	if (item != NULL)
-		return g_object_ref(item->device);
+	entry = fu_device_list_find_by_guid(self, guid);
+	if (entry != NULL)
+		return g_object_ref(entry->device);
 	g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "GUID %s was not found", guid);
 	return NULL;
 }
@@ -981,15 +1076,61 @@ static GPtrArray *
 fu_device_list_get_wait_for_replug(FuDeviceList *self)
 {
 	GPtrArray *devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		if (fu_device_has_flag(item_tmp->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
-		    !fu_device_has_flag(item_tmp->device, FWUPD_DEVICE_FLAG_EMULATED))
-			g_ptr_array_add(devices, g_object_ref(item_tmp->device));
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
+		    !fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_EMULATED))
+			g_ptr_array_add(devices, g_object_ref(entry->device));
 	}
 	return devices;
 }
 
+static gboolean
+fu_device_list_has_no_wait_for_replug_cb(FuDeviceList *self, gpointer user_data)
+{
+	g_autoptr(GPtrArray) snapshot = fu_device_list_snapshot_ref(self);
+	for (guint i = 0; i < snapshot->len; i++) {
+		FuDeviceListEntry *entry = g_ptr_array_index(snapshot, i);
+		if (fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
+		    !fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_EMULATED))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+typedef gboolean (*FuDeviceListWaitFunc)(FuDeviceList *self, gpointer user_data);
+
+static gboolean
+fu_device_list_wait_for_timeout_cb(gpointer user_data)
+{
+	gboolean *timed_out = (gboolean *)user_data;
+	*timed_out = TRUE;
+	return G_SOURCE_REMOVE;
+}
+
+/* sleeps in the default main context until @func returns TRUE or the timeout expires -- the
+ * device list wakes the context when a device is added or comes back, and nothing is polled */
+static gboolean
+fu_device_list_wait_for(FuDeviceList *self,
+			guint timeout_ms,
+			FuDeviceListWaitFunc func,
+			gpointer user_data)
+{
+	gboolean timed_out = FALSE;
+	g_autoptr(GSource) source = g_timeout_source_new(timeout_ms);
+
+	g_source_set_callback(source, fu_device_list_wait_for_timeout_cb, &timed_out, NULL);
+	g_source_attach(source, NULL);
+	while (!func(self, user_data)) {
+		if (timed_out)
+			return FALSE;
+		g_main_context_iteration(NULL, TRUE);
+	}
+	g_source_destroy(source);
+	return TRUE;
+}
+
 /**
  * fu_device_list_wait_for_replug:
  * @self: a device list
@@ -1007,7 +1148,6 @@ gboolean
 fu_device_list_wait_for_replug(FuDeviceList *self, GError **error)
 {
 	guint remove_delay = 0;
-	g_autoptr(GTimer) timer = g_timer_new();
 	g_autoptr(GPtrArray) devices_wfr1 = NULL;
 	g_autoptr(GPtrArray) devices_wfr2 = NULL;
 
@@ -1039,16 +1179,7 @@ fu_device_list_wait_for_replug(FuDeviceList *self, GError **error)
 	}
 
 	/* time to unplug and then re-plug */
-	do {
-		g_autoptr(GPtrArray) devices_wfr_tmp = NULL;
-		g_usleep(1000);
-		while (g_main_context_iteration(NULL, FALSE)) {
-			/* nothing needs to be done here */
-		};
-		devices_wfr_tmp = fu_device_list_get_wait_for_replug(self);
-		if (devices_wfr_tmp->len == 0)
-			break;
-	} while (g_timer_elapsed(timer, NULL) * 1000.f < remove_delay);
+	fu_device_list_wait_for(self, remove_delay, fu_device_list_has_no_wait_for_replug_cb, NULL);
 
 	/* check that no other devices are still waiting for replug */
 	devices_wfr2 = fu_device_list_get_wait_for_replug(self);
@@ -1081,6 +1212,66 @@ fu_device_list_wait_for_replug(FuDeviceList *self, GError **error)
 	return TRUE;
 }
 
+typedef struct {
+	const gchar *id;
+	FuDevice *device;
+} FuDeviceListWaitHelper;
+
+static gboolean
+fu_device_list_has_device_cb(FuDeviceList *self, gpointer user_data)
+{
+	FuDeviceListWaitHelper *helper = (FuDeviceListWaitHelper *)user_data;
+	g_autoptr(FuDeviceListEntry) entry = NULL;
+
+	entry = fwupd_guid_is_valid(helper->id) ? fu_device_list_find_by_guid(self, helper->id)
+						: fu_device_list_find_by_id(self, helper->id, NULL);
+	if (entry == NULL)
+		return FALSE;
+	if (fu_device_has_flag(entry->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) ||
+	    fu_device_has_private_flag(entry->device, FU_DEVICE_PRIVATE_FLAG_UNCONNECTED))
+		return FALSE;
+	g_set_object(&helper->device, entry->device);
+	return TRUE;
+}
+
+/**
+ * fu_device_list_wait_for_device:
+ * @self: a device list
+ * @id: a device ID or GUID
+ * @timeout_ms: the maximum time to wait, in milliseconds
+ * @error: (nullable): optional return location for an error
+ *
+ * Waits for a device matching the ID or GUID to be added to the list, or to come back if it is
+ * currently being replugged.
+ *
+ * Returns: (transfer full): a device, or %NULL if it did not appear in time
+ *
+ * Since: 2.1.1
+ **/
+FuDevice *
+fu_device_list_wait_for_device(FuDeviceList *self,
+			       const gchar *id,
+			       guint timeout_ms,
+			       GError **error)
+{
+	FuDeviceListWaitHelper helper = {.id = id};
+
+	g_return_val_if_fail(FU_IS_DEVICE_LIST(self), NULL);
+	g_return_val_if_fail(id != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (!fu_device_list_wait_for(self, timeout_ms, fu_device_list_has_device_cb, &helper)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "device %s did not appear within %ums",
+			    id,
+			    timeout_ms);
+		return NULL;
+	}
+	return helper.device;
+}
+
 /**
  * fu_device_list_get_by_id:
  * @self: a device list
@@ -1097,30 +1288,19 @@ fu_device_list_wait_for_replug(FuDeviceList *self, GError **error)
 FuDevice *
 fu_device_list_get_by_id(FuDeviceList *self, const gchar *device_id, GError **error)
 {
-	FuDeviceItem *item;
+	g_autoptr(FuDeviceListEntry) entry = NULL;
 
 	g_return_val_if_fail(FU_IS_DEVICE_LIST(self), NULL);
 	g_return_val_if_fail(device_id != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	/* multiple things matched */
-	item = fu_device_list_find_by_id(self, device_id, error);
-	if (item == NULL)
+	entry = fu_device_list_find_by_id(self, device_id, error);
+	if (entry == NULL)
 		return NULL;
 
 	/* something found */
-	return g_object_ref(item->device);
-}
-
-static void
-fu_device_list_item_free(FuDeviceItem *item)
-{
-	if (item->remove_id != 0)
-		g_source_remove(item->remove_id);
-	if (item->device_old != NULL)
-		g_object_unref(item->device_old);
-	fu_device_list_item_set_device(item, NULL);
-	g_free(item);
+	return g_object_ref(entry->device);
 }
 
 static void
@@ -1134,8 +1314,11 @@ fu_device_list_dispose(GObject *obj)
 {
 	FuDeviceList *self = FU_DEVICE_LIST(obj);
 
-	if (self->devices != NULL)
+	if (self->devices != NULL) {
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->devices_mutex);
 		g_ptr_array_set_size(self->devices, 0);
+		fu_device_list_snapshot_publish(self);
+	}
 
 	G_OBJECT_CLASS(fu_device_list_parent_class)->dispose(obj);
 }
@@ -1206,8 +1389,10 @@ fu_device_list_class_init(FuDeviceListClass *klass)
 static void
 fu_device_list_init(FuDeviceList *self)
 {
-	self->devices = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_item_free);
-	g_rw_lock_init(&self->devices_mutex);
+	self->devices = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_item_release);
+	self->snapshot = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_entry_free);
+	g_mutex_init(&self->devices_mutex);
+	g_mutex_init(&self->snapshot_mutex);
 }
 
 static void
@@ -1215,7 +1400,9 @@ fu_device_list_finalize(GObject *obj)
 {
 	FuDeviceList *self = FU_DEVICE_LIST(obj);
 
-	g_rw_lock_clear(&self->devices_mutex);
+	g_mutex_clear(&self->devices_mutex);
+	g_mutex_clear(&self->snapshot_mutex);
+	g_ptr_array_unref(self->snapshot);
 	g_ptr_array_unref(self->devices);
 
 	G_OBJECT_CLASS(fu_device_list_parent_class)->finalize(obj);
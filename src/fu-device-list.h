@@ -33,5 +33,10 @@ fu_device_list_get_by_guid(FuDeviceList *self, const gchar *guid, GError **error
     G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_device_list_wait_for_replug(FuDeviceList *self, GError **error) G_GNUC_NON_NULL(1);
+FuDevice *
+fu_device_list_wait_for_device(FuDeviceList *self,
+			       const gchar *id,
+			       guint timeout_ms,
+			       GError **error) G_GNUC_NON_NULL(1, 2);
 void
 fu_device_list_depsolve_order(FuDeviceList *self, FuDevice *device) G_GNUC_NON_NULL(1, 2);
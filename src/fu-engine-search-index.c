@@ -0,0 +1,335 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuEngine"
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fu-engine-search-index.h"
+
+/*
+ * Searching the silo with XPath has to visit every component for the name and developer name
+ * substring matches, and each query is run in turn. The index is built once per silo and maps
+ * each token to the components that contain it, so a search is a couple of hash lookups.
+ *
+ * Values such as IDs, GUIDs and checksums are matched exactly, and the name and developer name
+ * are split into case-folded words which match any prefix of at least three characters.
+ */
+
+#define FU_ENGINE_SEARCH_INDEX_PREFIX_MIN 3
+
+struct _FuEngineSearchIndex {
+	GObject parent_instance;
+	GPtrArray *components; /* (element-type XbNode) */
+	GHashTable *values;    /* (element-type utf8 GPtrArray) of XbNode, no ref */
+	GHashTable *words;     /* (element-type utf8 GPtrArray) of XbNode, no ref */
+};
+
+G_DEFINE_TYPE(FuEngineSearchIndex, fu_engine_search_index, G_TYPE_OBJECT)
+
+typedef void (*FuEngineSearchIndexAddFunc)(FuEngineSearchIndex *self,
+					   XbNode *n,
+					   XbNode *component);
+
+static void
+fu_engine_search_index_add(GHashTable *hash, const gchar *token, XbNode *component)
+{
+	GPtrArray *components = g_hash_table_lookup(hash, token);
+	if (components == NULL) {
+		components = g_ptr_array_new();
+		g_hash_table_insert(hash, g_strdup(token), components);
+	}
+
+	/* each component is added in one go, so only the last entry can be a duplicate */
+	if (components->len > 0 &&
+	    g_ptr_array_index(components, components->len - 1) == (gpointer)component)
+		return;
+	g_ptr_array_add(components, component);
+}
+
+static void
+fu_engine_search_index_add_value(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	const gchar *text = xb_node_get_text(n);
+	if (text == NULL)
+		return;
+	fu_engine_search_index_add(self->values, text, component);
+}
+
+static void
+fu_engine_search_index_add_words(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	const gchar *text = xb_node_get_text(n);
+	g_auto(GStrv) words = NULL;
+
+	if (text == NULL)
+		return;
+	words = g_str_tokenize_and_fold(text, NULL, NULL);
+	for (guint i = 0; words[i] != NULL; i++) {
+		gsize wordsz = strlen(words[i]);
+		fu_engine_search_index_add(self->words, words[i], component);
+		for (gsize j = FU_ENGINE_SEARCH_INDEX_PREFIX_MIN; j < wordsz; j++) {
+			g_autofree gchar *prefix = g_strndup(words[i], j);
+			fu_engine_search_index_add(self->words, prefix, component);
+		}
+	}
+}
+
+/* calls @func for each child of @n called @element */
+static void
+fu_engine_search_index_add_children(FuEngineSearchIndex *self,
+				    XbNode *n,
+				    const gchar *element,
+				    FuEngineSearchIndexAddFunc func,
+				    XbNode *component)
+{
+	g_autoptr(GPtrArray) children = xb_node_get_children(n);
+	for (guint i = 0; i < children->len; i++) {
+		XbNode *c = g_ptr_array_index(children, i);
+		if (g_strcmp0(xb_node_get_element(c), element) == 0)
+			func(self, c, component);
+	}
+}
+
+static void
+fu_engine_search_index_add_provides(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	if (g_strcmp0(xb_node_get_attr(n, "type"), "flashed") != 0)
+		return;
+	fu_engine_search_index_add_value(self, n, component);
+}
+
+static void
+fu_engine_search_index_add_artifact(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "filename",
+					    fu_engine_search_index_add_value,
+					    component);
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "checksum",
+					    fu_engine_search_index_add_value,
+					    component);
+}
+
+static void
+fu_engine_search_index_add_artifacts(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "artifact",
+					    fu_engine_search_index_add_artifact,
+					    component);
+}
+
+static void
+fu_engine_search_index_add_issues(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "issue",
+					    fu_engine_search_index_add_value,
+					    component);
+}
+
+static void
+fu_engine_search_index_add_release(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "artifacts",
+					    fu_engine_search_index_add_artifacts,
+					    component);
+	fu_engine_search_index_add_children(self,
+					    n,
+					    "issues",
+					    fu_engine_search_index_add_issues,
+					    component);
+}
+
+static void
+fu_engine_search_index_add_custom_value(FuEngineSearchIndex *self, XbNode *n, XbNode *component)
+{
+	if (g_strcmp0(xb_node_get_attr(n, "key"), "LVFS::UpdateProtocol") != 0)
+		return;
+	fu_engine_search_index_add_value(self, n, component);
+}
+
+static void
+fu_engine_search_index_add_component(FuEngineSearchIndex *self, XbNode *component)
+{
+	g_autoptr(GPtrArray) children = xb_node_get_children(component);
+
+	/* walk the tree directly as running an XPath query per component is slow */
+	for (guint i = 0; i < children->len; i++) {
+		XbNode *c = g_ptr_array_index(children, i);
+		const gchar *element = xb_node_get_element(c);
+		if (g_strcmp0(element, "id") == 0) {
+			fu_engine_search_index_add_value(self, c, component);
+		} else if (g_strcmp0(element, "name") == 0 ||
+			   g_strcmp0(element, "developer_name") == 0) {
+			fu_engine_search_index_add_words(self, c, component);
+		} else if (g_strcmp0(element, "provides") == 0) {
+			fu_engine_search_index_add_children(self,
+							    c,
+							    "firmware",
+							    fu_engine_search_index_add_provides,
+							    component);
+		} else if (g_strcmp0(element, "releases") == 0) {
+			fu_engine_search_index_add_children(self,
+							    c,
+							    "release",
+							    fu_engine_search_index_add_release,
+							    component);
+		} else if (g_strcmp0(element, "custom") == 0) {
+			fu_engine_search_index_add_children(self,
+							    c,
+							    "value",
+							    fu_engine_search_index_add_custom_value,
+							    component);
+		}
+	}
+}
+
+/**
+ * fu_engine_search_index_build:
+ * @self: a #FuEngineSearchIndex
+ * @silo: a #XbSilo
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds every component in the silo to the index, clearing any existing entries.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_search_index_build(FuEngineSearchIndex *self, XbSilo *silo, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) components = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE_SEARCH_INDEX(self), FALSE);
+	g_return_val_if_fail(XB_IS_SILO(silo), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	g_hash_table_remove_all(self->values);
+	g_hash_table_remove_all(self->words);
+	g_ptr_array_set_size(self->components, 0);
+
+	components = xb_silo_query(silo, "components/component", 0, &error_local);
+	if (components == NULL) {
+		if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return TRUE;
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	for (guint i = 0; i < components->len; i++) {
+		XbNode *component = g_ptr_array_index(components, i);
+		g_ptr_array_add(self->components, g_object_ref(component));
+		fu_engine_search_index_add_component(self, component);
+	}
+	g_debug("search index has %u values and %u words for %u components",
+		g_hash_table_size(self->values),
+		g_hash_table_size(self->words),
+		self->components->len);
+
+	/* success */
+	return TRUE;
+}
+
+static void
+fu_engine_search_index_lookup_append(GHashTable *hash,
+				     const gchar *token,
+				     GHashTable *seen,
+				     GPtrArray *components)
+{
+	GPtrArray *components_tmp = g_hash_table_lookup(hash, token);
+	if (components_tmp == NULL)
+		return;
+	for (guint i = 0; i < components_tmp->len; i++) {
+		XbNode *component = g_ptr_array_index(components_tmp, i);
+		if (!g_hash_table_add(seen, component))
+			continue;
+		g_ptr_array_add(components, g_object_ref(component));
+	}
+}
+
+/**
+ * fu_engine_search_index_lookup:
+ * @self: a #FuEngineSearchIndex
+ * @token: a search term
+ *
+ * Finds the components that match the search term, with exact matches first. Each component is
+ * only returned once.
+ *
+ * Returns: (transfer container) (element-type XbNode): components, which may be empty
+ **/
+GPtrArray *
+fu_engine_search_index_lookup(FuEngineSearchIndex *self, const gchar *token)
+{
+	g_auto(GStrv) words = NULL;
+	g_autoptr(GHashTable) seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_autoptr(GPtrArray) components =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+
+	g_return_val_if_fail(FU_IS_ENGINE_SEARCH_INDEX(self), NULL);
+	g_return_val_if_fail(token != NULL, NULL);
+
+	fu_engine_search_index_lookup_append(self->values, token, seen, components);
+	words = g_str_tokenize_and_fold(token, NULL, NULL);
+	for (guint i = 0; words[i] != NULL; i++)
+		fu_engine_search_index_lookup_append(self->words, words[i], seen, components);
+	return g_steal_pointer(&components);
+}
+
+static void
+fu_engine_search_index_init(FuEngineSearchIndex *self)
+{
+	self->components = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->values = g_hash_table_new_full(g_str_hash,
+					     g_str_equal,
+					     g_free,
+					     (GDestroyNotify)g_ptr_array_unref);
+	self->words = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    (GDestroyNotify)g_ptr_array_unref);
+}
+
+static void
+fu_engine_search_index_finalize(GObject *obj)
+{
+	FuEngineSearchIndex *self = FU_ENGINE_SEARCH_INDEX(obj);
+	g_hash_table_unref(self->values);
+	g_hash_table_unref(self->words);
+	g_ptr_array_unref(self->components);
+	G_OBJECT_CLASS(fu_engine_search_index_parent_class)->finalize(obj);
+}
+
+static void
+fu_engine_search_index_class_init(FuEngineSearchIndexClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_engine_search_index_finalize;
+}
+
+/**
+ * fu_engine_search_index_new:
+ *
+ * Creates a new search index.
+ *
+ * Returns: (transfer full): a #FuEngineSearchIndex
+ **/
+FuEngineSearchIndex *
+fu_engine_search_index_new(void)
+{
+	return FU_ENGINE_SEARCH_INDEX(g_object_new(FU_TYPE_ENGINE_SEARCH_INDEX, NULL));
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_ENGINE_SEARCH_INDEX (fu_engine_search_index_get_type())
+G_DECLARE_FINAL_TYPE(FuEngineSearchIndex,
+		     fu_engine_search_index,
+		     FU,
+		     ENGINE_SEARCH_INDEX,
+		     GObject)
+
+FuEngineSearchIndex *
+fu_engine_search_index_new(void);
+gboolean
+fu_engine_search_index_build(FuEngineSearchIndex *self, XbSilo *silo, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+GPtrArray *
+fu_engine_search_index_lookup(FuEngineSearchIndex *self, const gchar *token)
+    G_GNUC_NON_NULL(1, 2);
@@ -0,0 +1,405 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuEngine"
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+#include <json-glib/json-glib.h>
+
+#include "fu-engine-snapshot.h"
+
+/*
+ * The daemon exits when idle and is started again on demand, and every start has to ask each
+ * possible plugin about each backend device. Most of the devices are rejected, often only after
+ * opening them and reading descriptors or feature reports.
+ *
+ * The snapshot remembers which plugins rejected which devices, keyed by the backend ID and a
+ * token that changes when the device is replugged, or changes driver, power state or flags
+ * without being replugged. It is only valid for the same boot, daemon version, quirks and config,
+ * and devices that were accepted are always set up again as plugins keep private state.
+ */
+
+struct _FuEngineSnapshot {
+	GObject parent_instance;
+	gchar *boot_id;
+	gchar *context_id;
+	GHashTable *ignored_old; /* (element-type utf8 utf8) */
+	GHashTable *ignored_new; /* (element-type utf8 FuEngineSnapshotItem) */
+};
+
+typedef struct {
+	gchar *backend_id;
+	gchar *token;
+	gchar *plugin_name;
+} FuEngineSnapshotItem;
+
+G_DEFINE_TYPE(FuEngineSnapshot, fu_engine_snapshot, G_TYPE_OBJECT)
+
+static void
+fu_engine_snapshot_item_free(FuEngineSnapshotItem *item)
+{
+	g_free(item->backend_id);
+	g_free(item->token);
+	g_free(item->plugin_name);
+	g_free(item);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineSnapshotItem, fu_engine_snapshot_item_free)
+
+/*
+ * changes when the device is removed and added again, or NULL if that cannot be detected -- a
+ * device can also switch mode by binding a different driver, or be runtime suspended, and
+ * plugins often reject devices in one state and accept them in another
+ */
+static gchar *
+fu_engine_snapshot_build_token(FuDevice *device)
+{
+	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED))
+		return NULL;
+	if (FU_IS_UDEV_DEVICE(device)) {
+		FuUdevDevice *udev_device = FU_UDEV_DEVICE(device);
+		const gchar *driver = fu_udev_device_get_driver(udev_device);
+		const gchar *sysfs_path = fu_udev_device_get_sysfs_path(udev_device);
+		GStatBuf statbuf = {0};
+		g_autofree gchar *runtime_status = NULL;
+
+		if (sysfs_path == NULL || g_stat(sysfs_path, &statbuf) != 0)
+			return NULL;
+		runtime_status = fu_udev_device_read_sysfs(udev_device,
+							   "power/runtime_status",
+							   FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+							   NULL);
+		return g_strdup_printf("%" G_GUINT64_FORMAT ":%" G_GINT64_FORMAT
+				       ":%s:%s:%" G_GINT64_MODIFIER "x",
+				       (guint64)statbuf.st_ino,
+				       (gint64)statbuf.st_mtime,
+				       driver != NULL ? driver : "",
+				       runtime_status != NULL ? runtime_status : "",
+				       (guint64)fwupd_device_get_flags(FWUPD_DEVICE(device)));
+	}
+	if (FU_IS_USB_DEVICE(device)) {
+		/* the kernel allocates a new address on each enumeration */
+		return g_strdup_printf("%02x:%02x",
+				       fu_usb_device_get_bus(FU_USB_DEVICE(device)),
+				       fu_usb_device_get_address(FU_USB_DEVICE(device)));
+	}
+	return NULL;
+}
+
+static gchar *
+fu_engine_snapshot_build_key(const gchar *backend_id, const gchar *token, const gchar *plugin_name)
+{
+	return g_strdup_printf("%s|%s|%s", plugin_name, token, backend_id);
+}
+
+static gboolean
+fu_engine_snapshot_ensure_boot_id(FuEngineSnapshot *self, GError **error)
+{
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *fn = NULL;
+
+	if (self->boot_id != NULL)
+		return TRUE;
+	fn = fu_path_build(FU_PATH_KIND_PROCFS, "sys", "kernel", "random", "boot_id", NULL);
+	if (!g_file_get_contents(fn, &buf, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	self->boot_id = g_strstrip(g_steal_pointer(&buf));
+	return TRUE;
+}
+
+/**
+ * fu_engine_snapshot_set_context_id:
+ * @self: a #FuEngineSnapshot
+ * @context_id: (nullable): a string that changes when the quirks or config change
+ *
+ * Sets the context ID, which has to match when the snapshot is loaded.
+ **/
+void
+fu_engine_snapshot_set_context_id(FuEngineSnapshot *self, const gchar *context_id)
+{
+	g_return_if_fail(FU_IS_ENGINE_SNAPSHOT(self));
+	if (g_strcmp0(self->context_id, context_id) == 0)
+		return;
+	g_free(self->context_id);
+	self->context_id = g_strdup(context_id);
+}
+
+/**
+ * fu_engine_snapshot_get_context_id:
+ * @self: a #FuEngineSnapshot
+ *
+ * Gets the context ID.
+ *
+ * Returns: a string, or %NULL if unset
+ **/
+const gchar *
+fu_engine_snapshot_get_context_id(FuEngineSnapshot *self)
+{
+	g_return_val_if_fail(FU_IS_ENGINE_SNAPSHOT(self), NULL);
+	return self->context_id;
+}
+
+/**
+ * fu_engine_snapshot_add_ignored:
+ * @self: a #FuEngineSnapshot
+ * @device: a backend #FuDevice
+ * @plugin_name: a plugin name
+ *
+ * Records that the plugin does not support the device.
+ **/
+void
+fu_engine_snapshot_add_ignored(FuEngineSnapshot *self, FuDevice *device, const gchar *plugin_name)
+{
+	const gchar *backend_id = fu_device_get_backend_id(device);
+	g_autofree gchar *token = NULL;
+	g_autoptr(FuEngineSnapshotItem) item = g_new0(FuEngineSnapshotItem, 1);
+
+	g_return_if_fail(FU_IS_ENGINE_SNAPSHOT(self));
+	g_return_if_fail(FU_IS_DEVICE(device));
+	g_return_if_fail(plugin_name != NULL);
+
+	if (backend_id == NULL)
+		return;
+	token = fu_engine_snapshot_build_token(device);
+	if (token == NULL)
+		return;
+	item->backend_id = g_strdup(backend_id);
+	item->token = g_steal_pointer(&token);
+	item->plugin_name = g_strdup(plugin_name);
+	g_hash_table_insert(
+	    self->ignored_new,
+	    fu_engine_snapshot_build_key(item->backend_id, item->token, item->plugin_name),
+	    g_steal_pointer(&item));
+}
+
+/**
+ * fu_engine_snapshot_has_ignored:
+ * @self: a #FuEngineSnapshot
+ * @device: a backend #FuDevice
+ * @plugin_name: a plugin name
+ *
+ * Finds out if the plugin did not support the device when the snapshot was saved, in which case
+ * it is also recorded for the next snapshot.
+ *
+ * Returns: %TRUE if the plugin can be skipped for this device
+ **/
+gboolean
+fu_engine_snapshot_has_ignored(FuEngineSnapshot *self, FuDevice *device, const gchar *plugin_name)
+{
+	const gchar *backend_id = fu_device_get_backend_id(device);
+	g_autofree gchar *key = NULL;
+	g_autofree gchar *token = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE_SNAPSHOT(self), FALSE);
+	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
+	g_return_val_if_fail(plugin_name != NULL, FALSE);
+
+	if (backend_id == NULL || g_hash_table_size(self->ignored_old) == 0)
+		return FALSE;
+	token = fu_engine_snapshot_build_token(device);
+	if (token == NULL)
+		return FALSE;
+	key = fu_engine_snapshot_build_key(backend_id, token, plugin_name);
+	if (!g_hash_table_contains(self->ignored_old, key))
+		return FALSE;
+	fu_engine_snapshot_add_ignored(self, device, plugin_name);
+	return TRUE;
+}
+
+/**
+ * fu_engine_snapshot_load:
+ * @self: a #FuEngineSnapshot
+ * @filename: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Loads a snapshot saved with fu_engine_snapshot_save(). A missing file, or one saved by a
+ * different boot, daemon version or context ID is not an error, and just does not return any
+ * devices.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_snapshot_load(FuEngineSnapshot *self, const gchar *filename, GError **error)
+{
+	JsonArray *json_array;
+	JsonNode *json_root;
+	JsonObject *json_obj;
+	g_autofree gchar *buf = NULL;
+	g_autoptr(JsonParser) parser = json_parser_new();
+
+	g_return_val_if_fail(FU_IS_ENGINE_SNAPSHOT(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	g_hash_table_remove_all(self->ignored_old);
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+	if (!fu_engine_snapshot_ensure_boot_id(self, error))
+		return FALSE;
+	if (!g_file_get_contents(filename, &buf, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	if (!json_parser_load_from_data(parser, buf, -1, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	json_root = json_parser_get_root(parser);
+	if (json_root == NULL || !JSON_NODE_HOLDS_OBJECT(json_root)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "no root object");
+		return FALSE;
+	}
+	json_obj = json_node_get_object(json_root);
+	if (g_strcmp0(json_object_get_string_member_with_default(json_obj, "Version", NULL),
+		      PACKAGE_VERSION) != 0) {
+		g_debug("ignoring snapshot from another daemon version");
+		return TRUE;
+	}
+	if (g_strcmp0(json_object_get_string_member_with_default(json_obj, "BootId", NULL),
+		      self->boot_id) != 0) {
+		g_debug("ignoring snapshot from another boot");
+		return TRUE;
+	}
+	if (g_strcmp0(json_object_get_string_member_with_default(json_obj, "ContextId", NULL),
+		      self->context_id) != 0) {
+		g_debug("ignoring snapshot with different quirks or config");
+		return TRUE;
+	}
+	if (!json_object_has_member(json_obj, "Ignored"))
+		return TRUE;
+	json_array = json_object_get_array_member(json_obj, "Ignored");
+	for (guint i = 0; json_array != NULL && i < json_array_get_length(json_array); i++) {
+		JsonObject *json_item = json_array_get_object_element(json_array, i);
+		const gchar *backend_id;
+		const gchar *token;
+		const gchar *plugin_name;
+
+		if (json_item == NULL)
+			continue;
+		backend_id = json_object_get_string_member_with_default(json_item, "BackendId", NULL);
+		token = json_object_get_string_member_with_default(json_item, "Token", NULL);
+		plugin_name = json_object_get_string_member_with_default(json_item, "Plugin", NULL);
+		if (backend_id == NULL || token == NULL || plugin_name == NULL)
+			continue;
+		g_hash_table_add(self->ignored_old,
+				 fu_engine_snapshot_build_key(backend_id, token, plugin_name));
+	}
+	g_debug("loaded %u ignored devices from snapshot", g_hash_table_size(self->ignored_old));
+	return TRUE;
+}
+
+/**
+ * fu_engine_snapshot_save:
+ * @self: a #FuEngineSnapshot
+ * @filename: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Saves the devices that have been ignored by plugins since the snapshot was loaded.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_snapshot_save(FuEngineSnapshot *self, const gchar *filename, GError **error)
+{
+	GHashTableIter iter;
+	FuEngineSnapshotItem *item;
+	g_autofree gchar *data = NULL;
+	g_autoptr(JsonBuilder) builder = json_builder_new();
+	g_autoptr(JsonGenerator) generator = json_generator_new();
+	g_autoptr(JsonNode) root = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE_SNAPSHOT(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (!fu_engine_snapshot_ensure_boot_id(self, error))
+		return FALSE;
+
+	json_builder_begin_object(builder);
+	json_builder_set_member_name(builder, "Version");
+	json_builder_add_string_value(builder, PACKAGE_VERSION);
+	json_builder_set_member_name(builder, "BootId");
+	json_builder_add_string_value(builder, self->boot_id);
+	if (self->context_id != NULL) {
+		json_builder_set_member_name(builder, "ContextId");
+		json_builder_add_string_value(builder, self->context_id);
+	}
+	json_builder_set_member_name(builder, "Ignored");
+	json_builder_begin_array(builder);
+	g_hash_table_iter_init(&iter, self->ignored_new);
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&item)) {
+		json_builder_begin_object(builder);
+		json_builder_set_member_name(builder, "BackendId");
+		json_builder_add_string_value(builder, item->backend_id);
+		json_builder_set_member_name(builder, "Token");
+		json_builder_add_string_value(builder, item->token);
+		json_builder_set_member_name(builder, "Plugin");
+		json_builder_add_string_value(builder, item->plugin_name);
+		json_builder_end_object(builder);
+	}
+	json_builder_end_array(builder);
+	json_builder_end_object(builder);
+
+	root = json_builder_get_root(builder);
+	json_generator_set_root(generator, root);
+	data = json_generator_to_data(generator, NULL);
+	if (!fu_path_mkdir_parent(filename, error))
+		return FALSE;
+	if (!g_file_set_contents(filename, data, -1, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+fu_engine_snapshot_init(FuEngineSnapshot *self)
+{
+	self->ignored_old = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	self->ignored_new =
+	    g_hash_table_new_full(g_str_hash,
+				  g_str_equal,
+				  g_free,
+				  (GDestroyNotify)fu_engine_snapshot_item_free);
+}
+
+static void
+fu_engine_snapshot_finalize(GObject *obj)
+{
+	FuEngineSnapshot *self = FU_ENGINE_SNAPSHOT(obj);
+	g_free(self->boot_id);
+	g_free(self->context_id);
+	g_hash_table_unref(self->ignored_old);
+	g_hash_table_unref(self->ignored_new);
+	G_OBJECT_CLASS(fu_engine_snapshot_parent_class)->finalize(obj);
+}
+
+static void
+fu_engine_snapshot_class_init(FuEngineSnapshotClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_engine_snapshot_finalize;
+}
+
+/**
+ * fu_engine_snapshot_new:
+ *
+ * Creates a new warm-start snapshot.
+ *
+ * Returns: (transfer full): a #FuEngineSnapshot
+ **/
+FuEngineSnapshot *
+fu_engine_snapshot_new(void)
+{
+	return FU_ENGINE_SNAPSHOT(g_object_new(FU_TYPE_ENGINE_SNAPSHOT, NULL));
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2025 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_ENGINE_SNAPSHOT (fu_engine_snapshot_get_type())
+G_DECLARE_FINAL_TYPE(FuEngineSnapshot, fu_engine_snapshot, FU, ENGINE_SNAPSHOT, GObject)
+
+FuEngineSnapshot *
+fu_engine_snapshot_new(void);
+gboolean
+fu_engine_snapshot_load(FuEngineSnapshot *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_engine_snapshot_save(FuEngineSnapshot *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+const gchar *
+fu_engine_snapshot_get_context_id(FuEngineSnapshot *self) G_GNUC_NON_NULL(1);
+void
+fu_engine_snapshot_set_context_id(FuEngineSnapshot *self, const gchar *context_id)
+    G_GNUC_NON_NULL(1);
+void
+fu_engine_snapshot_add_ignored(FuEngineSnapshot *self, FuDevice *device, const gchar *plugin_name)
+    G_GNUC_NON_NULL(1, 2, 3);
+gboolean
+fu_engine_snapshot_has_ignored(FuEngineSnapshot *self, FuDevice *device, const gchar *plugin_name)
+    G_GNUC_NON_NULL(1, 2, 3);
@@ -48,6 +48,8 @@
 #include "fu-engine-helper.h"
 #include "fu-engine-request.h"
 #include "fu-engine-requirements.h"
+#include "fu-engine-search-index.h"
+#include "fu-engine-snapshot.h"
 #include "fu-engine.h"
 #include "fu-history.h"
 #include "fu-idle.h"
@@ -108,14 +110,19 @@ struct _FuEngine {
 	guint percentage;
 	FuHistory *history;
 	FuIdle *idle;
+	FuEngineSnapshot *snapshot;
 	XbSilo *silo;
 	XbQuery *query_component_by_guid;
 	XbQuery *query_container_checksum1; /* container checksum -> release */
 	XbQuery *query_container_checksum2; /* artifact checksum -> release */
 	XbQuery *query_tag_by_guid_version;
-	GPtrArray *search_queries; /* (element-type XbQuery) */
+	FuEngineSearchIndex *search_index; /* nullable, built on first search */
+	GHashTable *components_cache; /* (element-type utf8 GPtrArray) */
+	guint components_cache_hits;
+	guint components_cache_misses;
 	FuPluginList *plugin_list;
 	GPtrArray *plugin_filter;
+	GPtrArray *plugins_deferred; /* (element-type FuPlugin) */
 	FuContext *ctx;
 	GHashTable *approved_firmware; /* (nullable) */
 	GHashTable *blocked_firmware;  /* (nullable) */
@@ -123,7 +130,10 @@ struct _FuEngine {
 	GHashTable *device_changed_allowlist; /* (element-type str int) */
 	gchar *host_machine_id;
 	JcatContext *jcat_context;
+	FuCabinetVerifyCache *verify_cache; /* nullable */
 	FuSecurityAttrs *host_security_attrs;
+	FuSecurityAttrs *host_security_attrs_recorded; /* (nullable) */
+	GHashTable *host_security_attrs_sources;       /* source-id : FuSecurityAttrs */
 	GPtrArray *local_monitors; /* (element-type GFileMonitor) */
 	GMainLoop *acquiesce_loop;
 	guint acquiesce_id;
@@ -199,6 +209,16 @@ fu_engine_update_motd_reset(FuEngine *self)
 						     self);
 }
 
+static void
+fu_engine_components_cache_invalidate(FuEngine *self)
+{
+	if (g_hash_table_size(self->components_cache) == 0)
+		return;
+	g_debug("invalidating %u cached GUID components",
+		g_hash_table_size(self->components_cache));
+	g_hash_table_remove_all(self->components_cache);
+}
+
 static void
 fu_engine_emit_changed(FuEngine *self)
 {
@@ -220,6 +240,48 @@ fu_engine_emit_changed(FuEngine *self)
 		g_info("failed to update list of devices: %s", error->message);
 }
 
+/* @source_id is NULL to recalculate the attributes from every device and plugin */
+static void
+fu_engine_security_attrs_invalidate(FuEngine *self, const gchar *source_id)
+{
+	if (source_id == NULL)
+		g_hash_table_remove_all(self->host_security_attrs_sources);
+	else
+		g_hash_table_remove(self->host_security_attrs_sources, source_id);
+	fu_security_attrs_remove_all(self->host_security_attrs);
+}
+
+static void
+fu_engine_security_attrs_forget_device(FuEngine *self, FuDevice *device)
+{
+	g_autofree gchar *source_id = g_strdup_printf("device:%s", fu_device_get_id(device));
+	g_hash_table_remove(self->host_security_attrs_sources, source_id);
+}
+
+/*
+ * plugins add attributes using the state of devices from *any* plugin and also from sysfs,
+ * so only the attributes from the other devices can be reused
+ */
+static void
+fu_engine_security_attrs_invalidate_device(FuEngine *self, FuDevice *device)
+{
+	GHashTableIter iter;
+	const gchar *source_id = NULL;
+
+	/* unknown source, so recalculate everything */
+	if (fu_device_get_id(device) == NULL || fu_device_get_plugin(device) == NULL) {
+		fu_engine_security_attrs_invalidate(self, NULL);
+		return;
+	}
+	fu_engine_security_attrs_forget_device(self, device);
+	g_hash_table_iter_init(&iter, self->host_security_attrs_sources);
+	while (g_hash_table_iter_next(&iter, (gpointer *)&source_id, NULL)) {
+		if (g_str_has_prefix(source_id, "plugin:"))
+			g_hash_table_iter_remove(&iter);
+	}
+	fu_security_attrs_remove_all(self->host_security_attrs);
+}
+
 static void
 fu_engine_emit_device_changed_safe(FuEngine *self, FuDevice *device)
 {
@@ -227,8 +289,8 @@ fu_engine_emit_device_changed_safe(FuEngine *self, FuDevice *device)
 	if ((self->load_flags & FU_ENGINE_LOAD_FLAG_READY) == 0)
 		return;
 
-	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	/* invalidate host security attributes from this device and all plugins */
+	fu_engine_security_attrs_invalidate_device(self, device);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
 }
 
@@ -552,6 +614,7 @@ fu_engine_device_removed_cb(FuDeviceList *device_list, FuDevice *device, FuEngin
 	fu_engine_device_runner_device_removed(self, device);
 	fu_engine_acquiesce_reset(self);
 	g_signal_handlers_disconnect_by_data(device, self);
+	fu_engine_security_attrs_invalidate_device(self, device);
 	g_signal_emit(self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
 }
 
@@ -2053,6 +2116,17 @@ fu_engine_get_report_metadata(FuEngine *self, GError **error)
 	fu_engine_add_report_metadata_bool(hash, "FwupdSupported", FALSE);
 #endif
 
+	/* useful for debugging clients that poll for updates */
+	g_hash_table_insert(hash,
+			    g_strdup("ComponentCacheHits"),
+			    g_strdup_printf("%u", self->components_cache_hits));
+	g_hash_table_insert(hash,
+			    g_strdup("ComponentCacheMisses"),
+			    g_strdup_printf("%u", self->components_cache_misses));
+	g_hash_table_insert(hash,
+			    g_strdup("ComponentCacheSize"),
+			    g_strdup_printf("%u", g_hash_table_size(self->components_cache)));
+
 	/* find out what BKC is being targeted to understand "odd" upgrade paths */
 	tmp = fu_engine_config_get_host_bkc(self->config);
 	if (tmp != NULL)
@@ -3776,6 +3850,7 @@ fu_engine_install_blob(FuEngine *self,
 		       GError **error)
 {
 	gboolean write_complete = FALSE;
+	guint64 sleep_duration = fu_device_get_sleep_duration(device);
 	g_autofree gchar *device_id = NULL;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autoptr(GTimer) timer = g_timer_new();
@@ -3844,7 +3919,10 @@ fu_engine_install_blob(FuEngine *self,
 
 	/* make the UI update */
 	fu_engine_emit_device_changed(self, device_id);
-	g_info("updating %s took %f seconds", id_display, g_timer_elapsed(timer, NULL));
+	g_info("updating %s took %f seconds, of which %.3f were spent sleeping",
+	       id_display,
+	       g_timer_elapsed(timer, NULL),
+	       (gdouble)(fu_device_get_sleep_duration(device) - sleep_duration) / 1000);
 	return TRUE;
 }
 
@@ -3904,71 +3982,6 @@ fu_engine_get_item_by_id_fallback_history(FuEngine *self, const gchar *id, GErro
 	return NULL;
 }
 
-static gboolean
-fu_engine_search_query_append(FuEngine *self, const gchar *xpath, GError **error)
-{
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(XbQuery) query = NULL;
-
-	/* prepare tag query with bound GUID parameter */
-	query = xb_query_new_full(self->silo, xpath, XB_QUERY_FLAG_OPTIMIZE, &error_local);
-	if (query == NULL) {
-		if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-		    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
-			g_debug("ignoring prepared query %s: %s", xpath, error_local->message);
-			return TRUE;
-		}
-		g_propagate_error(error, g_steal_pointer(&error_local));
-		fwupd_error_convert(error);
-		return FALSE;
-	}
-	g_ptr_array_add(self->search_queries, g_steal_pointer(&query));
-
-	/* success */
-	return TRUE;
-}
-
-static gboolean
-fu_engine_search_query_create(FuEngine *self, GError **error)
-{
-	/* invalidate everything */
-	g_ptr_array_set_size(self->search_queries, 0);
-
-	/* we get one for free, add build the others */
-	g_ptr_array_add(self->search_queries, g_object_ref(self->query_component_by_guid));
-	if (!fu_engine_search_query_append(self, "components/component/id[text()=?]/..", error))
-		return FALSE;
-	if (!fu_engine_search_query_append(self, "components/component/name[text()~=?]/..", error))
-		return FALSE;
-	if (!fu_engine_search_query_append(self,
-					   "components/component/developer_name[text()~=?]/..",
-					   error))
-		return FALSE;
-	if (!fu_engine_search_query_append(self,
-					   "components/component/releases/release/artifacts/"
-					   "artifact/filename[text()=?]/../../../../..",
-					   error))
-		return FALSE;
-	if (!fu_engine_search_query_append(self,
-					   "components/component/releases/release/artifacts/"
-					   "artifact/checksum[text()=?]/../../../../..",
-					   error))
-		return FALSE;
-	if (!fu_engine_search_query_append(
-		self,
-		"components/component/releases/release/issues/issue[text()=?]/../../../..",
-		error))
-		return FALSE;
-	if (!fu_engine_search_query_append(
-		self,
-		"components/component/custom/value[@key='LVFS::UpdateProtocol'][text()=?]/../..",
-		error))
-		return FALSE;
-
-	/* success */
-	return TRUE;
-}
-
 static gboolean
 fu_engine_create_silo_index(FuEngine *self, GError **error)
 {
@@ -3977,6 +3990,10 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 	g_autoptr(GError) error_container_checksum2 = NULL;
 	g_autoptr(GError) error_tag_by_guid_version = NULL;
 
+	/* the search index and any cached components refer to the old silo */
+	g_clear_object(&self->search_index);
+	fu_engine_components_cache_invalidate(self);
+
 	/* print what we've got */
 	components = xb_silo_query(self->silo, "components/component[@type='firmware']", 0, NULL);
 	if (components == NULL)
@@ -4058,10 +4075,6 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 	if (self->query_tag_by_guid_version == NULL)
 		g_debug("ignoring prepared query: %s", error_tag_by_guid_version->message);
 
-	/* build all the search queries */
-	if (!fu_engine_search_query_create(self, error))
-		return FALSE;
-
 	/* success */
 	return TRUE;
 }
@@ -4330,6 +4343,7 @@ fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **
 
 	/* clear existing silo */
 	g_clear_object(&self->silo);
+	g_clear_object(&self->search_index);
 
 #ifdef SOURCE_VERSION
 	/* invalidate the cache if the fwupd version changes */
@@ -4491,7 +4505,7 @@ fu_engine_metadata_changed(FuEngine *self)
 	fu_engine_md_refresh_devices(self);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_security_attrs_invalidate(self, NULL);
 
 	/* make the UI update */
 	fu_engine_emit_changed(self);
@@ -4787,7 +4801,7 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 	fu_engine_md_refresh_devices(self);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_security_attrs_invalidate(self, NULL);
 
 	/* make the UI update */
 	fu_engine_emit_changed(self);
@@ -4883,6 +4897,8 @@ fu_engine_build_cabinet_from_stream(FuEngine *self, GInputStream *stream, GError
 	fu_firmware_set_size_max(FU_FIRMWARE(cabinet),
 				 fu_engine_config_get_archive_size_max(self->config));
 	fu_cabinet_set_jcat_context(cabinet, self->jcat_context);
+	if (self->verify_cache != NULL)
+		fu_cabinet_set_verify_cache(cabinet, self->verify_cache);
 	if (!fu_firmware_parse_stream(FU_FIRMWARE(cabinet), stream, 0x0, flags, error))
 		return NULL;
 	return g_steal_pointer(&cabinet);
@@ -5479,6 +5495,7 @@ fu_engine_sort_releases_cb(gconstpointer a, gconstpointer b, gpointer user_data)
 	FuDevice *device = FU_DEVICE(user_data);
 	FuRelease *rel_a = FU_RELEASE(*((FuRelease **)a));
 	FuRelease *rel_b = FU_RELEASE(*((FuRelease **)b));
+	FwupdVersionFormat fmt = fu_device_get_version_format(device);
 	gint rc;
 
 	/* first by branch */
@@ -5486,10 +5503,9 @@ fu_engine_sort_releases_cb(gconstpointer a, gconstpointer b, gpointer user_data)
 	if (rc != 0)
 		return rc;
 
-	/* then by version */
-	rc = fu_version_compare(fu_release_get_version(rel_b),
-				fu_release_get_version(rel_a),
-				fu_device_get_version_format(device));
+	/* then by version, without re-parsing for every comparison */
+	rc = fu_version_key_compare(fu_release_get_version_key(rel_b, fmt),
+				    fu_release_get_version_key(rel_a, fmt));
 	if (rc != 0)
 		return rc;
 
@@ -5611,9 +5627,8 @@ fu_engine_add_releases_for_device_component(FuEngine *self,
 		}
 
 		/* test for upgrade or downgrade */
-		vercmp = fu_version_compare(fu_release_get_version(release),
-					    fu_device_get_version(device),
-					    fmt);
+		vercmp = fu_version_key_compare(fu_release_get_version_key(release, fmt),
+						fu_device_get_version_key(device));
 		if (vercmp > 0)
 			fu_release_add_flag(release, FWUPD_RELEASE_FLAG_IS_UPGRADE);
 		else if (vercmp < 0)
@@ -5677,6 +5692,40 @@ fu_engine_get_branch_fallback(const gchar *nullable_branch)
 	return nullable_branch;
 }
 
+/* the components only depend on the silo, so the releases are still built for each request as
+ * they depend on the device, the request and the config */
+static GPtrArray *
+fu_engine_get_components_for_guid(FuEngine *self, const gchar *guid)
+{
+	GPtrArray *components_cached;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) components = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+
+	/* already queried since the last metadata change */
+	components_cached = g_hash_table_lookup(self->components_cache, guid);
+	if (components_cached != NULL) {
+		self->components_cache_hits++;
+		return g_ptr_array_ref(components_cached);
+	}
+	self->components_cache_misses++;
+
+	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
+	components = xb_silo_query_with_context(self->silo,
+						self->query_component_by_guid,
+						&context,
+						&error_local);
+	if (components == NULL) {
+		g_debug("%s was not found: %s", guid, error_local->message);
+		components = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	}
+
+	/* save for next time, even if empty */
+	g_hash_table_insert(self->components_cache, g_strdup(guid), g_ptr_array_ref(components));
+	return g_steal_pointer(&components);
+}
+
 GPtrArray *
 fu_engine_get_releases_for_device(FuEngine *self,
 				  FuEngineRequest *request,
@@ -5734,20 +5783,10 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint j = 0; j < device_guids->len; j++) {
 		const gchar *guid = g_ptr_array_index(device_guids, j);
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) components = NULL;
-		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+		g_autoptr(GPtrArray) components = fu_engine_get_components_for_guid(self, guid);
 
-		xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		components = xb_silo_query_with_context(self->silo,
-							self->query_component_by_guid,
-							&context,
-							&error_local);
-		if (components == NULL) {
-			g_debug("%s was not found: %s", guid, error_local->message);
+		if (components->len == 0)
 			continue;
-		}
 
 		/* find all the releases that pass all the requirements */
 		g_debug("%s matched %u components", guid, components->len);
@@ -5813,41 +5852,37 @@ fu_engine_search(FuEngine *self, const gchar *token, GError **error)
 {
 	g_autoptr(GPtrArray) releases =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+	g_autoptr(GPtrArray) components = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 	g_return_val_if_fail(token != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	/* bind search token and then query */
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, token, NULL);
-	for (guint i = 0; i < self->search_queries->len; i++) {
-		XbQuery *query_tmp = g_ptr_array_index(self->search_queries, i);
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) components = NULL;
+	/* nothing loaded */
+	if (self->silo == NULL)
+		return g_steal_pointer(&releases);
 
-		components =
-		    xb_silo_query_with_context(self->silo, query_tmp, &context, &error_local);
-		if (components == NULL) {
-			if (g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-			    g_error_matches(error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-				continue;
-			g_propagate_error(error, g_steal_pointer(&error_local));
-			fwupd_error_convert(error);
+	/* only pay for the index if something actually searches */
+	if (self->search_index == NULL) {
+		g_autoptr(FuEngineSearchIndex) search_index = fu_engine_search_index_new();
+		if (!fu_engine_search_index_build(search_index, self->silo, error))
 			return NULL;
-		}
-		for (guint j = 0; j < components->len; j++) {
-			g_autoptr(FuRelease) rel = fu_release_new();
-			XbNode *component = g_ptr_array_index(components, j);
-			if (!fu_release_load(rel,
-					     NULL,
-					     component,
-					     NULL,
-					     FWUPD_INSTALL_FLAG_FORCE,
-					     error))
-				return NULL;
-			g_ptr_array_add(releases, g_steal_pointer(&rel));
-		}
+		self->search_index = g_steal_pointer(&search_index);
+	}
+
+	/* each component is only returned once */
+	components = fu_engine_search_index_lookup(self->search_index, token);
+	for (guint i = 0; i < components->len; i++) {
+		g_autoptr(FuRelease) rel = fu_release_new();
+		XbNode *component = g_ptr_array_index(components, i);
+		if (!fu_release_load(rel,
+				     NULL,
+				     component,
+				     NULL,
+				     FWUPD_INSTALL_FLAG_FORCE,
+				     error))
+			return NULL;
+		g_ptr_array_add(releases, g_steal_pointer(&rel));
 	}
 
 	/* success */
@@ -6089,6 +6124,19 @@ fu_engine_add_blocked_firmware(FuEngine *self, const gchar *checksum)
 	g_hash_table_add(self->blocked_firmware, g_strdup(checksum));
 }
 
+static gboolean
+fu_engine_save_blocked_firmware(FuEngine *self, GPtrArray *checksums, GError **error)
+{
+	if (!fu_history_clear_blocked_firmware(self->history, error))
+		return FALSE;
+	for (guint i = 0; i < checksums->len; i++) {
+		const gchar *csum = g_ptr_array_index(checksums, i);
+		if (!fu_history_add_blocked_firmware(self->history, csum, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 gboolean
 fu_engine_set_blocked_firmware(FuEngine *self, GPtrArray *checksums, GError **error)
 {
@@ -6102,15 +6150,16 @@ fu_engine_set_blocked_firmware(FuEngine *self, GPtrArray *checksums, GError **er
 		fu_engine_add_blocked_firmware(self, csum);
 	}
 
-	/* save database */
-	if (!fu_history_clear_blocked_firmware(self->history, error))
+	/* save database in one commit */
+	if (!fu_history_transaction_begin(self->history, error))
+		return FALSE;
+	if (!fu_engine_save_blocked_firmware(self, checksums, error)) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_history_transaction_rollback(self->history, &error_local))
+			g_warning("failed to rollback: %s", error_local->message);
 		return FALSE;
-	for (guint i = 0; i < checksums->len; i++) {
-		const gchar *csum = g_ptr_array_index(checksums, i);
-		if (!fu_history_add_blocked_firmware(self->history, csum, error))
-			return FALSE;
 	}
-	return TRUE;
+	return fu_history_transaction_commit(self->history, error);
 }
 
 gchar *
@@ -6388,6 +6437,21 @@ fu_engine_plugins_startup(FuEngine *self, FuProgress *progress)
 	for (guint i = 0; i < plugins->len; i++) {
 		g_autoptr(GError) error = NULL;
 		FuPlugin *plugin = g_ptr_array_index(plugins, i);
+
+		/* wait for a matching backend device, unless already activated by HwId */
+		if (fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP) &&
+		    !fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED) &&
+		    fu_plugin_get_activation_reason(plugin) == NULL) {
+			if (fu_plugin_can_defer_startup(plugin)) {
+				g_debug("deferring startup of %s", fu_plugin_get_name(plugin));
+				fu_plugin_set_deferred(plugin, TRUE);
+				g_ptr_array_add(self->plugins_deferred, g_object_ref(plugin));
+				fu_progress_step_done(progress);
+				continue;
+			}
+			g_info("not deferring startup of %s as vfuncs have to run for all devices",
+			       fu_plugin_get_name(plugin));
+		}
 		if (!fu_plugin_runner_startup(plugin, fu_progress_get_child(progress), &error)) {
 			fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED);
 			if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED))
@@ -6418,6 +6482,55 @@ fu_engine_plugins_ready(FuEngine *self, FuProgress *progress)
 	}
 }
 
+/* run ->startup() and ->coldplug() for a plugin deferred by fu_engine_plugins_startup() */
+static void
+fu_engine_plugin_activate(FuEngine *self, FuPlugin *plugin, const gchar *reason)
+{
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+
+	/* not deferred, or already activated */
+	if (!g_ptr_array_remove(self->plugins_deferred, plugin))
+		return;
+
+	g_info("activating %s due to %s", fu_plugin_get_name(plugin), reason);
+	fu_plugin_set_activation_reason(plugin, reason);
+	fu_plugin_set_deferred(plugin, FALSE);
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_NO_PROFILE);
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 40, "startup");
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 40, "coldplug");
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 20, "ready");
+
+	if (!fu_plugin_runner_startup(plugin, fu_progress_get_child(progress), &error)) {
+		fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED);
+		if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED))
+			fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_NO_HARDWARE);
+		g_info("disabling plugin because: %s", error->message);
+		return;
+	}
+	fu_progress_step_done(progress);
+	if (!fu_plugin_runner_coldplug(plugin, fu_progress_get_child(progress), &error)) {
+		fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED);
+		g_info("disabling plugin because: %s", error->message);
+		return;
+	}
+	fu_progress_step_done(progress);
+
+	/* the engine has already run ->ready() for the other plugins */
+	if (self->load_flags & FU_ENGINE_LOAD_FLAG_READY) {
+		if (!fu_plugin_runner_ready(plugin, fu_progress_get_child(progress), &error)) {
+			if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED))
+				fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_NO_HARDWARE);
+			g_info("disabling plugin because: %s", error->message);
+			return;
+		}
+	}
+	fu_progress_step_done(progress);
+}
+
 static void
 fu_engine_plugins_coldplug(FuEngine *self, FuProgress *progress)
 {
@@ -6442,7 +6555,8 @@ fu_engine_plugins_coldplug(FuEngine *self, FuProgress *progress)
 	/* print what we do have */
 	for (guint i = 0; i < plugins->len; i++) {
 		FuPlugin *plugin = g_ptr_array_index(plugins, i);
-		if (fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED))
+		if (fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED) ||
+		    fu_plugin_get_deferred(plugin))
 			continue;
 		g_string_append_printf(str, "%s, ", fu_plugin_get_name(plugin));
 	}
@@ -6882,6 +6996,24 @@ fu_engine_add_device(FuEngine *self, FuDevice *device)
 	fu_engine_emit_changed(self);
 }
 
+static void
+fu_engine_plugin_security_changed_cb(FuPlugin *plugin, gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE(user_data);
+
+	/* invalidate host security attributes from just this plugin */
+	if (fu_plugin_get_name(plugin) != NULL) {
+		g_autofree gchar *source_id =
+		    g_strdup_printf("plugin:%s", fu_plugin_get_name(plugin));
+		fu_engine_security_attrs_invalidate(self, source_id);
+	} else {
+		fu_engine_security_attrs_invalidate(self, NULL);
+	}
+
+	/* make UI refresh */
+	fu_engine_emit_changed(self);
+}
+
 static void
 fu_engine_plugin_rules_changed_cb(FuPlugin *plugin, gpointer user_data)
 {
@@ -6901,7 +7033,7 @@ fu_engine_context_security_changed_cb(FuContext *ctx, gpointer user_data)
 	FuEngine *self = FU_ENGINE(user_data);
 
 	/* invalidate host security attributes */
-	fu_security_attrs_remove_all(self->host_security_attrs);
+	fu_engine_security_attrs_invalidate(self, NULL);
 
 	/* make UI refresh */
 	fu_engine_emit_changed(self);
@@ -7165,12 +7297,64 @@ fu_engine_get_host_security_id(FuEngine *self, const gchar *fwupd_version)
 			       FWUPD_MICRO_VERSION);
 }
 
+/* the attributes are modified by depsolving, so keep the originals pristine */
+static void
+fu_engine_security_attrs_append_copy(FuSecurityAttrs *attrs, FuSecurityAttrs *donor)
+{
+	g_autoptr(GPtrArray) items = fu_security_attrs_get_all(donor, NULL);
+	for (guint i = 0; i < items->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(items, i);
+		g_autoptr(FwupdSecurityAttr) attr_copy = fwupd_security_attr_copy(attr);
+		fu_security_attrs_append_internal(attrs, attr_copy);
+	}
+}
+
+static gboolean
+fu_engine_save_security_attrs(FuEngine *self,
+			      const gchar *json,
+			      const gchar *host_security_id,
+			      GPtrArray *events,
+			      GError **error)
+{
+	if (!fu_history_add_security_attribute(self->history, json, host_security_id, error)) {
+		g_prefix_error_literal(error, "failed to write to DB: ");
+		return FALSE;
+	}
+	if (events != NULL && !fu_history_add_security_events(self->history, events, error)) {
+		g_prefix_error_literal(error, "failed to write events to DB: ");
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_engine_record_security_attrs(FuEngine *self, GError **error)
 {
-	g_autoptr(GPtrArray) attrs_array = NULL;
-	g_autofree gchar *host_security_id = fu_engine_get_host_security_id(self, NULL);
+	g_autofree gchar *host_security_id = NULL;
 	g_autofree gchar *json = NULL;
+	g_autoptr(FuSecurityAttrs) attrs_recorded = fu_security_attrs_new();
+	g_autoptr(GPtrArray) events = NULL;
+
+	/* get what we stored last boot */
+	if (self->host_security_attrs_recorded == NULL) {
+		g_autoptr(GPtrArray) attrs_array =
+		    fu_history_get_security_attrs(self->history, 1, error);
+		if (attrs_array == NULL) {
+			g_prefix_error_literal(error, "failed to get historical attr: ");
+			return FALSE;
+		}
+		self->host_security_attrs_recorded =
+		    attrs_array->len > 0 ? g_object_ref(g_ptr_array_index(attrs_array, 0))
+					 : fu_security_attrs_new();
+	}
+
+	/* compare the results directly, as converting to JSON is expensive */
+	if (fu_security_attrs_is_valid(self->host_security_attrs_recorded) &&
+	    fu_security_attrs_equal(self->host_security_attrs_recorded,
+				    self->host_security_attrs)) {
+		g_info("skipping writing HSI attrs to database as unchanged");
+		return TRUE;
+	}
 
 	/* convert attrs to json string */
 	json = fwupd_codec_to_json_string(FWUPD_CODEC(self->host_security_attrs),
@@ -7181,25 +7365,22 @@ fu_engine_record_security_attrs(FuEngine *self, GError **error)
 		return FALSE;
 	}
 
-	/* check that we did not store this already last boot */
-	attrs_array = fu_history_get_security_attrs(self->history, 1, error);
-	if (attrs_array == NULL) {
-		g_prefix_error_literal(error, "failed to get historical attr: ");
+	/* write new values, and what changed since last time */
+	host_security_id = fu_engine_get_host_security_id(self, NULL);
+	if (fu_security_attrs_is_valid(self->host_security_attrs_recorded))
+		events = fu_security_attrs_compare(self->host_security_attrs_recorded,
+						   self->host_security_attrs);
+	if (!fu_history_transaction_begin(self->history, error))
 		return FALSE;
-	}
-	if (attrs_array->len > 0) {
-		FuSecurityAttrs *attrs_tmp = g_ptr_array_index(attrs_array, 0);
-		if (fu_security_attrs_equal(attrs_tmp, self->host_security_attrs)) {
-			g_info("skipping writing HSI attrs to database as unchanged");
-			return TRUE;
-		}
-	}
-
-	/* write new values */
-	if (!fu_history_add_security_attribute(self->history, json, host_security_id, error)) {
-		g_prefix_error_literal(error, "failed to write to DB: ");
+	if (!fu_engine_save_security_attrs(self, json, host_security_id, events, error)) {
+		if (!fu_history_transaction_rollback(self->history, NULL))
+			g_debug("failed to rollback");
 		return FALSE;
 	}
+	if (!fu_history_transaction_commit(self->history, error))
+		return FALSE;
+	fu_engine_security_attrs_append_copy(attrs_recorded, self->host_security_attrs);
+	g_set_object(&self->host_security_attrs_recorded, attrs_recorded);
 
 	/* success */
 	return TRUE;
@@ -7570,16 +7751,38 @@ fu_engine_ensure_security_attrs(FuEngine *self)
 	fu_engine_ensure_security_attrs_supported_cpu(self);
 	fu_engine_ensure_security_attrs_tainted(self);
 
-	/* call into devices */
+	/* call into devices, unless nothing changed since last time */
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index(devices, i);
-		fu_device_add_security_attrs(device, self->host_security_attrs);
+		g_autofree gchar *source_id =
+		    g_strdup_printf("device:%s", fu_device_get_id(device));
+		FuSecurityAttrs *attrs =
+		    g_hash_table_lookup(self->host_security_attrs_sources, source_id);
+		if (attrs == NULL) {
+			attrs = fu_security_attrs_new();
+			fu_device_add_security_attrs(device, attrs);
+			g_hash_table_insert(self->host_security_attrs_sources,
+					    g_steal_pointer(&source_id),
+					    attrs);
+		}
+		fu_engine_security_attrs_append_copy(self->host_security_attrs, attrs);
 	}
 
-	/* call into plugins */
+	/* call into plugins, unless nothing changed since last time */
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index(plugins, j);
-		fu_plugin_runner_add_security_attrs(plugin_tmp, self->host_security_attrs);
+		g_autofree gchar *source_id =
+		    g_strdup_printf("plugin:%s", fu_plugin_get_name(plugin_tmp));
+		FuSecurityAttrs *attrs =
+		    g_hash_table_lookup(self->host_security_attrs_sources, source_id);
+		if (attrs == NULL) {
+			attrs = fu_security_attrs_new();
+			fu_plugin_runner_add_security_attrs(plugin_tmp, attrs);
+			g_hash_table_insert(self->host_security_attrs_sources,
+					    g_steal_pointer(&source_id),
+					    attrs);
+		}
+		fu_engine_security_attrs_append_copy(self->host_security_attrs, attrs);
 	}
 
 	/* sanity check */
@@ -7620,30 +7823,19 @@ FuSecurityAttrs *
 fu_engine_get_host_security_events(FuEngine *self, guint limit, GError **error)
 {
 	g_autoptr(FuSecurityAttrs) events = fu_security_attrs_new();
-	g_autoptr(GPtrArray) attrs_array = NULL;
+	g_autoptr(GPtrArray) attrs = NULL;
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 
-	attrs_array = fu_history_get_security_attrs(self->history, limit, error);
-	if (attrs_array == NULL)
+	/* the changes are computed when each snapshot is recorded */
+	attrs = fu_history_get_security_events(self->history, limit, error);
+	if (attrs == NULL)
 		return NULL;
-	for (guint i = 1; i < attrs_array->len; i++) {
-		FuSecurityAttrs *attrs_new = g_ptr_array_index(attrs_array, i - 1);
-		FuSecurityAttrs *attrs_old = g_ptr_array_index(attrs_array, i - 0);
-		g_autoptr(GPtrArray) diffs = fu_security_attrs_compare(attrs_old, attrs_new);
-		for (guint j = 0; j < diffs->len; j++) {
-			FwupdSecurityAttr *attr = g_ptr_array_index(diffs, j);
-			if (fwupd_security_attr_get_title(attr) == NULL) {
-				fwupd_security_attr_set_title(attr,
-							      fu_security_attr_get_title(attr));
-			}
-			if (fwupd_security_attr_get_description(attr) == NULL) {
-				fwupd_security_attr_set_description(
-				    attr,
-				    fu_security_attr_get_description(attr));
-			}
-			fu_security_attrs_append_internal(events, attr);
-		}
+	for (guint i = 0; i < attrs->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(attrs, i);
+		fwupd_security_attr_set_title(attr, fu_security_attr_get_title(attr));
+		fwupd_security_attr_set_description(attr, fu_security_attr_get_description(attr));
+		fu_security_attrs_append_internal(events, attr);
 	}
 
 	/* success */
@@ -7831,6 +8023,10 @@ fu_engine_plugins_init(FuEngine *self, FuProgress *progress, GError **error)
 				 "rules-changed",
 				 G_CALLBACK(fu_engine_plugin_rules_changed_cb),
 				 self);
+		g_signal_connect(FU_PLUGIN(plugin),
+				 "security-changed",
+				 G_CALLBACK(fu_engine_plugin_security_changed_cb),
+				 self);
 		fu_progress_step_done(progress);
 	}
 
@@ -7992,6 +8188,13 @@ fu_engine_backend_device_added_run_plugin(FuEngine *self,
 	if (plugin == NULL)
 		return FALSE;
 
+	/* the first matching device starts a lazy plugin */
+	if (fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP)) {
+		g_autofree gchar *reason =
+		    g_strdup_printf("backend device %s", fu_device_get_backend_id(device));
+		fu_engine_plugin_activate(self, plugin, reason);
+	}
+
 	/* run the ->probe() then ->setup() vfuncs */
 	if (!fu_plugin_runner_backend_device_added(plugin, device, progress, error)) {
 #ifdef SUPPORTED_BUILD
@@ -8040,13 +8243,29 @@ fu_engine_backend_device_added_run_plugins(FuEngine *self, FuDevice *device, FuP
 	for (guint i = 0; i < possible_plugins->len; i++) {
 		const gchar *plugin_name = g_ptr_array_index(possible_plugins, i);
 		g_autoptr(GError) error_local = NULL;
+
+		/* rejected by this plugin before the daemon last exited, which is only trusted
+		 * for coldplug as the device might have changed state since then */
+		if (!fu_engine_get_loaded(self) &&
+		    fu_engine_snapshot_has_ignored(self->snapshot, device, plugin_name)) {
+			g_debug("%s ignoring %s from snapshot",
+				plugin_name,
+				fu_device_get_backend_id(device));
+			fu_progress_step_done(progress);
+			continue;
+		}
 		if (!fu_engine_backend_device_added_run_plugin(self,
 							       device,
 							       plugin_name,
 							       fu_progress_get_child(progress),
 							       &error_local)) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
-			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
+			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+				g_debug("%s ignoring: %s", plugin_name, error_local->message);
+				fu_engine_snapshot_add_ignored(self->snapshot, device, plugin_name);
+			} else if (g_error_matches(error_local,
+						   FWUPD_ERROR,
+						   FWUPD_ERROR_NOT_FOUND)) {
+				/* might be transient, e.g. the device is not ready yet */
 				g_debug("%s ignoring: %s", plugin_name, error_local->message);
 			} else {
 				g_warning("failed to add device %s: %s",
@@ -8223,11 +8442,28 @@ fu_engine_load_quirks_for_hwid(FuEngine *self, const gchar *hwid)
 		}
 		g_info("enabling %s due to HwId %s", plugins[i], hwid);
 		fu_plugin_remove_flag(plugin, FWUPD_PLUGIN_FLAG_REQUIRE_HWID);
+		if (fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP) &&
+		    fu_plugin_get_activation_reason(plugin) == NULL) {
+			g_autofree gchar *reason = g_strdup_printf("HwId %s", hwid);
+			fu_plugin_set_activation_reason(plugin, reason);
+		}
 	}
 }
 
+/* the history is written afterwards so that plugins are never called inside a transaction */
+static void
+fu_engine_update_history_device_changed(GPtrArray *devices_changed, FuDevice *dev_history)
+{
+	if (g_ptr_array_find(devices_changed, dev_history, NULL))
+		return;
+	g_ptr_array_add(devices_changed, g_object_ref(dev_history));
+}
+
 static gboolean
-fu_engine_update_history_device(FuEngine *self, FuDevice *dev_history, GError **error)
+fu_engine_update_history_device(FuEngine *self,
+				FuDevice *dev_history,
+				GPtrArray *devices_changed,
+				GError **error)
 {
 	FuPlugin *plugin;
 	FuRelease *rel_history;
@@ -8274,13 +8510,7 @@ fu_engine_update_history_device(FuEngine *self, FuDevice *dev_history, GError **
 	metadata_device = fu_device_report_metadata_post(dev);
 	if (metadata_device != NULL && g_hash_table_size(metadata_device) > 0) {
 		fu_release_add_metadata(rel_history, metadata_device);
-		if (!fu_history_modify_device_release(self->history,
-						      dev_history,
-						      rel_history,
-						      error)) {
-			g_prefix_error_literal(error, "failed to set metadata: ");
-			return FALSE;
-		}
+		fu_engine_update_history_device_changed(devices_changed, dev_history);
 	}
 
 	/* measure the "new" system state */
@@ -8315,10 +8545,8 @@ fu_engine_update_history_device(FuEngine *self, FuDevice *dev_history, GError **
 		fu_device_set_version(dev_history, fu_device_get_version(dev));
 		fu_device_remove_flag(dev_history, FWUPD_DEVICE_FLAG_NEEDS_ACTIVATION);
 		fu_device_set_update_state(dev_history, FWUPD_UPDATE_STATE_SUCCESS);
-		return fu_history_modify_device_release(self->history,
-							dev_history,
-							rel_history,
-							error);
+		fu_engine_update_history_device_changed(devices_changed, dev_history);
+		return TRUE;
 	}
 
 	/* does the plugin know the update failure */
@@ -8342,13 +8570,15 @@ fu_engine_update_history_device(FuEngine *self, FuDevice *dev_history, GError **
 	}
 
 	/* update the state in the database */
-	return fu_history_modify_device_release(self->history, dev_history, rel_history, error);
+	fu_engine_update_history_device_changed(devices_changed, dev_history);
+	return TRUE;
 }
 
 static gboolean
 fu_engine_update_history_database(FuEngine *self, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_changed = g_ptr_array_new_with_free_func(g_object_unref);
 
 	/* get any devices */
 	devices = fu_history_get_devices(self->history, error);
@@ -8364,7 +8594,7 @@ fu_engine_update_history_database(FuEngine *self, GError **error)
 			continue;
 
 		/* try to save the new update-state, but ignoring any error */
-		if (!fu_engine_update_history_device(self, dev, &error_local)) {
+		if (!fu_engine_update_history_device(self, dev, devices_changed, &error_local)) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND)) {
 				g_debug("failed to update history database: %s",
 					error_local->message);
@@ -8373,6 +8603,29 @@ fu_engine_update_history_database(FuEngine *self, GError **error)
 			g_warning("failed to update history database: %s", error_local->message);
 		}
 	}
+	if (devices_changed->len == 0)
+		return TRUE;
+
+	/* write all the changes in one commit, so the new states are all saved or none are */
+	if (!fu_history_transaction_begin(self->history, error)) {
+		g_prefix_error_literal(error, "failed to update history database: ");
+		return FALSE;
+	}
+	for (guint i = 0; i < devices_changed->len; i++) {
+		FuDevice *dev = g_ptr_array_index(devices_changed, i);
+		FuRelease *rel = FU_RELEASE(fu_device_get_release_default(dev));
+		if (!fu_history_modify_device_release(self->history, dev, rel, error)) {
+			g_autoptr(GError) error_local = NULL;
+			g_prefix_error_literal(error, "failed to update history database: ");
+			if (!fu_history_transaction_rollback(self->history, &error_local))
+				g_warning("failed to rollback: %s", error_local->message);
+			return FALSE;
+		}
+	}
+	if (!fu_history_transaction_commit(self->history, error)) {
+		g_prefix_error_literal(error, "failed to update history database: ");
+		return FALSE;
+	}
 	return TRUE;
 }
 
@@ -8403,6 +8656,27 @@ fu_engine_ensure_client_certificate(FuEngine *self)
 	g_info("client certificate exists and working");
 }
 
+static gboolean
+fu_engine_ensure_verify_cache(FuEngine *self, GError **error)
+{
+	const gchar *pkidirs[] = {"fwupd", "fwupd-metadata", NULL};
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuCabinetVerifyCache) verify_cache = fu_cabinet_verify_cache_new();
+
+	/* the same trust roots as the Jcat context */
+	for (guint i = 0; pkidirs[i] != NULL; i++) {
+		g_autofree gchar *pkidir =
+		    fu_path_build(FU_PATH_KIND_SYSCONFDIR, "pki", pkidirs[i], NULL);
+		if (!fu_cabinet_verify_cache_add_trust_root(verify_cache, pkidir, error))
+			return FALSE;
+	}
+	filename = fu_path_build(FU_PATH_KIND_CACHEDIR_PKG, "verify.cache", NULL);
+	if (!fu_cabinet_verify_cache_load(verify_cache, filename, error))
+		return FALSE;
+	g_set_object(&self->verify_cache, verify_cache);
+	return TRUE;
+}
+
 static void
 fu_engine_context_set_battery_threshold(FuContext *ctx)
 {
@@ -8550,6 +8824,47 @@ fu_engine_backends_coldplug_backend_add_devices(FuEngine *self,
 	return TRUE;
 }
 
+/* the plugins may use quirks or config to decide if a device is supported */
+static gchar *
+fu_engine_snapshot_build_context_id(FuEngine *self)
+{
+	const gchar *quirks_guid = fu_context_get_quirks_guid(self->ctx);
+	g_autofree gchar *config_checksum = fu_config_build_checksum(FU_CONFIG(self->config));
+	return g_strdup_printf("%s|%s",
+			       quirks_guid != NULL ? quirks_guid : "none",
+			       config_checksum);
+}
+
+static void
+fu_engine_snapshot_load_cached(FuEngine *self)
+{
+	g_autofree gchar *fn = fu_path_build(FU_PATH_KIND_CACHEDIR_PKG, "snapshot.json", NULL);
+	g_autoptr(GError) error_local = NULL;
+	if (!fu_engine_snapshot_load(self->snapshot, fn, &error_local))
+		g_debug("failed to load snapshot: %s", error_local->message);
+}
+
+static void
+fu_engine_snapshot_save_cached(FuEngine *self)
+{
+	g_autofree gchar *context_id = NULL;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	if (self->load_flags & FU_ENGINE_LOAD_FLAG_READONLY)
+		return;
+
+	/* devices may have been rejected using the old quirks or config */
+	context_id = fu_engine_snapshot_build_context_id(self);
+	if (g_strcmp0(context_id, fu_engine_snapshot_get_context_id(self->snapshot)) != 0) {
+		g_debug("quirks or config changed since coldplug, not saving snapshot");
+		return;
+	}
+	fn = fu_path_build(FU_PATH_KIND_CACHEDIR_PKG, "snapshot.json", NULL);
+	if (!fu_engine_snapshot_save(self->snapshot, fn, &error_local))
+		g_debug("failed to save snapshot: %s", error_local->message);
+}
+
 static gboolean
 fu_engine_backends_coldplug_backend(FuEngine *self,
 				    FuBackend *backend,
@@ -8743,6 +9058,14 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 	/* create client certificate */
 	if (flags & FU_ENGINE_LOAD_FLAG_ENSURE_CLIENT_CERT)
 		fu_engine_ensure_client_certificate(self);
+
+	/* remember verified payloads, but only if the cache can be saved */
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0 &&
+	    (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) == 0) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_engine_ensure_verify_cache(self, &error_local))
+			g_info("failed to load verify cache: %s", error_local->message);
+	}
 	fu_progress_step_done(progress);
 
 	/* get hardcoded approved and blocked firmware */
@@ -8944,8 +9267,14 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 	}
 
 	/* coldplug backends */
-	if (flags & FU_ENGINE_LOAD_FLAG_COLDPLUG)
+	if (flags & FU_ENGINE_LOAD_FLAG_COLDPLUG) {
+		g_autofree gchar *context_id = fu_engine_snapshot_build_context_id(self);
+		fu_engine_snapshot_set_context_id(self->snapshot, context_id);
+		if ((flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) == 0)
+			fu_engine_snapshot_load_cached(self);
 		fu_engine_backends_coldplug(self, fu_progress_get_child(progress));
+		fu_engine_snapshot_save_cached(self);
+	}
 	fu_progress_step_done(progress);
 
 	/* coldplug done, so plugin is ready */
@@ -9219,6 +9548,8 @@ fu_engine_context_power_changed_cb(FuContext *ctx, GParamSpec *pspec, FuEngine *
 static void
 fu_engine_idle_timeout_cb(FuIdle *idle, FuEngine *self)
 {
+	/* include devices hotplugged since startup */
+	fu_engine_snapshot_save_cached(self);
 	fu_engine_set_status(self, FWUPD_STATUS_SHUTDOWN);
 }
 
@@ -9395,11 +9726,18 @@ fu_engine_init(FuEngine *self)
 	self->remote_list = fu_remote_list_new();
 	self->device_list = fu_device_list_new();
 	self->idle = fu_idle_new();
+	self->snapshot = fu_engine_snapshot_new();
 	self->plugin_list = fu_plugin_list_new();
 	self->plugin_filter = g_ptr_array_new_with_free_func(g_free);
+	self->plugins_deferred = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->host_security_attrs = fu_security_attrs_new();
+	self->host_security_attrs_sources =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
 	self->local_monitors = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	self->search_queries = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->components_cache = g_hash_table_new_full(g_str_hash,
+						       g_str_equal,
+						       g_free,
+						       (GDestroyNotify)g_ptr_array_unref);
 	self->acquiesce_loop = g_main_loop_new(NULL, FALSE);
 	self->device_changed_allowlist =
 	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
@@ -9431,6 +9769,10 @@ fu_engine_finalize(GObject *obj)
 		g_object_unref(self->query_container_checksum2);
 	if (self->query_tag_by_guid_version != NULL)
 		g_object_unref(self->query_tag_by_guid_version);
+	if (self->search_index != NULL)
+		g_object_unref(self->search_index);
+	if (self->verify_cache != NULL)
+		g_object_unref(self->verify_cache);
 	if (self->approved_firmware != NULL)
 		g_hash_table_unref(self->approved_firmware);
 	if (self->blocked_firmware != NULL)
@@ -9449,15 +9791,20 @@ fu_engine_finalize(GObject *obj)
 
 	g_free(self->host_machine_id);
 	g_object_unref(self->host_security_attrs);
+	if (self->host_security_attrs_recorded != NULL)
+		g_object_unref(self->host_security_attrs_recorded);
+	g_hash_table_unref(self->host_security_attrs_sources);
 	g_object_unref(self->idle);
+	g_object_unref(self->snapshot);
 	g_object_unref(self->config);
 	g_object_unref(self->remote_list);
 	g_object_unref(self->history);
 	g_object_unref(self->device_list);
 	g_object_unref(self->jcat_context);
 	g_ptr_array_unref(self->plugin_filter);
+	g_ptr_array_unref(self->plugins_deferred);
 	g_ptr_array_unref(self->local_monitors);
-	g_ptr_array_unref(self->search_queries);
+	g_hash_table_unref(self->components_cache);
 	g_hash_table_unref(self->device_changed_allowlist);
 	g_object_unref(self->plugin_list);
 
@@ -32,8 +32,9 @@
  * v12	add install_duration to history
  * v13	add release_flags to history
  * v14	create table emulation_tag
+ * v15	create table hsi_event
  */
-#define FU_HISTORY_CURRENT_SCHEMA_VERSION 14
+#define FU_HISTORY_CURRENT_SCHEMA_VERSION 15
 
 static void
 fu_history_finalize(GObject *object);
@@ -42,6 +43,7 @@ struct _FuHistory {
 	GObject parent_instance;
 	FuContext *ctx;
 	sqlite3 *db;
+	GHashTable *stmts; /* (element-type utf8 sqlite3_stmt) */
 };
 
 G_DEFINE_TYPE(FuHistory, fu_history, G_TYPE_OBJECT)
@@ -51,6 +53,46 @@ G_DEFINE_TYPE(FuHistory, fu_history, G_TYPE_OBJECT)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(sqlite3_stmt, sqlite3_finalize);
 #pragma clang diagnostic pop
 
+/* a cached statement that is only reset, not finalized, when it goes out of scope */
+typedef sqlite3_stmt FuHistoryStmt;
+
+static void
+fu_history_stmt_reset(FuHistoryStmt *stmt)
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuHistoryStmt, fu_history_stmt_reset)
+
+/* @sql must be a static string as it is used as the key in the cache */
+static FuHistoryStmt *
+fu_history_prepare(FuHistory *self, const gchar *sql, GError **error)
+{
+	sqlite3_stmt *stmt = g_hash_table_lookup(self->stmts, sql);
+	if (stmt == NULL) {
+		gint rc = sqlite3_prepare_v2(self->db, sql, -1, &stmt, NULL);
+		if (rc != SQLITE_OK) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INTERNAL,
+					    sqlite3_errmsg(self->db));
+			return NULL;
+		}
+		g_hash_table_insert(self->stmts, (gpointer)sql, stmt);
+	}
+	return stmt;
+}
+
+static void
+fu_history_close(FuHistory *self)
+{
+	/* all statements have to be finalized before the connection can be closed */
+	g_hash_table_remove_all(self->stmts);
+	sqlite3_close(self->db);
+	self->db = NULL;
+}
+
 static FuDevice *
 fu_history_device_from_stmt(sqlite3_stmt *stmt)
 {
@@ -187,6 +229,33 @@ fu_history_stmt_exec(FuHistory *self, sqlite3_stmt *stmt, GPtrArray *array, GErr
 	return TRUE;
 }
 
+/* @timestamp is NULL for now */
+static gboolean
+fu_history_insert_security_event(FuHistory *self,
+				 FwupdSecurityAttr *attr,
+				 const gchar *timestamp,
+				 GError **error)
+{
+	g_autoptr(FuHistoryStmt) stmt = NULL;
+
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO hsi_event (timestamp, appstream_id, plugin, "
+				  "result, result_fallback, flags) "
+				  "VALUES (COALESCE(?1, CURRENT_TIMESTAMP), ?2, ?3, ?4, ?5, ?6)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to write security event: ");
+		return FALSE;
+	}
+	sqlite3_bind_text(stmt, 1, timestamp, -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 2, fwupd_security_attr_get_appstream_id(attr), -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 3, fwupd_security_attr_get_plugin(attr), -1, SQLITE_STATIC);
+	sqlite3_bind_int(stmt, 4, fwupd_security_attr_get_result(attr));
+	sqlite3_bind_int(stmt, 5, fwupd_security_attr_get_result_fallback(attr));
+	sqlite3_bind_int64(stmt, 6, fwupd_security_attr_get_flags(attr));
+	return fu_history_stmt_exec(self, stmt, NULL, error);
+}
+
 static gboolean
 fu_history_create_database(FuHistory *self, GError **error)
 {
@@ -229,6 +298,14 @@ fu_history_create_database(FuHistory *self, GError **error)
 			  "hsi_score TEXT DEFAULT NULL);"
 			  "CREATE TABLE emulation_tag (device_id TEXT);"
 			  "CREATE UNIQUE INDEX idx_device_id ON emulation_tag (device_id);"
+			  "CREATE TABLE hsi_event ("
+			  "timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+			  "appstream_id TEXT NOT NULL,"
+			  "plugin TEXT DEFAULT NULL,"
+			  "result INTEGER DEFAULT 0,"
+			  "result_fallback INTEGER DEFAULT 0,"
+			  "flags INTEGER DEFAULT 0);"
+			  "CREATE INDEX idx_hsi_event_timestamp ON hsi_event (timestamp);"
 			  "COMMIT;",
 			  NULL,
 			  NULL,
@@ -470,6 +547,104 @@ fu_history_migrate_database_v12(FuHistory *self, GError **error)
 	return TRUE;
 }
 
+/* convert the old snapshots into events, which are the changes between each snapshot */
+static gboolean
+fu_history_migrate_security_events(FuHistory *self, GError **error)
+{
+	gint rc;
+	g_autoptr(FuSecurityAttrs) attrs_old = NULL;
+	g_autoptr(sqlite3_stmt) stmt = NULL;
+
+	rc = sqlite3_prepare_v2(self->db,
+				"SELECT timestamp, hsi_details FROM hsi_history "
+				"ORDER BY timestamp ASC;",
+				-1,
+				&stmt,
+				NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "Failed to prepare SQL to get security attrs: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		const gchar *timestamp = (const gchar *)sqlite3_column_text(stmt, 0);
+		const gchar *json = (const gchar *)sqlite3_column_text(stmt, 1);
+		g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new();
+		g_autoptr(GError) error_local = NULL;
+
+		if (timestamp == NULL || json == NULL)
+			continue;
+		if (!fwupd_codec_from_json_string(FWUPD_CODEC(attrs), json, &error_local)) {
+			g_debug("ignoring %s: %s", timestamp, error_local->message);
+			continue;
+		}
+		if (attrs_old != NULL) {
+			g_autoptr(GPtrArray) diffs = fu_security_attrs_compare(attrs_old, attrs);
+			for (guint i = 0; i < diffs->len; i++) {
+				FwupdSecurityAttr *attr = g_ptr_array_index(diffs, i);
+				if (!fu_history_insert_security_event(self, attr, timestamp, error))
+					return FALSE;
+			}
+		}
+		g_set_object(&attrs_old, attrs);
+	}
+	if (rc != SQLITE_DONE) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_READ,
+			    "failed to execute prepared statement: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_history_migrate_database_v13(FuHistory *self, GError **error)
+{
+	gint rc;
+	rc = sqlite3_exec(self->db,
+			  "BEGIN TRANSACTION;"
+			  "CREATE TABLE IF NOT EXISTS hsi_event ("
+			  "timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+			  "appstream_id TEXT NOT NULL,"
+			  "plugin TEXT DEFAULT NULL,"
+			  "result INTEGER DEFAULT 0,"
+			  "result_fallback INTEGER DEFAULT 0,"
+			  "flags INTEGER DEFAULT 0);"
+			  "CREATE INDEX IF NOT EXISTS idx_hsi_event_timestamp "
+			  "ON hsi_event (timestamp);",
+			  NULL,
+			  NULL,
+			  NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "Failed to create table: %s",
+			    sqlite3_errmsg(self->db));
+		sqlite3_exec(self->db, "ROLLBACK;", NULL, NULL, NULL);
+		return FALSE;
+	}
+	if (!fu_history_migrate_security_events(self, error)) {
+		sqlite3_exec(self->db, "ROLLBACK;", NULL, NULL, NULL);
+		return FALSE;
+	}
+	rc = sqlite3_exec(self->db, "COMMIT;", NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "Failed to commit: %s",
+			    sqlite3_errmsg(self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 /* returns 0 if database is not initialized */
 static guint
 fu_history_get_schema_version(FuHistory *self)
@@ -555,6 +730,10 @@ fu_history_create_or_migrate(FuHistory *self, guint schema_ver, GError **error)
 	case 13:
 		if (!fu_history_migrate_database_v12(self, error))
 			return FALSE;
+	/* fall through */
+	case 14:
+		if (!fu_history_migrate_database_v13(self, error))
+			return FALSE;
 		/* no longer fall through */
 		break;
 	default:
@@ -596,6 +775,17 @@ fu_history_open(FuHistory *self, const gchar *filename, GError **error)
 
 	/* turn off the lookaside cache */
 	sqlite3_db_config(self->db, SQLITE_DBCONFIG_LOOKASIDE, NULL, 0, 0);
+
+	/* a commit is an append to the write-ahead log, which is still synced every time so that
+	 * the result of an update is not lost if the system loses power straight afterwards */
+	rc = sqlite3_exec(self->db,
+			  "PRAGMA journal_mode=WAL;"
+			  "PRAGMA synchronous=FULL;",
+			  NULL,
+			  NULL,
+			  NULL);
+	if (rc != SQLITE_OK)
+		g_debug("failed to use WAL, ignoring: %s", sqlite3_errmsg(self->db));
 	return TRUE;
 }
 
@@ -651,7 +841,7 @@ fu_history_load(FuHistory *self, GError **error)
 			g_warning("failed to migrate %s database: %s",
 				  filename,
 				  error_migrate->message);
-			sqlite3_close(self->db);
+			fu_history_close(self);
 			if (g_unlink(filename) != 0) {
 				g_set_error(error,
 					    FWUPD_ERROR,
@@ -694,6 +884,84 @@ fu_history_get_device_flags_filtered(FuDevice *device)
 	return flags;
 }
 
+static gboolean
+fu_history_exec_literal(FuHistory *self, const gchar *sql, GError **error)
+{
+	g_autoptr(FuHistoryStmt) stmt = fu_history_prepare(self, sql, error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL: ");
+		return FALSE;
+	}
+	return fu_history_stmt_exec(self, stmt, NULL, error);
+}
+
+/**
+ * fu_history_transaction_begin:
+ * @self: a #FuHistory
+ * @error: (nullable): optional return location for an error
+ *
+ * Starts a transaction so that multiple changes are written to disk in one commit.
+ * Transactions can be nested, and each one has to be finished using
+ * fu_history_transaction_commit() or fu_history_transaction_rollback().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_history_transaction_begin(FuHistory *self, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return FALSE;
+
+	/* unlike BEGIN, savepoints can be nested */
+	return fu_history_exec_literal(self, "SAVEPOINT history;", error);
+}
+
+/**
+ * fu_history_transaction_commit:
+ * @self: a #FuHistory
+ * @error: (nullable): optional return location for an error
+ *
+ * Finishes the transaction started with fu_history_transaction_begin(). The changes are only
+ * written to disk when the outermost transaction is committed.
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_history_transaction_commit(FuHistory *self, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(self->db != NULL, FALSE);
+	return fu_history_exec_literal(self, "RELEASE history;", error);
+}
+
+/**
+ * fu_history_transaction_rollback:
+ * @self: a #FuHistory
+ * @error: (nullable): optional return location for an error
+ *
+ * Discards all the changes made since the matching fu_history_transaction_begin().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_history_transaction_rollback(FuHistory *self, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(self->db != NULL, FALSE);
+	if (!fu_history_exec_literal(self, "ROLLBACK TO history;", error))
+		return FALSE;
+	return fu_history_exec_literal(self, "RELEASE history;", error);
+}
+
 /**
  * fu_history_modify_device:
  * @self: a #FuHistory
@@ -709,9 +977,8 @@ fu_history_get_device_flags_filtered(FuDevice *device)
 gboolean
 fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -722,24 +989,18 @@ fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"UPDATE history SET "
-				"update_state = ?1, "
-				"update_error = ?2, "
-				"checksum_device = ?6, "
-				"device_modified = ?7, "
-				"install_duration = ?8, "
-				"flags = ?3 "
-				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to update history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "UPDATE history SET "
+				  "update_state = ?1, "
+				  "update_error = ?2, "
+				  "checksum_device = ?6, "
+				  "device_modified = ?7, "
+				  "install_duration = ?8, "
+				  "flags = ?3 "
+				  "WHERE device_id = ?4;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to update history: ");
 		return FALSE;
 	}
 
@@ -789,10 +1050,9 @@ fu_history_modify_device_release(FuHistory *self,
 				 FuRelease *release,
 				 GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -806,24 +1066,18 @@ fu_history_modify_device_release(FuHistory *self,
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"UPDATE history SET "
-				"update_state = ?1, "
-				"update_error = ?2, "
-				"checksum_device = ?6, "
-				"device_modified = ?7, "
-				"metadata = ?8, "
-				"flags = ?3 "
-				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to update history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "UPDATE history SET "
+				  "update_state = ?1, "
+				  "update_error = ?2, "
+				  "checksum_device = ?6, "
+				  "device_modified = ?7, "
+				  "metadata = ?8, "
+				  "flags = ?3 "
+				  "WHERE device_id = ?4;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to update history: ");
 		return FALSE;
 	}
 
@@ -844,43 +1098,15 @@ fu_history_modify_device_release(FuHistory *self,
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
-/**
- * fu_history_add_device:
- * @self: a #FuHistory
- * @device: a device
- * @release: a #FuRelease
- * @error: (nullable): optional return location for an error
- *
- * Adds a device to the history database
- *
- * Returns: @TRUE if successful, @FALSE for failure
- *
- * Since: 1.0.4
- **/
-gboolean
-fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
+static gboolean
+fu_history_insert_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
 {
 	const gchar *checksum_device;
 	const gchar *checksum = NULL;
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-
-	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
-	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
-	g_return_val_if_fail(FU_IS_RELEASE(release), FALSE);
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
-	/* lazy load */
-	if (!fu_history_load(self, error))
-		return FALSE;
-
-	/* make tests easier */
-	fu_device_convert_instance_ids(device);
-
-	/* ensure all old device(s) with this ID are removed */
-	if (!fu_history_remove_device(self, device, error))
-		return FALSE;
 	g_debug("add device %s", id_display);
 	checksum = fwupd_checksum_get_by_kind(fu_release_get_checksums(release), G_CHECKSUM_SHA1);
 	checksum_device =
@@ -890,39 +1116,33 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	metadata = fu_history_convert_hash_to_string(fu_release_get_metadata(release));
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO history (device_id,"
-				"update_state,"
-				"update_error,"
-				"flags,"
-				"filename,"
-				"checksum,"
-				"display_name,"
-				"plugin,"
-				"guid_default,"
-				"metadata,"
-				"device_created,"
-				"device_modified,"
-				"version_old,"
-				"version_new,"
-				"checksum_device,"
-				"protocol,"
-				"release_id,"
-				"appstream_id,"
-				"version_format,"
-				"install_duration,"
-				"release_flags) "
-				"VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
-				"?11,?12,?13,?14,?15,?16,?17,?18,?19,?20,?21)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to insert history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO history (device_id,"
+				  "update_state,"
+				  "update_error,"
+				  "flags,"
+				  "filename,"
+				  "checksum,"
+				  "display_name,"
+				  "plugin,"
+				  "guid_default,"
+				  "metadata,"
+				  "device_created,"
+				  "device_modified,"
+				  "version_old,"
+				  "version_new,"
+				  "checksum_device,"
+				  "protocol,"
+				  "release_id,"
+				  "appstream_id,"
+				  "version_format,"
+				  "install_duration,"
+				  "release_flags) "
+				  "VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
+				  "?11,?12,?13,?14,?15,?16,?17,?18,?19,?20,?21)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to insert history: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, fu_device_get_id(device), -1, SQLITE_STATIC);
@@ -949,6 +1169,46 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
+/**
+ * fu_history_add_device:
+ * @self: a #FuHistory
+ * @device: a device
+ * @release: a #FuRelease
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds a device to the history database
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.0.4
+ **/
+gboolean
+fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
+	g_return_val_if_fail(FU_IS_RELEASE(release), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return FALSE;
+
+	/* make tests easier */
+	fu_device_convert_instance_ids(device);
+
+	/* ensure all old device(s) with this ID are replaced in one commit */
+	if (!fu_history_transaction_begin(self, error))
+		return FALSE;
+	if (!fu_history_remove_device(self, device, error) ||
+	    !fu_history_insert_device(self, device, release, error)) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_history_transaction_rollback(self, &error_local))
+			g_warning("failed to rollback: %s", error_local->message);
+		return FALSE;
+	}
+	return fu_history_transaction_commit(self, error);
+}
+
 /**
  * fu_history_remove_all:
  * @self: a #FuHistory
@@ -963,8 +1223,7 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 gboolean
 fu_history_remove_all(FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -974,13 +1233,9 @@ fu_history_remove_all(FuHistory *self, GError **error)
 
 	/* remove entries */
 	g_debug("removing all devices");
-	rc = sqlite3_prepare_v2(self->db, "DELETE FROM history;", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self, "DELETE FROM history;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to delete history: ");
 		return FALSE;
 	}
 	return fu_history_stmt_exec(self, stmt, NULL, error);
@@ -1001,9 +1256,8 @@ fu_history_remove_all(FuHistory *self, GError **error)
 gboolean
 fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 {
-	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -1013,17 +1267,11 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 		return FALSE;
 
 	g_debug("remove device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"DELETE FROM history WHERE device_id = ?1;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "DELETE FROM history WHERE device_id = ?1;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to delete history: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, fu_device_get_id(device), -1, SQLITE_STATIC);
@@ -1045,9 +1293,8 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 FuDevice *
 fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **error)
 {
-	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 	g_return_val_if_fail(device_id != NULL, NULL);
@@ -1057,39 +1304,33 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 		return NULL;
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT device_id, "
-				"checksum, "
-				"plugin, "
-				"device_created, "
-				"device_modified, "
-				"display_name, "
-				"filename, "
-				"flags, "
-				"metadata, "
-				"guid_default, "
-				"update_state, "
-				"update_error, "
-				"version_new, "
-				"version_old, "
-				"checksum_device, "
-				"protocol, "
-				"release_id, "
-				"appstream_id, "
-				"version_format, "
-				"install_duration, "
-				"release_flags FROM history WHERE "
-				"device_id = ?1 ORDER BY device_created DESC "
-				"LIMIT 1",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT device_id, "
+				  "checksum, "
+				  "plugin, "
+				  "device_created, "
+				  "device_modified, "
+				  "display_name, "
+				  "filename, "
+				  "flags, "
+				  "metadata, "
+				  "guid_default, "
+				  "update_state, "
+				  "update_error, "
+				  "version_new, "
+				  "version_old, "
+				  "checksum_device, "
+				  "protocol, "
+				  "release_id, "
+				  "appstream_id, "
+				  "version_format, "
+				  "install_duration, "
+				  "release_flags FROM history WHERE "
+				  "device_id = ?1 ORDER BY device_created DESC "
+				  "LIMIT 1",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get history: ");
 		return NULL;
 	}
 	sqlite3_bind_text(stmt, 1, device_id, -1, SQLITE_STATIC);
@@ -1118,8 +1359,7 @@ GPtrArray *
 fu_history_get_devices(FuHistory *self, GError **error)
 {
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-	gint rc;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1130,38 +1370,32 @@ fu_history_get_devices(FuHistory *self, GError **error)
 	}
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT device_id, "
-				"checksum, "
-				"plugin, "
-				"device_created, "
-				"device_modified, "
-				"display_name, "
-				"filename, "
-				"flags, "
-				"metadata, "
-				"guid_default, "
-				"update_state, "
-				"update_error, "
-				"version_new, "
-				"version_old, "
-				"checksum_device, "
-				"protocol, "
-				"release_id, "
-				"appstream_id, "
-				"version_format, "
-				"install_duration, "
-				"release_flags FROM history "
-				"ORDER BY device_modified ASC;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get history: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT device_id, "
+				  "checksum, "
+				  "plugin, "
+				  "device_created, "
+				  "device_modified, "
+				  "display_name, "
+				  "filename, "
+				  "flags, "
+				  "metadata, "
+				  "guid_default, "
+				  "update_state, "
+				  "update_error, "
+				  "version_new, "
+				  "version_old, "
+				  "checksum_device, "
+				  "protocol, "
+				  "release_id, "
+				  "appstream_id, "
+				  "version_format, "
+				  "install_duration, "
+				  "release_flags FROM history "
+				  "ORDER BY device_modified ASC;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get history: ");
 		return NULL;
 	}
 	if (!fu_history_stmt_exec(self, stmt, array, error))
@@ -1185,7 +1419,7 @@ fu_history_get_approved_firmware(FuHistory *self, GError **error)
 {
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func(g_free);
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1196,17 +1430,11 @@ fu_history_get_approved_firmware(FuHistory *self, GError **error)
 	}
 
 	/* get all the approved firmware */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT checksum FROM approved_firmware;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get checksum: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT checksum FROM approved_firmware;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get checksum: ");
 		return NULL;
 	}
 	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
@@ -1238,8 +1466,7 @@ fu_history_get_approved_firmware(FuHistory *self, GError **error)
 gboolean
 fu_history_clear_approved_firmware(FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1248,13 +1475,10 @@ fu_history_clear_approved_firmware(FuHistory *self, GError **error)
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db, "DELETE FROM approved_firmware;", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete approved firmware: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self, "DELETE FROM approved_firmware;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error,
+				       "Failed to prepare SQL to delete approved firmware: ");
 		return FALSE;
 	}
 	return fu_history_stmt_exec(self, stmt, NULL, error);
@@ -1275,8 +1499,7 @@ fu_history_clear_approved_firmware(FuHistory *self, GError **error)
 gboolean
 fu_history_add_approved_firmware(FuHistory *self, const gchar *checksum, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(checksum != NULL, FALSE);
@@ -1286,18 +1509,12 @@ fu_history_add_approved_firmware(FuHistory *self, const gchar *checksum, GError
 		return FALSE;
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO approved_firmware (checksum) "
-				"VALUES (?1)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to insert checksum: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO approved_firmware (checksum) "
+				  "VALUES (?1)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to insert checksum: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, checksum, -1, SQLITE_STATIC);
@@ -1320,7 +1537,7 @@ fu_history_get_blocked_firmware(FuHistory *self, GError **error)
 {
 	gint rc;
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func(g_free);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1331,14 +1548,9 @@ fu_history_get_blocked_firmware(FuHistory *self, GError **error)
 	}
 
 	/* get all the blocked firmware */
-	rc =
-	    sqlite3_prepare_v2(self->db, "SELECT checksum FROM blocked_firmware;", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get checksum: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self, "SELECT checksum FROM blocked_firmware;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get checksum: ");
 		return NULL;
 	}
 	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
@@ -1370,8 +1582,7 @@ fu_history_get_blocked_firmware(FuHistory *self, GError **error)
 gboolean
 fu_history_clear_blocked_firmware(FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1380,13 +1591,9 @@ fu_history_clear_blocked_firmware(FuHistory *self, GError **error)
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db, "DELETE FROM blocked_firmware;", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete blocked firmware: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self, "DELETE FROM blocked_firmware;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to delete blocked firmware: ");
 		return FALSE;
 	}
 	return fu_history_stmt_exec(self, stmt, NULL, error);
@@ -1407,8 +1614,7 @@ fu_history_clear_blocked_firmware(FuHistory *self, GError **error)
 gboolean
 fu_history_add_blocked_firmware(FuHistory *self, const gchar *checksum, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(checksum != NULL, FALSE);
@@ -1418,18 +1624,12 @@ fu_history_add_blocked_firmware(FuHistory *self, const gchar *checksum, GError *
 		return FALSE;
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO blocked_firmware (checksum) "
-				"VALUES (?1)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to insert checksum: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO blocked_firmware (checksum) "
+				  "VALUES (?1)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to insert checksum: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, checksum, -1, SQLITE_STATIC);
@@ -1442,8 +1642,7 @@ fu_history_add_security_attribute(FuHistory *self,
 				  const gchar *hsi_score,
 				  GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1452,18 +1651,13 @@ fu_history_add_security_attribute(FuHistory *self,
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO hsi_history (hsi_details, hsi_score)"
-				"VALUES (?1, ?2)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to write security attribute: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO hsi_history (hsi_details, hsi_score)"
+				  "VALUES (?1, ?2)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error,
+				       "Failed to prepare SQL to write security attribute: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, security_attr_json, -1, SQLITE_STATIC);
@@ -1490,7 +1684,7 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 	gint rc;
 	guint old_hash = 0;
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1501,18 +1695,12 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 	}
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT timestamp, hsi_details FROM hsi_history "
-				"ORDER BY timestamp DESC;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to get security attrs: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "SELECT timestamp, hsi_details FROM hsi_history "
+				  "ORDER BY timestamp DESC;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get security attrs: ");
 		return NULL;
 	}
 	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
@@ -1575,6 +1763,147 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 	return g_steal_pointer(&array);
 }
 
+/**
+ * fu_history_add_security_events:
+ * @self: a #FuHistory
+ * @events: (element-type FwupdSecurityAttr): attributes that have changed
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds the security attributes that have changed since the last snapshot, typically using the
+ * results from fu_security_attrs_compare().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_history_add_security_events(FuHistory *self, GPtrArray *events, GError **error)
+{
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+	g_return_val_if_fail(events != NULL, FALSE);
+
+	if (!fu_history_transaction_begin(self, error))
+		return FALSE;
+	for (guint i = 0; i < events->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index(events, i);
+		if (!fu_history_insert_security_event(self, attr, NULL, error)) {
+			if (!fu_history_transaction_rollback(self, NULL))
+				g_debug("failed to rollback");
+			return FALSE;
+		}
+	}
+	return fu_history_transaction_commit(self, error);
+}
+
+/**
+ * fu_history_clear_security_events:
+ * @self: a #FuHistory
+ * @error: (nullable): optional return location for an error
+ *
+ * Clear all security attribute events.
+ *
+ * Returns: #TRUE for success, #FALSE for failure
+ *
+ * Since: 2.1.1
+ **/
+gboolean
+fu_history_clear_security_events(FuHistory *self, GError **error)
+{
+	g_autoptr(FuHistoryStmt) stmt = NULL;
+
+	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return FALSE;
+
+	/* remove entries */
+	stmt = fu_history_prepare(self, "DELETE FROM hsi_event;", error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to delete security events: ");
+		return FALSE;
+	}
+	return fu_history_stmt_exec(self, stmt, NULL, error);
+}
+
+/**
+ * fu_history_get_security_events:
+ * @self: a #FuHistory
+ * @limit: maximum number of snapshots to compare, or 0 for no limit
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the security attributes that have changed, newest first.
+ *
+ * As with fu_history_get_security_attrs(), @limit counts snapshots rather than events, and so
+ * the events from the newest @limit - 1 changes are returned.
+ *
+ * Returns: (element-type FwupdSecurityAttr) (transfer container): attrs
+ *
+ * Since: 2.1.1
+ **/
+GPtrArray *
+fu_history_get_security_events(FuHistory *self, guint limit, GError **error)
+{
+	gint rc;
+	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GTimeZone) tz_utc = g_time_zone_new_utc();
+	g_autoptr(FuHistoryStmt) stmt = NULL;
+
+	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
+
+	/* lazy load */
+	if (!fu_history_load(self, error))
+		return NULL;
+
+	/* all the events of each change share the timestamp of the snapshot */
+	if (limit > 0) {
+		stmt = fu_history_prepare(self,
+					  "SELECT timestamp, appstream_id, plugin, result, "
+					  "result_fallback, flags FROM hsi_event "
+					  "WHERE timestamp IN (SELECT DISTINCT timestamp "
+					  "FROM hsi_event ORDER BY timestamp DESC LIMIT ?1) "
+					  "ORDER BY timestamp DESC, rowid DESC;",
+					  error);
+	} else {
+		stmt = fu_history_prepare(self,
+					  "SELECT timestamp, appstream_id, plugin, result, "
+					  "result_fallback, flags FROM hsi_event "
+					  "ORDER BY timestamp DESC, rowid DESC;",
+					  error);
+	}
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to get security events: ");
+		return NULL;
+	}
+	if (limit > 0)
+		sqlite3_bind_int(stmt, 1, (gint)limit - 1);
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		const gchar *timestamp = (const gchar *)sqlite3_column_text(stmt, 0);
+		const gchar *appstream_id = (const gchar *)sqlite3_column_text(stmt, 1);
+		g_autoptr(FwupdSecurityAttr) attr = fwupd_security_attr_new(appstream_id);
+		g_autoptr(GDateTime) created_dt = NULL;
+
+		fwupd_security_attr_set_plugin(attr, (const gchar *)sqlite3_column_text(stmt, 2));
+		fwupd_security_attr_set_result(attr, sqlite3_column_int(stmt, 3));
+		fwupd_security_attr_set_result_fallback(attr, sqlite3_column_int(stmt, 4));
+		fwupd_security_attr_set_flags(attr, sqlite3_column_int64(stmt, 5));
+		if (timestamp != NULL)
+			created_dt = g_date_time_new_from_iso8601(timestamp, tz_utc);
+		if (created_dt != NULL)
+			fwupd_security_attr_set_created(attr, g_date_time_to_unix(created_dt));
+		g_ptr_array_add(array, g_steal_pointer(&attr));
+	}
+	if (rc != SQLITE_DONE) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_READ,
+			    "failed to execute prepared statement: %s",
+			    sqlite3_errmsg(self->db));
+		return NULL;
+	}
+	return g_steal_pointer(&array);
+}
+
 /**
  * fu_history_has_emulation_tag:
  * @self: a #FuHistory
@@ -1591,7 +1920,7 @@ gboolean
 fu_history_has_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1603,25 +1932,17 @@ fu_history_has_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 
 	/* get tagged device ID */
 	if (device_id != NULL) {
-		rc = sqlite3_prepare_v2(self->db,
-					"SELECT device_id FROM emulation_tag "
-					"WHERE device_id = ?1 LIMIT 1;",
-					-1,
-					&stmt,
-					NULL);
+		stmt = fu_history_prepare(self,
+					  "SELECT device_id FROM emulation_tag "
+					  "WHERE device_id = ?1 LIMIT 1;",
+					  error);
 	} else {
-		rc = sqlite3_prepare_v2(self->db,
-					"SELECT device_id FROM emulation_tag LIMIT 1;",
-					-1,
-					&stmt,
-					NULL);
+		stmt = fu_history_prepare(self,
+					  "SELECT device_id FROM emulation_tag LIMIT 1;",
+					  error);
 	}
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "failed to prepare SQL to get emulation tag: %s",
-			    sqlite3_errmsg(self->db));
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to prepare SQL to get emulation tag: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, device_id, -1, SQLITE_STATIC);
@@ -1669,8 +1990,7 @@ fu_history_has_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 gboolean
 fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(device_id != NULL, FALSE);
@@ -1680,18 +2000,12 @@ fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 		return FALSE;
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
-				"INSERT INTO emulation_tag (device_id) "
-				"VALUES (?1)",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "failed to prepare SQL to insert emulation tag: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "INSERT INTO emulation_tag (device_id) "
+				  "VALUES (?1)",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "failed to prepare SQL to insert emulation tag: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, device_id, -1, SQLITE_STATIC);
@@ -1712,8 +2026,7 @@ fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 gboolean
 fu_history_remove_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(device_id != NULL, FALSE);
@@ -1723,17 +2036,11 @@ fu_history_remove_emulation_tag(FuHistory *self, const gchar *device_id, GError
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db,
-				"DELETE FROM emulation_tag WHERE device_id = ?1;",
-				-1,
-				&stmt,
-				NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "Failed to prepare SQL to delete emulation tag: %s",
-			    sqlite3_errmsg(self->db));
+	stmt = fu_history_prepare(self,
+				  "DELETE FROM emulation_tag WHERE device_id = ?1;",
+				  error);
+	if (stmt == NULL) {
+		g_prefix_error_literal(error, "Failed to prepare SQL to delete emulation tag: ");
 		return FALSE;
 	}
 	sqlite3_bind_text(stmt, 1, device_id, -1, SQLITE_STATIC);
@@ -1769,6 +2076,8 @@ fu_history_class_init(FuHistoryClass *klass)
 static void
 fu_history_init(FuHistory *self)
 {
+	self->stmts =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)sqlite3_finalize);
 }
 
 static void
@@ -1776,7 +2085,8 @@ fu_history_finalize(GObject *object)
 {
 	FuHistory *self = FU_HISTORY(object);
 	if (self->db != NULL)
-		sqlite3_close(self->db);
+		fu_history_close(self);
+	g_hash_table_unref(self->stmts);
 	G_OBJECT_CLASS(fu_history_parent_class)->finalize(object);
 }
 
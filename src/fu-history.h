@@ -16,6 +16,13 @@ G_DECLARE_FINAL_TYPE(FuHistory, fu_history, FU, HISTORY, GObject)
 FuHistory *
 fu_history_new(FuContext *ctx);
 
+gboolean
+fu_history_transaction_begin(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_history_transaction_commit(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_history_transaction_rollback(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
+
 gboolean
 fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
     G_GNUC_NON_NULL(1, 2, 3);
@@ -57,6 +64,13 @@ fu_history_add_security_attribute(FuHistory *self,
 				  GError **error) G_GNUC_NON_NULL(1, 2, 3);
 GPtrArray *
 fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error) G_GNUC_NON_NULL(1);
+gboolean
+fu_history_add_security_events(FuHistory *self, GPtrArray *events, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_history_clear_security_events(FuHistory *self, GError **error) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_history_get_security_events(FuHistory *self, guint limit, GError **error) G_GNUC_NON_NULL(1);
 
 gboolean
 fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
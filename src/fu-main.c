@@ -77,6 +77,7 @@ main(int argc, char *argv[])
 {
 	gboolean immediate_exit = FALSE;
 	gboolean timed_exit = FALSE;
+	gboolean trace = FALSE;
 	const gchar *socket_filename = g_getenv("FWUPD_DBUS_SOCKET");
 	const GOptionEntry options[] = {
 	    {"timed-exit",
@@ -95,6 +96,14 @@ main(int argc, char *argv[])
 	     /* TRANSLATORS: exit straight away, used for automatic profiling */
 	     N_("Exit after the engine has loaded"),
 	     NULL},
+	    {"trace",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_NONE,
+	     &trace,
+	     /* TRANSLATORS: record timing data that can be read using GetTrace */
+	     N_("Record a timing trace of the daemon"),
+	     NULL},
 	    {NULL}};
 	g_autofree gchar *socket_address = NULL;
 	g_autoptr(GError) error = NULL;
@@ -121,6 +130,7 @@ main(int argc, char *argv[])
 		g_printerr("Failed to parse command line: %s\n", error->message);
 		return EXIT_FAILURE;
 	}
+	fu_trace_set_enabled(trace);
 
 #ifdef FWUPD_DBUS_SOCKET_ADDRESS
 	/* this is set for macOS and Windows */
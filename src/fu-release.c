@@ -32,6 +32,7 @@ struct _FuRelease {
 	gchar *firmware_basename;
 	GPtrArray *soft_reqs; /* nullable, element-type XbNode */
 	GPtrArray *hard_reqs; /* nullable, element-type XbNode */
+	FuVersionKey *version_key; /* nullable */
 	guint64 priority;
 };
 
@@ -100,6 +101,30 @@ fu_release_get_request(FuRelease *self)
 	return self->request;
 }
 
+/**
+ * fu_release_get_version_key:
+ * @self: a #FuRelease
+ * @fmt: a version format, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Gets the release version in a form that can be compared many times without allocating, for
+ * instance when sorting releases.
+ *
+ * Returns: (transfer none): a version key
+ **/
+FuVersionKey *
+fu_release_get_version_key(FuRelease *self, FwupdVersionFormat fmt)
+{
+	g_return_val_if_fail(FU_IS_RELEASE(self), NULL);
+
+	if (self->version_key == NULL || fu_version_key_get_format(self->version_key) != fmt ||
+	    g_strcmp0(fu_version_key_get_version(self->version_key),
+		      fu_release_get_version(self)) != 0) {
+		g_clear_pointer(&self->version_key, fu_version_key_free);
+		self->version_key = fu_version_key_new(fu_release_get_version(self), fmt);
+	}
+	return self->version_key;
+}
+
 /**
  * fu_release_get_device_version_old:
  * @self: a #FuRelease
@@ -1375,9 +1400,9 @@ fu_release_compare(FuRelease *release1, FuRelease *release2)
 	}
 
 	/* FWUPD_DEVICE_FLAG_INSTALL_ALL_RELEASES has to be from oldest to newest */
-	return fu_version_compare(fu_release_get_version(release1),
-				  fu_release_get_version(release2),
-				  fu_device_get_version_format(device1));
+	return fu_version_key_compare(
+	    fu_release_get_version_key(release1, fu_device_get_version_format(device1)),
+	    fu_release_get_version_key(release2, fu_device_get_version_format(device1)));
 }
 
 static void
@@ -1408,6 +1433,8 @@ fu_release_finalize(GObject *obj)
 		g_ptr_array_unref(self->soft_reqs);
 	if (self->hard_reqs != NULL)
 		g_ptr_array_unref(self->hard_reqs);
+	if (self->version_key != NULL)
+		fu_version_key_free(self->version_key);
 
 	G_OBJECT_CLASS(fu_release_parent_class)->finalize(obj);
 }
@@ -70,6 +70,8 @@ const gchar *
 fu_release_get_device_version_old(FuRelease *self) G_GNUC_NON_NULL(1);
 const gchar *
 fu_release_get_firmware_basename(FuRelease *self) G_GNUC_NON_NULL(1);
+FuVersionKey *
+fu_release_get_version_key(FuRelease *self, FwupdVersionFormat fmt) G_GNUC_NON_NULL(1);
 
 void
 fu_release_set_request(FuRelease *self, FuEngineRequest *request) G_GNUC_NON_NULL(1);
@@ -28,6 +28,8 @@
 #include "fu-engine-config.h"
 #include "fu-engine-helper.h"
 #include "fu-engine-requirements.h"
+#include "fu-engine-search-index.h"
+#include "fu-engine-snapshot.h"
 #include "fu-engine.h"
 #include "fu-history.h"
 #include "fu-idle.h"
@@ -37,6 +39,7 @@
 #include "fu-remote-list.h"
 #include "fu-remote.h"
 #include "fu-security-attrs-private.h"
+#include "fu-udev-device-private.h"
 #include "fu-usb-backend.h"
 #include "fu-util-common.h"
 
@@ -2256,6 +2259,71 @@ fu_engine_device_parent_id_func(gconstpointer user_data)
 	g_assert_cmpstr(fu_device_get_vendor(device3), ==, "oem");
 }
 
+#ifdef HAVE_HSI
+static void
+fu_engine_security_attrs_sources_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
+	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new_from_gtype(fu_test_plugin_get_type(), self->ctx);
+	g_autoptr(FuPlugin) plugin_other = fu_plugin_new(self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuSecurityAttrs) attrs1 = NULL;
+	g_autoptr(FuSecurityAttrs) attrs2 = NULL;
+	g_autoptr(FuSecurityAttrs) attrs3 = NULL;
+	g_autoptr(FwupdSecurityAttr) attr1 = NULL;
+	g_autoptr(FwupdSecurityAttr) attr2 = NULL;
+	g_autoptr(FwupdSecurityAttr) attr3 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo(engine, silo_empty);
+
+	/* the test plugin uses a device owned by another plugin */
+	fu_plugin_set_name(plugin_other, "other");
+	fu_engine_add_plugin(engine, plugin);
+	fu_engine_add_plugin(engine, plugin_other);
+	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_NO_CACHE, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_device_set_id(device, "hsi_device");
+	fu_device_set_plugin(device, "other");
+	fu_device_set_metadata(device, "TestHsi", "true");
+	fu_engine_add_device(engine, device);
+	attrs1 = fu_engine_get_host_security_attrs(engine);
+	attr1 = fu_security_attrs_get_by_appstream_id(attrs1, "org.fwupd.hsi.Test", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr1);
+	g_assert_cmpint(fwupd_security_attr_get_result(attr1),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_NOT_LOCKED);
+
+	/* changing the device has to recalculate the test plugin too */
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_LOCKED);
+	attrs2 = fu_engine_get_host_security_attrs(engine);
+	attr2 = fu_security_attrs_get_by_appstream_id(attrs2, "org.fwupd.hsi.Test", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr2);
+	g_assert_cmpint(fwupd_security_attr_get_result(attr2),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_LOCKED);
+	g_assert_true(fwupd_security_attr_has_flag(attr2, FWUPD_SECURITY_ATTR_FLAG_SUCCESS));
+
+	/* removing the device has to recalculate the test plugin too */
+	fu_plugin_device_remove(plugin_other, device);
+	attrs3 = fu_engine_get_host_security_attrs(engine);
+	attr3 = fu_security_attrs_get_by_appstream_id(attrs3, "org.fwupd.hsi.Test", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(attr3);
+}
+#endif
+
 static void
 fu_engine_partial_hash_func(gconstpointer user_data)
 {
@@ -2812,12 +2880,25 @@ fu_engine_get_details_missing_func(gconstpointer user_data)
 	g_assert_cmpstr(fwupd_release_get_version(release), ==, "1.2.3");
 }
 
+static guint64
+fu_engine_get_report_metadata_uint(FuEngine *engine, const gchar *key)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) metadata = fu_engine_get_report_metadata(engine, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(metadata);
+	g_assert_nonnull(g_hash_table_lookup(metadata, key));
+	return g_ascii_strtoull(g_hash_table_lookup(metadata, key), NULL, 10);
+}
+
 static void
 fu_engine_downgrade_func(gconstpointer user_data)
 {
 	FuTest *self = (FuTest *)user_data;
 	FwupdRelease *rel;
 	gboolean ret;
+	guint64 cache_hits;
+	guint64 cache_misses;
 	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
 	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
 	g_autoptr(FuEngineRequest) request = fu_engine_request_new(NULL);
@@ -2827,10 +2908,12 @@ fu_engine_downgrade_func(gconstpointer user_data)
 	g_autoptr(GPtrArray) devices_pre = NULL;
 	g_autoptr(GPtrArray) releases_dg = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
+	g_autoptr(GPtrArray) releases_cached = NULL;
 	g_autoptr(GPtrArray) releases_up = NULL;
 	g_autoptr(GPtrArray) releases_up2 = NULL;
 	g_autoptr(GPtrArray) remotes = NULL;
 	g_autoptr(XbSilo) silo_empty = xb_silo_new();
+	g_autoptr(XbSilo) silo_reload = NULL;
 
 	/* ensure empty tree */
 	fu_self_test_mkroot();
@@ -2964,6 +3047,22 @@ fu_engine_downgrade_func(gconstpointer user_data)
 	g_assert_nonnull(releases);
 	g_assert_cmpint(releases->len, ==, 4);
 
+	/* the matched components are reused, but the releases are built for each request */
+	cache_hits = fu_engine_get_report_metadata_uint(engine, "ComponentCacheHits");
+	cache_misses = fu_engine_get_report_metadata_uint(engine, "ComponentCacheMisses");
+	g_assert_cmpint(cache_misses, >, 0);
+	releases_cached =
+	    fu_engine_get_releases(engine, request, fu_device_get_id(device), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(releases_cached);
+	g_assert_cmpint(releases_cached->len, ==, 4);
+	g_assert_cmpint(fu_engine_get_report_metadata_uint(engine, "ComponentCacheHits"),
+			>,
+			cache_hits);
+	g_assert_cmpint(fu_engine_get_report_metadata_uint(engine, "ComponentCacheMisses"),
+			==,
+			cache_misses);
+
 	/* no upgrades, as no firmware is approved */
 	releases_up = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
@@ -3002,6 +3101,32 @@ fu_engine_downgrade_func(gconstpointer user_data)
 	releases_up2 = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
 	g_assert_null(releases_up2);
+	g_clear_error(&error);
+
+	/* the matched components are dropped when the metadata is reloaded */
+	silo_reload = xb_silo_new_from_xml(
+	    "<components>"
+	    "  <component type=\"firmware\">"
+	    "    <id>test</id>"
+	    "    <provides>"
+	    "      <firmware type=\"flashed\">aaaaaaaa-bbbb-cccc-dddd-eeeeeeeeeeee</firmware>"
+	    "    </provides>"
+	    "  </component>"
+	    "</components>",
+	    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(silo_reload);
+	fu_engine_set_silo(engine, silo_reload);
+	g_assert_cmpint(fu_engine_get_report_metadata_uint(engine, "ComponentCacheSize"), ==, 0);
+	cache_hits = fu_engine_get_report_metadata_uint(engine, "ComponentCacheHits");
+	cache_misses = fu_engine_get_report_metadata_uint(engine, "ComponentCacheMisses");
+	releases_up2 = fu_engine_get_releases(engine, request, fu_device_get_id(device), NULL);
+	g_assert_cmpint(fu_engine_get_report_metadata_uint(engine, "ComponentCacheHits"),
+			==,
+			cache_hits);
+	g_assert_cmpint(fu_engine_get_report_metadata_uint(engine, "ComponentCacheMisses"),
+			>,
+			cache_misses);
 }
 
 static void
@@ -3316,6 +3441,285 @@ fu_engine_history_modify_func(gconstpointer user_data)
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
 }
 
+static void
+fu_history_transaction_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuDevice) device1 = fu_device_new(self->ctx);
+	g_autoptr(FuDevice) device2 = fu_device_new(self->ctx);
+	g_autoptr(FuDevice) device_tmp = NULL;
+	g_autoptr(FuHistory) history = fu_history_new(self->ctx);
+	g_autoptr(FuRelease) release = fu_release_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	ret = fu_history_remove_all(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* adding the same device twice replaces it */
+	fu_device_set_id(device1, "device1");
+	fu_device_set_id(device2, "device2");
+	ret = fu_history_transaction_begin(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_history_add_device(history, device1, release, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_history_add_device(history, device1, release, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* nested, and discarded */
+	ret = fu_history_transaction_begin(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_history_add_device(history, device2, release, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_history_transaction_rollback(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_history_transaction_commit(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	devices = fu_history_get_devices(history, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(devices);
+	g_assert_cmpint(devices->len, ==, 1);
+	device_tmp = fu_history_get_device_by_id(history, fu_device_get_id(device2), &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device_tmp);
+}
+
+static void
+fu_history_security_events_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	FwupdSecurityAttr *attr_tmp;
+	gboolean ret;
+	g_autoptr(FuHistory) history = fu_history_new(self->ctx);
+	g_autoptr(FwupdSecurityAttr) attr1 = fwupd_security_attr_new("org.fwupd.hsi.Foo");
+	g_autoptr(FwupdSecurityAttr) attr2 = fwupd_security_attr_new("org.fwupd.hsi.Bar");
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) events = g_ptr_array_new();
+	g_autoptr(GPtrArray) events_new = NULL;
+	g_autoptr(GPtrArray) events_none = NULL;
+
+	/* remove anything from previous tests */
+	ret = fu_history_clear_security_events(history, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	fwupd_security_attr_set_plugin(attr1, "foo");
+	fwupd_security_attr_set_result(attr1, FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	fwupd_security_attr_set_result_fallback(attr1, FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	fwupd_security_attr_add_flag(attr1, FWUPD_SECURITY_ATTR_FLAG_SUCCESS);
+	fwupd_security_attr_set_result(attr2, FWUPD_SECURITY_ATTR_RESULT_LOCKED);
+	g_ptr_array_add(events, attr1);
+	g_ptr_array_add(events, attr2);
+	ret = fu_history_add_security_events(history, events, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* a single snapshot has nothing to compare against */
+	events_none = fu_history_get_security_events(history, 1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(events_none);
+	g_assert_cmpint(events_none->len, ==, 0);
+
+	/* newest first, and both events are from the same change */
+	events_new = fu_history_get_security_events(history, 2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(events_new);
+	g_assert_cmpint(events_new->len, ==, 2);
+	attr_tmp = g_ptr_array_index(events_new, 0);
+	g_assert_cmpstr(fwupd_security_attr_get_appstream_id(attr_tmp), ==, "org.fwupd.hsi.Bar");
+	g_assert_null(fwupd_security_attr_get_plugin(attr_tmp));
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_LOCKED);
+	g_assert_cmpint(fwupd_security_attr_get_created(attr_tmp), >, 0);
+	attr_tmp = g_ptr_array_index(events_new, 1);
+	g_assert_cmpstr(fwupd_security_attr_get_appstream_id(attr_tmp), ==, "org.fwupd.hsi.Foo");
+	g_assert_cmpstr(fwupd_security_attr_get_plugin(attr_tmp), ==, "foo");
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	g_assert_cmpint(fwupd_security_attr_get_result_fallback(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	g_assert_true(fwupd_security_attr_has_flag(attr_tmp, FWUPD_SECURITY_ATTR_FLAG_SUCCESS));
+}
+
+static void
+fu_engine_search_index_func(void)
+{
+	gboolean ret;
+	const guint components_cnt = g_test_slow() ? 10000 : 100;
+	const guint lookup_cnt = 1000;
+	g_autoptr(FuEngineSearchIndex) search_index = fu_engine_search_index_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) components = NULL;
+	g_autoptr(GString) xml = g_string_new("<components>\n");
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* a silo about the size of the LVFS when benchmarking */
+	for (guint i = 0; i < components_cnt; i++) {
+		g_string_append_printf(
+		    xml,
+		    "<component type=\"firmware\">"
+		    "<id>com.acme.Widget%05u.firmware</id>"
+		    "<name>Acme Widget%05u</name>"
+		    "<developer_name>Acme</developer_name>"
+		    "<provides><firmware type=\"flashed\">%08x-0000-0000-0000-000000000000"
+		    "</firmware></provides>"
+		    "<releases><release version=\"1.2.3\">"
+		    "<artifacts><artifact type=\"binary\">"
+		    "<filename>widget%05u.cab</filename>"
+		    "<checksum type=\"sha1\">%040x</checksum>"
+		    "</artifact></artifacts>"
+		    "<issues><issue type=\"cve\">CVE-2025-%05u</issue></issues>"
+		    "</release></releases>"
+		    "<custom><value key=\"LVFS::UpdateProtocol\">com.acme.proto%u</value></custom>"
+		    "</component>\n",
+		    i,
+		    i,
+		    i,
+		    i,
+		    i,
+		    i,
+		    i % 10);
+	}
+	g_string_append(xml, "</components>\n");
+	ret = xb_builder_source_load_xml(source, xml->str, XB_BUILDER_SOURCE_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	xb_builder_import_source(builder, source);
+	silo = xb_builder_compile(builder, XB_BUILDER_COMPILE_FLAG_NONE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(silo);
+
+	g_timer_reset(timer);
+	ret = fu_engine_search_index_build(search_index, silo, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	if (g_test_slow())
+		g_print("build=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* exact values */
+	components = fu_engine_search_index_lookup(search_index, "com.acme.Widget00042.firmware");
+	g_assert_cmpint(components->len, ==, 1);
+	g_clear_pointer(&components, g_ptr_array_unref);
+	components =
+	    fu_engine_search_index_lookup(search_index, "0000002a-0000-0000-0000-000000000000");
+	g_assert_cmpint(components->len, ==, 1);
+	g_clear_pointer(&components, g_ptr_array_unref);
+	components = fu_engine_search_index_lookup(search_index, "widget00042.cab");
+	g_assert_cmpint(components->len, ==, 1);
+	g_clear_pointer(&components, g_ptr_array_unref);
+	components = fu_engine_search_index_lookup(search_index, "CVE-2025-00042");
+	g_assert_cmpint(components->len, ==, 1);
+	g_clear_pointer(&components, g_ptr_array_unref);
+	components = fu_engine_search_index_lookup(search_index, "com.acme.proto2");
+	g_assert_cmpint(components->len, ==, components_cnt / 10);
+	g_clear_pointer(&components, g_ptr_array_unref);
+
+	/* words and prefixes, case insensitive */
+	components = fu_engine_search_index_lookup(search_index, "WIDGET00042");
+	g_assert_cmpint(components->len, ==, 1);
+	g_clear_pointer(&components, g_ptr_array_unref);
+	components = fu_engine_search_index_lookup(search_index, "widget0004");
+	g_assert_cmpint(components->len, ==, 10);
+	g_clear_pointer(&components, g_ptr_array_unref);
+
+	/* in both name and developer name, but only returned once */
+	components = fu_engine_search_index_lookup(search_index, "acme");
+	g_assert_cmpint(components->len, ==, components_cnt);
+	g_clear_pointer(&components, g_ptr_array_unref);
+
+	/* nothing */
+	components = fu_engine_search_index_lookup(search_index, "XXX");
+	g_assert_cmpint(components->len, ==, 0);
+	g_clear_pointer(&components, g_ptr_array_unref);
+
+	/* typical searches */
+	if (!g_test_slow())
+		return;
+	g_timer_reset(timer);
+	for (guint i = 0; i < lookup_cnt; i++) {
+		components = fu_engine_search_index_lookup(search_index, "widget00042");
+		g_assert_cmpint(components->len, ==, 1);
+		g_clear_pointer(&components, g_ptr_array_unref);
+	}
+	g_print("lookup=%.3fms ", g_timer_elapsed(timer, NULL) * 1000.f / lookup_cnt);
+}
+
+static void
+fu_engine_snapshot_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *sysfs_path1 = NULL;
+	g_autofree gchar *sysfs_path2 = NULL;
+	g_autoptr(FuEngineSnapshot) snapshot1 = fu_engine_snapshot_new();
+	g_autoptr(FuEngineSnapshot) snapshot2 = fu_engine_snapshot_new();
+	g_autoptr(FuEngineSnapshot) snapshot3 = fu_engine_snapshot_new();
+	g_autoptr(FuUdevDevice) device1 = NULL;
+	g_autoptr(FuUdevDevice) device2 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	sysfs_path1 = g_test_build_filename(G_TEST_DIST, "tests", "sys", "bus", NULL);
+	sysfs_path2 = g_test_build_filename(G_TEST_DIST, "tests", "sys", "kernel", NULL);
+	device1 = fu_udev_device_new(self->ctx, sysfs_path1);
+	device2 = fu_udev_device_new(self->ctx, sysfs_path2);
+
+	/* nothing loaded */
+	fn = fu_path_build(FU_PATH_KIND_CACHEDIR_PKG, "snapshot-self-test.json", NULL);
+	(void)g_unlink(fn);
+	fu_engine_snapshot_set_context_id(snapshot1, "quirks1|config1");
+	ret = fu_engine_snapshot_load(snapshot1, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot1, FU_DEVICE(device1), "foo"));
+
+	fu_engine_snapshot_add_ignored(snapshot1, FU_DEVICE(device1), "foo");
+	ret = fu_engine_snapshot_save(snapshot1, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only the plugin and device that were ignored */
+	fu_engine_snapshot_set_context_id(snapshot2, "quirks1|config1");
+	ret = fu_engine_snapshot_load(snapshot2, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device1), "foo"));
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device1), "bar"));
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device2), "foo"));
+
+	/* the device changed mode or flags without being replugged */
+	g_object_set(device1, "driver", "foo", NULL);
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device1), "foo"));
+	g_object_set(device1, "driver", NULL, NULL);
+	g_assert_true(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device1), "foo"));
+	fu_device_add_flag(FU_DEVICE(device1), FWUPD_DEVICE_FLAG_NEEDS_REBOOT);
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot2, FU_DEVICE(device1), "foo"));
+	fu_device_remove_flag(FU_DEVICE(device1), FWUPD_DEVICE_FLAG_NEEDS_REBOOT);
+
+	/* quirks changed */
+	fu_engine_snapshot_set_context_id(snapshot3, "quirks2|config1");
+	ret = fu_engine_snapshot_load(snapshot3, fn, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_engine_snapshot_has_ignored(snapshot3, FU_DEVICE(device1), "foo"));
+}
+
 static void
 fu_engine_history_convert_version_func(gconstpointer user_data)
 {
@@ -4434,6 +4838,35 @@ fu_device_list_replug_auto_func(gconstpointer user_data)
 	g_assert_false(fu_device_has_flag(device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG));
 }
 
+static void
+fu_device_list_wait_for_device_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
+	g_autoptr(FuDevice) device_tmp1 = NULL;
+	g_autoptr(FuDevice) device_tmp2 = NULL;
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *guid = fwupd_guid_hash_string("foo");
+	FuDeviceListReplugHelper helper = {.device_list = device_list, .device_new = device};
+
+	fu_device_set_id(device, "device");
+	fu_device_add_instance_id(device, "foo");
+
+	/* never added */
+	device_tmp1 = fu_device_list_wait_for_device(device_list, "device", 10, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device_tmp1);
+	g_clear_error(&error);
+
+	/* added from the main loop while waiting */
+	g_timeout_add(10, fu_device_list_add_cb, &helper);
+	device_tmp2 = fu_device_list_wait_for_device(device_list, guid, 5000, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device_tmp2);
+	g_assert_true(device_tmp2 == device);
+}
+
 static void
 fu_device_list_replug_user_func(gconstpointer user_data)
 {
@@ -4895,6 +5328,110 @@ fu_device_list_unconnected_no_delay_func(gconstpointer user_data)
 	g_assert_true(fu_device_has_private_flag(device2, FU_DEVICE_PRIVATE_FLAG_UNCONNECTED));
 }
 
+typedef struct {
+	FuDeviceList *device_list;
+	const gchar *device_id;
+	gint done; /* atomic */
+} FuDeviceListSnapshotHelper;
+
+static gpointer
+fu_device_list_snapshot_thread_cb(gpointer user_data)
+{
+	FuDeviceListSnapshotHelper *helper = (FuDeviceListSnapshotHelper *)user_data;
+
+	while (!g_atomic_int_get(&helper->done)) {
+		g_autoptr(FuDevice) device = NULL;
+		g_autoptr(GPtrArray) devices = fu_device_list_get_all(helper->device_list);
+
+		/* the device may be removed at any point while we are using it */
+		device = fu_device_list_get_by_id(helper->device_list, helper->device_id, NULL);
+		if (device != NULL)
+			g_assert_cmpstr(fu_device_get_id(device), ==, helper->device_id);
+		for (guint i = 0; i < devices->len; i++) {
+			FuDevice *device_tmp = g_ptr_array_index(devices, i);
+			g_assert_true(FU_IS_DEVICE(device_tmp));
+			g_assert_nonnull(fu_device_get_id(device_tmp));
+		}
+	}
+	return NULL;
+}
+
+static void
+fu_device_list_snapshot_func(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+	g_autoptr(GPtrArray) devices_before = NULL;
+	g_autoptr(GPtrArray) devices_after = NULL;
+	g_autoptr(FuDevice) device3 = NULL;
+	g_autoptr(FuDevice) device4_found = NULL;
+	g_autoptr(GError) error = NULL;
+	FuDevice *device1 = fu_device_new(self->ctx);
+	FuDevice *device2 = fu_device_new(self->ctx);
+	FuDevice *device4 = fu_device_new(self->ctx);
+	FuDeviceListSnapshotHelper helper = {0};
+	GThread *thread;
+
+	g_object_add_weak_pointer(G_OBJECT(device1), (gpointer *)&device1);
+	g_object_add_weak_pointer(G_OBJECT(device2), (gpointer *)&device2);
+
+	fu_device_set_id(device1, "device1");
+	fu_device_list_add(device_list, device1);
+	devices_before = fu_device_list_get_all(device_list);
+	g_assert_cmpint(devices_before->len, ==, 1);
+
+	/* replacing the device does not change what earlier readers saw */
+	fu_device_set_id(device2, "device1");
+	fu_device_list_add(device_list, device2);
+	g_assert_cmpint(devices_before->len, ==, 1);
+	g_assert_true(g_ptr_array_index(devices_before, 0) == device1);
+	devices_after = fu_device_list_get_all(device_list);
+	g_assert_cmpint(devices_after->len, ==, 2);
+	g_assert_true(g_ptr_array_index(devices_after, 0) == device2);
+	g_assert_true(g_ptr_array_index(devices_after, 1) == device1);
+
+	/* the list holds no references once everything has been removed */
+	fu_device_list_remove_all(device_list);
+	g_clear_pointer(&devices_before, g_ptr_array_unref);
+	g_clear_pointer(&devices_after, g_ptr_array_unref);
+	g_object_unref(device1);
+	g_object_unref(device2);
+	g_assert_null(device1);
+	g_assert_null(device2);
+	devices_after = fu_device_list_get_all(device_list);
+	g_assert_cmpint(devices_after->len, ==, 0);
+
+	/* add and remove devices while another thread is looking them up */
+	device3 = fu_device_new(self->ctx);
+	fu_device_set_id(device3, "device3");
+	helper.device_list = device_list;
+	helper.device_id = fu_device_get_id(device3);
+	thread = g_thread_new("device-list-reader", fu_device_list_snapshot_thread_cb, &helper);
+	for (guint i = 0; i < 1000; i++) {
+		g_autoptr(FuDevice) device_tmp = fu_device_new(self->ctx);
+		fu_device_set_id(device_tmp, "device3");
+		fu_device_list_add(device_list, device_tmp);
+		fu_device_list_remove(device_list, device_tmp);
+	}
+	g_atomic_int_set(&helper.done, TRUE);
+	g_thread_join(thread);
+
+	/* a device that was looked up is kept alive after it is removed from the list */
+	g_object_add_weak_pointer(G_OBJECT(device4), (gpointer *)&device4);
+	fu_device_set_id(device4, "device4");
+	fu_device_list_add(device_list, device4);
+	device4_found = fu_device_list_get_by_id(device_list, fu_device_get_id(device4), &error);
+	g_assert_no_error(error);
+	g_assert_true(device4_found == device4);
+	fu_device_list_remove(device_list, device4);
+	g_object_unref(device4);
+	g_assert_nonnull(device4);
+	g_assert_null(fu_device_list_get_by_id(device_list, fu_device_get_id(device4_found), NULL));
+	g_assert_true(FU_IS_DEVICE(device4_found));
+	g_clear_object(&device4_found);
+	g_assert_null(device4);
+}
+
 static void
 fu_device_list_func(gconstpointer user_data)
 {
@@ -5114,6 +5651,55 @@ fu_history_migrate_v2_func(gconstpointer user_data)
 	g_assert_cmpstr(fu_device_get_id(device), ==, "2ba16d10df45823dd4494ff10a0bfccfef512c9d");
 }
 
+static void
+fu_history_migrate_v14_func(gconstpointer user_data)
+{
+	FwupdSecurityAttr *attr_tmp;
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file_dst = NULL;
+	g_autoptr(GFile) file_src = NULL;
+	g_autoptr(FuHistory) history = NULL;
+	g_autoptr(GPtrArray) events = NULL;
+	g_autofree gchar *filename = NULL;
+
+	/* load old version */
+	filename = g_test_build_filename(G_TEST_DIST, "tests", "history_v14.db", NULL);
+	file_src = g_file_new_for_path(filename);
+	file_dst = g_file_new_for_path("/tmp/fwupd-self-test/var/lib/fwupd/pending.db");
+	ret = g_file_copy(file_src, file_dst, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* create, migrating as required */
+	history = fu_history_new(ctx);
+	g_assert_nonnull(history);
+
+	/* the second snapshot was unchanged, the third changed Foo and added Baz */
+	events = fu_history_get_security_events(history, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(events);
+	g_assert_cmpint(events->len, ==, 2);
+	attr_tmp = g_ptr_array_index(events, 0);
+	g_assert_cmpstr(fwupd_security_attr_get_appstream_id(attr_tmp), ==, "org.fwupd.hsi.Foo");
+	g_assert_cmpstr(fwupd_security_attr_get_plugin(attr_tmp), ==, "foo");
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_NOT_ENABLED);
+	g_assert_cmpint(fwupd_security_attr_get_result_fallback(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_ENABLED);
+	g_assert_cmpint(fwupd_security_attr_get_created(attr_tmp), ==, 1704276000);
+	attr_tmp = g_ptr_array_index(events, 1);
+	g_assert_cmpstr(fwupd_security_attr_get_appstream_id(attr_tmp), ==, "org.fwupd.hsi.Baz");
+	g_assert_cmpstr(fwupd_security_attr_get_plugin(attr_tmp), ==, "baz");
+	g_assert_cmpint(fwupd_security_attr_get_result(attr_tmp),
+			==,
+			FWUPD_SECURITY_ATTR_RESULT_VALID);
+	g_assert_cmpint(fwupd_security_attr_get_created(attr_tmp), ==, 1704276000);
+}
+
 static void
 fu_test_plugin_device_added_cb(FuPlugin *plugin, FuDevice *device, gpointer user_data)
 {
@@ -6105,6 +6691,167 @@ fu_common_cabinet_func(void)
 	g_assert_null(img2);
 }
 
+static FuCabinet *
+fu_test_cabinet_verify(JcatContext *jcat_context,
+		       FuCabinetVerifyCache *verify_cache,
+		       GBytes *blob,
+		       FwupdReleaseFlags *release_flags)
+{
+	gboolean ret;
+	g_autoptr(FuCabinet) cabinet = fu_cabinet_new();
+	g_autoptr(GBytes) release_flags_blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) component = NULL;
+	g_autoptr(XbNode) release = NULL;
+
+	fu_cabinet_set_jcat_context(cabinet, jcat_context);
+	fu_cabinet_set_verify_cache(cabinet, verify_cache);
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cabinet),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_BLOB,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	component = fu_cabinet_get_component(cabinet, "org.fwupd.fakedevice.firmware", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(component);
+	release = xb_node_query_first(component, "releases/release", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(release);
+	release_flags_blob = xb_node_get_data(release, "fwupd::ReleaseFlags");
+	g_assert_nonnull(release_flags_blob);
+	memcpy(release_flags, g_bytes_get_data(release_flags_blob, NULL), sizeof(*release_flags));
+	return g_steal_pointer(&cabinet);
+}
+
+static void
+fu_cabinet_verify_cache_func(void)
+{
+	const gchar *filenames[] = {"fakedevice123.bin",
+				    "fakedevice123.jcat",
+				    "fakedevice123.metainfo.xml",
+				    NULL};
+	const gchar *filename = "/tmp/fwupd-self-test/verify.cache";
+	gboolean ret;
+	gdouble elapsed_cached;
+	gdouble elapsed_verify;
+	FwupdReleaseFlags release_flags = FWUPD_RELEASE_FLAG_NONE;
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *filename_key = g_strdup_printf("%s.key", filename);
+	g_autofree gchar *pkidir = NULL;
+	g_autoptr(FuCabFirmware) cab_firmware = fu_cab_firmware_new();
+	g_autoptr(FuCabinet) cabinet1 = NULL;
+	g_autoptr(FuCabinet) cabinet2 = NULL;
+	g_autoptr(FuCabinetVerifyCache) verify_cache = fu_cabinet_verify_cache_new();
+	g_autoptr(FuCabinetVerifyCache) verify_cache2 = fu_cabinet_verify_cache_new();
+	g_autoptr(FuCabinetVerifyCache) verify_cache3 = fu_cabinet_verify_cache_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_payload = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(JcatContext) jcat_context = jcat_context_new();
+	g_autoptr(JcatContext) jcat_context_nokeys = jcat_context_new();
+
+	/* signed by the LVFS */
+	for (guint i = 0; filenames[i] != NULL; i++) {
+		g_autofree gchar *fn =
+		    g_test_build_filename(G_TEST_DIST, "..", "data", "tests", filenames[i], NULL);
+		g_autoptr(FuCabImage) img = fu_cab_image_new();
+		g_autoptr(GBytes) blob_tmp = NULL;
+		if (!g_file_test(fn, G_FILE_TEST_EXISTS)) {
+			g_test_skip("missing signed test payload");
+			return;
+		}
+		blob_tmp = fu_bytes_get_contents(fn, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_tmp);
+		if (i == 0)
+			blob_payload = g_bytes_ref(blob_tmp);
+		fu_firmware_set_id(FU_FIRMWARE(img), filenames[i]);
+		fu_firmware_set_bytes(FU_FIRMWARE(img), blob_tmp);
+		ret = fu_firmware_add_image(FU_FIRMWARE(cab_firmware), FU_FIRMWARE(img), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	blob = fu_firmware_write(FU_FIRMWARE(cab_firmware), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_payload);
+
+	/* trust the LVFS */
+	pkidir = g_test_build_filename(G_TEST_DIST, "..", "data", "pki", NULL);
+	jcat_context_blob_kind_allow(jcat_context, JCAT_BLOB_KIND_SHA256);
+	jcat_context_blob_kind_allow(jcat_context, JCAT_BLOB_KIND_SHA512);
+	jcat_context_blob_kind_allow(jcat_context, JCAT_BLOB_KIND_PKCS7);
+	jcat_context_blob_kind_allow(jcat_context, JCAT_BLOB_KIND_GPG);
+	jcat_context_set_keyring_path(jcat_context, "/tmp/fwupd-self-test/var/lib/fwupd");
+	jcat_context_add_public_keys(jcat_context, pkidir);
+	ret = fu_cabinet_verify_cache_add_trust_root(verify_cache, pkidir, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_unlink(filename);
+	g_unlink(filename_key);
+	ret = fu_cabinet_verify_cache_load(verify_cache, filename, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_cabinet_verify_cache_get_size(verify_cache), ==, 0);
+
+	/* verify the signature */
+	g_timer_reset(timer);
+	cabinet1 = fu_test_cabinet_verify(jcat_context, verify_cache, blob, &release_flags);
+	elapsed_verify = g_timer_elapsed(timer, NULL);
+	if ((release_flags & FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD) == 0) {
+		g_test_skip("cannot verify the signed test payload");
+		return;
+	}
+	g_assert_cmpint(fu_cabinet_verify_cache_get_size(verify_cache), ==, 1);
+	g_assert_true(fu_cabinet_verify_cache_lookup(verify_cache,
+						     checksum,
+						     JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS));
+
+	/* seen before, so no signature check -- which would fail as there are no public keys */
+	release_flags = FWUPD_RELEASE_FLAG_NONE;
+	jcat_context_blob_kind_allow(jcat_context_nokeys, JCAT_BLOB_KIND_SHA256);
+	jcat_context_blob_kind_allow(jcat_context_nokeys, JCAT_BLOB_KIND_PKCS7);
+	jcat_context_blob_kind_allow(jcat_context_nokeys, JCAT_BLOB_KIND_GPG);
+	g_timer_reset(timer);
+	cabinet2 = fu_test_cabinet_verify(jcat_context_nokeys, verify_cache, blob, &release_flags);
+	elapsed_cached = g_timer_elapsed(timer, NULL);
+	g_assert_true((release_flags & FWUPD_RELEASE_FLAG_TRUSTED_PAYLOAD) > 0);
+	g_debug("verify=%.2fms cached=%.2fms", elapsed_verify * 1000.f, elapsed_cached * 1000.f);
+
+	/* the entry was appended as a single line */
+	ret = g_file_get_contents(filename, &buf, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(strlen(buf), ==, 65);
+
+	/* persistent */
+	ret = fu_cabinet_verify_cache_add_trust_root(verify_cache2, pkidir, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_cabinet_verify_cache_load(verify_cache2, filename, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_cabinet_verify_cache_get_size(verify_cache2), ==, 1);
+	g_assert_true(fu_cabinet_verify_cache_lookup(verify_cache2,
+						     checksum,
+						     JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS));
+	g_assert_false(fu_cabinet_verify_cache_lookup(verify_cache2,
+						      checksum,
+						      JCAT_VERIFY_FLAG_NONE));
+
+	/* different trust roots */
+	ret = fu_cabinet_verify_cache_load(verify_cache3, filename, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_cabinet_verify_cache_lookup(verify_cache3,
+						      checksum,
+						      JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS));
+}
+
 static void
 fu_memcpy_func(gconstpointer user_data)
 {
@@ -7986,10 +8733,60 @@ fu_test_engine_fake_v4l(gconstpointer user_data)
 	g_assert_cmpstr(fu_device_get_plugin(device), ==, "logitech_tap");
 }
 
+static void
+fu_test_engine_lazy_startup(gconstpointer user_data)
+{
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	g_autoptr(FuDevice) device = fu_device_new(self->ctx);
+	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new_from_gtype(fu_test_plugin_get_type(), self->ctx);
+	g_autoptr(FuPlugin) plugin_lazy = fu_plugin_new(self->ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo(engine, silo_empty);
+
+	/* the test plugin implements ->device_registered() so cannot wait for a device */
+	fu_plugin_set_name(plugin_lazy, "lazy");
+	fu_plugin_add_flag(plugin_lazy, FWUPD_PLUGIN_FLAG_LAZY_STARTUP);
+	fu_plugin_add_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP);
+	g_assert_true(fu_plugin_can_defer_startup(plugin_lazy));
+	g_assert_false(fu_plugin_can_defer_startup(plugin));
+	fu_engine_add_plugin(engine, plugin);
+	fu_engine_add_plugin(engine, plugin_lazy);
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_COLDPLUG | FU_ENGINE_LOAD_FLAG_READONLY |
+				 FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* deferred, but not reported as disabled */
+	g_assert_true(fu_plugin_get_deferred(plugin_lazy));
+	g_assert_null(fu_plugin_get_activation_reason(plugin_lazy));
+	g_assert_false(fu_plugin_has_flag(plugin_lazy, FWUPD_PLUGIN_FLAG_DISABLED));
+	g_assert_false(fu_plugin_get_deferred(plugin));
+	g_assert_false(fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED));
+
+	/* the test plugin still sees devices from other plugins */
+	fu_device_set_id(device, "lazy_device");
+	fu_device_set_plugin(device, "lazy");
+	fu_engine_add_device(engine, device);
+	g_assert_cmpstr(fu_device_get_metadata(device, "BestDevice"), ==, "/dev/urandom");
+}
+
 static void
 fu_test_engine_fake_nvme(gconstpointer user_data)
 {
 	FuTest *self = (FuTest *)user_data;
+	FuPlugin *plugin;
 	gboolean ret;
 	g_autoptr(FuDevice) device = NULL;
 	g_autoptr(FuEngine) engine = fu_engine_new(self->ctx);
@@ -8013,11 +8810,19 @@ fu_test_engine_fake_nvme(gconstpointer user_data)
 	g_assert_true(ret);
 
 	/* no linux/nvme_ioctl.h */
-	if (fu_engine_get_plugin_by_name(engine, "nvme", &error) == NULL) {
+	plugin = fu_engine_get_plugin_by_name(engine, "nvme", &error);
+	if (plugin == NULL) {
 		g_test_skip(error->message);
 		return;
 	}
 
+	/* started lazily by the backend device */
+	g_assert_true(fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_LAZY_STARTUP));
+	g_assert_true(fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_READY));
+	g_assert_false(fu_plugin_has_flag(plugin, FWUPD_PLUGIN_FLAG_DISABLED));
+	g_assert_false(fu_plugin_get_deferred(plugin));
+	g_assert_true(g_str_has_prefix(fu_plugin_get_activation_reason(plugin), "backend device "));
+
 	/* NVMe -> nvme */
 	device = fu_engine_get_device(engine, "4c263c95f596030b430d65dc934f6722bcee5720", &error);
 	g_assert_no_error(error);
@@ -8262,8 +9067,10 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/plugin{module}", self, fu_plugin_module_func);
 	g_test_add_data_func("/fwupd/memcpy", self, fu_memcpy_func);
 	g_test_add_func("/fwupd/cabinet", fu_common_cabinet_func);
+	g_test_add_func("/fwupd/cabinet{verify-cache}", fu_cabinet_verify_cache_func);
 	g_test_add_data_func("/fwupd/security-attr", self, fu_security_attr_func);
 	g_test_add_data_func("/fwupd/device-list", self, fu_device_list_func);
+	g_test_add_data_func("/fwupd/device-list{snapshot}", self, fu_device_list_snapshot_func);
 	g_test_add_data_func("/fwupd/device-list{unconnected-no-delay}",
 			     self,
 			     fu_device_list_unconnected_no_delay_func);
@@ -8346,6 +9153,7 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/engine{fake-usb}", self, fu_test_engine_fake_usb);
 	g_test_add_data_func("/fwupd/engine{fake-serio}", self, fu_test_engine_fake_serio);
 	g_test_add_data_func("/fwupd/engine{fake-nvme}", self, fu_test_engine_fake_nvme);
+	g_test_add_data_func("/fwupd/engine{lazy-startup}", self, fu_test_engine_lazy_startup);
 	g_test_add_data_func("/fwupd/engine{fake-block}", self, fu_test_engine_fake_block);
 	g_test_add_data_func("/fwupd/engine{fake-tpm}", self, fu_test_engine_fake_tpm);
 	g_test_add_data_func("/fwupd/engine{fake-v4l}", self, fu_test_engine_fake_v4l);
@@ -8357,7 +9165,11 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/device-list{replug-user}",
 			     self,
 			     fu_device_list_replug_user_func);
+	g_test_add_data_func("/fwupd/device-list{wait-for-device}",
+			     self,
+			     fu_device_list_wait_for_device_func);
 	g_test_add_func("/fwupd/engine{machine-hash}", fu_engine_machine_hash_func);
+	g_test_add_func("/fwupd/engine{search-index}", fu_engine_search_index_func);
 	g_test_add_func("/fwupd/engine{error-array}", fu_engine_error_array_func);
 	g_test_add_data_func("/fwupd/engine{report-metadata}",
 			     self,
@@ -8372,6 +9184,11 @@ main(int argc, char **argv)
 			     self,
 			     fu_engine_history_convert_version_func);
 	g_test_add_data_func("/fwupd/engine{partial-hash}", self, fu_engine_partial_hash_func);
+#ifdef HAVE_HSI
+	g_test_add_data_func("/fwupd/engine{security-attrs-sources}",
+			     self,
+			     fu_engine_security_attrs_sources_func);
+#endif
 	g_test_add_data_func("/fwupd/engine{downgrade}", self, fu_engine_downgrade_func);
 	g_test_add_data_func("/fwupd/engine{md-verfmt}", self, fu_engine_md_verfmt_func);
 	g_test_add_data_func("/fwupd/engine{requirements-success}",
@@ -8477,6 +9294,12 @@ main(int argc, char **argv)
 	g_test_add_data_func("/fwupd/history", self, fu_history_func);
 	g_test_add_data_func("/fwupd/history{migrate-v1}", self, fu_history_migrate_v1_func);
 	g_test_add_data_func("/fwupd/history{migrate-v2}", self, fu_history_migrate_v2_func);
+	g_test_add_data_func("/fwupd/history{migrate-v14}", self, fu_history_migrate_v14_func);
+	g_test_add_data_func("/fwupd/history{transaction}", self, fu_history_transaction_func);
+	g_test_add_data_func("/fwupd/engine{snapshot}", self, fu_engine_snapshot_func);
+	g_test_add_data_func("/fwupd/history{security-events}",
+			     self,
+			     fu_history_security_events_func);
 	g_test_add_data_func("/fwupd/plugin-list", self, fu_plugin_list_func);
 	g_test_add_data_func("/fwupd/plugin-list{depsolve}", self, fu_plugin_list_depsolve_func);
 	g_test_add_func("/fwupd/common{cab-success}", fu_common_store_cab_func);
@@ -541,8 +541,16 @@ fu_util_get_plugins(FuUtil *self, gchar **values, GError **error)
 	/* print */
 	for (guint i = 0; i < plugins->len; i++) {
 		FuPlugin *plugin = g_ptr_array_index(plugins, i);
-		g_autofree gchar *str = fu_util_plugin_to_string(FWUPD_PLUGIN(plugin), 0);
-		fu_console_print_literal(self->console, str);
+		g_autofree gchar *tmp = fu_util_plugin_to_string(FWUPD_PLUGIN(plugin), 0);
+		g_autoptr(GString) str = g_string_new(tmp);
+
+		/* only set for plugins with lazy startup */
+		fwupd_codec_string_append(str,
+					  1,
+					  /* TRANSLATORS: why the plugin was started */
+					  _("Activated by"),
+					  fu_plugin_get_activation_reason(plugin));
+		fu_console_print_literal(self->console, str->str);
 	}
 
 	return TRUE;
@@ -3141,6 +3149,79 @@ fu_util_prompt_for_firmware_type(FuUtil *self, GPtrArray *firmware_types, GError
 	return g_strdup(g_ptr_array_index(firmware_types, idx - 1));
 }
 
+typedef struct {
+	gchar *id;
+	FuFirmwareDetectKind kind;
+} FuUtilFirmwareCandidate;
+
+static void
+fu_util_firmware_candidate_free(FuUtilFirmwareCandidate *candidate)
+{
+	g_free(candidate->id);
+	g_free(candidate);
+}
+
+static gint
+fu_util_firmware_candidate_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuUtilFirmwareCandidate *candidate1 = *((FuUtilFirmwareCandidate **)a);
+	FuUtilFirmwareCandidate *candidate2 = *((FuUtilFirmwareCandidate **)b);
+	if (candidate1->kind > candidate2->kind)
+		return -1;
+	if (candidate1->kind < candidate2->kind)
+		return 1;
+	return g_strcmp0(candidate1->id, candidate2->id);
+}
+
+/* only looks at the header, so the most likely firmware types are first */
+static GPtrArray *
+fu_util_firmware_detect_candidates(FuUtil *self, GInputStream *stream, GError **error)
+{
+	FuContext *ctx = fu_engine_get_context(self->engine);
+	g_autoptr(GPtrArray) gtype_ids = fu_context_get_firmware_gtype_ids(ctx);
+	g_autoptr(GPtrArray) candidates =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_util_firmware_candidate_free);
+
+	for (guint i = 0; i < gtype_ids->len; i++) {
+		const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
+		FuFirmwareDetectKind kind = FU_FIRMWARE_DETECT_KIND_UNKNOWN;
+		FuUtilFirmwareCandidate *candidate;
+		GType gtype_tmp;
+		g_autoptr(FuFirmware) firmware_tmp = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		if (g_strcmp0(gtype_id, "raw") == 0)
+			continue;
+		gtype_tmp = fu_context_get_firmware_gtype_by_id(ctx, gtype_id);
+		if (gtype_tmp == G_TYPE_INVALID) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_FOUND,
+				    "GType %s not supported",
+				    gtype_id);
+			return NULL;
+		}
+		firmware_tmp = g_object_new(gtype_tmp, NULL);
+		if (fu_firmware_has_flag(firmware_tmp, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
+			continue;
+		if (!fu_firmware_detect(firmware_tmp,
+					stream,
+					0x0,
+					FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+					&kind,
+					&error_local)) {
+			g_debug("not %s: %s", gtype_id, error_local->message);
+			continue;
+		}
+		candidate = g_new0(FuUtilFirmwareCandidate, 1);
+		candidate->id = g_strdup(gtype_id);
+		candidate->kind = kind;
+		g_ptr_array_add(candidates, candidate);
+	}
+	g_ptr_array_sort(candidates, fu_util_firmware_candidate_sort_cb);
+	return g_steal_pointer(&candidates);
+}
+
 static gboolean
 fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 {
@@ -3179,31 +3260,43 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 		firmware_type = fu_util_prompt_for_firmware_type(self, firmware_types, error);
 		if (firmware_type == NULL)
 			return FALSE;
+	} else if (g_strcmp0(values[1], "detect") == 0) {
+		g_autoptr(GPtrArray) candidates = NULL;
+		candidates = fu_util_firmware_detect_candidates(self, stream, error);
+		if (candidates == NULL)
+			return FALSE;
+		if (candidates->len == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOTHING_TO_DO,
+					    "No detected firmware types");
+			return FALSE;
+		}
+		for (guint i = 0; i < candidates->len; i++) {
+			FuUtilFirmwareCandidate *candidate = g_ptr_array_index(candidates, i);
+			fu_console_print(self->console,
+					 "%s\t%s",
+					 fu_firmware_detect_kind_to_string(candidate->kind),
+					 candidate->id);
+		}
+		return TRUE;
 	} else if (g_strcmp0(values[1], "auto") == 0) {
-		g_autoptr(GPtrArray) gtype_ids = fu_context_get_firmware_gtype_ids(ctx);
+		g_autoptr(GPtrArray) candidates = NULL;
 		g_autoptr(GPtrArray) firmware_auto_types = g_ptr_array_new_with_free_func(g_free);
-		for (guint i = 0; i < gtype_ids->len; i++) {
-			const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
-			GType gtype_tmp;
+
+		/* only parse the types where the header matched */
+		candidates = fu_util_firmware_detect_candidates(self, stream, error);
+		if (candidates == NULL)
+			return FALSE;
+		for (guint i = 0; i < candidates->len; i++) {
+			FuUtilFirmwareCandidate *candidate = g_ptr_array_index(candidates, i);
+			const gchar *gtype_id = candidate->id;
+			GType gtype_tmp = fu_context_get_firmware_gtype_by_id(ctx, gtype_id);
 			g_autofree gchar *firmware_str = NULL;
-			g_autoptr(FuFirmware) firmware_tmp = NULL;
+			g_autoptr(FuFirmware) firmware_tmp = g_object_new(gtype_tmp, NULL);
 			g_autoptr(GError) error_local = NULL;
 
-			if (g_strcmp0(gtype_id, "raw") == 0)
-				continue;
 			g_debug("parsing as %s", gtype_id);
-			gtype_tmp = fu_context_get_firmware_gtype_by_id(ctx, gtype_id);
-			if (gtype_tmp == G_TYPE_INVALID) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_FOUND,
-					    "GType %s not supported",
-					    gtype_id);
-				return FALSE;
-			}
-			firmware_tmp = g_object_new(gtype_tmp, NULL);
-			if (fu_firmware_has_flag(firmware_tmp, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
-				continue;
 			if (!fu_firmware_parse_stream(firmware_tmp,
 						      stream,
 						      0x0,
@@ -3237,6 +3330,9 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 	/* match the behavior of the daemon as we're printing the children */
 	self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM;
 
+	/* BIOS images can contain many compressed files, and the result is the same */
+	self->parse_flags |= FU_FIRMWARE_PARSE_FLAG_THREADED;
+
 	/* does firmware specify an internal size */
 	firmware = g_object_new(gtype, NULL);
 	if (fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_ALLOW_LINEAR)) {
@@ -5353,6 +5449,7 @@ main(int argc, char *argv[])
 	g_autofree gchar *cmd_descriptions = NULL;
 	g_autofree gchar *filter_device = NULL;
 	g_autofree gchar *filter_release = NULL;
+	g_autofree gchar *trace_filename = NULL;
 	const GOptionEntry options[] = {
 	    {"version",
 	     '\0',
@@ -5524,6 +5621,14 @@ main(int argc, char *argv[])
 	     N_("Filter with a set of release flags using a ~ prefix to "
 		"exclude, e.g. 'trusted-release,~trusted-metadata'"),
 	     NULL},
+	    {"trace",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &trace_filename,
+	     /* TRANSLATORS: command line option */
+	     N_("Save a timing trace that can be loaded into Perfetto"),
+	     NULL},
 	    {"assume-yes",
 	     'y',
 	     0,
@@ -6142,6 +6247,7 @@ main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 	fu_progress_set_profile(self->progress, g_getenv("FWUPD_VERBOSE") != NULL);
+	fu_trace_set_enabled(trace_filename != NULL);
 
 	/* allow disabling SSL strict mode for broken corporate proxies */
 	if (self->disable_ssl_strict) {
@@ -6242,6 +6348,13 @@ main(int argc, char *argv[])
 
 	/* run the specified command */
 	ret = fu_util_cmd_array_run(cmd_array, self, argv[1], (gchar **)&argv[2], &error);
+
+	/* the trace is most useful when the command failed */
+	if (trace_filename != NULL) {
+		g_autoptr(GError) error_trace = NULL;
+		if (!fu_trace_save(trace_filename, &error_trace))
+			g_warning("failed to save trace: %s", error_trace->message);
+	}
 	if (!ret) {
 #ifdef SUPPORTED_BUILD
 		/* sanity check */
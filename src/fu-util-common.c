@@ -1645,6 +1645,10 @@ fu_util_plugin_flag_to_string(FwupdPluginFlags plugin_flag)
 		/* TRANSLATORS: The plugin enumeration might change the device current mode */
 		return g_strdup(_("Plugin enumeration may change device state"));
 	}
+	if (plugin_flag == FWUPD_PLUGIN_FLAG_LAZY_STARTUP) {
+		/* TRANSLATORS: The plugin is only started when a supported device is found */
+		return g_strdup(_("Started when matching hardware is found"));
+	}
 
 	/* fall back for unknown types */
 	return g_strdup(fwupd_plugin_flag_to_string(plugin_flag));
@@ -1665,6 +1669,7 @@ fu_util_plugin_flag_to_cli_text(FwupdPluginFlags plugin_flag)
 	case FWUPD_PLUGIN_FLAG_MODULAR:
 	case FWUPD_PLUGIN_FLAG_MEASURE_SYSTEM_INTEGRITY:
 	case FWUPD_PLUGIN_FLAG_SECURE_CONFIG:
+	case FWUPD_PLUGIN_FLAG_LAZY_STARTUP:
 		return fu_console_color_format(plugin_flag_str, FU_CONSOLE_COLOR_GREEN);
 	case FWUPD_PLUGIN_FLAG_DISABLED:
 	case FWUPD_PLUGIN_FLAG_NO_HARDWARE:
@@ -2708,6 +2708,29 @@ fu_util_get_updates_as_json(FuUtil *self, GPtrArray *devices, GError **error)
 	return fu_util_print_builder(self->console, builder, error);
 }
 
+static void
+fu_util_show_component_cache_stats(FuUtil *self)
+{
+	const gchar *keys[] = {"ComponentCacheHits", "ComponentCacheMisses", "ComponentCacheSize"};
+	g_autoptr(GHashTable) metadata = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* only useful when debugging */
+	if (g_getenv("FWUPD_VERBOSE") == NULL)
+		return;
+	metadata =
+	    fwupd_client_get_report_metadata(self->client, self->cancellable, &error_local);
+	if (metadata == NULL) {
+		g_debug("failed to get report metadata: %s", error_local->message);
+		return;
+	}
+	for (guint i = 0; i < G_N_ELEMENTS(keys); i++) {
+		const gchar *value = g_hash_table_lookup(metadata, keys[i]);
+		if (value != NULL)
+			g_debug("%s: %s", keys[i], value);
+	}
+}
+
 static gboolean
 fu_util_get_updates(FuUtil *self, gchar **values, GError **error)
 {
@@ -2790,6 +2813,7 @@ fu_util_get_updates(FuUtil *self, gchar **values, GError **error)
 			g_node_append_data(child, g_object_ref(rel));
 		}
 	}
+	fu_util_show_component_cache_stats(self);
 
 	/* devices that have no updates available for whatever reason */
 	if (devices_no_support->len > 0) {
@@ -5487,7 +5511,7 @@ main(int argc, char *argv[])
 	FwupdFeatureFlags feature_flags =
 	    FWUPD_FEATURE_FLAG_CAN_REPORT | FWUPD_FEATURE_FLAG_SWITCH_BRANCH |
 	    FWUPD_FEATURE_FLAG_FDE_WARNING | FWUPD_FEATURE_FLAG_COMMUNITY_TEXT |
-	    FWUPD_FEATURE_FLAG_SHOW_PROBLEMS;
+	    FWUPD_FEATURE_FLAG_SHOW_PROBLEMS | FWUPD_FEATURE_FLAG_PACKED_PAYLOADS;
 
 #ifdef _WIN32
 	/* workaround Windows setting the codepage to 1252 */